@@ -486,13 +486,15 @@ class USERPREF_PT_system(Panel):
 
         col.label(text="Images Draw Method:")
         col.prop(system, "image_draw_method", text="")
+        col.prop(system, "display_lut_tolerance")
 
         col.separator()
 
         col.label(text="Sequencer / Clip Editor:")
-        # currently disabled in the code
-        # col.prop(system, "prefetch_frames")
+        col.prop(system, "prefetch_frames")
         col.prop(system, "memory_cache_limit")
+        col.prop(system, "sequencer_disk_cache_limit", text="Disk Cache Limit")
+        col.prop(system, "sequencer_disk_cache_compression", text="")
 
         # 3. Column
         column = split.column()
@@ -943,6 +945,7 @@ class USERPREF_PT_file(Panel):
         sub.label(text="Sounds:")
         sub.label(text="Temp:")
         sub.label(text="Render Cache:")
+        sub.label(text="Sequencer Cache:")
         sub.label(text="I18n Branches:")
         sub.label(text="Image Editor:")
         sub.label(text="Animation Player:")
@@ -955,6 +958,7 @@ class USERPREF_PT_file(Panel):
         sub.prop(paths, "sound_directory", text="")
         sub.prop(paths, "temporary_directory", text="")
         sub.prop(paths, "render_cache_directory", text="")
+        sub.prop(paths, "sequencer_disk_cache_directory", text="")
         sub.prop(paths, "i18n_branches_directory", text="")
         sub.prop(paths, "image_editor", text="")
         subsplit = sub.split(percentage=0.3)
@@ -986,6 +990,9 @@ class USERPREF_PT_file(Panel):
         col.label(text="Save & Load:")
         col.prop(paths, "use_relative_paths")
         col.prop(paths, "use_file_compression")
+        sub = col.column()
+        sub.active = paths.use_file_compression
+        sub.prop(paths, "use_file_compression_fast")
         col.prop(paths, "use_load_ui")
         col.prop(paths, "use_filter_files")
         col.prop(paths, "show_hidden_files_datablocks")
@@ -129,10 +129,13 @@ enum {
 	G_DEBUG_GPU_MEM =   (1 << 10), /* gpu memory in status bar */
 	G_DEBUG_DEPSGRAPH_NO_THREADS = (1 << 11),  /* single threaded depsgraph */
 	G_DEBUG_GPU =        (1 << 12), /* gpu debug */
+	G_DEBUG_IO =         (1 << 13), /* IO debugging (for blend file reading/writing) */
+	G_DEBUG_COMPOSITOR = (1 << 14), /* compositor execution time and memory statistics */
 };
 
 #define G_DEBUG_ALL  (G_DEBUG | G_DEBUG_FFMPEG | G_DEBUG_PYTHON | G_DEBUG_EVENTS | G_DEBUG_WM | G_DEBUG_JOBS | \
-                      G_DEBUG_FREESTYLE | G_DEBUG_DEPSGRAPH | G_DEBUG_GPU_MEM)
+                      G_DEBUG_FREESTYLE | G_DEBUG_DEPSGRAPH | G_DEBUG_GPU_MEM | G_DEBUG_IO | \
+                      G_DEBUG_COMPOSITOR)
 
 
 /* G.fileflags */
@@ -178,6 +181,8 @@ enum {
 #define G_FILE_MESH_COMPAT       (1 << 26)
 /* On write, restore paths after editing them (G_FILE_RELATIVE_REMAP) */
 #define G_FILE_SAVE_COPY         (1 << 27)
+/* On write, use multi-threaded block compression instead of gzip (only used with G_FILE_COMPRESS) */
+#define G_FILE_COMPRESS_FAST     (1 << 28)
 
 #define G_FILE_FLAGS_RUNTIME (G_FILE_NO_UI | G_FILE_RELATIVE_REMAP | G_FILE_MESH_COMPAT | G_FILE_SAVE_COPY)
 
@@ -102,6 +102,7 @@ typedef struct SeqRenderData {
 	float motion_blur_shutter;
 	bool skip_cache;
 	bool is_proxy_render;
+	bool is_prefetch_render;  /* scene and strips are copies owned by a prefetch thread */
 	int view_id;
 
 	/* special case for OpenGL render */
@@ -187,10 +188,8 @@ struct SeqEffectHandle {
  * ********************************************************************** */
 
 struct ImBuf *BKE_sequencer_give_ibuf(const SeqRenderData *context, float cfra, int chanshown);
-struct ImBuf *BKE_sequencer_give_ibuf_threaded(const SeqRenderData *context, float cfra, int chanshown);
 struct ImBuf *BKE_sequencer_give_ibuf_direct(const SeqRenderData *context, float cfra, struct Sequence *seq);
 struct ImBuf *BKE_sequencer_give_ibuf_seqbase(const SeqRenderData *context, float cfra, int chan_shown, struct ListBase *seqbasep);
-void BKE_sequencer_give_ibuf_prefetch_request(const SeqRenderData *context, float cfra, int chan_shown);
 
 /* **********************************************************************
  * sequencer.c
@@ -236,6 +235,7 @@ void BKE_sequencer_base_clipboard_pointers_restore(struct ListBase *seqbase, str
 
 void BKE_sequence_free(struct Scene *scene, struct Sequence *seq);
 void BKE_sequence_free_anim(struct Sequence *seq);
+void BKE_sequence_base_free_copy(ListBase *seqbase);
 const char *BKE_sequence_give_name(struct Sequence *seq);
 ListBase *BKE_sequence_seqbase_get(struct Sequence *seq, int *r_offset);
 void BKE_sequence_calc(struct Scene *scene, struct Sequence *seq);
@@ -251,9 +251,23 @@ bool BKE_sequencer_input_have_to_preprocess(const SeqRenderData *context, struct
 
 void BKE_sequencer_proxy_rebuild_context(struct Main *bmain, struct Scene *scene, struct Sequence *seq, struct GSet *file_list, ListBase *queue);
 void BKE_sequencer_proxy_rebuild(struct SeqIndexBuildContext *context, short *stop, short *do_update, float *progress);
+void BKE_sequencer_proxy_rebuild_queue(ListBase *queue, short *stop, short *do_update, float *progress);
 void BKE_sequencer_proxy_rebuild_finish(struct SeqIndexBuildContext *context, bool stop);
 
 void BKE_sequencer_proxy_set(struct Sequence *seq, bool value);
+/* **********************************************************************
+ * seqprefetch.c
+ *
+ * Sequencer render ahead of playback
+ * ********************************************************************** */
+
+struct ImBuf *BKE_sequencer_give_ibuf_threaded(const SeqRenderData *context, float cfra, int chanshown);
+void BKE_sequencer_prefetch_stop(void);
+void BKE_sequencer_prefetch_cancel(void);
+bool BKE_sequencer_prefetch_cache_begin(struct Scene **scene, struct Sequence **seq);
+void BKE_sequencer_prefetch_cache_end(void);
+bool BKE_sequencer_prefetch_stats_get(int *r_tot_ready, int *r_tot_shown, float *r_fps);
+
 /* **********************************************************************
  * seqcache.c
  *
@@ -395,6 +409,7 @@ typedef struct SeqLoadInfo {
 #define SEQ_DUPE_CONTEXT        (1 << 1)
 #define SEQ_DUPE_ANIM           (1 << 2)
 #define SEQ_DUPE_ALL            (1 << 3) /* otherwise only selected are copied */
+#define SEQ_DUPE_NO_SOUND       (1 << 4) /* sound strips are not copied, for copies only used for rendering */
 
 /* use as an api function */
 typedef struct Sequence *(*SeqLoadFunc)(struct bContext *, ListBase *, struct SeqLoadInfo *);
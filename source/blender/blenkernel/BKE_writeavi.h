@@ -47,7 +47,7 @@ typedef struct bMovieHandle {
 	                   struct ReportList *reports, bool preview, const char *suffix);
 	int (*append_movie)(void *context_v, struct RenderData *rd, int start_frame, int frame, int *pixels,
 	                    int rectx, int recty, const char *suffix, struct ReportList *reports);
-	void (*end_movie)(void *context_v);
+	int (*end_movie)(void *context_v, struct ReportList *reports);
 	int (*get_next_frame)(void *context_v, struct RenderData *rd, struct ReportList *reports); /* optional */
 	void (*get_movie_path)(char *string, struct RenderData *rd, bool preview, const char *suffix); /* optional */
 	void *(*context_create)(void);
@@ -69,7 +69,7 @@ struct ReportList;
 struct Scene;
 
 int BKE_ffmpeg_start(void *context_v, struct Scene *scene, struct RenderData *rd, int rectx, int recty, struct ReportList *reports, bool preview, const char *suffix);
-void BKE_ffmpeg_end(void *context_v);
+int BKE_ffmpeg_end(void *context_v, struct ReportList *reports);
 int BKE_ffmpeg_append(void *context_v, struct RenderData *rd, int start_frame, int frame, int *pixels,
                       int rectx, int recty, const char *suffix, struct ReportList *reports);
 void BKE_ffmpeg_filepath_get(char *string, struct RenderData *rd, bool preview, const char *suffix);
@@ -43,7 +43,7 @@ struct Scene;
 int BKE_frameserver_start(
         void *context_v, struct Scene *scene, struct RenderData *rd, int rectx, int recty,
         struct ReportList *reports, bool preview, const char *suffix);
-void BKE_frameserver_end(void *context_v);
+int BKE_frameserver_end(void *context_v, struct ReportList *reports);
 int BKE_frameserver_append(
         void *context_v, struct RenderData *rd, int start_frame, int frame, int *pixels,
         int rectx, int recty, const char *suffix, struct ReportList *reports);
@@ -49,11 +49,14 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "DNA_material_types.h"
+#include "DNA_object_types.h"
 #include "DNA_userdef_types.h"
 #include "DNA_scene_types.h"
 #include "DNA_screen_types.h"
 #include "DNA_view3d_types.h"
 #include "DNA_windowmanager_types.h"
+#include "DNA_world_types.h"
 
 #include "BLI_blenlib.h"
 #include "BLI_utildefines.h"
@@ -92,6 +95,8 @@
 
 #include "RNA_access.h"
 
+#include "GPU_material.h"
+
 #include "WM_api.h" // XXXXX BAD, very BAD dependency (bad level call) - remove asap, elubie
 
 #include "IMB_colormanagement.h"
@@ -567,6 +572,40 @@ bool BKE_read_file_from_memory(
 	return (bfd != NULL);
 }
 
+/**
+ * Datablocks kept from the current state on undo (see #BLO_memfile_tag_identical) keep all their runtime data,
+ * clear what depends on datablocks that are freed (GPU materials and lamps point to the scene).
+ * Must run before the old main is freed.
+ */
+static void undo_reused_ids_runtime_reset(Main *bmain)
+{
+	ListBase *lbarray[MAX_LIBARRAY];
+	ID *id;
+	int a;
+
+	a = set_listbasepointers(bmain, lbarray);
+	while (a--) {
+		for (id = lbarray[a]->first; id; id = id->next) {
+			if ((id->tag & LIB_TAG_UNDO_OLD_ID_REUSED) == 0) {
+				continue;
+			}
+			id->tag &= ~LIB_TAG_UNDO_OLD_ID_REUSED;
+
+			switch (GS(id->name)) {
+				case ID_MA:
+					GPU_material_free(&((Material *)id)->gpumaterial);
+					break;
+				case ID_WO:
+					GPU_material_free(&((World *)id)->gpumaterial);
+					break;
+				case ID_OB:
+					GPU_lamp_free((Object *)id);
+					break;
+			}
+		}
+	}
+}
+
 /* memfile is the undo buffer */
 bool BKE_read_file_from_memfile(
         bContext *C, MemFile *memfile,
@@ -581,6 +620,8 @@ bool BKE_read_file_from_memfile(
 			BKE_libblock_free_ex(bfd->main, bfd->main->wm.first, true);
 		while (bfd->main->screen.first)
 			BKE_libblock_free_ex(bfd->main, bfd->main->screen.first, true);
+
+		undo_reused_ids_runtime_reset(bfd->main);
 		
 		setup_app_data(C, bfd, "<memory1>", reports);
 	}
@@ -670,7 +711,11 @@ static ListBase undobase = {NULL, NULL};
 static UndoElem *curundo = NULL;
 
 
-static int read_undosave(bContext *C, UndoElem *uel)
+/**
+ * \param uel_current: The step matching the current state (when known), its unchanged datablocks are kept.
+ * This assumes all changes are followed by an undo push.
+ */
+static int read_undosave(bContext *C, UndoElem *uel, UndoElem *uel_current)
 {
 	char mainstr[sizeof(G.main->name)];
 	int success = 0, fileflags;
@@ -685,8 +730,11 @@ static int read_undosave(bContext *C, UndoElem *uel)
 
 	if (UNDO_DISK) 
 		success = (BKE_read_file(C, uel->str, NULL) != BKE_READ_FILE_FAIL);
-	else
+	else {
+		BLO_memfile_tag_identical(&uel->memfile, uel_current ? &uel_current->memfile : NULL);
 		success = BKE_read_file_from_memfile(C, &uel->memfile, NULL);
+		BLO_memfile_tag_identical(&uel->memfile, NULL);
+	}
 
 	/* restore */
 	BLI_strncpy(G.main->name, mainstr, sizeof(G.main->name)); /* restore */
@@ -808,7 +856,7 @@ void BKE_undo_step(bContext *C, int step)
 {
 	
 	if (step == 0) {
-		read_undosave(C, curundo);
+		read_undosave(C, curundo, NULL);
 	}
 	else if (step == 1) {
 		/* curundo should never be NULL, after restart or load file it should call undo_save */
@@ -818,7 +866,7 @@ void BKE_undo_step(bContext *C, int step)
 		else {
 			if (G.debug & G_DEBUG) printf("undo %s\n", curundo->name);
 			curundo = curundo->prev;
-			read_undosave(C, curundo);
+			read_undosave(C, curundo, curundo->next);
 		}
 	}
 	else {
@@ -828,7 +876,7 @@ void BKE_undo_step(bContext *C, int step)
 			// XXX error("No redo available");
 		}
 		else {
-			read_undosave(C, curundo->next);
+			read_undosave(C, curundo->next, curundo);
 			curundo = curundo->next;
 			if (G.debug & G_DEBUG) printf("redo %s\n", curundo->name);
 		}
@@ -852,8 +900,10 @@ void BKE_undo_reset(void)
 /* based on index nr it does a restore */
 void BKE_undo_number(bContext *C, int nr)
 {
+	UndoElem *uel_current = curundo;
+
 	curundo = BLI_findlink(&undobase, nr);
-	BKE_undo_step(C, 0);
+	read_undosave(C, curundo, uel_current);
 }
 
 /* go back to the last occurance of name in stack */
@@ -862,8 +912,10 @@ void BKE_undo_name(bContext *C, const char *name)
 	UndoElem *uel = BLI_rfindstring(&undobase, name, offsetof(UndoElem, name));
 
 	if (uel && uel->prev) {
+		UndoElem *uel_current = curundo;
+
 		curundo = uel->prev;
-		BKE_undo_step(C, 0);
+		read_undosave(C, curundo, uel_current);
 	}
 }
 
@@ -106,6 +106,8 @@ void DAG_init(void)
 void DAG_exit(void)
 {
 	BLI_spin_end(&threaded_update_lock);
+	/* Write trace requested from the command line. */
+	DEG_debug_trace_end();
 	DEG_free_node_types();
 }
 
@@ -1689,6 +1691,18 @@ void DAG_relations_tag_update(Main *bmain)
 	}
 }
 
+void DAG_id_relations_tag_update(Main *bmain, ID *id)
+{
+	if (DEG_depsgraph_use_legacy()) {
+		/* Legacy graph can only be rebuilt as a whole. */
+		DAG_relations_tag_update(bmain);
+	}
+	else {
+		/* New dependency graph. */
+		DEG_id_tag_relations_update(bmain, id);
+	}
+}
+
 /* rebuild dependency graph only for a given scene */
 void DAG_scene_relations_rebuild(Main *bmain, Scene *sce)
 {
@@ -3534,6 +3548,8 @@ void DAG_init(void)
 
 void DAG_exit(void)
 {
+	/* Write trace requested from the command line. */
+	DEG_debug_trace_end();
 	DEG_free_node_types();
 }
 
@@ -3557,6 +3573,11 @@ void DAG_relations_tag_update(Main *bmain)
 	DEG_relations_tag_update(bmain);
 }
 
+void DAG_id_relations_tag_update(Main *bmain, ID *id)
+{
+	DEG_id_tag_relations_update(bmain, id);
+}
+
 /* Rebuild dependency graph only for a given scene. */
 void DAG_scene_relations_rebuild(Main *bmain, Scene *scene)
 {
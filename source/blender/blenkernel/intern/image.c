@@ -3218,6 +3218,38 @@ static void image_create_multilayer(Image *ima, ImBuf *ibuf, int framenr)
 	/* set proper views */
 	image_init_multilayer_multiview(ima, ima->rr);
 }
+
+/* multilayer files are opened without reading their passes, those are read when first used,
+ * returns false when the file is not a multilayer file */
+static bool image_open_multilayer(Image *ima, const char *filepath, int framenr)
+{
+	const char *colorspace = ima->colorspace_settings.name;
+	bool predivide = (ima->alpha_mode == IMA_ALPHA_PREMUL);
+	RenderResult *rr;
+
+	if (!BLI_testextensie(filepath, ".exr")) {
+		return false;
+	}
+
+	rr = RE_MultilayerOpen(filepath, colorspace, predivide);
+	if (rr == NULL) {
+		return false;
+	}
+
+	/* only load rr once for multiview */
+	if (!ima->rr)
+		ima->rr = rr;
+	else
+		RE_FreeRenderResult(rr);
+
+	ima->rr->framenr = framenr;
+	ima->type = IMA_TYPE_MULTILAYER;
+
+	/* set proper views */
+	image_init_multilayer_multiview(ima, ima->rr);
+
+	return true;
+}
 #endif  /* WITH_OPENEXR */
 
 /* common stuff to do with images after loading */
@@ -3290,6 +3322,14 @@ static ImBuf *load_sequence_single(Image *ima, ImageUser *iuser, int frame, cons
 	flag = IB_rect | IB_multilayer;
 	flag |= imbuf_alpha_flags_for_image(ima);
 
+#ifdef WITH_OPENEXR
+	/* handle multilayer case, don't assign ibuf. will be handled in BKE_image_acquire_ibuf,
+	 * the first frame of a sequence is loaded below to detect the type */
+	if (ima->type == IMA_TYPE_MULTILAYER && image_open_multilayer(ima, name, frame)) {
+		return NULL;
+	}
+#endif
+
 	/* read ibuf */
 	ibuf = IMB_loadiffname(name, flag, ima->colorspace_settings.name);
 
@@ -3410,7 +3450,7 @@ static ImBuf *image_load_sequence_multilayer(Image *ima, ImageUser *iuser, int f
 	if (ima->rr) {
 		RenderPass *rpass = BKE_image_multilayer_index(ima->rr, iuser);
 
-		if (rpass) {
+		if (rpass && RE_MultilayerReadPass(ima->rr, rpass)) {
 			// printf("load from pass %s\n", rpass->name);
 			/* since we free  render results, we copy the rect */
 			ibuf = IMB_allocImBuf(ima->rr->rectx, ima->rr->recty, 32, 0);
@@ -3595,6 +3635,13 @@ static ImBuf *load_image_single(
 
 		BKE_image_user_file_path(&iuser_t, ima, filepath);
 
+#ifdef WITH_OPENEXR
+		/* handle multilayer case, don't assign ibuf. will be handled in BKE_image_acquire_ibuf */
+		if (image_open_multilayer(ima, filepath, cfra)) {
+			return NULL;
+		}
+#endif
+
 		/* read ibuf */
 		ibuf = IMB_loadiffname(filepath, flag, ima->colorspace_settings.name);
 	}
@@ -3729,7 +3776,7 @@ static ImBuf *image_get_ibuf_multilayer(Image *ima, ImageUser *iuser)
 	if (ima->rr) {
 		RenderPass *rpass = BKE_image_multilayer_index(ima->rr, iuser);
 
-		if (rpass) {
+		if (rpass && RE_MultilayerReadPass(ima->rr, rpass)) {
 			ibuf = IMB_allocImBuf(ima->rr->rectx, ima->rr->recty, 32, 0);
 
 			image_initialize_after_load(ima, ibuf);
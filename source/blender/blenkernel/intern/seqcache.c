@@ -27,6 +27,8 @@
  */
 
 #include <stddef.h>
+#include <stdio.h>
+#include <string.h>
 
 #include "BLI_sys_types.h"  /* for intptr_t */
 
@@ -34,16 +36,42 @@
 
 #include "DNA_sequence_types.h"
 #include "DNA_scene_types.h"
+#include "DNA_userdef_types.h"
 
+#include "IMB_colormanagement.h"
 #include "IMB_moviecache.h"
 #include "IMB_imbuf.h"
 #include "IMB_imbuf_types.h"
 
+#include "BLI_fileops.h"
+#include "BLI_ghash.h"
+#include "BLI_hash_mm2a.h"
 #include "BLI_listbase.h"
+#include "BLI_path_util.h"
+#include "BLI_string.h"
+#include "BLI_threads.h"
+#include "BLI_utildefines.h"
 
+#include "BKE_appdir.h"
+#include "BKE_global.h"
 #include "BKE_sequencer.h"
 #include "BKE_scene.h"
 
+#ifdef WITH_LZO
+#  ifdef WITH_SYSTEM_LZO
+#    include <lzo/lzo1x.h>
+#  else
+#    include "minilzo.h"
+#  endif
+#  define LZO_HEAP_ALLOC(var,size) \
+	lzo_align_t __LZO_MMODEL var [ ((size) + (sizeof(lzo_align_t) - 1)) / sizeof(lzo_align_t) ]
+#  define LZO_OUT_LEN(size)     ((size) + (size) / 16 + 64 + 3)
+#endif
+
+#ifdef WITH_LZMA
+#  include "LzmaLib.h"
+#endif
+
 typedef struct SeqCacheKey {
 	struct Sequence *seq;
 	SeqRenderData context;
@@ -69,7 +97,14 @@ typedef struct SeqPreprocessCache {
 static struct MovieCache *moviecache = NULL;
 static struct SeqPreprocessCache *preprocess_cache = NULL;
 
+/* strips of a frame can be rendered from multiple threads */
+static ThreadMutex cache_lock = BLI_MUTEX_INITIALIZER;
+
 static void preprocessed_cache_destruct(void);
+static void seq_disk_cache_evict_cb(ImBuf *ibuf, void *userkey);
+static ImBuf *seq_disk_cache_get(const SeqCacheKey *key);
+static void seq_disk_cache_cleanup(Sequence *seq);
+static void seq_disk_cache_destruct(void);
 
 static bool seq_cmp_render_data(const SeqRenderData *a, const SeqRenderData *b)
 {
@@ -123,20 +158,33 @@ static bool seqcache_hashcmp(const void *a_, const void *b_)
 
 void BKE_sequencer_cache_destruct(void)
 {
-	if (moviecache)
+	BKE_sequencer_prefetch_stop();
+
+	BLI_mutex_lock(&cache_lock);
+	if (moviecache) {
 		IMB_moviecache_free(moviecache);
+		moviecache = NULL;
+	}
+	BLI_mutex_unlock(&cache_lock);
 
 	preprocessed_cache_destruct();
+	seq_disk_cache_destruct();
 }
 
 void BKE_sequencer_cache_cleanup(void)
 {
+	BKE_sequencer_prefetch_cancel();
+
+	BLI_mutex_lock(&cache_lock);
 	if (moviecache) {
 		IMB_moviecache_free(moviecache);
 		moviecache = IMB_moviecache_create("seqcache", sizeof(SeqCacheKey), seqcache_hashhash, seqcache_hashcmp);
+		IMB_moviecache_set_evict_callback(moviecache, seq_disk_cache_evict_cb);
 	}
+	BLI_mutex_unlock(&cache_lock);
 
 	BKE_sequencer_preprocessed_cache_cleanup();
+	seq_disk_cache_cleanup(NULL);
 }
 
 static bool seqcache_key_check_seq(ImBuf *UNUSED(ibuf), void *userkey, void *userdata)
@@ -149,13 +197,21 @@ static bool seqcache_key_check_seq(ImBuf *UNUSED(ibuf), void *userkey, void *use
 
 void BKE_sequencer_cache_cleanup_sequence(Sequence *seq)
 {
+	BKE_sequencer_prefetch_cancel();
+
+	BLI_mutex_lock(&cache_lock);
 	if (moviecache)
 		IMB_moviecache_cleanup(moviecache, seqcache_key_check_seq, seq);
+	BLI_mutex_unlock(&cache_lock);
+
+	seq_disk_cache_cleanup(seq);
 }
 
 struct ImBuf *BKE_sequencer_cache_get(const SeqRenderData *context, Sequence *seq, float cfra, eSeqStripElemIBuf type)
 {
-	if (moviecache && seq) {
+	ImBuf *ibuf = NULL;
+
+	if (seq) {
 		SeqCacheKey key;
 
 		key.seq = seq;
@@ -163,10 +219,40 @@ struct ImBuf *BKE_sequencer_cache_get(const SeqRenderData *context, Sequence *se
 		key.cfra = cfra - seq->start;
 		key.type = type;
 
-		return IMB_moviecache_get(moviecache, &key);
+		/* prefetch threads render copies of the strips, frames are cached for the originals */
+		if (context->is_prefetch_render) {
+			if (!BKE_sequencer_prefetch_cache_begin(&key.context.scene, &key.seq)) {
+				return NULL;
+			}
+			key.context.is_prefetch_render = false;
+		}
+
+		BLI_mutex_lock(&cache_lock);
+		if (moviecache) {
+			ibuf = IMB_moviecache_get(moviecache, &key);
+		}
+		BLI_mutex_unlock(&cache_lock);
+
+		/* frames freed from memory may still be in the disk cache, they go back in memory
+		 * as they're likely to be needed again, files are kept until the disk cache is full */
+		if (ibuf == NULL) {
+			ibuf = seq_disk_cache_get(&key);
+
+			if (ibuf) {
+				BLI_mutex_lock(&cache_lock);
+				if (moviecache) {
+					IMB_moviecache_put(moviecache, &key, ibuf);
+				}
+				BLI_mutex_unlock(&cache_lock);
+			}
+		}
+
+		if (context->is_prefetch_render) {
+			BKE_sequencer_prefetch_cache_end();
+		}
 	}
 
-	return NULL;
+	return ibuf;
 }
 
 void BKE_sequencer_cache_put(const SeqRenderData *context, Sequence *seq, float cfra, eSeqStripElemIBuf type, ImBuf *i)
@@ -177,25 +263,39 @@ void BKE_sequencer_cache_put(const SeqRenderData *context, Sequence *seq, float
 		return;
 	}
 
-	if (!moviecache) {
-		moviecache = IMB_moviecache_create("seqcache", sizeof(SeqCacheKey), seqcache_hashhash, seqcache_hashcmp);
-	}
-
 	key.seq = seq;
 	key.context = *context;
 	key.cfra = cfra - seq->start;
 	key.type = type;
 
+	/* frames of outdated copies are dropped */
+	if (context->is_prefetch_render) {
+		if (!BKE_sequencer_prefetch_cache_begin(&key.context.scene, &key.seq)) {
+			return;
+		}
+		key.context.is_prefetch_render = false;
+	}
+
+	BLI_mutex_lock(&cache_lock);
+
+	if (!moviecache) {
+		moviecache = IMB_moviecache_create("seqcache", sizeof(SeqCacheKey), seqcache_hashhash, seqcache_hashcmp);
+		IMB_moviecache_set_evict_callback(moviecache, seq_disk_cache_evict_cb);
+	}
+
 	IMB_moviecache_put(moviecache, &key, i);
+
+	BLI_mutex_unlock(&cache_lock);
+
+	if (context->is_prefetch_render) {
+		BKE_sequencer_prefetch_cache_end();
+	}
 }
 
-void BKE_sequencer_preprocessed_cache_cleanup(void)
+static void preprocessed_cache_free_elems(void)
 {
 	SeqPreprocessCacheElem *elem;
 
-	if (!preprocess_cache)
-		return;
-
 	for (elem = preprocess_cache->elems.first; elem; elem = elem->next) {
 		IMB_freeImBuf(elem->ibuf);
 	}
@@ -204,6 +304,17 @@ void BKE_sequencer_preprocessed_cache_cleanup(void)
 	BLI_listbase_clear(&preprocess_cache->elems);
 }
 
+void BKE_sequencer_preprocessed_cache_cleanup(void)
+{
+	BKE_sequencer_prefetch_cancel();
+
+	BLI_mutex_lock(&cache_lock);
+	if (preprocess_cache) {
+		preprocessed_cache_free_elems();
+	}
+	BLI_mutex_unlock(&cache_lock);
+}
+
 static void preprocessed_cache_destruct(void)
 {
 	if (!preprocess_cache)
@@ -218,40 +329,43 @@ static void preprocessed_cache_destruct(void)
 ImBuf *BKE_sequencer_preprocessed_cache_get(const SeqRenderData *context, Sequence *seq, float cfra, eSeqStripElemIBuf type)
 {
 	SeqPreprocessCacheElem *elem;
+	ImBuf *ibuf = NULL;
 
-	if (!preprocess_cache)
+	/* only keeps a single frame, which is the one shown by the interface */
+	if (context->is_prefetch_render) {
 		return NULL;
+	}
 
-	if (preprocess_cache->cfra != cfra)
-		return NULL;
+	BLI_mutex_lock(&cache_lock);
 
-	for (elem = preprocess_cache->elems.first; elem; elem = elem->next) {
-		if (elem->seq != seq)
-			continue;
+	if (preprocess_cache && preprocess_cache->cfra == cfra) {
+		for (elem = preprocess_cache->elems.first; elem; elem = elem->next) {
+			if (elem->seq != seq)
+				continue;
 
-		if (elem->type != type)
-			continue;
+			if (elem->type != type)
+				continue;
 
-		if (seq_cmp_render_data(&elem->context, context) != 0)
-			continue;
+			if (seq_cmp_render_data(&elem->context, context) != 0)
+				continue;
 
-		IMB_refImBuf(elem->ibuf);
-		return elem->ibuf;
+			IMB_refImBuf(elem->ibuf);
+			ibuf = elem->ibuf;
+			break;
+		}
 	}
 
-	return NULL;
+	BLI_mutex_unlock(&cache_lock);
+
+	return ibuf;
 }
 
 void BKE_sequencer_preprocessed_cache_put(const SeqRenderData *context, Sequence *seq, float cfra, eSeqStripElemIBuf type, ImBuf *ibuf)
 {
 	SeqPreprocessCacheElem *elem;
 
-	if (!preprocess_cache) {
-		preprocess_cache = MEM_callocN(sizeof(SeqPreprocessCache), "sequencer preprocessed cache");
-	}
-	else {
-		if (preprocess_cache->cfra != cfra)
-			BKE_sequencer_preprocessed_cache_cleanup();
+	if (context->is_prefetch_render) {
+		return;
 	}
 
 	elem = MEM_callocN(sizeof(SeqPreprocessCacheElem), "sequencer preprocessed cache element");
@@ -261,27 +375,585 @@ void BKE_sequencer_preprocessed_cache_put(const SeqRenderData *context, Sequence
 	elem->context = *context;
 	elem->ibuf = ibuf;
 
-	preprocess_cache->cfra = cfra;
-
 	IMB_refImBuf(ibuf);
 
+	BLI_mutex_lock(&cache_lock);
+
+	if (!preprocess_cache) {
+		preprocess_cache = MEM_callocN(sizeof(SeqPreprocessCache), "sequencer preprocessed cache");
+	}
+	else {
+		if (preprocess_cache->cfra != cfra)
+			preprocessed_cache_free_elems();
+	}
+
+	preprocess_cache->cfra = cfra;
+
 	BLI_addtail(&preprocess_cache->elems, elem);
+
+	BLI_mutex_unlock(&cache_lock);
 }
 
 void BKE_sequencer_preprocessed_cache_cleanup_sequence(Sequence *seq)
 {
 	SeqPreprocessCacheElem *elem, *elem_next;
 
-	if (!preprocess_cache)
+	BKE_sequencer_prefetch_cancel();
+
+	BLI_mutex_lock(&cache_lock);
+
+	if (preprocess_cache) {
+		for (elem = preprocess_cache->elems.first; elem; elem = elem_next) {
+			elem_next = elem->next;
+
+			if (elem->seq == seq) {
+				IMB_freeImBuf(elem->ibuf);
+
+				BLI_freelinkN(&preprocess_cache->elems, elem);
+			}
+		}
+	}
+
+	BLI_mutex_unlock(&cache_lock);
+}
+
+/* ********************* Disk cache ********************* */
+
+/* Frames freed from the memory cache by the cache limiter are written to a directory by a
+ * background thread, optionally compressed, and read back when they're needed again, which
+ * is much faster than rendering scene strips and stacks of effects again.
+ *
+ * Files are indexed with the same keys as the memory cache and are invalidated along with
+ * it, so they're only used by the session that wrote them. Until its file is written, an
+ * entry keeps the frame itself, so frames are never missing while they're waiting.
+ *
+ * The cache always makes a new directory, only deletes the files of its entries and
+ * only removes the directory once it's empty, so nothing else is ever deleted. */
+
+#define SEQ_DISK_CACHE_VERSION 2
+
+/* frames waiting to be written, more frames freed from memory are not kept */
+#define SEQ_DISK_CACHE_MAX_PENDING 16
+
+enum {
+	SEQ_DISK_CACHE_RECT       = (1 << 0),
+	SEQ_DISK_CACHE_RECT_FLOAT = (1 << 1),
+};
+
+typedef struct SeqDiskCacheHeader {
+	char magic[4];
+	int version;
+	int x, y;
+	unsigned char planes, channels, flag, compression;
+	uint64_t data_size;         /* size of the pixels */
+	uint64_t stored_size;       /* size of the pixels in the file, after compression */
+	unsigned int hash;          /* of the pixels, to detect corrupted files */
+	unsigned int props_size;
+	unsigned char props[16];    /* LZMA properties */
+	char rect_colorspace[64];
+	char float_colorspace[64];
+} SeqDiskCacheHeader;
+
+typedef struct SeqDiskCacheEntry {
+	struct SeqDiskCacheEntry *next, *prev;
+
+	SeqCacheKey key;
+	char filepath[FILE_MAX];
+	size_t size;
+
+	/* frame waiting to be written, NULL once the file is written */
+	ImBuf *ibuf;
+} SeqDiskCacheEntry;
+
+typedef struct SeqDiskCacheWrite {
+	SeqCacheKey key;
+	char filepath[FILE_MAX];
+	ImBuf *ibuf;
+} SeqDiskCacheWrite;
+
+typedef struct SeqDiskCache {
+	ListBase threads;
+	ThreadQueue *queue;
+	bool stop;
+
+	/* protected by disk_cache_lock */
+	GHash *entries;     /* SeqCacheKey -> SeqDiskCacheEntry */
+	ListBase lru;       /* entries, least recently used first */
+	size_t size;
+	int tot_pending;
+	unsigned int file_index;
+	char dirpath[FILE_MAX];
+	bool dir_created;
+
+	/* statistics, reported with --debug */
+	int tot_written;
+	int tot_read;
+} SeqDiskCache;
+
+static SeqDiskCache disk_cache = {{NULL}};
+
+/* frames are freed from memory by any thread putting buffers in a movie cache,
+ * so this is never locked for longer than looking up entries */
+static ThreadMutex disk_cache_lock = BLI_MUTEX_INITIALIZER;
+
+static size_t seq_disk_cache_write_file(const char *filepath, ImBuf *ibuf, short compression)
+{
+	SeqDiskCacheHeader header = {{0}};
+	const size_t rect_size = ibuf->rect ? (size_t)ibuf->x * ibuf->y * sizeof(unsigned int) : 0;
+	const size_t float_size = ibuf->rect_float ? (size_t)ibuf->x * ibuf->y * ibuf->channels * sizeof(float) : 0;
+	unsigned char *data, *out = NULL;
+	FILE *fp;
+	bool ok;
+
+	memcpy(header.magic, "BSQC", sizeof(header.magic));
+	header.version = SEQ_DISK_CACHE_VERSION;
+	header.x = ibuf->x;
+	header.y = ibuf->y;
+	header.planes = ibuf->planes;
+	header.channels = ibuf->channels;
+	header.data_size = rect_size + float_size;
+
+	if (ibuf->rect) {
+		header.flag |= SEQ_DISK_CACHE_RECT;
+		if (ibuf->rect_colorspace) {
+			BLI_strncpy(header.rect_colorspace, IMB_colormanagement_get_rect_colorspace(ibuf),
+			            sizeof(header.rect_colorspace));
+		}
+	}
+	if (ibuf->rect_float) {
+		header.flag |= SEQ_DISK_CACHE_RECT_FLOAT;
+		if (ibuf->float_colorspace) {
+			BLI_strncpy(header.float_colorspace, IMB_colormanagement_get_float_colorspace(ibuf),
+			            sizeof(header.float_colorspace));
+		}
+	}
+
+	data = MEM_mallocN((size_t)header.data_size, "seq disk cache data");
+	if (rect_size) {
+		memcpy(data, ibuf->rect, rect_size);
+	}
+	if (float_size) {
+		memcpy(data + rect_size, ibuf->rect_float, float_size);
+	}
+
+	header.hash = BLI_hash_mm2(data, (size_t)header.data_size, 0);
+	header.stored_size = header.data_size;
+
+	(void)compression; /* unused when building w/o compression */
+
+#ifdef WITH_LZO
+	if (compression == USER_SEQ_DISK_CACHE_COMPRESS_FAST) {
+		LZO_HEAP_ALLOC(wrkmem, LZO1X_MEM_COMPRESS);
+		lzo_uint out_len;
+
+		out = MEM_mallocN((size_t)LZO_OUT_LEN(header.data_size), "seq disk cache lzo");
+		if (lzo1x_1_compress(data, (lzo_uint)header.data_size, out, &out_len, wrkmem) == LZO_E_OK &&
+		    out_len < header.data_size)
+		{
+			header.compression = USER_SEQ_DISK_CACHE_COMPRESS_FAST;
+			header.stored_size = out_len;
+		}
+	}
+#endif
+#ifdef WITH_LZMA
+	if (compression == USER_SEQ_DISK_CACHE_COMPRESS_HIGH) {
+		size_t out_len = (size_t)header.data_size, props_size = sizeof(header.props);
+
+		out = MEM_mallocN((size_t)header.data_size, "seq disk cache lzma");
+		if (LzmaCompress(out, &out_len, data, (size_t)header.data_size, header.props, &props_size,
+		                 5, 1 << 24, 3, 0, 2, 32, 2) == SZ_OK &&
+		    out_len < header.data_size)
+		{
+			header.compression = USER_SEQ_DISK_CACHE_COMPRESS_HIGH;
+			header.stored_size = out_len;
+			header.props_size = (unsigned int)props_size;
+		}
+	}
+#endif
+
+	fp = BLI_fopen(filepath, "wb");
+	if (fp) {
+		ok = (fwrite(&header, sizeof(header), 1, fp) == 1 &&
+		      fwrite(header.compression ? out : data, (size_t)header.stored_size, 1, fp) == 1);
+		ok = (fclose(fp) == 0) && ok;
+
+		if (!ok) {
+			BLI_delete(filepath, false, false);
+		}
+	}
+	else {
+		ok = false;
+	}
+
+	MEM_freeN(data);
+	if (out) {
+		MEM_freeN(out);
+	}
+
+	return ok ? sizeof(header) + (size_t)header.stored_size : 0;
+}
+
+static ImBuf *seq_disk_cache_read_file(const char *filepath)
+{
+	SeqDiskCacheHeader header;
+	unsigned char *stored = NULL, *data = NULL;
+	ImBuf *ibuf = NULL;
+	size_t rect_size, float_size;
+	bool ok = false;
+	FILE *fp;
+
+	fp = BLI_fopen(filepath, "rb");
+	if (fp == NULL) {
+		return NULL;
+	}
+
+	if (fread(&header, sizeof(header), 1, fp) == 1 &&
+	    memcmp(header.magic, "BSQC", sizeof(header.magic)) == 0 &&
+	    header.version == SEQ_DISK_CACHE_VERSION &&
+	    header.props_size <= sizeof(header.props) &&
+	    header.x > 0 && header.y > 0 && IN_RANGE_INCL(header.channels, 1, 4))
+	{
+		/* sizes are checked against the frame, so a corrupted header can't allocate any size */
+		rect_size = (header.flag & SEQ_DISK_CACHE_RECT) ? (size_t)header.x * header.y * sizeof(unsigned int) : 0;
+		float_size = (header.flag & SEQ_DISK_CACHE_RECT_FLOAT) ?
+		             (size_t)header.x * header.y * header.channels * sizeof(float) : 0;
+
+		if (header.data_size == rect_size + float_size && header.stored_size <= header.data_size) {
+			stored = MEM_mallocN((size_t)header.stored_size, "seq disk cache stored");
+			ok = (fread(stored, (size_t)header.stored_size, 1, fp) == 1);
+		}
+	}
+	fclose(fp);
+
+	if (ok) {
+		if (header.compression == USER_SEQ_DISK_CACHE_COMPRESS_NONE) {
+			data = stored;
+			stored = NULL;
+			ok = (header.stored_size == header.data_size);
+		}
+		else {
+			data = MEM_mallocN((size_t)header.data_size, "seq disk cache data");
+			ok = false;
+#ifdef WITH_LZO
+			if (header.compression == USER_SEQ_DISK_CACHE_COMPRESS_FAST) {
+				lzo_uint out_len = (lzo_uint)header.data_size;
+				ok = (lzo1x_decompress_safe(stored, (lzo_uint)header.stored_size, data, &out_len, NULL) == LZO_E_OK &&
+				      out_len == header.data_size);
+			}
+#endif
+#ifdef WITH_LZMA
+			if (header.compression == USER_SEQ_DISK_CACHE_COMPRESS_HIGH) {
+				size_t out_len = (size_t)header.data_size, in_len = (size_t)header.stored_size;
+				ok = (LzmaUncompress(data, &out_len, stored, &in_len, header.props, header.props_size) == SZ_OK &&
+				      out_len == header.data_size);
+			}
+#endif
+		}
+	}
+
+	if (ok) {
+		ok = (BLI_hash_mm2(data, (size_t)header.data_size, 0) == header.hash);
+	}
+
+	if (ok) {
+		ibuf = IMB_allocImBuf(header.x, header.y, header.planes,
+		                      (header.flag & SEQ_DISK_CACHE_RECT) ? IB_rect : 0);
+
+		/* float buffers are allocated with 4 channels, frames may have fewer */
+		if (ibuf && float_size) {
+			ibuf->rect_float = MEM_mapallocN(float_size, "seq disk cache rect_float");
+			ibuf->channels = header.channels;
+			ibuf->mall |= IB_rectfloat;
+			ibuf->flags |= IB_rectfloat;
+		}
+
+		if (ibuf) {
+			if (ibuf->rect) {
+				memcpy(ibuf->rect, data, rect_size);
+				if (header.rect_colorspace[0]) {
+					IMB_colormanagement_assign_rect_colorspace(ibuf, header.rect_colorspace);
+				}
+			}
+			if (ibuf->rect_float) {
+				memcpy(ibuf->rect_float, data + rect_size, float_size);
+				if (header.float_colorspace[0]) {
+					IMB_colormanagement_assign_float_colorspace(ibuf, header.float_colorspace);
+				}
+			}
+		}
+	}
+
+	if (stored) {
+		MEM_freeN(stored);
+	}
+	if (data) {
+		MEM_freeN(data);
+	}
+
+	return ibuf;
+}
+
+static void seq_disk_cache_entry_remove(SeqDiskCacheEntry *entry)
+{
+	BLI_ghash_remove(disk_cache.entries, &entry->key, NULL, NULL);
+	BLI_remlink(&disk_cache.lru, entry);
+
+	if (entry->ibuf) {
+		/* the writer thread deletes the file when it finds the entry is gone */
+		IMB_freeImBuf(entry->ibuf);
+	}
+	else {
+		BLI_delete(entry->filepath, false, false);
+		disk_cache.size -= entry->size;
+	}
+
+	MEM_freeN(entry);
+}
+
+static void seq_disk_cache_limit(void)
+{
+	const size_t limit = (size_t)max_ii(U.sequencer_disk_cache_limit, 0) * 1024 * 1024;
+	SeqDiskCacheEntry *entry, *entry_next;
+
+	for (entry = disk_cache.lru.first; entry && disk_cache.size > limit; entry = entry_next) {
+		entry_next = entry->next;
+
+		if (entry->ibuf == NULL) {
+			seq_disk_cache_entry_remove(entry);
+		}
+	}
+}
+
+static void *seq_disk_cache_thread(void *UNUSED(data))
+{
+	SeqDiskCacheWrite *write;
+
+	while ((write = BLI_thread_queue_pop(disk_cache.queue))) {
+		SeqDiskCacheEntry *entry;
+		size_t size = 0;
+
+		if (!disk_cache.stop) {
+			size = seq_disk_cache_write_file(write->filepath, write->ibuf, U.sequencer_disk_cache_compression);
+		}
+
+		BLI_mutex_lock(&disk_cache_lock);
+
+		/* the entry may have been removed or replaced while the frame was written */
+		entry = BLI_ghash_lookup(disk_cache.entries, &write->key);
+		if (entry && entry->ibuf == write->ibuf) {
+			if (size) {
+				IMB_freeImBuf(entry->ibuf);
+				entry->ibuf = NULL;
+				entry->size = size;
+				disk_cache.size += size;
+				disk_cache.tot_written++;
+				seq_disk_cache_limit();
+			}
+			else {
+				seq_disk_cache_entry_remove(entry);
+			}
+		}
+		else if (size) {
+			BLI_delete(write->filepath, false, false);
+		}
+
+		disk_cache.tot_pending--;
+
+		BLI_mutex_unlock(&disk_cache_lock);
+
+		IMB_freeImBuf(write->ibuf);
+		MEM_freeN(write);
+	}
+
+	return NULL;
+}
+
+/* Make a new directory for the files. The session temp directory may be the shared temp
+ * directory when it couldn't be made, so an existing directory is never used. */
+static void seq_disk_cache_dir_create(void)
+{
+	const char *tempdir = BKE_tempdir_session();
+	char dirpath[FILE_MAX];
+	int index;
+
+	/* in a user directory, files are kept apart from other sessions in a directory named after the session */
+	if (U.sequencer_disk_cache_dir[0]) {
+		char session[FILE_MAX];
+
+		BLI_strncpy(session, tempdir, sizeof(session));
+		BLI_del_slash(session);
+		BLI_join_dirfile(dirpath, sizeof(dirpath), U.sequencer_disk_cache_dir, BLI_path_basename(session));
+	}
+	else {
+		BLI_join_dirfile(dirpath, sizeof(dirpath), tempdir, "sequencer_cache");
+	}
+
+	BLI_strncpy(disk_cache.dirpath, dirpath, sizeof(disk_cache.dirpath));
+	for (index = 1; BLI_exists(disk_cache.dirpath); index++) {
+		BLI_snprintf(disk_cache.dirpath, sizeof(disk_cache.dirpath), "%s_%d", dirpath, index);
+	}
+
+	/* when it can't be made, files fail to be written and frames are only kept in memory */
+	BLI_dir_create_recursive(disk_cache.dirpath);
+	disk_cache.dir_created = BLI_is_dir(disk_cache.dirpath);
+}
+
+static void seq_disk_cache_start(void)
+{
+	seq_disk_cache_dir_create();
+
+	disk_cache.entries = BLI_ghash_new(seqcache_hashhash, seqcache_hashcmp, "seq disk cache entries");
+	disk_cache.queue = BLI_thread_queue_init();
+	disk_cache.stop = false;
+
+	BLI_init_threads(&disk_cache.threads, seq_disk_cache_thread, 1);
+	BLI_insert_thread(&disk_cache.threads, NULL);
+}
+
+/* Frames are only freed from memory with the cache limiter locked, so this can't render,
+ * lock the memory cache or wait for files to be written. */
+static void seq_disk_cache_evict_cb(ImBuf *ibuf, void *userkey)
+{
+	const SeqCacheKey *key = userkey;
+	SeqDiskCacheEntry *entry;
+	SeqDiskCacheWrite *write;
+	char filename[FILE_MAXFILE];
+
+	if (U.sequencer_disk_cache_limit <= 0 ||
+	    !ELEM(key->type, SEQ_STRIPELEM_IBUF, SEQ_STRIPELEM_IBUF_COMP) ||
+	    (ibuf->rect == NULL && ibuf->rect_float == NULL))
+	{
 		return;
+	}
+
+	BLI_mutex_lock(&disk_cache_lock);
+
+	if (disk_cache.queue == NULL) {
+		seq_disk_cache_start();
+	}
+
+	if (disk_cache.tot_pending >= SEQ_DISK_CACHE_MAX_PENDING || BLI_ghash_haskey(disk_cache.entries, key)) {
+		BLI_mutex_unlock(&disk_cache_lock);
+		return;
+	}
 
-	for (elem = preprocess_cache->elems.first; elem; elem = elem_next) {
-		elem_next = elem->next;
+	entry = MEM_callocN(sizeof(SeqDiskCacheEntry), "seq disk cache entry");
+	entry->key = *key;
+	entry->ibuf = ibuf;
+	IMB_refImBuf(ibuf);
+
+	/* strips may be freed before the file is written, so the name is made here */
+	BLI_snprintf(filename, sizeof(filename), "%s_%d_%d_%08x_%u.bsc", key->seq->name + 2, (int)key->cfra,
+	             (int)key->type, seqcache_hashhash(key), disk_cache.file_index++);
+	BLI_filename_make_safe(filename);
+	BLI_join_dirfile(entry->filepath, sizeof(entry->filepath), disk_cache.dirpath, filename);
+
+	BLI_ghash_insert(disk_cache.entries, &entry->key, entry);
+	BLI_addtail(&disk_cache.lru, entry);
+
+	write = MEM_callocN(sizeof(SeqDiskCacheWrite), "seq disk cache write");
+	write->key = *key;
+	BLI_strncpy(write->filepath, entry->filepath, sizeof(write->filepath));
+	write->ibuf = ibuf;
+	IMB_refImBuf(ibuf);
+
+	disk_cache.tot_pending++;
+	BLI_thread_queue_push(disk_cache.queue, write);
 
-		if (elem->seq == seq) {
-			IMB_freeImBuf(elem->ibuf);
+	BLI_mutex_unlock(&disk_cache_lock);
+}
 
-			BLI_freelinkN(&preprocess_cache->elems, elem);
+static ImBuf *seq_disk_cache_get(const SeqCacheKey *key)
+{
+	SeqDiskCacheEntry *entry;
+	char filepath[FILE_MAX] = "";
+	ImBuf *ibuf = NULL;
+
+	if (!ELEM(key->type, SEQ_STRIPELEM_IBUF, SEQ_STRIPELEM_IBUF_COMP)) {
+		return NULL;
+	}
+
+	BLI_mutex_lock(&disk_cache_lock);
+
+	entry = disk_cache.entries ? BLI_ghash_lookup(disk_cache.entries, key) : NULL;
+	if (entry) {
+		if (entry->ibuf) {
+			ibuf = entry->ibuf;
+			IMB_refImBuf(ibuf);
+		}
+		else {
+			BLI_strncpy(filepath, entry->filepath, sizeof(filepath));
 		}
+
+		BLI_remlink(&disk_cache.lru, entry);
+		BLI_addtail(&disk_cache.lru, entry);
 	}
+
+	BLI_mutex_unlock(&disk_cache_lock);
+
+	if (filepath[0]) {
+		ibuf = seq_disk_cache_read_file(filepath);
+
+		BLI_mutex_lock(&disk_cache_lock);
+		if (ibuf) {
+			disk_cache.tot_read++;
+		}
+		else {
+			/* unreadable files are not tried again */
+			entry = disk_cache.entries ? BLI_ghash_lookup(disk_cache.entries, key) : NULL;
+			if (entry && STREQ(entry->filepath, filepath)) {
+				seq_disk_cache_entry_remove(entry);
+			}
+		}
+		BLI_mutex_unlock(&disk_cache_lock);
+	}
+
+	return ibuf;
+}
+
+/* remove the files of a strip, or all files when seq is NULL */
+static void seq_disk_cache_cleanup(Sequence *seq)
+{
+	SeqDiskCacheEntry *entry, *entry_next;
+
+	BLI_mutex_lock(&disk_cache_lock);
+
+	for (entry = disk_cache.lru.first; entry; entry = entry_next) {
+		entry_next = entry->next;
+
+		if (seq == NULL || entry->key.seq == seq) {
+			seq_disk_cache_entry_remove(entry);
+		}
+	}
+
+	BLI_mutex_unlock(&disk_cache_lock);
+}
+
+static void seq_disk_cache_destruct(void)
+{
+	if (disk_cache.queue == NULL) {
+		return;
+	}
+
+	/* frames still waiting are not written */
+	disk_cache.stop = true;
+	BLI_thread_queue_nowait(disk_cache.queue);
+	BLI_end_threads(&disk_cache.threads);
+
+	seq_disk_cache_cleanup(NULL);
+
+	BLI_thread_queue_free(disk_cache.queue);
+	BLI_ghash_free(disk_cache.entries, NULL, NULL);
+
+	/* not recursive, all files of the cache were deleted with their entries */
+	if (disk_cache.dir_created) {
+		BLI_delete(disk_cache.dirpath, true, false);
+	}
+
+	if (G.debug & G_DEBUG) {
+		printf("Sequencer disk cache: %d frames written, %d frames read\n",
+		       disk_cache.tot_written, disk_cache.tot_read);
+	}
+
+	memset(&disk_cache, 0, sizeof(disk_cache));
 }
@@ -0,0 +1,573 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file blender/blenkernel/intern/seqprefetch.c
+ *  \ingroup bke
+ *
+ * Render frames ahead of the current frame in background threads, so they are
+ * in the sequencer cache by the time playback reaches them.
+ *
+ * Each thread renders from its own copy of the scene and strips, with its own movie
+ * handles, so threads render at the same time as each other and as the interface.
+ * Frames are cached for the original strips, so the interface finds them. The interface
+ * goes first: threads don't start new frames while it's rendering one.
+ *
+ * Invalidating the cache cancels prefetching: frames of the outdated copies are no longer
+ * cached, and the main thread makes new copies the next time the interface renders a frame.
+ *
+ * It only runs for edits it can render outside of the main thread: without scene, clip,
+ * mask and text strips, which use data shared with the interface, and without animated
+ * strip properties, which are only evaluated for the current frame.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_anim_types.h"
+#include "DNA_scene_types.h"
+#include "DNA_sequence_types.h"
+#include "DNA_userdef_types.h"
+
+#include "BLI_utildefines.h"
+#include "BLI_ghash.h"
+#include "BLI_listbase.h"
+#include "BLI_math_base.h"
+#include "BLI_threads.h"
+
+#include "BKE_global.h"
+#include "BKE_sequencer.h"
+
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+
+#include "PIL_time.h"
+
+#define SEQ_PREFETCH_MAX_THREADS 4
+
+/* scene and strips rendered by a prefetch thread */
+typedef struct SeqPrefetchCopy {
+	Scene *scene;
+	ListBase *seqbasep;
+	Scene *scene_orig;
+	GHash *original_seqs;   /* copied strip -> original strip */
+	int generation;         /* prefetch.generation when copied */
+} SeqPrefetchCopy;
+
+typedef struct SeqPrefetchThread {
+	SeqPrefetchCopy *copy;
+
+	/* protected by prefetch_lock */
+	SeqPrefetchCopy *copy_next;     /* used after the current frame */
+	bool is_rendering;
+	int cfra;
+} SeqPrefetchThread;
+
+typedef struct SeqPrefetch {
+	ListBase threads;
+	SeqPrefetchThread thread_data[SEQ_PREFETCH_MAX_THREADS];
+	int tot_thread;
+	bool running;
+	ListBase *seqbasep;
+
+	/* protected by prefetch_lock */
+	bool stop;
+	bool ui_rendering;
+	int generation;         /* changes when strips are changed */
+	int tot_cache_access;   /* threads using the cache with original strips */
+	SeqRenderData context;
+	int chanshown;
+	int cfra_next;      /* next frame to render */
+	int cfra_end;       /* last frame to render */
+	int cfra_request;   /* last frame requested by the interface */
+	int cfra_start;
+
+	/* statistics */
+	int tot_prefetched;
+	int tot_requested;
+	int tot_ready;
+	int tot_played;
+	double time_played;
+	double time_request;
+} SeqPrefetch;
+
+static SeqPrefetch prefetch = {{NULL}};
+
+static ThreadMutex prefetch_lock = BLI_MUTEX_INITIALIZER;
+static ThreadCondition prefetch_cond = PTHREAD_COND_INITIALIZER;
+static ThreadCondition prefetch_cache_cond = PTHREAD_COND_INITIALIZER;
+
+static bool seq_prefetch_seqbase_supported(ListBase *seqbase)
+{
+	Sequence *seq;
+	SequenceModifierData *smd;
+
+	for (seq = seqbase->first; seq; seq = seq->next) {
+		if (ELEM(seq->type, SEQ_TYPE_SCENE, SEQ_TYPE_MOVIECLIP, SEQ_TYPE_MASK, SEQ_TYPE_TEXT)) {
+			return false;
+		}
+		for (smd = seq->modifiers.first; smd; smd = smd->next) {
+			if (smd->mask_input_type == SEQUENCE_MASK_INPUT_ID && smd->mask_id) {
+				return false;
+			}
+		}
+		if (!seq_prefetch_seqbase_supported(&seq->seqbase)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool seq_prefetch_fcurves_supported(ListBase *fcurves)
+{
+	FCurve *fcu;
+
+	for (fcu = fcurves->first; fcu; fcu = fcu->next) {
+		if (fcu->rna_path && STRPREFIX(fcu->rna_path, "sequence_editor.")) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool seq_prefetch_supported(const SeqRenderData *context, int chanshown)
+{
+	Scene *scene = context->scene;
+	AnimData *adt = scene->adt;
+
+	if (U.prefetchframes <= 0 || G.is_rendering || chanshown < 0 || scene->ed == NULL) {
+		return false;
+	}
+
+	if (adt) {
+		if (adt->action && !seq_prefetch_fcurves_supported(&adt->action->curves)) {
+			return false;
+		}
+		if (!seq_prefetch_fcurves_supported(&adt->drivers) || !BLI_listbase_is_empty(&adt->nla_tracks)) {
+			return false;
+		}
+	}
+
+	return seq_prefetch_seqbase_supported(&scene->ed->seqbase);
+}
+
+static bool seq_prefetch_context_equals(const SeqRenderData *a, const SeqRenderData *b)
+{
+	return (a->bmain == b->bmain &&
+	        a->scene == b->scene &&
+	        a->rectx == b->rectx &&
+	        a->recty == b->recty &&
+	        a->preview_render_size == b->preview_render_size &&
+	        a->motion_blur_samples == b->motion_blur_samples &&
+	        a->motion_blur_shutter == b->motion_blur_shutter &&
+	        a->skip_cache == b->skip_cache &&
+	        a->is_proxy_render == b->is_proxy_render &&
+	        a->view_id == b->view_id);
+}
+
+/* ********************* Copies of the strips ********************* */
+
+static void seq_prefetch_copy_map_originals(GHash *original_seqs, ListBase *seqbase)
+{
+	Sequence *seq;
+
+	for (seq = seqbase->first; seq; seq = seq->next) {
+		if (seq->tmp) {
+			BLI_ghash_insert(original_seqs, seq->tmp, seq);
+		}
+		seq_prefetch_copy_map_originals(original_seqs, &seq->seqbase);
+	}
+}
+
+/* only in the main thread, strips may be changed at any time otherwise */
+static SeqPrefetchCopy *seq_prefetch_copy_create(Scene *scene, int generation)
+{
+	SeqPrefetchCopy *copy = MEM_callocN(sizeof(SeqPrefetchCopy), "seq prefetch copy");
+	Editing *ed = scene->ed;
+	Editing *ed_copy;
+
+	/* the scene is only used for its render settings and strips */
+	copy->scene = MEM_dupallocN(scene);
+	copy->scene->adt = NULL;
+	copy->scene->sound_scene = NULL;
+	copy->scene->playback_handle = NULL;
+	copy->scene->sound_scrub_handle = NULL;
+	copy->scene->speaker_handles = NULL;
+	copy->scene->fps_info = NULL;
+
+	ed_copy = copy->scene->ed = MEM_dupallocN(ed);
+	BLI_listbase_clear(&ed_copy->seqbase);
+	BLI_listbase_clear(&ed_copy->metastack);
+	ed_copy->act_seq = NULL;
+
+	/* sound strips don't render images and would add sound handles to the scene */
+	BKE_sequence_base_dupli_recursive(scene, copy->scene, &ed_copy->seqbase, &ed->seqbase,
+	                                  SEQ_DUPE_ALL | SEQ_DUPE_NO_SOUND);
+
+	if (ed->seqbasep == &ed->seqbase) {
+		ed_copy->seqbasep = &ed_copy->seqbase;
+	}
+	else {
+		MetaStack *ms = ed->metastack.last;
+		ed_copy->seqbasep = &((Sequence *)ms->parseq->tmp)->seqbase;
+	}
+	copy->seqbasep = ed_copy->seqbasep;
+
+	copy->scene_orig = scene;
+	copy->original_seqs = BLI_ghash_ptr_new("seq prefetch original strips");
+	seq_prefetch_copy_map_originals(copy->original_seqs, &ed->seqbase);
+	copy->generation = generation;
+
+	return copy;
+}
+
+/* also in prefetch threads, copies don't use any data shared with the interface */
+static void seq_prefetch_copy_free(SeqPrefetchCopy *copy)
+{
+	BKE_sequence_base_free_copy(&copy->scene->ed->seqbase);
+	MEM_freeN(copy->scene->ed);
+	MEM_freeN(copy->scene);
+	BLI_ghash_free(copy->original_seqs, NULL, NULL);
+	MEM_freeN(copy);
+}
+
+/* strips were changed since threads copied them */
+static void seq_prefetch_copies_update(Scene *scene)
+{
+	int i;
+
+	for (i = 0; i < prefetch.tot_thread; i++) {
+		SeqPrefetchThread *thread = &prefetch.thread_data[i];
+		SeqPrefetchCopy *copy, *copy_unused;
+		int generation;
+		bool outdated;
+
+		BLI_mutex_lock(&prefetch_lock);
+		generation = prefetch.generation;
+		copy = thread->copy_next ? thread->copy_next : thread->copy;
+		outdated = (copy->generation != generation);
+		BLI_mutex_unlock(&prefetch_lock);
+
+		if (!outdated) {
+			continue;
+		}
+
+		copy = seq_prefetch_copy_create(scene, generation);
+
+		/* the thread switches copies when it finished its frame */
+		BLI_mutex_lock(&prefetch_lock);
+		copy_unused = thread->copy_next;
+		thread->copy_next = copy;
+		BLI_condition_notify_all(&prefetch_cond);
+		BLI_mutex_unlock(&prefetch_lock);
+
+		if (copy_unused) {
+			seq_prefetch_copy_free(copy_unused);
+		}
+	}
+}
+
+/* ********************* Prefetch threads ********************* */
+
+static void *seq_prefetch_thread(void *thread_v)
+{
+	SeqPrefetchThread *thread = thread_v;
+
+	BLI_mutex_lock(&prefetch_lock);
+
+	while (!prefetch.stop) {
+		SeqRenderData context;
+		SeqPrefetchCopy *copy_old;
+		ImBuf *ibuf;
+		int cfra, chanshown;
+
+		if (thread->copy_next) {
+			copy_old = thread->copy;
+			thread->copy = thread->copy_next;
+			thread->copy_next = NULL;
+			BLI_mutex_unlock(&prefetch_lock);
+
+			seq_prefetch_copy_free(copy_old);
+
+			BLI_mutex_lock(&prefetch_lock);
+			continue;
+		}
+
+		if (prefetch.ui_rendering || prefetch.cfra_next > prefetch.cfra_end ||
+		    thread->copy->generation != prefetch.generation)
+		{
+			BLI_condition_wait(&prefetch_cond, &prefetch_lock);
+			continue;
+		}
+
+		cfra = prefetch.cfra_next++;
+		thread->cfra = cfra;
+		thread->is_rendering = true;
+		context = prefetch.context;
+		chanshown = prefetch.chanshown;
+		BLI_mutex_unlock(&prefetch_lock);
+
+		context.scene = thread->copy->scene;
+		context.is_prefetch_render = true;
+
+		ibuf = BKE_sequencer_give_ibuf_seqbase(&context, cfra, chanshown, thread->copy->seqbasep);
+
+		/* the cache keeps its own reference */
+		if (ibuf) {
+			IMB_freeImBuf(ibuf);
+		}
+
+		BLI_mutex_lock(&prefetch_lock);
+		thread->is_rendering = false;
+		prefetch.tot_prefetched++;
+	}
+
+	BLI_mutex_unlock(&prefetch_lock);
+
+	return NULL;
+}
+
+static void seq_prefetch_start(const SeqRenderData *context, int cfra, int chanshown)
+{
+	int i;
+
+	memset(&prefetch, 0, sizeof(prefetch));
+	prefetch.context = *context;
+	prefetch.chanshown = chanshown;
+	prefetch.seqbasep = context->scene->ed->seqbasep;
+	prefetch.cfra_next = prefetch.cfra_start = cfra + 1;
+	prefetch.cfra_end = cfra;
+	prefetch.cfra_request = cfra;
+	prefetch.time_request = PIL_check_seconds_timer();
+
+	/* leave cores for the interface and for effects, which are threaded themselves */
+	prefetch.tot_thread = min_ii(max_ii(BLI_system_thread_count() / 2, 1), SEQ_PREFETCH_MAX_THREADS);
+
+	BLI_init_threads(&prefetch.threads, seq_prefetch_thread, prefetch.tot_thread);
+	for (i = 0; i < prefetch.tot_thread; i++) {
+		prefetch.thread_data[i].copy = seq_prefetch_copy_create(context->scene, prefetch.generation);
+		BLI_insert_thread(&prefetch.threads, &prefetch.thread_data[i]);
+	}
+	prefetch.running = true;
+}
+
+/* frames taken by threads which are not being rendered anymore */
+static bool seq_prefetch_frame_ready(int cfra)
+{
+	int i;
+
+	if (cfra < prefetch.cfra_start || cfra >= prefetch.cfra_next) {
+		return false;
+	}
+	for (i = 0; i < prefetch.tot_thread; i++) {
+		if (prefetch.thread_data[i].is_rendering && prefetch.thread_data[i].cfra == cfra) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/* move the frames to render along with the frame shown by the interface */
+static void seq_prefetch_update(const SeqRenderData *context, int cfra, int chanshown)
+{
+	double time = PIL_check_seconds_timer();
+
+	if (prefetch.running &&
+	    (prefetch.chanshown != chanshown || prefetch.seqbasep != context->scene->ed->seqbasep ||
+	     !seq_prefetch_context_equals(&prefetch.context, context)))
+	{
+		BKE_sequencer_prefetch_stop();
+	}
+
+	if (!prefetch.running) {
+		seq_prefetch_start(context, cfra, chanshown);
+	}
+
+	seq_prefetch_copies_update(context->scene);
+
+	BLI_mutex_lock(&prefetch_lock);
+
+	prefetch.tot_requested++;
+	if (seq_prefetch_frame_ready(cfra)) {
+		prefetch.tot_ready++;
+	}
+	if (cfra == prefetch.cfra_request + 1) {
+		prefetch.tot_played++;
+		prefetch.time_played += time - prefetch.time_request;
+	}
+
+	/* restart from the current frame when playback jumped ahead of prefetching, or back */
+	if (cfra >= prefetch.cfra_next || cfra < prefetch.cfra_request) {
+		prefetch.cfra_next = prefetch.cfra_start = cfra + 1;
+	}
+	prefetch.cfra_request = cfra;
+	prefetch.cfra_end = min_ii(cfra + U.prefetchframes, context->scene->r.efra);
+	prefetch.time_request = time;
+
+	BLI_condition_notify_all(&prefetch_cond);
+	BLI_mutex_unlock(&prefetch_lock);
+}
+
+/*
+ * Render a frame for the interface, and prefetch the next frames.
+ * returned ImBuf is refed, you have to free after usage!
+ */
+ImBuf *BKE_sequencer_give_ibuf_threaded(const SeqRenderData *context, float cfra, int chanshown)
+{
+	ImBuf *ibuf;
+
+	if (!seq_prefetch_supported(context, chanshown)) {
+		BKE_sequencer_prefetch_stop();
+		return BKE_sequencer_give_ibuf(context, cfra, chanshown);
+	}
+
+	/* threads don't start new frames while the interface renders */
+	BLI_mutex_lock(&prefetch_lock);
+	prefetch.ui_rendering = true;
+	BLI_mutex_unlock(&prefetch_lock);
+
+	ibuf = BKE_sequencer_give_ibuf(context, cfra, chanshown);
+
+	BLI_mutex_lock(&prefetch_lock);
+	prefetch.ui_rendering = false;
+	BLI_mutex_unlock(&prefetch_lock);
+
+	seq_prefetch_update(context, (int)cfra, chanshown);
+
+	return ibuf;
+}
+
+/* Stop the prefetch threads and free their copies, when playback stops or can't be prefetched.
+ * Only has effect in the main thread. */
+void BKE_sequencer_prefetch_stop(void)
+{
+	int i;
+
+	if (!prefetch.running || !BLI_thread_is_main()) {
+		return;
+	}
+
+	BLI_mutex_lock(&prefetch_lock);
+	prefetch.stop = true;
+	BLI_condition_notify_all(&prefetch_cond);
+	BLI_mutex_unlock(&prefetch_lock);
+
+	BLI_end_threads(&prefetch.threads);
+	prefetch.running = false;
+
+	for (i = 0; i < prefetch.tot_thread; i++) {
+		SeqPrefetchThread *thread = &prefetch.thread_data[i];
+
+		seq_prefetch_copy_free(thread->copy);
+		if (thread->copy_next) {
+			seq_prefetch_copy_free(thread->copy_next);
+		}
+		thread->copy = thread->copy_next = NULL;
+	}
+
+	if (G.debug & G_DEBUG) {
+		printf("Sequencer prefetch: %d frames rendered ahead by %d threads, %d of %d shown frames were ready",
+		       prefetch.tot_prefetched, prefetch.tot_thread, prefetch.tot_ready, prefetch.tot_requested);
+		if (prefetch.time_played > 0.0) {
+			printf(", sustained playback %.2f fps", prefetch.tot_played / prefetch.time_played);
+		}
+		printf("\n");
+	}
+}
+
+/* Frames being rendered are outdated, to be called before strips or the cache are changed.
+ * Waits for threads caching frames, threads keep rendering their copies until the main
+ * thread copied the strips again. */
+void BKE_sequencer_prefetch_cancel(void)
+{
+	if (!prefetch.running) {
+		return;
+	}
+
+	BLI_mutex_lock(&prefetch_lock);
+
+	prefetch.generation++;
+	prefetch.cfra_next = prefetch.cfra_start = prefetch.cfra_request + 1;
+
+	while (prefetch.tot_cache_access > 0) {
+		BLI_condition_wait(&prefetch_cache_cond, &prefetch_lock);
+	}
+
+	BLI_mutex_unlock(&prefetch_lock);
+}
+
+/* Frames rendered by prefetch threads are cached for the original scene and strip instead of
+ * their copies. Returns false when the copy is outdated, then nothing is cached or read,
+ * otherwise BKE_sequencer_prefetch_cache_end must be called once the cache is used. */
+bool BKE_sequencer_prefetch_cache_begin(Scene **scene, Sequence **seq)
+{
+	bool valid = false;
+	int i;
+
+	BLI_mutex_lock(&prefetch_lock);
+
+	for (i = 0; i < prefetch.tot_thread; i++) {
+		SeqPrefetchCopy *copy = prefetch.thread_data[i].copy;
+
+		if (copy && copy->scene == *scene) {
+			if (copy->generation == prefetch.generation) {
+				*scene = copy->scene_orig;
+				*seq = BLI_ghash_lookup(copy->original_seqs, *seq);
+				valid = (*seq != NULL);
+			}
+			break;
+		}
+	}
+
+	if (valid) {
+		prefetch.tot_cache_access++;
+	}
+
+	BLI_mutex_unlock(&prefetch_lock);
+
+	return valid;
+}
+
+void BKE_sequencer_prefetch_cache_end(void)
+{
+	BLI_mutex_lock(&prefetch_lock);
+	if (--prefetch.tot_cache_access == 0) {
+		BLI_condition_notify_all(&prefetch_cache_cond);
+	}
+	BLI_mutex_unlock(&prefetch_lock);
+}
+
+/* Shown frames which were rendered ahead, and the frame rate sustained by playback
+ * since prefetching started. Returns false when not prefetching. */
+bool BKE_sequencer_prefetch_stats_get(int *r_tot_ready, int *r_tot_shown, float *r_fps)
+{
+	if (!prefetch.running) {
+		return false;
+	}
+
+	BLI_mutex_lock(&prefetch_lock);
+	*r_tot_ready = prefetch.tot_ready;
+	*r_tot_shown = prefetch.tot_requested;
+	*r_fps = (prefetch.time_played > 0.0) ? (float)(prefetch.tot_played / prefetch.time_played) : 0.0f;
+	BLI_mutex_unlock(&prefetch_lock);
+
+	return true;
+}
@@ -50,6 +50,7 @@
 #include "BLI_path_util.h"
 #include "BLI_string.h"
 #include "BLI_string_utf8.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
@@ -78,12 +79,12 @@
 
 #include "RE_pipeline.h"
 
-#include <pthread.h>
-
 #include "IMB_imbuf.h"
 #include "IMB_imbuf_types.h"
 #include "IMB_colormanagement.h"
 
+#include "PIL_time.h"
+
 #include "BKE_context.h"
 #include "BKE_sound.h"
 
@@ -281,6 +282,18 @@ static void seq_free_sequence_recurse(Scene *scene, Sequence *seq)
 	BKE_sequence_free_ex(scene, seq, false);
 }
 
+/* free strips copied with SEQ_DUPE_NO_SOUND, which have no scene, sound handles or cached frames */
+void BKE_sequence_base_free_copy(ListBase *seqbase)
+{
+	Sequence *seq, *seq_next;
+
+	for (seq = seqbase->first; seq; seq = seq_next) {
+		seq_next = seq->next;
+		seq_free_sequence_recurse(NULL, seq);
+	}
+	BLI_listbase_clear(seqbase);
+}
+
 
 Editing *BKE_sequencer_editing_get(Scene *scene, bool alloc)
 {
@@ -564,6 +577,7 @@ void BKE_sequencer_new_render_data(
 	r_context->motion_blur_shutter = 0;
 	r_context->skip_cache = false;
 	r_context->is_proxy_render = false;
+	r_context->is_prefetch_render = false;
 	r_context->view_id = 0;
 	r_context->gpu_offscreen = NULL;
 	r_context->gpu_samples = (scene->r.mode & R_OSA) ? scene->r.osa : 0;
@@ -1419,6 +1433,8 @@ typedef struct SeqIndexBuildContext {
 	Main *bmain;
 	Scene *scene;
 	Sequence *seq, *orig_seq;
+
+	float progress;
 } SeqIndexBuildContext;
 
 #define PROXY_MAXFILE (2 * FILE_MAXDIR + FILE_MAXFILE)
@@ -1489,6 +1505,7 @@ static void seq_open_anim_file(Scene *scene, Sequence *seq, bool openfile)
 	bool is_multiview_loaded = false;
 	Editing *ed = scene->ed;
 	const bool is_multiview = (seq->flag & SEQ_USE_VIEWS) != 0 && (scene->r.scemode & R_MULTIVIEW) != 0;
+	StripAnim *sanim;
 
 	if ((seq->anims.first != NULL) && (((StripAnim *)seq->anims.first)->anim != NULL)) {
 		return;
@@ -1531,7 +1548,8 @@ static void seq_open_anim_file(Scene *scene, Sequence *seq, bool openfile)
 			for (i = 0; i < totfiles; i++) {
 				const char *suffix = BKE_scene_multiview_view_id_suffix_get(&scene->r, i);
 				char str[FILE_MAX];
-				StripAnim *sanim = MEM_mallocN(sizeof(StripAnim), "Strip Anim");
+
+				sanim = MEM_mallocN(sizeof(StripAnim), "Strip Anim");
 
 				BLI_addtail(&seq->anims, sanim);
 
@@ -1581,8 +1599,6 @@ static void seq_open_anim_file(Scene *scene, Sequence *seq, bool openfile)
 	}
 
 	if (is_multiview_loaded == false) {
-		StripAnim *sanim;
-
 		sanim = MEM_mallocN(sizeof(StripAnim), "Strip Anim");
 		BLI_addtail(&seq->anims, sanim);
 
@@ -1601,6 +1617,14 @@ static void seq_open_anim_file(Scene *scene, Sequence *seq, bool openfile)
 			seq_proxy_index_dir_set(sanim->anim, dir);
 		}
 	}
+
+	/* frames are mostly read in order, when playing back or rendering,
+	 * decoding ahead stops again when the strip isn't played, see seq_free_idle_decode_ahead */
+	for (sanim = seq->anims.first; sanim; sanim = sanim->next) {
+		if (sanim->anim) {
+			IMB_anim_set_decode_ahead(sanim->anim, true);
+		}
+	}
 }
 
 static bool seq_proxy_get_fname(Editing *ed, Sequence *seq, int cfra, int render_size, char *name, const int view_id)
@@ -1785,7 +1809,7 @@ static void seq_proxy_build_frame(const SeqRenderData *context, Sequence *seq, i
 		ibuf = IMB_dupImBuf(ibuf_tmp);
 		IMB_metadata_copy(ibuf, ibuf_tmp);
 		IMB_freeImBuf(ibuf_tmp);
-		IMB_scalefastImBuf(ibuf, (short)rectx, (short)recty);
+		IMB_scaleImBuf_filter(ibuf, (short)rectx, (short)recty, IMB_SCALE_FILTER_BICUBIC);
 	}
 	else {
 		ibuf = ibuf_tmp;
@@ -2000,6 +2024,109 @@ void BKE_sequencer_proxy_rebuild(SeqIndexBuildContext *context, short *stop, sho
 	}
 }
 
+typedef struct SeqProxyRebuildQueueData {
+	short *stop;
+	int tot_done;  /* protected by the pool user mutex */
+} SeqProxyRebuildQueueData;
+
+static void seq_proxy_rebuild_queue_task(TaskPool *__restrict pool, void *taskdata, int UNUSED(threadid))
+{
+	SeqProxyRebuildQueueData *data = BLI_task_pool_userdata(pool);
+	SeqIndexBuildContext *context = taskdata;
+	short do_update;
+
+	if (!*data->stop) {
+		IMB_anim_index_rebuild(context->index_context, data->stop, &do_update, &context->progress);
+
+		if (!*data->stop) {
+			printf("Proxy: finished building %s\n", context->seq->name + 2);
+		}
+	}
+
+	BLI_mutex_lock(BLI_task_pool_user_mutex(pool));
+	data->tot_done++;
+	BLI_mutex_unlock(BLI_task_pool_user_mutex(pool));
+}
+
+static float seq_proxy_rebuild_queue_progress(ListBase *queue)
+{
+	LinkData *link;
+	float progress = 0.0f;
+	int tot = 0;
+
+	for (link = queue->first; link; link = link->next) {
+		SeqIndexBuildContext *context = link->data;
+		progress += context->progress;
+		tot++;
+	}
+
+	return tot ? progress / tot : 1.0f;
+}
+
+/**
+ * Build the proxies of all strips in the queue. Movies are decoded and encoded in
+ * background tasks, several at a time, while the other strips render through the
+ * sequencer one at a time in the calling thread. Every context keeps its own progress,
+ * \a progress is their average.
+ */
+void BKE_sequencer_proxy_rebuild_queue(ListBase *queue, short *stop, short *do_update, float *progress)
+{
+	TaskScheduler *task_scheduler = BLI_task_scheduler_get();
+	TaskPool *task_pool;
+	SeqProxyRebuildQueueData data = {stop, 0};
+	LinkData *link;
+	int tot_task = 0;
+	bool done;
+
+	task_pool = BLI_task_pool_create_background(task_scheduler, &data);
+	/* every movie also encodes its proxy sizes in parallel, leave threads for those */
+	BLI_pool_set_num_threads(task_pool, max_ii(1, BLI_system_thread_count() / 2));
+
+	for (link = queue->first; link; link = link->next) {
+		SeqIndexBuildContext *context = link->data;
+
+		context->progress = 0.0f;
+
+		if (context->seq->type == SEQ_TYPE_MOVIE) {
+			if (context->index_context) {
+				BLI_task_pool_push(task_pool, seq_proxy_rebuild_queue_task, context, false, TASK_PRIORITY_LOW);
+				tot_task++;
+			}
+			else {
+				context->progress = 1.0f;
+			}
+		}
+	}
+
+	for (link = queue->first; link && !*stop; link = link->next) {
+		SeqIndexBuildContext *context = link->data;
+
+		if (context->seq->type != SEQ_TYPE_MOVIE) {
+			BKE_sequencer_proxy_rebuild(context, stop, do_update, &context->progress);
+			context->progress = 1.0f;
+
+			*progress = seq_proxy_rebuild_queue_progress(queue);
+			*do_update = true;
+		}
+	}
+
+	do {
+		BLI_mutex_lock(BLI_task_pool_user_mutex(task_pool));
+		done = (data.tot_done == tot_task);
+		BLI_mutex_unlock(BLI_task_pool_user_mutex(task_pool));
+
+		*progress = seq_proxy_rebuild_queue_progress(queue);
+		*do_update = true;
+
+		if (!done) {
+			PIL_sleep_ms(100);
+		}
+	} while (!done);
+
+	BLI_task_pool_work_and_wait(task_pool);
+	BLI_task_pool_free(task_pool);
+}
+
 void BKE_sequencer_proxy_rebuild_finish(SeqIndexBuildContext *context, bool stop)
 {
 	if (context->index_context) {
@@ -3637,10 +3764,125 @@ static ImBuf *seq_render_strip_stack_apply_effect(const SeqRenderData *context,
 	return out;
 }
 
+#define SEQ_STACK_INPUTS_MAX (MAXSEQ * 2)
+
+/* Strips which can be rendered while other strips of the stack are rendered:
+ * image and movie strips only use their own data and the locked sequencer cache. */
+static bool seq_render_strip_is_independent(Sequence *seq)
+{
+	SequenceModifierData *smd;
+
+	if (!ELEM(seq->type, SEQ_TYPE_IMAGE, SEQ_TYPE_MOVIE)) {
+		return false;
+	}
+
+	/* masks render other strips or evaluate mask animation */
+	for (smd = seq->modifiers.first; smd; smd = smd->next) {
+		if (smd->mask_sequence || smd->mask_id) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static void seq_render_strip_stack_inputs_add(Sequence *seq, Sequence **seq_inputs, int *r_tot, int depth)
+{
+	int i;
+
+	if (*r_tot == SEQ_STACK_INPUTS_MAX) {
+		return;
+	}
+
+	if (seq_render_strip_is_independent(seq)) {
+		for (i = 0; i < *r_tot; i++) {
+			if (seq_inputs[i] == seq) {
+				return;
+			}
+		}
+		seq_inputs[(*r_tot)++] = seq;
+	}
+	else if ((seq->type & SEQ_TYPE_EFFECT) && seq->type != SEQ_TYPE_SPEED && depth < MAXSEQ) {
+		/* inputs of effects are rendered at the frame of the effect */
+		if (seq->seq1) seq_render_strip_stack_inputs_add(seq->seq1, seq_inputs, r_tot, depth + 1);
+		if (seq->seq2) seq_render_strip_stack_inputs_add(seq->seq2, seq_inputs, r_tot, depth + 1);
+		if (seq->seq3) seq_render_strip_stack_inputs_add(seq->seq3, seq_inputs, r_tot, depth + 1);
+	}
+}
+
+typedef struct RenderStripStackInputsData {
+	const SeqRenderData *context;
+	float cfra;
+	Sequence **seq_inputs;
+	ImBuf **ibufs;
+} RenderStripStackInputsData;
+
+static void seq_render_strip_stack_inputs_cb(void *userdata, void *UNUSED(userdata_chunk), const int iter,
+                                             const int UNUSED(thread_id))
+{
+	RenderStripStackInputsData *data = userdata;
+
+	data->ibufs[iter] = seq_render_strip(data->context, data->seq_inputs[iter], data->cfra);
+}
+
+/* Render the strips blended by the stack, and the inputs of its effects, in parallel. The results
+ * are put in the sequencer cache, from where the stack is blended in order as before, so the
+ * result doesn't change. Returns the number of buffers referenced in r_ibufs. */
+static int seq_render_strip_stack_inputs(const SeqRenderData *context, Sequence **seq_arr, int count, float cfra,
+                                         ImBuf **r_ibufs)
+{
+	Sequence *seq_inputs[SEQ_STACK_INPUTS_MAX];
+	RenderStripStackInputsData data;
+	int tot = 0;
+	int i;
+
+	if (context->skip_cache || BKE_render_num_threads(&context->scene->r) < 2) {
+		return 0;
+	}
+
+	/* same strips as rendered while blending the stack */
+	for (i = count - 1; i >= 0; i--) {
+		Sequence *seq = seq_arr[i];
+		int early_out = (seq->blend_mode == SEQ_BLEND_REPLACE) ? EARLY_NO_INPUT : seq_get_early_out_for_blend_mode(seq);
+
+		if (early_out != EARLY_USE_INPUT_1) {
+			seq_render_strip_stack_inputs_add(seq, seq_inputs, &tot, 0);
+		}
+		if (ELEM(early_out, EARLY_NO_INPUT, EARLY_USE_INPUT_2)) {
+			break;
+		}
+	}
+
+	if (tot < 2) {
+		return 0;
+	}
+
+	data.context = context;
+	data.cfra = cfra;
+	data.seq_inputs = seq_inputs;
+	data.ibufs = r_ibufs;
+
+	BLI_task_parallel_range_ex(0, tot, &data, NULL, 0, seq_render_strip_stack_inputs_cb, true, true);
+
+	return tot;
+}
+
+static void seq_render_strip_stack_inputs_free(ImBuf **ibufs, int tot)
+{
+	int i;
+
+	for (i = 0; i < tot; i++) {
+		if (ibufs[i]) {
+			IMB_freeImBuf(ibufs[i]);
+		}
+	}
+}
+
 static ImBuf *seq_render_strip_stack(const SeqRenderData *context, ListBase *seqbasep, float cfra, int chanshown)
 {
 	Sequence *seq_arr[MAXSEQ + 1];
-	int count;
+	ImBuf *ibuf_inputs[SEQ_STACK_INPUTS_MAX];
+	int count, tot_inputs;
 	int i;
 	ImBuf *out = NULL;
 
@@ -3663,7 +3905,10 @@ static ImBuf *seq_render_strip_stack(const SeqRenderData *context, ListBase *seq
 	if (out) {
 		return out;
 	}
-	
+
+	/* keep the inputs referenced until they are blended, the cache may not hold them that long */
+	tot_inputs = seq_render_strip_stack_inputs(context, seq_arr, count, cfra, ibuf_inputs);
+
 	if (count == 1) {
 		Sequence *seq = seq_arr[0];
 
@@ -3708,6 +3953,8 @@ static ImBuf *seq_render_strip_stack(const SeqRenderData *context, ListBase *seq
 
 		BKE_sequencer_cache_put(context, seq, cfra, SEQ_STRIPELEM_IBUF_COMP, out);
 
+		seq_render_strip_stack_inputs_free(ibuf_inputs, tot_inputs);
+
 		return out;
 	}
 
@@ -3775,9 +4022,31 @@ static ImBuf *seq_render_strip_stack(const SeqRenderData *context, ListBase *seq
 		BKE_sequencer_cache_put(context, seq_arr[i], cfra, SEQ_STRIPELEM_IBUF_COMP, out);
 	}
 
+	seq_render_strip_stack_inputs_free(ibuf_inputs, tot_inputs);
+
 	return out;
 }
 
+/* Movies of strips which are not played anymore don't keep decoding frames ahead. */
+static void seq_free_idle_decode_ahead(ListBase *seqbase)
+{
+	Sequence *seq;
+	StripAnim *sanim;
+
+	for (seq = seqbase->first; seq; seq = seq->next) {
+		if (seq->type == SEQ_TYPE_MOVIE) {
+			for (sanim = seq->anims.first; sanim; sanim = sanim->next) {
+				if (sanim->anim) {
+					IMB_anim_decode_ahead_free_idle(sanim->anim);
+				}
+			}
+		}
+		else if (seq->type == SEQ_TYPE_META) {
+			seq_free_idle_decode_ahead(&seq->seqbase);
+		}
+	}
+}
+
 /*
  * returned ImBuf is refed!
  * you have to free after usage!
@@ -3785,6 +4054,7 @@ static ImBuf *seq_render_strip_stack(const SeqRenderData *context, ListBase *seq
 
 ImBuf *BKE_sequencer_give_ibuf(const SeqRenderData *context, float cfra, int chanshown)
 {
+	ImBuf *ibuf;
 	Editing *ed = BKE_sequencer_editing_get(context->scene, false);
 	ListBase *seqbasep;
 	
@@ -3803,7 +4073,10 @@ ImBuf *BKE_sequencer_give_ibuf(const SeqRenderData *context, float cfra, int cha
 	BKE_main_id_tag_idcode(context->bmain, ID_SCE, LIB_TAG_DOIT, false);
 #endif
 
-	return seq_render_strip_stack(context, seqbasep, cfra, chanshown);
+	ibuf = seq_render_strip_stack(context, seqbasep, cfra, chanshown);
+	seq_free_idle_decode_ahead(&ed->seqbase);
+
+	return ibuf;
 }
 
 ImBuf *BKE_sequencer_give_ibuf_seqbase(const SeqRenderData *context, float cfra, int chanshown, ListBase *seqbasep)
@@ -3817,158 +4090,6 @@ ImBuf *BKE_sequencer_give_ibuf_direct(const SeqRenderData *context, float cfra,
 	return seq_render_strip(context, seq, cfra);
 }
 
-/* *********************** threading api ******************* */
-
-static ListBase running_threads;
-static ListBase prefetch_wait;
-static ListBase prefetch_done;
-
-static pthread_mutex_t queue_lock          = PTHREAD_MUTEX_INITIALIZER;
-static pthread_mutex_t wakeup_lock         = PTHREAD_MUTEX_INITIALIZER;
-static pthread_cond_t wakeup_cond          = PTHREAD_COND_INITIALIZER;
-
-//static pthread_mutex_t prefetch_ready_lock = PTHREAD_MUTEX_INITIALIZER;
-//static pthread_cond_t  prefetch_ready_cond = PTHREAD_COND_INITIALIZER;
-
-static pthread_mutex_t frame_done_lock     = PTHREAD_MUTEX_INITIALIZER;
-static pthread_cond_t frame_done_cond      = PTHREAD_COND_INITIALIZER;
-
-static volatile bool seq_thread_shutdown = true; 
-static volatile int seq_last_given_monoton_cfra = 0;
-static int monoton_cfra = 0;
-
-typedef struct PrefetchThread {
-	struct PrefetchThread *next, *prev;
-	
-	Scene *scene;
-	struct PrefetchQueueElem *current;
-	pthread_t pthread;
-	int running;
-	
-} PrefetchThread;
-
-typedef struct PrefetchQueueElem {
-	struct PrefetchQueueElem *next, *prev;
-	
-	int rectx;
-	int recty;
-	float cfra;
-	int chanshown;
-	int preview_render_size;
-
-	int monoton_cfra;
-
-	ImBuf *ibuf;
-} PrefetchQueueElem;
-
-void BKE_sequencer_give_ibuf_prefetch_request(const SeqRenderData *context, float cfra, int chanshown)
-{
-	PrefetchQueueElem *e;
-	if (seq_thread_shutdown) {
-		return;
-	}
-
-	e = MEM_callocN(sizeof(PrefetchQueueElem), "prefetch_queue_elem");
-	e->rectx = context->rectx;
-	e->recty = context->recty;
-	e->cfra = cfra;
-	e->chanshown = chanshown;
-	e->preview_render_size = context->preview_render_size;
-	e->monoton_cfra = monoton_cfra++;
-
-	pthread_mutex_lock(&queue_lock);
-	BLI_addtail(&prefetch_wait, e);
-	pthread_mutex_unlock(&queue_lock);
-	
-	pthread_mutex_lock(&wakeup_lock);
-	pthread_cond_signal(&wakeup_cond);
-	pthread_mutex_unlock(&wakeup_lock);
-}
-
-ImBuf *BKE_sequencer_give_ibuf_threaded(const SeqRenderData *context, float cfra, int chanshown)
-{
-	PrefetchQueueElem *e = NULL;
-	bool found_something = false;
-
-	if (seq_thread_shutdown) {
-		return BKE_sequencer_give_ibuf(context, cfra, chanshown);
-	}
-
-	while (!e) {
-		bool success = false;
-		pthread_mutex_lock(&queue_lock);
-
-		for (e = prefetch_done.first; e; e = e->next) {
-			if (cfra == e->cfra &&
-			    chanshown == e->chanshown &&
-			    context->rectx == e->rectx &&
-			    context->recty == e->recty &&
-			    context->preview_render_size == e->preview_render_size)
-			{
-				success = true;
-				found_something = true;
-				break;
-			}
-		}
-
-		if (!e) {
-			for (e = prefetch_wait.first; e; e = e->next) {
-				if (cfra == e->cfra &&
-				    chanshown == e->chanshown &&
-				    context->rectx == e->rectx &&
-				    context->recty == e->recty &&
-				    context->preview_render_size == e->preview_render_size)
-				{
-					found_something = true;
-					break;
-				}
-			}
-		}
-
-		if (!e) {
-			PrefetchThread *tslot;
-
-			for (tslot = running_threads.first;
-			     tslot;
-			     tslot = tslot->next)
-			{
-				if (tslot->current &&
-				    cfra == tslot->current->cfra &&
-				    chanshown == tslot->current->chanshown &&
-				    context->rectx == tslot->current->rectx &&
-				    context->recty == tslot->current->recty &&
-				    context->preview_render_size == tslot->current->preview_render_size)
-				{
-					found_something = true;
-					break;
-				}
-			}
-		}
-
-		/* e->ibuf is unrefed by render thread on next round. */
-
-		if (e) {
-			seq_last_given_monoton_cfra = e->monoton_cfra;
-		}
-
-		pthread_mutex_unlock(&queue_lock);
-
-		if (!success) {
-			e = NULL;
-
-			if (!found_something) {
-				fprintf(stderr, "SEQ-THREAD: Requested frame not in queue ???\n");
-				break;
-			}
-			pthread_mutex_lock(&frame_done_lock);
-			pthread_cond_wait(&frame_done_cond, &frame_done_lock);
-			pthread_mutex_unlock(&frame_done_lock);
-		}
-	}
-	
-	return e ? e->ibuf : NULL;
-}
-
 /* check whether sequence cur depends on seq */
 bool BKE_sequence_check_depend(Sequence *seq, Sequence *cur)
 {
@@ -4018,6 +4139,9 @@ static void sequence_invalidate_cache(Scene *scene, Sequence *seq, bool invalida
 {
 	Editing *ed = scene->ed;
 
+	/* frames the prefetch threads are rendering from their copy of the strips are outdated */
+	BKE_sequencer_prefetch_cancel();
+
 	/* invalidate cache for current sequence */
 	if (invalidate_self) {
 		/* Animation structure holds some buffers inside,
@@ -5444,6 +5568,9 @@ void BKE_sequence_base_dupli_recursive(
 
 	for (seq = seqbase->first; seq; seq = seq->next) {
 		seq->tmp = NULL;
+		if ((dupe_flag & SEQ_DUPE_NO_SOUND) && seq->type == SEQ_TYPE_SOUND_RAM) {
+			continue;
+		}
 		if ((seq->flag & SELECT) || (dupe_flag & SEQ_DUPE_ALL)) {
 			seqn = seq_dupli(scene, scene_to, seq, dupe_flag);
 			if (seqn) { /*should never fail */
@@ -54,8 +54,8 @@ static int start_stub(void *UNUSED(context_v), Scene *UNUSED(scene), RenderData
                       ReportList *UNUSED(reports), bool UNUSED(preview), const char *UNUSED(suffix))
 { return 0; }
 
-static void end_stub(void *UNUSED(context_v))
-{}
+static int end_stub(void *UNUSED(context_v), ReportList *UNUSED(reports))
+{ return 1; }
 
 static int append_stub(void *UNUSED(context_v), RenderData *UNUSED(rd), int UNUSED(start_frame), int UNUSED(frame), int *UNUSED(pixels),
                        int UNUSED(rectx), int UNUSED(recty), const char *UNUSED(suffix), ReportList *UNUSED(reports))
@@ -72,7 +72,7 @@ static void context_free_stub(void *UNUSED(context_v))
 
 /* callbacks */
 static int start_avi(void *context_v, Scene *scene, RenderData *rd, int rectx, int recty, ReportList *reports, bool preview, const char *suffix);
-static void end_avi(void *context_v);
+static int end_avi(void *context_v, ReportList *reports);
 static int append_avi(void *context_v, RenderData *rd, int start_frame, int frame, int *pixels,
                       int rectx, int recty, const char *suffix, ReportList *reports);
 static void filepath_avi(char *string, RenderData *rd, bool preview, const char *suffix);
@@ -269,13 +269,18 @@ static int append_avi(void *context_v, RenderData *UNUSED(rd), int start_frame,
 	return 1;
 }
 
-static void end_avi(void *context_v)
+static int end_avi(void *context_v, ReportList *reports)
 {
 	AviMovie *avi = context_v;
 
-	if (avi == NULL) return;
+	if (avi == NULL) return 0;
 
-	AVI_close_compress(avi);
+	if (AVI_close_compress(avi) != AVI_ERROR_NONE) {
+		BKE_report(reports, RPT_ERROR, "Error closing AVI file");
+		return 0;
+	}
+
+	return 1;
 }
 
 static void *context_create_avi(void)
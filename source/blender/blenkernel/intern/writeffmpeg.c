@@ -43,6 +43,7 @@
 #include "DNA_scene_types.h"
 
 #include "BLI_blenlib.h"
+#include "BLI_threads.h"
 
 #ifdef WITH_AUDASPACE
 #  include AUD_DEVICE_H
@@ -93,10 +94,32 @@ typedef struct FFMpegContext {
 #ifdef WITH_AUDASPACE
 	AUD_Device *audio_mixdown_device;
 #endif
+
+	/* frames are encoded in a thread while the next ones are rendered, see BKE_ffmpeg_append */
+	ListBase encode_threads;
+	ThreadQueue *encode_queue;
+	ThreadQueue *free_queue;
+	struct FFMpegQueuedFrame *queued_frames;
+	int rectx, recty;
+	char suffix[64];
+
+	/* errors of the encoder thread, reported by the next append */
+	ThreadMutex encode_lock;
+	ReportList encode_reports;
+	bool encode_failed;
 } FFMpegContext;
 
+typedef struct FFMpegQueuedFrame {
+	RenderData *rd;
+	int frame;
+	int *pixels;
+} FFMpegQueuedFrame;
+
 #define FFMPEG_AUTOSPLIT_SIZE 2000000000
 
+/* frames rendered ahead of encoding, bounds the memory used for them */
+#define FFMPEG_QUEUE_SIZE 3
+
 #define PRINT if (G.debug & G_DEBUG_FFMPEG) printf
 
 static void ffmpeg_dict_set_int(AVDictionary **dict, const char *key, int value);
@@ -650,6 +673,10 @@ static AVStream *alloc_video_stream(FFMpegContext *context, RenderData *rd, int
 
 	st->sample_aspect_ratio = c->sample_aspect_ratio = av_d2q(((double) rd->xasp / (double) rd->yasp), 255);
 
+	/* threads the codec supports, unless set in the codec properties */
+	c->thread_count = BLI_system_thread_count();
+	c->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+
 	set_ffmpeg_properties(rd, c, "video", &opts);
 
 	if (avcodec_open2(c, codec, &opts) < 0) {
@@ -1000,9 +1027,10 @@ fail:
  * parameter.
  * </p>
  */
-static void flush_ffmpeg(FFMpegContext *context)
+static int flush_ffmpeg(FFMpegContext *context, ReportList *reports)
 {
 	int ret = 0;
+	int success = 1;
 	
 	AVCodecContext *c = context->video_stream->codec;
 	/* get the delayed frames */
@@ -1013,7 +1041,8 @@ static void flush_ffmpeg(FFMpegContext *context)
 		
 		ret = avcodec_encode_video2(c, &packet, NULL, &got_output);
 		if (ret < 0) {
-			fprintf(stderr, "Error encoding delayed frame %d\n", ret);
+			BKE_reportf(reports, RPT_ERROR, "Error encoding delayed frame %d", ret);
+			success = 0;
 			break;
 		}
 		if (!got_output) {
@@ -1037,11 +1066,14 @@ static void flush_ffmpeg(FFMpegContext *context)
 		packet.stream_index = context->video_stream->index;
 		ret = av_interleaved_write_frame(context->outfile, &packet);
 		if (ret != 0) {
-			fprintf(stderr, "Error writing delayed frame %d\n", ret);
+			BKE_reportf(reports, RPT_ERROR, "Error writing delayed frame %d", ret);
+			success = 0;
 			break;
 		}
 	}
 	avcodec_flush_buffers(context->video_stream->codec);
+
+	return success;
 }
 
 /* **********************************************************************
@@ -1117,6 +1149,8 @@ void BKE_ffmpeg_filepath_get(char *string, RenderData *rd, bool preview, const c
 	ffmpeg_filepath_get(NULL, string, rd, preview, suffix);
 }
 
+static void ffmpeg_encode_thread_start(FFMpegContext *context);
+
 int BKE_ffmpeg_start(void *context_v, struct Scene *scene, RenderData *rd, int rectx, int recty,
                      ReportList *reports, bool preview, const char *suffix)
 {
@@ -1125,6 +1159,9 @@ int BKE_ffmpeg_start(void *context_v, struct Scene *scene, RenderData *rd, int r
 
 	context->ffmpeg_autosplit_count = 0;
 	context->ffmpeg_preview = preview;
+	context->rectx = rectx;
+	context->recty = recty;
+	BLI_strncpy(context->suffix, suffix, sizeof(context->suffix));
 
 	success = start_ffmpeg_impl(context, rd, rectx, recty, suffix, reports);
 #ifdef WITH_AUDASPACE
@@ -1161,10 +1198,15 @@ int BKE_ffmpeg_start(void *context_v, struct Scene *scene, RenderData *rd, int r
 #endif
 	}
 #endif
+
+	if (success && context->video_stream) {
+		ffmpeg_encode_thread_start(context);
+	}
+
 	return success;
 }
 
-static void end_ffmpeg_impl(FFMpegContext *context, int is_autosplit);
+static int end_ffmpeg_impl(FFMpegContext *context, int is_autosplit, ReportList *reports);
 
 #ifdef WITH_AUDASPACE
 static void write_audio_frames(FFMpegContext *context, double to_pts)
@@ -1181,39 +1223,171 @@ static void write_audio_frames(FFMpegContext *context, double to_pts)
 }
 #endif
 
-int BKE_ffmpeg_append(void *context_v, RenderData *rd, int start_frame, int frame, int *pixels,
-                      int rectx, int recty, const char *suffix, ReportList *reports)
+/* encode and write a frame, frame is relative to the start frame */
+static int ffmpeg_encode_frame(FFMpegContext *context, RenderData *rd, int frame, int *pixels, ReportList *reports)
 {
-	FFMpegContext *context = context_v;
 	AVFrame *avframe;
 	int success = 1;
 
-	PRINT("Writing frame %i, render width=%d, render height=%d\n", frame, rectx, recty);
-
 /* why is this done before writing the video frame and again at end_ffmpeg? */
 //	write_audio_frames(frame / (((double)rd->frs_sec) / rd->frs_sec_base));
 
 	if (context->video_stream) {
 		avframe = generate_video_frame(context, (unsigned char *) pixels, reports);
-		success = (avframe && write_video_frame(context, rd, frame - start_frame, avframe, reports));
+		success = (avframe && write_video_frame(context, rd, frame, avframe, reports));
 
 		if (context->ffmpeg_autosplit) {
 			if (avio_tell(context->outfile->pb) > FFMPEG_AUTOSPLIT_SIZE) {
-				end_ffmpeg_impl(context, true);
+				success &= end_ffmpeg_impl(context, true, reports);
 				context->ffmpeg_autosplit_count++;
-				success &= start_ffmpeg_impl(context, rd, rectx, recty, suffix, reports);
+				success &= start_ffmpeg_impl(context, rd, context->rectx, context->recty, context->suffix, reports);
 			}
 		}
 	}
 
 #ifdef WITH_AUDASPACE
-	write_audio_frames(context, (frame - start_frame) / (((double)rd->frs_sec) / (double)rd->frs_sec_base));
+	write_audio_frames(context, frame / (((double)rd->frs_sec) / (double)rd->frs_sec_base));
 #endif
 	return success;
 }
 
-static void end_ffmpeg_impl(FFMpegContext *context, int is_autosplit)
+static void *ffmpeg_encode_thread(void *context_v)
+{
+	FFMpegContext *context = context_v;
+	FFMpegQueuedFrame *qframe;
+
+	/* NULL once the queue is empty and BKE_ffmpeg_end is waiting */
+	while ((qframe = BLI_thread_queue_pop(context->encode_queue))) {
+		bool failed;
+
+		BLI_mutex_lock(&context->encode_lock);
+		failed = context->encode_failed;
+		BLI_mutex_unlock(&context->encode_lock);
+
+		/* frames after an error are dropped */
+		if (!failed && !ffmpeg_encode_frame(context, qframe->rd, qframe->frame, qframe->pixels,
+		                                    &context->encode_reports))
+		{
+			BLI_mutex_lock(&context->encode_lock);
+			context->encode_failed = true;
+			BLI_mutex_unlock(&context->encode_lock);
+		}
+
+		BLI_thread_queue_push(context->free_queue, qframe);
+	}
+
+	return NULL;
+}
+
+static void ffmpeg_encode_thread_start(FFMpegContext *context)
+{
+	int i;
+
+	context->encode_queue = BLI_thread_queue_init();
+	context->free_queue = BLI_thread_queue_init();
+	context->queued_frames = MEM_callocN(sizeof(FFMpegQueuedFrame) * FFMPEG_QUEUE_SIZE, "ffmpeg queued frames");
+	for (i = 0; i < FFMPEG_QUEUE_SIZE; i++) {
+		BLI_thread_queue_push(context->free_queue, &context->queued_frames[i]);
+	}
+
+	BLI_mutex_init(&context->encode_lock);
+	BKE_reports_init(&context->encode_reports, RPT_STORE);
+	context->encode_failed = false;
+
+	BLI_init_threads(&context->encode_threads, ffmpeg_encode_thread, 1);
+	BLI_insert_thread(&context->encode_threads, context);
+}
+
+/* wait for the queued frames to be encoded and stop the thread,
+ * errors encoding the last frames are moved to the reports */
+static int ffmpeg_encode_thread_end(FFMpegContext *context, ReportList *reports)
+{
+	int i;
+	int success;
+
+	if (context->encode_queue == NULL) {
+		return 1;
+	}
+
+	BLI_thread_queue_nowait(context->encode_queue);
+	BLI_end_threads(&context->encode_threads);
+
+	for (i = 0; i < FFMPEG_QUEUE_SIZE; i++) {
+		MEM_SAFE_FREE(context->queued_frames[i].pixels);
+	}
+	MEM_freeN(context->queued_frames);
+	context->queued_frames = NULL;
+
+	BLI_thread_queue_free(context->encode_queue);
+	BLI_thread_queue_free(context->free_queue);
+	context->encode_queue = NULL;
+	context->free_queue = NULL;
+
+	success = !context->encode_failed;
+	if (!success) {
+		Report *report;
+
+		for (report = context->encode_reports.list.first; report; report = report->next) {
+			BKE_report(reports, report->type, report->message);
+		}
+	}
+	BKE_reports_clear(&context->encode_reports);
+	BLI_mutex_end(&context->encode_lock);
+
+	return success;
+}
+
+/* Frames are copied and queued for the encoder thread, so rendering of the next frame continues
+ * while the frame is encoded. Errors encoding earlier frames are reported here. */
+int BKE_ffmpeg_append(void *context_v, RenderData *rd, int start_frame, int frame, int *pixels,
+                      int rectx, int recty, const char *UNUSED(suffix), ReportList *reports)
 {
+	FFMpegContext *context = context_v;
+	FFMpegQueuedFrame *qframe;
+	bool failed;
+
+	PRINT("Writing frame %i, render width=%d, render height=%d\n", frame, rectx, recty);
+
+	if (context->encode_queue == NULL) {
+		/* no video, only audio is written */
+		return ffmpeg_encode_frame(context, rd, frame - start_frame, pixels, reports);
+	}
+
+	BLI_mutex_lock(&context->encode_lock);
+	failed = context->encode_failed;
+	if (failed) {
+		Report *report;
+
+		for (report = context->encode_reports.list.first; report; report = report->next) {
+			BKE_report(reports, report->type, report->message);
+		}
+		BKE_reports_clear(&context->encode_reports);
+	}
+	BLI_mutex_unlock(&context->encode_lock);
+
+	if (failed) {
+		return 0;
+	}
+
+	/* waits while the queue is full */
+	qframe = BLI_thread_queue_pop(context->free_queue);
+
+	if (qframe->pixels == NULL) {
+		qframe->pixels = MEM_mallocN(sizeof(int) * context->rectx * context->recty, "ffmpeg queued frame");
+	}
+	memcpy(qframe->pixels, pixels, sizeof(int) * context->rectx * context->recty);
+	qframe->rd = rd;
+	qframe->frame = frame - start_frame;
+
+	BLI_thread_queue_push(context->encode_queue, qframe);
+
+	return 1;
+}
+
+static int end_ffmpeg_impl(FFMpegContext *context, int is_autosplit, ReportList *reports)
+{
+	int success = 1;
+
 	PRINT("Closing ffmpeg...\n");
 
 #if 0
@@ -1233,11 +1407,14 @@ static void end_ffmpeg_impl(FFMpegContext *context, int is_autosplit)
 
 	if (context->video_stream && context->video_stream->codec) {
 		PRINT("Flushing delayed frames...\n");
-		flush_ffmpeg(context);
+		success &= flush_ffmpeg(context, reports);
 	}
 	
 	if (context->outfile) {
-		av_write_trailer(context->outfile);
+		if (av_write_trailer(context->outfile) < 0) {
+			BKE_report(reports, RPT_ERROR, "Could not write the movie file trailer");
+			success = 0;
+		}
 	}
 	
 	/* Close the video codec */
@@ -1260,7 +1437,10 @@ static void end_ffmpeg_impl(FFMpegContext *context, int is_autosplit)
 	}
 	if (context->outfile && context->outfile->oformat) {
 		if (!(context->outfile->oformat->flags & AVFMT_NOFILE)) {
-			avio_close(context->outfile->pb);
+			if (avio_close(context->outfile->pb) < 0) {
+				BKE_report(reports, RPT_ERROR, "Could not close the movie file");
+				success = 0;
+			}
 		}
 	}
 	if (context->outfile) {
@@ -1287,12 +1467,20 @@ static void end_ffmpeg_impl(FFMpegContext *context, int is_autosplit)
 		sws_freeContext(context->img_convert_ctx);
 		context->img_convert_ctx = 0;
 	}
+
+	return success;
 }
 
-void BKE_ffmpeg_end(void *context_v)
+/* Finish writing the movie, returns false when the last frames or the file could not be written. */
+int BKE_ffmpeg_end(void *context_v, ReportList *reports)
 {
 	FFMpegContext *context = context_v;
-	end_ffmpeg_impl(context, false);
+	int success;
+
+	success = ffmpeg_encode_thread_end(context, reports);
+	success &= end_ffmpeg_impl(context, false, reports);
+
+	return success;
 }
 
 /* properties */
@@ -394,7 +394,7 @@ int BKE_frameserver_append(void *context_v, RenderData *UNUSED(rd), int UNUSED(s
 	return 1;
 }
 
-void BKE_frameserver_end(void *context_v)
+int BKE_frameserver_end(void *context_v, ReportList *UNUSED(reports))
 {
 	FrameserverContext *context = context_v;
 
@@ -404,6 +404,8 @@ void BKE_frameserver_end(void *context_v)
 	}
 	closesocket(context->sock);
 	shutdown_socket_system();
+
+	return 1;
 }
 
 void *BKE_frameserver_context_create(void)
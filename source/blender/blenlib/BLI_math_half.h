@@ -0,0 +1,53 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ * */
+
+#ifndef __BLI_MATH_HALF_H__
+#define __BLI_MATH_HALF_H__
+
+/** \file BLI_math_half.h
+ *  \ingroup bli
+ *
+ * Conversion between 32 bit floats and IEEE 754 half precision (16 bit) floats,
+ * stored as unsigned shorts. Conversion to half rounds to the nearest even value,
+ * values too large for half precision become infinity.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "BLI_math_inline.h"
+
+MINLINE float half_to_float(unsigned short h);
+MINLINE unsigned short float_to_half(float f);
+
+/* arrays of values, using F16C instructions when the build targets them */
+void half_to_float_vn(float *array_tar, const unsigned short *array_src, const int size);
+void float_to_half_vn(unsigned short *array_tar, const float *array_src, const int size);
+
+#if BLI_MATH_DO_INLINE
+#include "intern/math_half_inline.c"
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BLI_MATH_HALF_H__ */
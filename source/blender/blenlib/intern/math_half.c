@@ -0,0 +1,63 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ * */
+
+/** \file blender/blenlib/intern/math_half.c
+ *  \ingroup bli
+ */
+
+#include "BLI_math_half.h"
+
+#ifdef __F16C__
+#  include <immintrin.h>
+#endif
+
+#include "BLI_strict_flags.h"
+
+void half_to_float_vn(float *array_tar, const unsigned short *array_src, const int size)
+{
+	int i = 0;
+
+#ifdef __F16C__
+	for (; i + 8 <= size; i += 8) {
+		__m128i h = _mm_loadu_si128((const __m128i *)&array_src[i]);
+		_mm256_storeu_ps(&array_tar[i], _mm256_cvtph_ps(h));
+	}
+#endif
+
+	for (; i < size; i++) {
+		array_tar[i] = half_to_float(array_src[i]);
+	}
+}
+
+void float_to_half_vn(unsigned short *array_tar, const float *array_src, const int size)
+{
+	int i = 0;
+
+#ifdef __F16C__
+	for (; i + 8 <= size; i += 8) {
+		__m256 f = _mm256_loadu_ps(&array_src[i]);
+		_mm_storeu_si128((__m128i *)&array_tar[i], _mm256_cvtps_ph(f, _MM_FROUND_TO_NEAREST_INT));
+	}
+#endif
+
+	for (; i < size; i++) {
+		array_tar[i] = float_to_half(array_src[i]);
+	}
+}
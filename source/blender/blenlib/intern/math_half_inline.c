@@ -0,0 +1,94 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ * */
+
+/** \file blender/blenlib/intern/math_half_inline.c
+ *  \ingroup bli
+ */
+
+#ifndef __MATH_HALF_INLINE_C__
+#define __MATH_HALF_INLINE_C__
+
+#include "BLI_math_half.h"
+
+MINLINE float half_to_float(unsigned short h)
+{
+	union { unsigned int i; float f; } u;
+	unsigned int sign = (unsigned int)(h & 0x8000) << 16;
+	unsigned int exponent = (h >> 10) & 0x1f;
+	unsigned int mantissa = h & 0x3ff;
+
+	if (exponent == 0x1f) {
+		/* infinity and nan */
+		u.i = sign | 0x7f800000 | (mantissa << 13);
+	}
+	else if (exponent != 0) {
+		u.i = sign | ((exponent + (127 - 15)) << 23) | (mantissa << 13);
+	}
+	else if (mantissa != 0) {
+		/* denormal half, normal float */
+		exponent = 127 - 15 + 1;
+		while ((mantissa & 0x400) == 0) {
+			mantissa <<= 1;
+			exponent--;
+		}
+		u.i = sign | (exponent << 23) | ((mantissa & 0x3ff) << 13);
+	}
+	else {
+		u.i = sign;
+	}
+
+	return u.f;
+}
+
+MINLINE unsigned short float_to_half(float f)
+{
+	/* largest float rounding to a finite half, and the offset that aligns denormal halves */
+	const union { unsigned int i; float f; } f16_max = {(127 + 16) << 23};
+	const union { unsigned int i; float f; } denormal_magic = {((127 - 15) + (23 - 10) + 1) << 23};
+	union { unsigned int i; float f; } u;
+	unsigned int sign;
+	unsigned short h;
+
+	u.f = f;
+	sign = u.i & 0x80000000;
+	u.i ^= sign;
+
+	if (u.i >= f16_max.i) {
+		/* infinity, or nan (keeping it quiet) */
+		h = (u.i > 0x7f800000) ? 0x7e00 : 0x7c00;
+	}
+	else if (u.i < ((127 - 15 + 1) << 23)) {
+		/* denormal half or zero, the addition rounds the mantissa to nearest even */
+		u.f += denormal_magic.f;
+		h = (unsigned short)(u.i - denormal_magic.i);
+	}
+	else {
+		const unsigned int mantissa_odd = (u.i >> 13) & 1;
+
+		/* rebias the exponent and round to nearest even */
+		u.i += ((unsigned int)(15 - 127) << 23) + 0xfff;
+		u.i += mantissa_odd;
+		h = (unsigned short)(u.i >> 13);
+	}
+
+	return (unsigned short)(h | (sign >> 16));
+}
+
+#endif /* __MATH_HALF_INLINE_C__ */
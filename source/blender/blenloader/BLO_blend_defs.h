@@ -77,4 +77,21 @@ enum {
 
 #define BLEN_THUMB_MEMSIZE_FILE(_x, _y) (sizeof(int) * (size_t)(2 + (_x) * (_y)))
 
+/**
+ * Block compressed files (see #G_FILE_COMPRESS_FAST), written instead of a gzip stream.
+ *
+ * Layout (all integers little endian):
+ * - The magic.
+ * - Frames, each LZO compressed independently: uint32 compressed size, uint32 raw size, data.
+ *   When both sizes are equal the data is stored uncompressed.
+ * - The frame index: uint64 file offset of each frame.
+ * - Trailer: uint32 number of frames, uint32 largest raw frame size, uint64 total raw size, the magic.
+ *
+ * Since the frames can be located from the index, they are decompressed in parallel on load.
+ */
+#define BLEND_BLOCK_LZO_MAGIC "BLOCKLZO"
+#define BLEND_BLOCK_LZO_MAGIC_LEN 8
+#define BLEND_BLOCK_LZO_FRAME_HEADER_LEN 8
+#define BLEND_BLOCK_LZO_TRAILER_LEN (16 + BLEND_BLOCK_LZO_MAGIC_LEN)
+
 #endif  /* __BLO_BLEND_DEFS_H__ */
@@ -33,12 +33,18 @@
  *  \ingroup blenloader
  */
 
+struct GHash;
+
 typedef struct {
 	void *next, *prev;
 	
 	char *buf;
 	unsigned int ident, size;
-	
+
+	/* address of the ID written first in this chunk, chunks are split at each ID (NULL for other chunks) */
+	const void *id_addr;
+	/* chunk is shared with the memfile of the current state, see BLO_memfile_tag_identical */
+	bool is_identical_current;
 } MemFileChunk;
 
 typedef struct MemFile {
@@ -46,12 +52,26 @@ typedef struct MemFile {
 	unsigned int size;
 } MemFile;
 
+typedef struct MemFileWriteData {
+	MemFile *current;
+	MemFile *compare;
+	MemFileChunk *compchunk;
+	/* ID address -> first chunk of that ID in 'compare' */
+	struct GHash *id_chunk_map;
+	/* address of the ID the next added chunk starts with */
+	const void *id_addr_next;
+} MemFileWriteData;
+
 /* actually only used writefile.c */
-extern void memfile_chunk_add(MemFile *compare, MemFile *current, const char *buf, unsigned int size);
+extern void memfile_write_init(MemFileWriteData *mem_data, MemFile *compare, MemFile *current);
+extern void memfile_write_finalize(MemFileWriteData *mem_data);
+extern void memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, unsigned int size);
+extern void memfile_chunk_id_begin(MemFileWriteData *mem_data, const void *id_addr);
 
 /* exports */
 extern void BLO_memfile_free(MemFile *memfile);
 extern void BLO_memfile_merge(MemFile *first, MemFile *second);
+extern void BLO_memfile_tag_identical(MemFile *memfile, const MemFile *current);
 
 #endif
 
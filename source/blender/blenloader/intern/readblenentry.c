@@ -389,6 +389,9 @@ BlendFileData *BLO_read_from_memfile(Main *oldmain, const char *filename, MemFil
 
 		/* make lookups of existing sound data in old main */
 		blo_make_sound_pointer_map(fd, oldmain);
+
+		/* find unchanged datablocks that can be kept as they are */
+		blo_make_undo_reuse_map(fd, oldmain);
 		
 		/* removed packed data from this trick - it's internal data that needs saves */
 		
@@ -403,6 +406,11 @@ BlendFileData *BLO_read_from_memfile(Main *oldmain, const char *filename, MemFil
 		/* ensures relinked sounds are not freed */
 		blo_end_sound_pointer_map(fd, oldmain);
 
+		/* corrects users of kept datablocks */
+		if (bfd) {
+			blo_end_undo_reuse_map(fd, oldmain);
+		}
+
 		/* Still in-use libraries have already been moved from oldmain to new mainlist,
 		 * but oldmain itself shall *never* be 'transferred' to new mainlist! */
 		BLI_assert(old_mainlist.first == oldmain);
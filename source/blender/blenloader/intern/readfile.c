@@ -45,6 +45,7 @@
 #include "BLI_utildefines.h"
 #ifndef WIN32
 #  include <unistd.h> // for read close
+#  include <sys/mman.h> // for mmap munmap
 #else
 #  include <io.h> // for open close read
 #  include "winsock2.h"
@@ -108,6 +109,9 @@
 #include "BLI_math.h"
 #include "BLI_threads.h"
 #include "BLI_mempool.h"
+#include "BLI_ghash.h"
+#include "BLI_linklist.h"
+#include "BLI_task.h"
 
 #include "BLT_translation.h"
 
@@ -154,11 +158,21 @@
 
 #include "RE_engine.h"
 
+#include "PIL_time.h"
+
 #include "readfile.h"
 
 
 #include <errno.h>
 
+#ifdef WITH_LZO
+#  ifdef WITH_SYSTEM_LZO
+#    include <lzo/lzo1x.h>
+#  else
+#    include "minilzo.h"
+#  endif
+#endif
+
 /*
  * Remark: still a weak point is the newaddress() function, that doesnt solve reading from
  * multiple files at the same time
@@ -211,6 +225,18 @@
 /* use GHash for BHead name-based lookups (speeds up linking) */
 #define USE_GHASH_BHEAD
 
+/* Memory-map uncompressed files, when the file matches our pointer size and endianness
+ * BHead's and their data are used in-place instead of being copied into BHeadN's.
+ * Blocks in files are only 4 byte aligned, so only enable this where unaligned access is supported. */
+#if !defined(WIN32) && (defined(__x86_64__) || defined(__i386__) || defined(__aarch64__))
+#  define USE_BHEAD_MMAP
+#endif
+
+/* Below this number of blocks, reconstruct structs on demand (threading overhead isn't worth it). */
+#define PREPARE_STRUCTS_THREADED_MIN 1024
+/* Bytes of file data to reconstruct structs for ahead of reading, bounds the extra memory used. */
+#define PREPARE_STRUCTS_BATCH_SIZE (64 * 1024 * 1024)
+
 /***/
 
 typedef struct OldNew {
@@ -221,13 +247,21 @@ typedef struct OldNew {
 typedef struct OldNewMap {
 	OldNew *entries;
 	int nentries, entriessize;
-	int sorted;
 	int lasthit;
+
+	/* Open addressing (linear probing) index into entries, stores 'index + 1', zero for empty slots.
+	 * Only used when the lasthit guess misses, since data is linked in mostly the same order it's written. */
+	int *map;
+	int map_size_exp;
 } OldNewMap;
 
+/* keep the map at most half full */
+#define OLDNEWMAP_MAP_SIZE_EXP_INIT 11
+
 
 /* local prototypes */
 static void *read_struct(FileData *fd, BHead *bh, const char *blockname);
+static void read_file_prepare_structs_free(FileData *fd);
 static void direct_link_modifiers(FileData *fd, ListBase *lb);
 static void convert_tface_mt(FileData *fd, Main *main);
 static BHead *find_bhead_from_code_name(FileData *fd, const short idcode, const char *name);
@@ -271,24 +305,49 @@ static OldNewMap *oldnewmap_new(void)
 	
 	onm->entriessize = 1024;
 	onm->entries = MEM_mallocN(sizeof(*onm->entries)*onm->entriessize, "OldNewMap.entries");
+
+	onm->map_size_exp = OLDNEWMAP_MAP_SIZE_EXP_INIT;
+	onm->map = MEM_callocN(sizeof(*onm->map) << onm->map_size_exp, "OldNewMap.map");
 	
 	return onm;
 }
 
-static int verg_oldnewmap(const void *v1, const void *v2)
+/* Fibonacci hashing, old addresses are aligned so the low bits can't be used directly. */
+BLI_INLINE unsigned int oldnewmap_hash(const void *addr, const int map_size_exp)
 {
-	const struct OldNew *x1=v1, *x2=v2;
-	
-	if (x1->old > x2->old) return 1;
-	else if (x1->old < x2->old) return -1;
-	return 0;
+	return (unsigned int)(((uint64_t)(uintptr_t)addr * 11400714819323198485ull) >> (64 - map_size_exp));
+}
+
+/* Returns the slot holding \a addr, or the empty slot it would be stored in. */
+BLI_INLINE int *oldnewmap_map_slot(const OldNewMap *onm, const void *addr)
+{
+	const unsigned int mask = (1u << onm->map_size_exp) - 1;
+	unsigned int i = oldnewmap_hash(addr, onm->map_size_exp);
+
+	while (onm->map[i] != 0 && onm->entries[onm->map[i] - 1].old != addr) {
+		i = (i + 1) & mask;
+	}
+
+	return &onm->map[i];
 }
 
+static void oldnewmap_map_insert(OldNewMap *onm, const int index)
+{
+	/* on duplicate old addresses, the most recent entry wins (as the previous backwards linear search did) */
+	*oldnewmap_map_slot(onm, onm->entries[index].old) = index + 1;
+}
 
-static void oldnewmap_sort(FileData *fd) 
+static void oldnewmap_map_grow(OldNewMap *onm)
 {
-	qsort(fd->libmap->entries, fd->libmap->nentries, sizeof(OldNew), verg_oldnewmap);
-	fd->libmap->sorted = 1;
+	int i;
+
+	onm->map_size_exp++;
+	MEM_freeN(onm->map);
+	onm->map = MEM_callocN(sizeof(*onm->map) << onm->map_size_exp, "OldNewMap.map");
+
+	for (i = 0; i < onm->nentries; i++) {
+		oldnewmap_map_insert(onm, i);
+	}
 }
 
 /* nr is zero for data, and ID code for libdata */
@@ -307,6 +366,13 @@ static void oldnewmap_insert(OldNewMap *onm, void *oldaddr, void *newaddr, int n
 	entry->old = oldaddr;
 	entry->newp = newaddr;
 	entry->nr = nr;
+
+	if (UNLIKELY(onm->nentries > (1 << (onm->map_size_exp - 1)))) {
+		oldnewmap_map_grow(onm);
+	}
+	else {
+		oldnewmap_map_insert(onm, onm->nentries - 1);
+	}
 }
 
 void blo_do_versions_oldnewmap_insert(OldNewMap *onm, void *oldaddr, void *newaddr, int nr)
@@ -317,51 +383,13 @@ void blo_do_versions_oldnewmap_insert(OldNewMap *onm, void *oldaddr, void *newad
 /**
  * Do a full search (no state).
  *
- * \param lasthit: Use as a reference position to avoid a full search
- * from either end of the array, giving more efficient lookups.
- *
- * \note This would seem an ideal case for hash or btree lookups.
- * However the data is written in-order, using the \a lasthit will normally avoid calling this function.
- * Creating a btree/hash structure adds overhead for the common-case to optimize the corner-case
- * (since most entries will never be retrieved).
- * So just keep full lookups as a fall-back.
+ * \note The data is written in-order, using the \a lasthit will normally avoid calling this function.
+ * When it misses (pointers between datablocks, node trees, custom-data layers...)
+ * a linear search made relinking quadratic on large files, so use the hash index.
  */
-static int oldnewmap_lookup_entry_full(const OldNewMap *onm, const void *addr, int lasthit)
+static int oldnewmap_lookup_entry_full(const OldNewMap *onm, const void *addr)
 {
-	const int nentries = onm->nentries;
-	const OldNew *entries = onm->entries;
-	int i;
-
-	/* search relative to lasthit where possible */
-	if (lasthit >= 0 && lasthit < nentries) {
-
-		/* search forwards */
-		i = lasthit;
-		while (++i != nentries) {
-			if (entries[i].old == addr) {
-				return i;
-			}
-		}
-
-		/* search backwards */
-		i = lasthit + 1;
-		while (i--) {
-			if (entries[i].old == addr) {
-				return i;
-			}
-		}
-	}
-	else {
-		/* search backwards (full) */
-		i = nentries;
-		while (i--) {
-			if (entries[i].old == addr) {
-				return i;
-			}
-		}
-	}
-
-	return -1;
+	return *oldnewmap_map_slot(onm, addr) - 1;
 }
 
 static void *oldnewmap_lookup_and_inc(OldNewMap *onm, void *addr, bool increase_users) 
@@ -380,7 +408,7 @@ static void *oldnewmap_lookup_and_inc(OldNewMap *onm, void *addr, bool increase_
 		}
 	}
 	
-	i = oldnewmap_lookup_entry_full(onm, addr, onm->lasthit);
+	i = oldnewmap_lookup_entry_full(onm, addr);
 	if (i != -1) {
 		OldNew *entry = &onm->entries[i];
 		BLI_assert(entry->old == addr);
@@ -401,23 +429,8 @@ static void *oldnewmap_liblookup(OldNewMap *onm, void *addr, void *lib)
 	}
 
 	/* lasthit works fine for non-libdata, linking there is done in same sequence as writing */
-	if (onm->sorted) {
-		OldNew entry_s, *entry;
-
-		entry_s.old = addr;
-
-		entry = bsearch(&entry_s, onm->entries, onm->nentries, sizeof(OldNew), verg_oldnewmap);
-		if (entry) {
-			ID *id = entry->newp;
-
-			if (id && (!lib || id->lib)) {
-				return id;
-			}
-		}
-	}
-	else {
-		/* note, this can be a bottle neck when loading some files */
-		const int i = oldnewmap_lookup_entry_full(onm, addr, -1);
+	{
+		const int i = oldnewmap_lookup_entry_full(onm, addr);
 		if (i != -1) {
 			OldNew *entry = &onm->entries[i];
 			ID *id = entry->newp;
@@ -446,12 +459,39 @@ static void oldnewmap_free_unused(OldNewMap *onm)
 
 static void oldnewmap_clear(OldNewMap *onm) 
 {
+	const int nentries = onm->nentries;
+
 	onm->nentries = 0;
 	onm->lasthit = 0;
+
+	/* shrink back, the map may have grown large for a single datablock (e.g. a huge mesh) */
+	if (onm->map_size_exp != OLDNEWMAP_MAP_SIZE_EXP_INIT) {
+		onm->map_size_exp = OLDNEWMAP_MAP_SIZE_EXP_INIT;
+		MEM_freeN(onm->map);
+		onm->map = MEM_callocN(sizeof(*onm->map) << onm->map_size_exp, "OldNewMap.map");
+	}
+	else if (nentries < (1 << (onm->map_size_exp - 3))) {
+		/* the datamap is cleared for every datablock, avoid clearing the whole map when few slots are used,
+		 * zero the entire cluster each entry is in (all slots belong to entries being cleared) */
+		const unsigned int mask = (1u << onm->map_size_exp) - 1;
+		int i;
+
+		for (i = 0; i < nentries; i++) {
+			unsigned int j = oldnewmap_hash(onm->entries[i].old, onm->map_size_exp);
+			while (onm->map[j] != 0) {
+				onm->map[j] = 0;
+				j = (j + 1) & mask;
+			}
+		}
+	}
+	else {
+		memset(onm->map, 0, sizeof(*onm->map) << onm->map_size_exp);
+	}
 }
 
 static void oldnewmap_free(OldNewMap *onm) 
 {
+	MEM_freeN(onm->map);
 	MEM_freeN(onm->entries);
 	MEM_freeN(onm);
 }
@@ -713,6 +753,8 @@ static BHeadN *get_bhead(FileData *fd)
 			BHead8 bhead8 = {0};
 			BHead4 bhead4 = {0};
 			BHead  bhead = {0};
+
+			fd->is_memchunk_identical = true;
 			
 			/* First read the bhead structure.
 			 * Depending on the platform the file was written on this can
@@ -783,6 +825,9 @@ static BHeadN *get_bhead(FileData *fd)
 						MEM_freeN(new_bhead);
 						new_bhead = NULL;
 					}
+					else {
+						new_bhead->is_memchunk_identical = (fd->memfile && fd->is_memchunk_identical);
+					}
 				}
 				else {
 					fd->eof = 1;
@@ -801,11 +846,47 @@ static BHeadN *get_bhead(FileData *fd)
 	return(new_bhead);
 }
 
+#ifdef USE_BHEAD_MMAP
+/* Returns the BHead at given offset in the mapped file, or NULL when there is no (valid) block there. */
+static BHead *bhead_mapped_at(FileData *fd, size_t offset)
+{
+	BHead *bhead;
+
+	if (offset + sizeof(BHead) > fd->mmap_size) {
+		return NULL;
+	}
+
+	bhead = (BHead *)(fd->mmap_buffer + offset);
+
+	/* make sure people are not trying to pass bad blend files */
+	if (bhead->len < 0 || (offset + sizeof(BHead) + (size_t)bhead->len) > fd->mmap_size) {
+		return NULL;
+	}
+
+	return bhead;
+}
+
+static int bhead_mapped_cmp(const void *v1, const void *v2)
+{
+	const BHead *bh1 = *(const BHead **)v1, *bh2 = *(const BHead **)v2;
+
+	if (bh1 > bh2) return 1;
+	else if (bh1 < bh2) return -1;
+	return 0;
+}
+#endif
+
 BHead *blo_firstbhead(FileData *fd)
 {
 	BHeadN *new_bhead;
 	BHead *bhead = NULL;
 	
+#ifdef USE_BHEAD_MMAP
+	if (fd->flags & FD_FLAGS_BHEAD_MAPPED) {
+		return bhead_mapped_at(fd, SIZEOFBLENDERHEADER);
+	}
+#endif
+
 	/* Rewind the file
 	 * Read in a new block if necessary
 	 */
@@ -821,10 +902,42 @@ BHead *blo_firstbhead(FileData *fd)
 	return(bhead);
 }
 
-BHead *blo_prevbhead(FileData *UNUSED(fd), BHead *thisblock)
+BHead *blo_prevbhead(FileData *fd, BHead *thisblock)
 {
-	BHeadN *bheadn = (BHeadN *)POINTER_OFFSET(thisblock, -offsetof(BHeadN, bhead));
-	BHeadN *prev = bheadn->prev;
+	BHeadN *bheadn, *prev;
+	
+#ifdef USE_BHEAD_MMAP
+	if (fd->flags & FD_FLAGS_BHEAD_MAPPED) {
+		BHead **bhead_p;
+
+		/* Mapped blocks have no back-links, build a (sorted) directory of all blocks on first use. */
+		if (fd->mmap_bheads == NULL) {
+			BHead *bhead;
+			int tot = 0;
+
+			for (bhead = blo_firstbhead(fd); bhead; bhead = blo_nextbhead(fd, bhead)) {
+				tot++;
+			}
+
+			fd->mmap_bheads = MEM_mallocN(sizeof(*fd->mmap_bheads) * (size_t)max_ii(tot, 1), __func__);
+			fd->tot_mmap_bheads = 0;
+
+			for (bhead = blo_firstbhead(fd); bhead; bhead = blo_nextbhead(fd, bhead)) {
+				fd->mmap_bheads[fd->tot_mmap_bheads++] = bhead;
+			}
+		}
+
+		bhead_p = bsearch(&thisblock, fd->mmap_bheads, fd->tot_mmap_bheads, sizeof(*fd->mmap_bheads),
+		                  bhead_mapped_cmp);
+
+		return (bhead_p && bhead_p != fd->mmap_bheads) ? bhead_p[-1] : NULL;
+	}
+#else
+	UNUSED_VARS(fd);
+#endif
+
+	bheadn = (BHeadN *)POINTER_OFFSET(thisblock, -offsetof(BHeadN, bhead));
+	prev = bheadn->prev;
 	
 	return (prev) ? &prev->bhead : NULL;
 }
@@ -834,6 +947,15 @@ BHead *blo_nextbhead(FileData *fd, BHead *thisblock)
 	BHeadN *new_bhead = NULL;
 	BHead *bhead = NULL;
 	
+#ifdef USE_BHEAD_MMAP
+	if (fd->flags & FD_FLAGS_BHEAD_MAPPED) {
+		if (thisblock == NULL || thisblock->code == ENDB) {
+			return NULL;
+		}
+		return bhead_mapped_at(fd, (size_t)((char *)(thisblock + 1) - fd->mmap_buffer) + (size_t)thisblock->len);
+	}
+#endif
+
 	if (thisblock) {
 		/* bhead is actually a sub part of BHeadN
 		 * We calculate the BHeadN pointer from the BHead pointer below */
@@ -899,6 +1021,13 @@ static void decode_blender_header(FileData *fd)
 			memcpy(num, header + 9, 3);
 			num[3] = 0;
 			fd->fileversion = atoi(num);
+
+#ifdef USE_BHEAD_MMAP
+			/* native files can use their blocks in-place */
+			if (fd->mmap_buffer && !(fd->flags & (FD_FLAGS_SWITCH_ENDIAN | FD_FLAGS_POINTSIZE_DIFFERS))) {
+				fd->flags |= FD_FLAGS_BHEAD_MAPPED;
+			}
+#endif
 		}
 	}
 }
@@ -990,6 +1119,17 @@ static int fd_read_gzip_from_file(FileData *filedata, void *buffer, unsigned int
 	return (readsize);
 }
 
+static int fd_read_from_mmap(FileData *filedata, void *buffer, unsigned int size)
+{
+	/* don't read more bytes then there are available in the mapping */
+	const size_t readsize = MIN2((size_t)size, filedata->mmap_size - filedata->mmap_seek);
+
+	memcpy(buffer, filedata->mmap_buffer + filedata->mmap_seek, readsize);
+	filedata->mmap_seek += readsize;
+
+	return (int)readsize;
+}
+
 static int fd_read_from_memory(FileData *filedata, void *buffer, unsigned int size)
 {
 	/* don't read more bytes then there are available in the buffer */
@@ -1049,6 +1189,9 @@ static int fd_read_from_memfile(FileData *filedata, void *buffer, unsigned int s
 				readsize= chunk->size-chunkoffset;
 			
 			memcpy(POINTER_OFFSET(buffer, totread), chunk->buf + chunkoffset, readsize);
+			if (!chunk->is_identical_current) {
+				filedata->is_memchunk_identical = false;
+			}
 			totread += readsize;
 			filedata->seek += readsize;
 			seek += readsize;
@@ -1100,11 +1243,267 @@ static FileData *blo_decode_and_check(FileData *fd, ReportList *reports)
 	return fd;
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Block compressed files (see: BLEND_BLOCK_LZO_MAGIC)
+ * \{ */
+
+static bool blo_file_is_block_lzo(const char *filepath)
+{
+	char magic[BLEND_BLOCK_LZO_MAGIC_LEN];
+	bool is_block_lzo = false;
+	int file;
+
+	file = BLI_open(filepath, O_BINARY | O_RDONLY, 0);
+	if (file != -1) {
+		if (read(file, magic, sizeof(magic)) == sizeof(magic)) {
+			is_block_lzo = STREQLEN(magic, BLEND_BLOCK_LZO_MAGIC, BLEND_BLOCK_LZO_MAGIC_LEN);
+		}
+		close(file);
+	}
+
+	return is_block_lzo;
+}
+
+#ifdef WITH_LZO
+typedef struct BlockLzoFrames {
+	const char *file;
+	char *raw;
+	const uint64_t *file_offsets;
+	const uint64_t *raw_offsets;
+	bool error;
+} BlockLzoFrames;
+
+/* little endian, see writefile.c */
+static uint64_t block_lzo_read_uint(const char *data, const int size)
+{
+	uint64_t value = 0;
+	int i;
+
+	for (i = 0; i < size; i++) {
+		value |= (uint64_t)(unsigned char)data[i] << (8 * i);
+	}
+	return value;
+}
+
+static void block_lzo_decompress_frame_cb(void *userdata, const int index)
+{
+	BlockLzoFrames *frames = userdata;
+	const char *frame = frames->file + frames->file_offsets[index];
+	const lzo_uint compressed_len = (lzo_uint)block_lzo_read_uint(frame, 4);
+	const lzo_uint raw_len = (lzo_uint)block_lzo_read_uint(frame + 4, 4);
+	char *raw = frames->raw + frames->raw_offsets[index];
+
+	frame += BLEND_BLOCK_LZO_FRAME_HEADER_LEN;
+
+	if (compressed_len == raw_len) {
+		memcpy(raw, frame, raw_len);
+	}
+	else {
+		lzo_uint out_len = raw_len;
+		const int r = lzo1x_decompress_safe((const unsigned char *)frame, compressed_len,
+		                                    (unsigned char *)raw, &out_len, NULL);
+		if (r != LZO_E_OK || out_len != raw_len) {
+			frames->error = true;
+		}
+	}
+}
+
+/**
+ * Decompress all frames in parallel.
+ *
+ * \return The raw file contents (caller owns), or NULL when the file is invalid.
+ */
+static char *block_lzo_decompress(const char *file, const size_t file_len, size_t *r_raw_len)
+{
+	BlockLzoFrames frames = {NULL};
+	const char *trailer;
+	uint64_t *file_offsets, *raw_offsets;
+	uint64_t raw_len, raw_offset = 0;
+	size_t index_offset;
+	unsigned int tot_frames, frame_len_max, i;
+
+	if (file_len < BLEND_BLOCK_LZO_MAGIC_LEN + BLEND_BLOCK_LZO_TRAILER_LEN) {
+		return NULL;
+	}
+
+	trailer = file + file_len - BLEND_BLOCK_LZO_TRAILER_LEN;
+	tot_frames = (unsigned int)block_lzo_read_uint(trailer, 4);
+	frame_len_max = (unsigned int)block_lzo_read_uint(trailer + 4, 4);
+	raw_len = block_lzo_read_uint(trailer + 8, 8);
+
+	if (!STREQLEN(trailer + 16, BLEND_BLOCK_LZO_MAGIC, BLEND_BLOCK_LZO_MAGIC_LEN) ||
+	    ((uint64_t)tot_frames * 8 > file_len - BLEND_BLOCK_LZO_MAGIC_LEN - BLEND_BLOCK_LZO_TRAILER_LEN) ||
+	    (raw_len > (uint64_t)SIZE_MAX))
+	{
+		return NULL;
+	}
+
+	index_offset = file_len - BLEND_BLOCK_LZO_TRAILER_LEN - (size_t)tot_frames * 8;
+
+	file_offsets = MEM_mallocN(sizeof(*file_offsets) * (size_t)max_ii((int)tot_frames, 1), __func__);
+	raw_offsets = MEM_mallocN(sizeof(*raw_offsets) * (size_t)max_ii((int)tot_frames, 1), __func__);
+
+	/* validate all frames before decompressing anything */
+	for (i = 0; i < tot_frames; i++) {
+		const uint64_t offset = block_lzo_read_uint(file + index_offset + i * 8, 8);
+		uint64_t frame_compressed_len, frame_raw_len;
+
+		if (offset < BLEND_BLOCK_LZO_MAGIC_LEN || offset + BLEND_BLOCK_LZO_FRAME_HEADER_LEN > index_offset) {
+			break;
+		}
+
+		frame_compressed_len = block_lzo_read_uint(file + offset, 4);
+		frame_raw_len = block_lzo_read_uint(file + offset + 4, 4);
+
+		if ((offset + BLEND_BLOCK_LZO_FRAME_HEADER_LEN + frame_compressed_len > index_offset) ||
+		    (frame_raw_len > frame_len_max) ||
+		    (frame_compressed_len > frame_raw_len) ||
+		    (raw_offset + frame_raw_len > raw_len))
+		{
+			break;
+		}
+
+		file_offsets[i] = offset;
+		raw_offsets[i] = raw_offset;
+		raw_offset += frame_raw_len;
+	}
+
+	if (i == tot_frames && raw_offset == raw_len && raw_len != 0) {
+		frames.file = file;
+		frames.file_offsets = file_offsets;
+		frames.raw_offsets = raw_offsets;
+		frames.raw = MEM_mallocN((size_t)raw_len, __func__);
+
+		BLI_task_parallel_range(0, (int)tot_frames, &frames, block_lzo_decompress_frame_cb, tot_frames > 1);
+
+		if (frames.error) {
+			MEM_freeN(frames.raw);
+			frames.raw = NULL;
+		}
+	}
+
+	MEM_freeN(file_offsets);
+	MEM_freeN(raw_offsets);
+
+	*r_raw_len = (size_t)raw_len;
+	return frames.raw;
+}
+#endif  /* WITH_LZO */
+
+/**
+ * The whole file is decompressed into memory, the data is then read like a memory-mapped file.
+ */
+static FileData *blo_openblenderfile_block_lzo(const char *filepath, ReportList *reports)
+{
+#ifdef WITH_LZO
+	FileData *fd;
+	char *file, *raw = NULL;
+	size_t file_len, raw_len;
+
+	file = BLI_file_read_binary_as_mem(filepath, 0, &file_len);
+	if (file) {
+		raw = block_lzo_decompress(file, file_len, &raw_len);
+		MEM_freeN(file);
+	}
+
+	if (raw == NULL) {
+		BKE_reportf(reports, RPT_ERROR, "Failed to read blend file '%s', invalid block compressed file", filepath);
+		return NULL;
+	}
+
+	fd = filedata_new();
+	fd->mmap_buffer = raw;
+	fd->mmap_size = raw_len;
+	fd->read = fd_read_from_mmap;
+	fd->flags |= FD_FLAGS_MMAP_IS_ALLOC;
+
+	return fd;
+#else
+	BKE_reportf(reports, RPT_ERROR, "Failed to read blend file '%s', block compressed files need LZO support",
+	            filepath);
+	return NULL;
+#endif
+}
+
+/** \} */
+
+#ifdef USE_BHEAD_MMAP
+/**
+ * Map an uncompressed file into memory, returns NULL when the file is compressed
+ * or can't be mapped, in that case the caller falls back to (gzip) streaming.
+ *
+ * \note The mapping is private & writable since reading patches blocks in-place
+ * (endian switching, ID code updates), these changes never reach the file.
+ */
+static FileData *blo_openblenderfile_mmap(const char *filepath)
+{
+	FileData *fd;
+	char *buffer;
+	size_t size;
+	int file;
+
+	file = BLI_open(filepath, O_BINARY | O_RDONLY, 0);
+	if (file == -1) {
+		return NULL;
+	}
+
+	size = BLI_file_descriptor_size(file);
+	if (size == (size_t)-1 || size < SIZEOFBLENDERHEADER) {
+		close(file);
+		return NULL;
+	}
+
+	buffer = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+	close(file);
+
+	if (buffer == MAP_FAILED) {
+		return NULL;
+	}
+
+	/* gzip'ed, use regular reading */
+	if (buffer[0] == 0x1f && buffer[1] == (char)0x8b) {
+		munmap(buffer, size);
+		return NULL;
+	}
+
+	fd = filedata_new();
+	fd->mmap_buffer = buffer;
+	fd->mmap_size = size;
+	fd->read = fd_read_from_mmap;
+
+	return fd;
+}
+#endif
+
 /* cannot be called with relative paths anymore! */
 /* on each new library added, it now checks for the current FileData and expands relativeness */
 FileData *blo_openblenderfile(const char *filepath, ReportList *reports)
 {
 	gzFile gzfile;
+
+	if (blo_file_is_block_lzo(filepath)) {
+		FileData *fd = blo_openblenderfile_block_lzo(filepath, reports);
+		if (fd) {
+			/* needed for library_append and read_libraries */
+			BLI_strncpy(fd->relabase, filepath, sizeof(fd->relabase));
+
+			fd = blo_decode_and_check(fd, reports);
+		}
+		return fd;
+	}
+
+#ifdef USE_BHEAD_MMAP
+	{
+		FileData *fd = blo_openblenderfile_mmap(filepath);
+		if (fd) {
+			/* needed for library_append and read_libraries */
+			BLI_strncpy(fd->relabase, filepath, sizeof(fd->relabase));
+
+			return blo_decode_and_check(fd, reports);
+		}
+	}
+#endif
+
 	errno = 0;
 	gzfile = BLI_gzopen(filepath, "rb");
 	
@@ -1132,6 +1531,37 @@ FileData *blo_openblenderfile(const char *filepath, ReportList *reports)
 static FileData *blo_openblenderfile_minimal(const char *filepath)
 {
 	gzFile gzfile;
+
+	if (blo_file_is_block_lzo(filepath)) {
+		FileData *fd = blo_openblenderfile_block_lzo(filepath, NULL);
+		if (fd) {
+			decode_blender_header(fd);
+
+			if (fd->flags & FD_FLAGS_FILE_OK) {
+				return fd;
+			}
+
+			blo_freefiledata(fd);
+		}
+		return NULL;
+	}
+
+#ifdef USE_BHEAD_MMAP
+	{
+		FileData *fd = blo_openblenderfile_mmap(filepath);
+		if (fd) {
+			decode_blender_header(fd);
+
+			if (fd->flags & FD_FLAGS_FILE_OK) {
+				return fd;
+			}
+
+			blo_freefiledata(fd);
+			return NULL;
+		}
+	}
+#endif
+
 	errno = 0;
 	gzfile = BLI_gzopen(filepath, "rb");
 
@@ -1261,8 +1691,30 @@ void blo_freefiledata(FileData *fd)
 			fd->buffer = NULL;
 		}
 		
+		if (fd->undo_reuse_ids) {
+			BLI_gset_free(fd->undo_reuse_ids, NULL);
+		}
+		if (fd->undo_old_ids) {
+			BLI_gset_free(fd->undo_old_ids, NULL);
+		}
+		read_file_prepare_structs_free(fd);
+
 		// Free all BHeadN data blocks
 		BLI_freelistN(&fd->listbase);
+
+		if (fd->mmap_bheads) {
+			MEM_freeN(fd->mmap_bheads);
+		}
+		if (fd->mmap_buffer) {
+			if (fd->flags & FD_FLAGS_MMAP_IS_ALLOC) {
+				MEM_freeN(fd->mmap_buffer);
+			}
+#ifdef USE_BHEAD_MMAP
+			else {
+				munmap(fd->mmap_buffer, fd->mmap_size);
+			}
+#endif
+		}
 		
 		if (fd->memsdna)
 			DNA_sdna_free(fd->memsdna);
@@ -1821,6 +2273,251 @@ void blo_add_library_pointer_map(ListBase *old_mainlist, FileData *fd)
 	fd->old_mainlist = old_mainlist;
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Undo: keep unchanged datablocks
+ *
+ * Datablocks whose blocks in the memfile are all shared with the memfile of the current state
+ * (see #BLO_memfile_tag_identical) did not change, so they can be kept as they are in memory,
+ * instead of being freed, read and linked again.
+ * This only holds when all datablocks they use are kept as well, since their pointers are not relinked.
+ * \{ */
+
+typedef struct UndoReuseIDLinkData {
+	FileData *fd;
+	bool is_valid;
+} UndoReuseIDLinkData;
+
+static bool undo_reuse_id_type_supported(const short idcode)
+{
+	/* UI is handled separately, scenes own the depsgraph and other runtime data pointing to objects */
+	return !ELEM(idcode, ID_LI, ID_WM, ID_SCR, ID_SCE);
+}
+
+static bool undo_reuse_id_supported(ID *id)
+{
+	if (!undo_reuse_id_type_supported(GS(id->name))) {
+		return false;
+	}
+	if (GS(id->name) == ID_OB) {
+		/* physics data is owned by the scene's rigid body world */
+		Object *ob = (Object *)id;
+		if (ob->rigidbody_object || ob->rigidbody_constraint) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * Like #BKE_library_foreach_ID_link, but also walks the datablocks used by node trees embedded in \a id,
+ * and mesh texture face images (not handled there).
+ */
+static void undo_reuse_foreach_ID_link(ID *id, LibraryIDLinkCallback callback, void *user_data)
+{
+	BKE_library_foreach_ID_link(id, callback, user_data, IDWALK_READONLY);
+
+	if (GS(id->name) == ID_ME) {
+		Mesh *me = (Mesh *)id;
+		int i, j;
+
+		for (i = 0; i < me->pdata.totlayer; i++) {
+			CustomDataLayer *layer = &me->pdata.layers[i];
+			if (layer->type == CD_MTEXPOLY) {
+				MTexPoly *tf = layer->data;
+				for (j = 0; j < me->totpoly; j++, tf++) {
+					if (tf->tpage && !callback(user_data, (ID **)&tf->tpage, IDWALK_USER_ONE)) {
+						return;
+					}
+				}
+			}
+		}
+	}
+}
+
+static bool undo_reuse_embedded_ntree_cb(FileData *fd, ID *id, LibraryIDLinkCallback callback, void *user_data)
+{
+	/* embedded node trees are not in main, walk them as part of their owner */
+	if (id && (GS(id->name) == ID_NT) && (id->lib == NULL) && !BLI_gset_haskey(fd->undo_old_ids, id)) {
+		undo_reuse_foreach_ID_link(id, callback, user_data);
+		return true;
+	}
+	return false;
+}
+
+static bool undo_reuse_check_id_link_cb(void *user_data, ID **id_pointer, int UNUSED(cd_flag))
+{
+	UndoReuseIDLinkData *data = user_data;
+	ID *id = *id_pointer;
+
+	if (id == NULL || undo_reuse_embedded_ntree_cb(data->fd, id, undo_reuse_check_id_link_cb, data)) {
+		return true;
+	}
+
+	/* linked datablocks are kept anyway */
+	if (BLI_gset_haskey(data->fd->undo_old_ids, id) && !BLI_gset_haskey(data->fd->undo_reuse_ids, id)) {
+		data->is_valid = false;
+		return false;
+	}
+	return true;
+}
+
+static bool undo_reuse_users_id_link_cb(void *user_data, ID **id_pointer, int cd_flag)
+{
+	UndoReuseIDLinkData *data = user_data;
+	ID *id = *id_pointer;
+
+	if (id == NULL || undo_reuse_embedded_ntree_cb(data->fd, id, undo_reuse_users_id_link_cb, data)) {
+		return true;
+	}
+
+	if ((cd_flag & IDWALK_USER) && (id->tag & LIB_TAG_UNDO_OLD_ID_REUSED)) {
+		id_us_min(id);
+	}
+	return true;
+}
+
+
+/**
+ * Find the datablocks of \a oldmain (local data only) that can be kept when reading the memfile.
+ * Does nothing unless the memfile chunks were tagged by #BLO_memfile_tag_identical.
+ */
+void blo_make_undo_reuse_map(FileData *fd, Main *oldmain)
+{
+	ListBase *lbarray[MAX_LIBARRAY];
+	UndoReuseIDLinkData data = {fd};
+	MemFileChunk *chunk;
+	BHead *bhead;
+	ID *id, *id_candidate = NULL;
+	bool changed;
+	int i;
+
+	for (chunk = fd->memfile->chunks.first; chunk; chunk = chunk->next) {
+		if (chunk->is_identical_current) {
+			break;
+		}
+	}
+	if (chunk == NULL) {
+		return;
+	}
+
+	fd->undo_old_ids = BLI_gset_ptr_new(__func__);
+	fd->undo_reuse_ids = BLI_gset_ptr_new(__func__);
+
+	i = set_listbasepointers(oldmain, lbarray);
+	while (i--) {
+		for (id = lbarray[i]->first; id; id = id->next) {
+			BLI_gset_add(fd->undo_old_ids, id);
+		}
+	}
+
+	/* candidates: all blocks of the datablock are unchanged, which implies the same address in memory */
+	for (bhead = blo_firstbhead(fd); bhead; bhead = blo_nextbhead(fd, bhead)) {
+		const bool is_identical = ((BHeadN *)POINTER_OFFSET(bhead, -offsetof(BHeadN, bhead)))->is_memchunk_identical;
+
+		if (bhead->code == DATA) {
+			if (!is_identical) {
+				id_candidate = NULL;
+			}
+			continue;
+		}
+
+		if (id_candidate) {
+			BLI_gset_add(fd->undo_reuse_ids, id_candidate);
+		}
+		id_candidate = NULL;
+
+		if (is_identical && BKE_idcode_is_valid(bhead->code) && BLI_gset_haskey(fd->undo_old_ids, bhead->old)) {
+			id = bhead->old;
+			if ((GS(id->name) == bhead->code) && undo_reuse_id_supported(id)) {
+				id_candidate = id;
+			}
+		}
+	}
+
+	/* only keep datablocks which use kept (or linked) datablocks */
+	do {
+		GSetIterator gs_iter;
+		LinkNode *invalid_ids = NULL;
+
+		changed = false;
+
+		GSET_ITER (gs_iter, fd->undo_reuse_ids) {
+			id = BLI_gsetIterator_getKey(&gs_iter);
+			data.is_valid = true;
+			undo_reuse_foreach_ID_link(id, undo_reuse_check_id_link_cb, &data);
+			if (!data.is_valid) {
+				BLI_linklist_prepend(&invalid_ids, id);
+			}
+		}
+
+		while (invalid_ids) {
+			id = BLI_linklist_pop(&invalid_ids);
+			BLI_gset_remove(fd->undo_reuse_ids, id, NULL);
+			changed = true;
+		}
+	} while (changed);
+
+	if (BLI_gset_size(fd->undo_reuse_ids) == 0) {
+		BLI_gset_free(fd->undo_reuse_ids, NULL);
+		fd->undo_reuse_ids = NULL;
+	}
+}
+
+/**
+ * Kept datablocks still count the users from the old state of the datablocks that were read again,
+ * remove those (the read ones added their own users when linking).
+ */
+void blo_end_undo_reuse_map(FileData *fd, Main *oldmain)
+{
+	ListBase *lbarray[MAX_LIBARRAY];
+	UndoReuseIDLinkData data = {fd};
+	ID *id;
+	int i;
+
+	if (fd->undo_reuse_ids == NULL) {
+		return;
+	}
+
+	i = set_listbasepointers(oldmain, lbarray);
+	while (i--) {
+		for (id = lbarray[i]->first; id; id = id->next) {
+			/* UI datablocks are replaced by the ones of the current state, not counted on reading */
+			if (!ELEM(GS(id->name), ID_WM, ID_SCR)) {
+				undo_reuse_foreach_ID_link(id, undo_reuse_users_id_link_cb, &data);
+			}
+		}
+	}
+}
+
+/* Keep the datablock of the current state as is, instead of reading it. */
+static BHead *read_libblock_undo_reuse(FileData *fd, Main *main, BHead *bhead, int flag, ID **r_id)
+{
+	Main *oldmain = fd->old_mainlist->first;
+	ID *id = bhead->old;
+
+	BLI_remlink(which_libbase(oldmain, GS(id->name)), id);
+	BLI_addtail(which_libbase(main, GS(id->name)), id);
+
+	/* same address, but needed for other datablocks to find it when linking */
+	oldnewmap_insert(fd->libmap, bhead->old, id, bhead->code);
+
+	/* no linking, the users of kept datablocks are corrected in blo_end_undo_reuse_map */
+	id->tag = flag | LIB_TAG_UNDO_OLD_ID_REUSED | (id->tag & (LIB_TAG_EXTRAUSER | LIB_TAG_EXTRAUSER_SET));
+
+	if (r_id) {
+		*r_id = id;
+	}
+
+	/* skip the direct data */
+	do {
+		bhead = blo_nextbhead(fd, bhead);
+	} while (bhead && bhead->code == DATA);
+
+	return bhead;
+}
+
+/** \} */
+
 
 /* ********** END OLD POINTERS ****************** */
 /* ********** READ FILE ****************** */
@@ -1841,13 +2538,13 @@ static void switch_endian_structs(struct SDNA *filesdna, BHead *bhead)
 	}
 }
 
-static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
+static void *read_struct_reconstruct(FileData *fd, BHead *bh, const char *blockname, const bool do_endian_switch)
 {
 	void *temp = NULL;
-	
+
 	if (bh->len) {
 		/* switch is based on file dna */
-		if (bh->SDNAnr && (fd->flags & FD_FLAGS_SWITCH_ENDIAN))
+		if (bh->SDNAnr && (fd->flags & FD_FLAGS_SWITCH_ENDIAN) && do_endian_switch)
 			switch_endian_structs(fd->filesdna, bh);
 		
 		if (fd->compflags[bh->SDNAnr] != SDNA_CMP_REMOVED) {
@@ -1865,6 +2562,160 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
 	return temp;
 }
 
+static void read_file_prepare_structs_batch(FileData *fd, const int index);
+
+static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
+{
+	void *temp;
+	
+	if (fd->prepared_structs) {
+		void **index_p;
+
+		temp = BLI_ghash_popkey(fd->prepared_structs, bh, NULL);
+		if (temp) {
+			return temp;
+		}
+
+		/* blocks past the current batch are prepared with the ones following them */
+		index_p = BLI_ghash_lookup_p(fd->prepare_index, bh);
+		if (index_p && GET_INT_FROM_POINTER(*index_p) >= fd->prepare_next) {
+			read_file_prepare_structs_batch(fd, GET_INT_FROM_POINTER(*index_p));
+
+			temp = BLI_ghash_popkey(fd->prepared_structs, bh, NULL);
+			if (temp) {
+				return temp;
+			}
+		}
+	}
+
+	return read_struct_reconstruct(fd, bh, blockname, !(fd->flags & FD_FLAGS_STRUCTS_PREPARED));
+}
+
+/* ************** PREPARE STRUCTS ************** */
+
+typedef struct PrepareStructsData {
+	FileData *fd;
+	BHead **bheads;
+	void **structs;
+} PrepareStructsData;
+
+static bool read_file_prepare_struct_test(const FileData *fd, const BHead *bhead, bool *r_is_reused)
+{
+	/* blocks of datablocks kept on undo are never read */
+	if (bhead->code != DATA) {
+		*r_is_reused = fd->undo_reuse_ids && BLI_gset_haskey(fd->undo_reuse_ids, bhead->old);
+	}
+	return !*r_is_reused && (bhead->len != 0) && !ELEM(bhead->code, DNA1, TEST, REND, ENDB);
+}
+
+static void read_file_prepare_structs_cb(
+        void *userdata, void *UNUSED(userdata_chunk), const int index, const int UNUSED(threadid))
+{
+	PrepareStructsData *data = userdata;
+
+	data->structs[index] = read_struct_reconstruct(data->fd, data->bheads[index], "read_struct prepared", true);
+}
+
+/**
+ * Reconstruct the structs of the blocks following the last batch in parallel, up to \a index
+ * and at least #PREPARE_STRUCTS_BATCH_SIZE bytes of file data.
+ *
+ * Blocks are always prepared in file order, so the blocks before \a fd->prepare_next are
+ * the ones which had their endian switched. Structs left from the previous batch belong to
+ * blocks which were skipped, they are freed so memory use stays within a batch.
+ */
+static void read_file_prepare_structs_batch(FileData *fd, const int index)
+{
+	PrepareStructsData data;
+	const int start = fd->prepare_next;
+	size_t size = 0;
+	int end = start, i;
+
+	BLI_ghash_clear(fd->prepared_structs, NULL, MEM_freeN);
+
+	while (end < fd->prepare_tot && (end <= index || size < PREPARE_STRUCTS_BATCH_SIZE)) {
+		size += (size_t)fd->prepare_bheads[end]->len;
+		end++;
+	}
+
+	data.fd = fd;
+	data.bheads = fd->prepare_bheads + start;
+	data.structs = MEM_mallocN(sizeof(*data.structs) * (size_t)(end - start), __func__);
+
+	/* block sizes vary a lot, use dynamic scheduling */
+	BLI_task_parallel_range_ex(0, end - start, &data, NULL, 0, read_file_prepare_structs_cb,
+	                           (end - start) > 1, true);
+
+	for (i = 0; i < end - start; i++) {
+		if (data.structs[i]) {
+			BLI_ghash_insert(fd->prepared_structs, data.bheads[i], data.structs[i]);
+		}
+	}
+	fd->prepare_next = end;
+
+	MEM_freeN(data.structs);
+}
+
+/**
+ * Endian switching and DNA reconstruction only depend on the block itself,
+ * so they're done for batches of blocks in parallel, ahead of the (serial) reading and linking.
+ * #read_struct then only has to take the result from \a fd->prepared_structs.
+ *
+ * Batches bound the memory used by structs prepared ahead, preparing the whole file at once
+ * would keep a second copy of it in memory until reading is done.
+ *
+ * \return the number of blocks to prepare (zero when there are too few to bother).
+ */
+static int read_file_prepare_structs(FileData *fd)
+{
+	BHead *bhead;
+	bool is_reused = false;
+	int tot = 0, i;
+
+	BLI_assert(fd->prepared_structs == NULL);
+
+	/* also reads in all blocks, when not mapped */
+	for (bhead = blo_firstbhead(fd); bhead; bhead = blo_nextbhead(fd, bhead)) {
+		if (read_file_prepare_struct_test(fd, bhead, &is_reused)) {
+			tot++;
+		}
+	}
+
+	if (tot < PREPARE_STRUCTS_THREADED_MIN) {
+		return 0;
+	}
+
+	fd->prepare_bheads = MEM_mallocN(sizeof(*fd->prepare_bheads) * (size_t)tot, __func__);
+	fd->prepare_index = BLI_ghash_ptr_new_ex(__func__, (unsigned int)tot);
+	fd->prepare_tot = tot;
+	fd->prepare_next = 0;
+
+	i = 0;
+	for (bhead = blo_firstbhead(fd); bhead; bhead = blo_nextbhead(fd, bhead)) {
+		if (read_file_prepare_struct_test(fd, bhead, &is_reused)) {
+			BLI_ghash_insert(fd->prepare_index, bhead, SET_INT_IN_POINTER(i));
+			fd->prepare_bheads[i++] = bhead;
+		}
+	}
+
+	fd->prepared_structs = BLI_ghash_ptr_new(__func__);
+	fd->flags |= FD_FLAGS_STRUCTS_PREPARED;
+
+	return tot;
+}
+
+static void read_file_prepare_structs_free(FileData *fd)
+{
+	if (fd->prepared_structs) {
+		BLI_ghash_free(fd->prepared_structs, NULL, MEM_freeN);
+		BLI_ghash_free(fd->prepare_index, NULL, NULL);
+		MEM_freeN(fd->prepare_bheads);
+		fd->prepared_structs = NULL;
+		fd->prepare_index = NULL;
+		fd->prepare_bheads = NULL;
+	}
+}
+
 typedef void (*link_list_cb)(FileData *fd, void *data);
 
 static void link_list_ex(FileData *fd, ListBase *lb, link_list_cb callback)		/* only direct data */
@@ -7920,6 +8771,10 @@ static BHead *read_libblock(FileData *fd, Main *main, BHead *bhead, int flag, ID
 		}
 	}
 
+	if (fd->undo_reuse_ids && (main->curlib == NULL) && BLI_gset_haskey(fd->undo_reuse_ids, bhead->old)) {
+		return read_libblock_undo_reuse(fd, main, bhead, flag, r_id);
+	}
+
 	/* read libblock */
 	id = read_struct(fd, bhead, "lib block");
 
@@ -8219,8 +9074,6 @@ static void do_versions_after_linking(FileData *fd, Library *lib, Main *main)
 
 static void lib_link_all(FileData *fd, Main *main)
 {
-	oldnewmap_sort(fd);
-	
 	/* No load UI for undo memfiles */
 	if (fd->memfile == NULL) {
 		lib_link_windowmanager(fd, main);
@@ -8339,10 +9192,18 @@ static BHead *read_userdef(BlendFileData *bfd, FileData *fd, BHead *bhead)
 
 BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
 {
-	BHead *bhead = blo_firstbhead(fd);
+	BHead *bhead;
 	BlendFileData *bfd;
 	ListBase mainlist = {NULL, NULL};
+	double time_start, time_prepare, time_read, time_versions, time_libraries, time_link;
+	int tot_prepared;
 	
+	time_start = PIL_check_seconds_timer();
+	tot_prepared = read_file_prepare_structs(fd);
+	time_prepare = PIL_check_seconds_timer();
+
+	bhead = blo_firstbhead(fd);
+
 	bfd = MEM_callocN(sizeof(BlendFileData), "blendfiledata");
 	bfd->main = BKE_main_new();
 	BLI_addtail(&mainlist, bfd->main);
@@ -8404,16 +9265,27 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
 		}
 	}
 	
+	/* structs of blocks that were never read (skipped datablocks), later reads prepare them again */
+	if (fd->prepared_structs) {
+		BLI_ghash_clear(fd->prepared_structs, NULL, MEM_freeN);
+	}
+
+	time_read = PIL_check_seconds_timer();
+
 	/* do before read_libraries, but skip undo case */
 	if (fd->memfile == NULL) {
 		do_versions(fd, NULL, bfd->main);
 		do_versions_userdef(fd, bfd);
 	}
 	
+	time_versions = PIL_check_seconds_timer();
+
 	read_libraries(fd, &mainlist);
 	
 	blo_join_main(&mainlist);
 	
+	time_libraries = PIL_check_seconds_timer();
+
 	lib_link_all(fd, bfd->main);
 	//do_versions_after_linking(fd, NULL, bfd->main); // XXX: not here (or even in this function at all)! this causes crashes on many files - Aligorith (July 04, 2010)
 	lib_verify_nodetree(bfd->main, true);
@@ -8423,6 +9295,24 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
 	
 	fd->mainlist = NULL;  /* Safety, this is local variable, shall not be used afterward. */
 
+	time_link = PIL_check_seconds_timer();
+
+	if (G.debug & G_DEBUG_IO) {
+		printf("Read blend: \"%s\" (%s)\n", filepath,
+		       (fd->flags & FD_FLAGS_BHEAD_MAPPED) ? "mapped" : (fd->memfile ? "undo" : "streamed"));
+		printf("  prepare structs:  %8.3f sec (%d blocks, %d threads)\n", time_prepare - time_start,
+		       tot_prepared, tot_prepared ? BLI_task_scheduler_num_threads(BLI_task_scheduler_get()) : 1);
+		printf("  read datablocks:  %8.3f sec", time_read - time_prepare);
+		if (fd->undo_reuse_ids) {
+			printf(" (%u unchanged kept)", BLI_gset_size(fd->undo_reuse_ids));
+		}
+		printf("\n");
+		printf("  versioning:       %8.3f sec\n", time_versions - time_read);
+		printf("  read libraries:   %8.3f sec\n", time_libraries - time_versions);
+		printf("  link datablocks:  %8.3f sec\n", time_link - time_libraries);
+		printf("  total:            %8.3f sec\n", time_link - time_start);
+	}
+
 	return bfd;
 }
 
@@ -57,11 +57,21 @@ typedef struct FileData {
 	const char *buffer;
 	// variables needed for reading from memfile (undo)
 	struct MemFile *memfile;
+	bool is_memchunk_identical;  /* all chunks read since the last block start are identical to current state */
+	struct GSet *undo_reuse_ids;  /* IDs of old main kept as-is, see blo_make_undo_reuse_map */
+	struct GSet *undo_old_ids;    /* all local IDs of old main */
 
 	// variables needed for reading from file
 	int filedes;
 	gzFile gzfiledes;
 
+	// variables needed for reading from a memory-mapped file (see: USE_BHEAD_MMAP),
+	// or from the decompressed contents of a block compressed file (FD_FLAGS_MMAP_IS_ALLOC)
+	char *mmap_buffer;
+	size_t mmap_size, mmap_seek;
+	struct BHead **mmap_bheads;  /* sorted by address, only built when needed by blo_prevbhead */
+	int tot_mmap_bheads;
+
 	// now only in use for library appending
 	char relabase[FILE_MAX];
 	
@@ -94,6 +104,12 @@ typedef struct FileData {
 
 	/* see: USE_GHASH_BHEAD */
 	struct GHash *bhead_idname_hash;
+
+	/* BHead -> struct, reconstructed ahead of time (see: read_file_prepare_structs) */
+	struct GHash *prepared_structs;
+	struct GHash *prepare_index;  /* BHead -> index in prepare_bheads */
+	struct BHead **prepare_bheads;
+	int prepare_tot, prepare_next;
 	
 	ListBase *mainlist;
 	ListBase *old_mainlist;  /* Used for undo. */
@@ -107,6 +123,8 @@ typedef struct FileData {
 
 typedef struct BHeadN {
 	struct BHeadN *next, *prev;
+	/* undo only, the block is unchanged from the current state (see FileData.is_memchunk_identical) */
+	bool is_memchunk_identical;
 	struct BHead bhead;
 } BHeadN;
 
@@ -118,6 +136,9 @@ enum {
 	FD_FLAGS_FILE_OK               = 1 << 3,
 	FD_FLAGS_NOT_MY_BUFFER         = 1 << 4,
 	FD_FLAGS_NOT_MY_LIBMAP         = 1 << 5,  /* XXX Unused in practice (checked once but never set). */
+	FD_FLAGS_BHEAD_MAPPED          = 1 << 6,  /* BHead's point directly into mmap_buffer, no BHeadN list */
+	FD_FLAGS_STRUCTS_PREPARED      = 1 << 7,  /* endian switching already done for all struct blocks */
+	FD_FLAGS_MMAP_IS_ALLOC         = 1 << 8,  /* mmap_buffer is allocated memory instead of a file mapping */
 };
 
 #define SIZEOFBLENDERHEADER 12
@@ -143,6 +164,8 @@ void blo_end_sound_pointer_map(FileData *fd, Main *oldmain);
 void blo_make_packed_pointer_map(FileData *fd, Main *oldmain);
 void blo_end_packed_pointer_map(FileData *fd, Main *oldmain);
 void blo_add_library_pointer_map(ListBase *old_mainlist, FileData *fd);
+void blo_make_undo_reuse_map(FileData *fd, Main *oldmain);
+void blo_end_undo_reuse_map(FileData *fd, Main *oldmain);
 
 void blo_freefiledata(FileData *fd);
 
@@ -40,6 +40,7 @@
 #include "DNA_listBase.h"
 
 #include "BLI_blenlib.h"
+#include "BLI_ghash.h"
 
 #include "BLO_undofile.h"
 
@@ -94,26 +95,61 @@ static int my_memcmp(const int *mem1, const int *mem2, const int len)
 	return 0;
 }
 
-void memfile_chunk_add(MemFile *compare, MemFile *current, const char *buf, unsigned int size)
+void memfile_write_init(MemFileWriteData *mem_data, MemFile *compare, MemFile *current)
 {
-	static MemFileChunk *compchunk = NULL;
-	MemFileChunk *curchunk;
-	
-	/* this function inits when compare != NULL or when current == NULL  */
+	mem_data->current = current;
+	mem_data->compare = compare;
+	mem_data->compchunk = compare ? compare->chunks.first : NULL;
+	mem_data->id_chunk_map = NULL;
+	mem_data->id_addr_next = NULL;
+
+	/* so IDs can be compared with their previous state, even when other IDs were added or removed before them */
 	if (compare) {
-		compchunk = compare->chunks.first;
-		return;
+		MemFileChunk *chunk;
+
+		mem_data->id_chunk_map = BLI_ghash_ptr_new(__func__);
+		for (chunk = compare->chunks.first; chunk; chunk = chunk->next) {
+			if (chunk->id_addr) {
+				BLI_ghash_insert(mem_data->id_chunk_map, (void *)chunk->id_addr, chunk);
+			}
+		}
+	}
+}
+
+void memfile_write_finalize(MemFileWriteData *mem_data)
+{
+	if (mem_data->id_chunk_map) {
+		BLI_ghash_free(mem_data->id_chunk_map, NULL, NULL);
+		mem_data->id_chunk_map = NULL;
 	}
-	if (current == NULL) {
-		compchunk = NULL;
-		return;
+}
+
+/* call before writing an ID, the buffered data of the previous one must already be added */
+void memfile_chunk_id_begin(MemFileWriteData *mem_data, const void *id_addr)
+{
+	mem_data->id_addr_next = id_addr;
+
+	if (mem_data->id_chunk_map) {
+		/* NULL when the ID is new, nothing to compare against then */
+		mem_data->compchunk = BLI_ghash_lookup(mem_data->id_chunk_map, id_addr);
 	}
+}
+
+void memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, unsigned int size)
+{
+	MemFile *current = mem_data->current;
+	MemFileChunk *compchunk = mem_data->compchunk;
+	MemFileChunk *curchunk;
 	
 	curchunk = MEM_mallocN(sizeof(MemFileChunk), "MemFileChunk");
 	curchunk->size = size;
 	curchunk->buf = NULL;
 	curchunk->ident = 0;
+	curchunk->id_addr = mem_data->id_addr_next;
+	curchunk->is_identical_current = false;
 	BLI_addtail(&current->chunks, curchunk);
+
+	mem_data->id_addr_next = NULL;
 	
 	/* we compare compchunk with buf */
 	if (compchunk) {
@@ -123,7 +159,7 @@ void memfile_chunk_add(MemFile *compare, MemFile *current, const char *buf, unsi
 				curchunk->ident = 1;
 			}
 		}
-		compchunk = compchunk->next;
+		mem_data->compchunk = compchunk->next;
 	}
 	
 	/* not equal... */
@@ -134,3 +170,29 @@ void memfile_chunk_add(MemFile *compare, MemFile *current, const char *buf, unsi
 	}
 }
 
+/**
+ * Tag the chunks of \a memfile that are shared with \a current (the memfile of the current state),
+ * when reading \a memfile this allows to keep the datablocks that did not change in between.
+ * Pass NULL for \a current to clear the tags.
+ */
+void BLO_memfile_tag_identical(MemFile *memfile, const MemFile *current)
+{
+	GSet *current_bufs = NULL;
+	MemFileChunk *chunk;
+
+	if (current && current != memfile) {
+		current_bufs = BLI_gset_ptr_new(__func__);
+		for (chunk = current->chunks.first; chunk; chunk = chunk->next) {
+			BLI_gset_add(current_bufs, chunk->buf);
+		}
+	}
+
+	for (chunk = memfile->chunks.first; chunk; chunk = chunk->next) {
+		chunk->is_identical_current = current_bufs && BLI_gset_haskey(current_bufs, chunk->buf);
+	}
+
+	if (current_bufs) {
+		BLI_gset_free(current_bufs, NULL);
+	}
+}
+
@@ -64,6 +64,9 @@ void BLO_update_defaults_userpref_blend(void)
 	/* default from T47064 */
 	U.audiorate = 48000;
 
+	/* render ahead of sequencer playback */
+	U.prefetchframes = 25;
+
 	/* Keep this a very small, non-zero number so zero-alpha doesn't mask out objects behind it.
 	 * but take care since some hardware has driver bugs here (T46962).
 	 * Further hardware workarounds should be made in gpu_extensions.c */
@@ -143,6 +143,7 @@
 #include "BLI_blenlib.h"
 #include "BLI_linklist.h"
 #include "BLI_mempool.h"
+#include "BLI_task.h"
 
 #include "BKE_action.h"
 #include "BKE_blender.h"
@@ -176,6 +177,15 @@
 
 #include <errno.h>
 
+#ifdef WITH_LZO
+#  ifdef WITH_SYSTEM_LZO
+#    include <lzo/lzo1x.h>
+#  else
+#    include "minilzo.h"
+#  endif
+#  define LZO_OUT_LEN(size)     ((size) + (size) / 16 + 64 + 3)
+#endif
+
 /* ********* my write, buffered writing with minimum size chunks ************ */
 
 #define MYWRITE_BUFFER_SIZE	100000
@@ -189,6 +199,7 @@
 typedef enum {
 	WW_WRAP_NONE = 1,
 	WW_WRAP_ZLIB,
+	WW_WRAP_LZO,
 } eWriteWrapType;
 
 typedef struct WriteWrap WriteWrap;
@@ -202,6 +213,7 @@ struct WriteWrap {
 	union {
 		int file_handle;
 		gzFile gz_handle;
+		struct WriteWrapLzo *lzo_handle;
 	} _user_data;
 };
 
@@ -261,6 +273,185 @@ static size_t ww_write_zlib(WriteWrap *ww, const char *buf, size_t buf_len)
 }
 #undef FILE_HANDLE
 
+#ifdef WITH_LZO
+/* lzo, frames compressed independently on multiple threads (see: BLEND_BLOCK_LZO_MAGIC) */
+#define FILE_HANDLE(ww) \
+	(ww)->_user_data.lzo_handle
+
+#define WW_LZO_FRAME_SIZE (1 << 20)
+
+typedef struct WriteWrapLzoFrame {
+	char *raw, *compressed;
+	lzo_uint raw_len, compressed_len;
+} WriteWrapLzoFrame;
+
+typedef struct WriteWrapLzo {
+	int file_handle;
+	bool error;
+
+	/* frames are filled in order, compressed in parallel once all are full, then written in order */
+	WriteWrapLzoFrame *frames;
+	int frames_len, frames_used;
+
+	/* index of all written frames */
+	uint64_t *offsets;
+	unsigned int offsets_len, offsets_alloc;
+
+	uint64_t file_len, raw_len;
+} WriteWrapLzo;
+
+static void ww_lzo_write_bytes(WriteWrapLzo *lzo, const void *data, size_t data_len)
+{
+	if (lzo->error == false) {
+		if ((size_t)write(lzo->file_handle, data, data_len) == data_len) {
+			lzo->file_len += data_len;
+		}
+		else {
+			lzo->error = true;
+		}
+	}
+}
+
+/* little endian, so files are portable */
+static void ww_lzo_write_uint(WriteWrapLzo *lzo, uint64_t value, const int size)
+{
+	unsigned char bytes[8];
+	int i;
+
+	BLI_assert(size <= 8);
+	for (i = 0; i < size; i++) {
+		bytes[i] = (unsigned char)(value >> (8 * i));
+	}
+	ww_lzo_write_bytes(lzo, bytes, (size_t)size);
+}
+
+static void ww_lzo_compress_frame_cb(void *userdata, const int index)
+{
+	WriteWrapLzoFrame *frame = &((WriteWrapLzoFrame *)userdata)[index];
+	void *wrkmem = MEM_mallocN(LZO1X_1_MEM_COMPRESS, __func__);
+	lzo_uint out_len;
+	int r;
+
+	r = lzo1x_1_compress((unsigned char *)frame->raw, frame->raw_len,
+	                     (unsigned char *)frame->compressed, &out_len, wrkmem);
+
+	/* store uncompressible frames as-is */
+	frame->compressed_len = (r == LZO_E_OK && out_len < frame->raw_len) ? out_len : frame->raw_len;
+
+	MEM_freeN(wrkmem);
+}
+
+static void ww_lzo_flush_frames(WriteWrapLzo *lzo, const int frames_len)
+{
+	int i;
+
+	BLI_task_parallel_range(0, frames_len, lzo->frames, ww_lzo_compress_frame_cb, frames_len > 1);
+
+	for (i = 0; i < frames_len; i++) {
+		WriteWrapLzoFrame *frame = &lzo->frames[i];
+		const bool is_stored = (frame->compressed_len == frame->raw_len);
+
+		if (UNLIKELY(lzo->offsets_len == lzo->offsets_alloc)) {
+			lzo->offsets_alloc *= 2;
+			lzo->offsets = MEM_reallocN(lzo->offsets, sizeof(*lzo->offsets) * lzo->offsets_alloc);
+		}
+		lzo->offsets[lzo->offsets_len++] = lzo->file_len;
+
+		ww_lzo_write_uint(lzo, frame->compressed_len, 4);
+		ww_lzo_write_uint(lzo, frame->raw_len, 4);
+		ww_lzo_write_bytes(lzo, is_stored ? frame->raw : frame->compressed, frame->compressed_len);
+
+		lzo->raw_len += frame->raw_len;
+		frame->raw_len = 0;
+	}
+
+	lzo->frames_used = 0;
+}
+
+static bool ww_open_lzo(WriteWrap *ww, const char *filepath)
+{
+	WriteWrapLzo *lzo;
+	int file, i;
+
+	file = BLI_open(filepath, O_BINARY + O_WRONLY + O_CREAT + O_TRUNC, 0666);
+
+	if (file == -1) {
+		return false;
+	}
+
+	lzo = MEM_callocN(sizeof(*lzo), __func__);
+	lzo->file_handle = file;
+
+	/* one frame per thread, keeps memory use bounded */
+	lzo->frames_len = max_ii(2, BLI_task_scheduler_num_threads(BLI_task_scheduler_get()));
+	lzo->frames = MEM_callocN(sizeof(*lzo->frames) * (size_t)lzo->frames_len, __func__);
+	for (i = 0; i < lzo->frames_len; i++) {
+		lzo->frames[i].raw = MEM_mallocN(WW_LZO_FRAME_SIZE, __func__);
+		lzo->frames[i].compressed = MEM_mallocN(LZO_OUT_LEN(WW_LZO_FRAME_SIZE), __func__);
+	}
+
+	lzo->offsets_alloc = 1024;
+	lzo->offsets = MEM_mallocN(sizeof(*lzo->offsets) * lzo->offsets_alloc, __func__);
+
+	ww_lzo_write_bytes(lzo, BLEND_BLOCK_LZO_MAGIC, BLEND_BLOCK_LZO_MAGIC_LEN);
+
+	FILE_HANDLE(ww) = lzo;
+	return true;
+}
+static bool ww_close_lzo(WriteWrap *ww)
+{
+	WriteWrapLzo *lzo = FILE_HANDLE(ww);
+	unsigned int i;
+	bool ok;
+
+	/* last frame may be partially filled */
+	ww_lzo_flush_frames(lzo, lzo->frames_used + (lzo->frames[lzo->frames_used].raw_len ? 1 : 0));
+
+	for (i = 0; i < lzo->offsets_len; i++) {
+		ww_lzo_write_uint(lzo, lzo->offsets[i], 8);
+	}
+	ww_lzo_write_uint(lzo, lzo->offsets_len, 4);
+	ww_lzo_write_uint(lzo, WW_LZO_FRAME_SIZE, 4);
+	ww_lzo_write_uint(lzo, lzo->raw_len, 8);
+	ww_lzo_write_bytes(lzo, BLEND_BLOCK_LZO_MAGIC, BLEND_BLOCK_LZO_MAGIC_LEN);
+
+	ok = (close(lzo->file_handle) != -1) && (lzo->error == false);
+
+	for (i = 0; i < (unsigned int)lzo->frames_len; i++) {
+		MEM_freeN(lzo->frames[i].raw);
+		MEM_freeN(lzo->frames[i].compressed);
+	}
+	MEM_freeN(lzo->frames);
+	MEM_freeN(lzo->offsets);
+	MEM_freeN(lzo);
+
+	return ok;
+}
+static size_t ww_write_lzo(WriteWrap *ww, const char *buf, size_t buf_len)
+{
+	WriteWrapLzo *lzo = FILE_HANDLE(ww);
+	size_t buf_used = 0;
+
+	while (buf_used != buf_len) {
+		WriteWrapLzoFrame *frame = &lzo->frames[lzo->frames_used];
+		const size_t len = MIN2(buf_len - buf_used, WW_LZO_FRAME_SIZE - frame->raw_len);
+
+		memcpy(frame->raw + frame->raw_len, buf + buf_used, len);
+		frame->raw_len += len;
+		buf_used += len;
+
+		if (frame->raw_len == WW_LZO_FRAME_SIZE) {
+			if (++lzo->frames_used == lzo->frames_len) {
+				ww_lzo_flush_frames(lzo, lzo->frames_len);
+			}
+		}
+	}
+
+	return lzo->error ? 0 : buf_len;
+}
+#undef FILE_HANDLE
+#endif  /* WITH_LZO */
+
 /* --- end compression types --- */
 
 static void ww_handle_init(eWriteWrapType ww_type, WriteWrap *r_ww)
@@ -275,6 +466,15 @@ static void ww_handle_init(eWriteWrapType ww_type, WriteWrap *r_ww)
 			r_ww->write = ww_write_zlib;
 			break;
 		}
+#ifdef WITH_LZO
+		case WW_WRAP_LZO:
+		{
+			r_ww->open  = ww_open_lzo;
+			r_ww->close = ww_close_lzo;
+			r_ww->write = ww_write_lzo;
+			break;
+		}
+#endif
 		default:
 		{
 			r_ww->open  = ww_open_none;
@@ -294,6 +494,7 @@ typedef struct {
 
 	unsigned char *buf;
 	MemFile *compare, *current;
+	MemFileWriteData mem;
 	
 	int tot, count, error;
 
@@ -333,7 +534,7 @@ static void writedata_do_write(WriteData *wd, const void *mem, int memlen)
 
 	/* memory based save */
 	if (wd->current) {
-		memfile_chunk_add(NULL, wd->current, mem, memlen);
+		memfile_chunk_add(&wd->mem, mem, memlen);
 	}
 	else {
 		if (wd->ww->write(wd->ww, mem, memlen) != memlen) {
@@ -421,7 +622,9 @@ static WriteData *bgnwrite(WriteWrap *ww, MemFile *compare, MemFile *current)
 	wd->compare= compare;
 	wd->current= current;
 	/* this inits comparing */
-	memfile_chunk_add(compare, NULL, NULL, 0);
+	if (current) {
+		memfile_write_init(&wd->mem, compare, current);
+	}
 	
 	return wd;
 }
@@ -441,6 +644,10 @@ static int endwrite(WriteData *wd)
 		wd->count= 0;
 	}
 	
+	if (wd->current) {
+		memfile_write_finalize(&wd->mem);
+	}
+
 	err= wd->error;
 	writedata_free(wd);
 
@@ -472,6 +679,12 @@ static void writestruct_at_address(WriteData *wd, int filecode, const char *stru
 
 	if (bh.len==0) return;
 
+	/* for undo, each ID starts a new chunk, so unchanged IDs give identical chunks (see: BLO_memfile_tag_identical) */
+	if (wd->current && filecode != DATA && BKE_idcode_is_valid(filecode)) {
+		mywrite(wd, MYWRITE_FLUSH, 0);
+		memfile_chunk_id_begin(&wd->mem, adr);
+	}
+
 	mywrite(wd, &bh, sizeof(BHead));
 	mywrite(wd, data, bh.len);
 }
@@ -3845,7 +4058,11 @@ bool BLO_write_file(
 	BLI_snprintf(tempname, sizeof(tempname), "%s@", filepath);
 
 	if (write_flags & G_FILE_COMPRESS) {
+#ifdef WITH_LZO
+		ww_type = (write_flags & G_FILE_COMPRESS_FAST) ? WW_WRAP_LZO : WW_WRAP_ZLIB;
+#else
 		ww_type = WW_WRAP_ZLIB;
+#endif
 	}
 	else {
 		ww_type = WW_WRAP_NONE;
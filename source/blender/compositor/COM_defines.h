@@ -111,4 +111,10 @@ typedef enum OrderOfChunks {
 
 #define COM_BLUR_BOKEH_PIXELS 512
 
+/**
+ * @brief maximum number of pixels calculated at once by SocketReader.executeSpan
+ * Span buffers hold 4 floats per pixel and are allocated on the stack.
+ */
+#define COM_SPAN_MAX_LENGTH 128
+
 #endif  /* __COM_DEFINES_H__ */
@@ -200,6 +200,8 @@ public:
 	void setFastCalculation(bool fastCalculation) {this->m_fastCalculation = fastCalculation;}
 	bool isFastCalculation() const { return this->m_fastCalculation; }
 	bool isGroupnodeBufferEnabled() const { return (this->getbNodeTree()->flag & NTREE_COM_GROUPNODE_BUFFER) != 0; }
+	bool isFullFrameEnabled() const { return (this->getbNodeTree()->flag & NTREE_COM_FULL_FRAME) != 0; }
+	bool isHalfFloatBuffersEnabled() const { return (this->getbNodeTree()->flag & NTREE_COM_HALF_FLOAT) != 0; }
 };
 
 
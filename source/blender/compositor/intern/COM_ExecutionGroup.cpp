@@ -36,6 +36,7 @@
 #include "COM_ViewerOperation.h"
 #include "COM_ChunkOrder.h"
 #include "COM_Debug.h"
+#include "COM_ExecutionStats.h"
 
 #include "MEM_guardedalloc.h"
 #include "BLI_math.h"
@@ -60,6 +61,7 @@ ExecutionGroup::ExecutionGroup()
 	this->m_initialized = false;
 	this->m_openCL = false;
 	this->m_singleThreaded = false;
+	this->m_fullFrame = false;
 	this->m_chunksFinished = 0;
 	BLI_rcti_init(&this->m_viewerBorder, 0, 0, 0, 0);
 	this->m_executionStartTime = 0;
@@ -138,6 +140,13 @@ void ExecutionGroup::initExecution()
 	maxNumber++;
 	this->m_cachedMaxReadBufferOffset = maxNumber;
 
+	/* Drive the group by spans of pixels only when every operation can calculate them,
+	 * otherwise the per pixel fallback inside the spans only adds overhead. */
+	bool useSpanExecution = !this->m_complex;
+	for (index = 1; index < this->m_operations.size() && useSpanExecution; index++) {
+		useSpanExecution = this->m_operations[index]->isSpanSupported();
+	}
+	this->getOutputOperation()->setUseSpanExecution(useSpanExecution);
 }
 
 void ExecutionGroup::deinitExecution()
@@ -168,6 +177,16 @@ void ExecutionGroup::determineNumberOfChunks()
 		this->m_numberOfYChunks = 1;
 		this->m_numberOfChunks = 1;
 	}
+	else if (this->m_fullFrame) {
+		/* Rows over the full width, enough of them to keep all threads busy
+		 * when some rows are more expensive than others. */
+		const int border_height = BLI_rcti_size_y(&this->m_viewerBorder);
+		const int numberOfRows = BLI_system_thread_count() * 4;
+		this->m_chunkSize = max_ii(1, (border_height + numberOfRows - 1) / numberOfRows);
+		this->m_numberOfXChunks = 1;
+		this->m_numberOfYChunks = (border_height + this->m_chunkSize - 1) / this->m_chunkSize;
+		this->m_numberOfChunks = this->m_numberOfYChunks;
+	}
 	else {
 		const float chunkSizef = this->m_chunkSize;
 		const int border_width = BLI_rcti_size_x(&this->m_viewerBorder);
@@ -302,6 +321,7 @@ void ExecutionGroup::execute(ExecutionSystem *graph)
 	}
 
 	DebugInfo::execution_group_started(this);
+	ExecutionStats::execution_group_started(this);
 	DebugInfo::graphviz(graph);
 
 	bool breaked = false;
@@ -338,18 +358,67 @@ void ExecutionGroup::execute(ExecutionSystem *graph)
 			}
 		}
 
-		WorkScheduler::finish();
+		/* chunks waiting for their inputs are scheduled as soon as any scheduled chunk is done */
+		if (!finished) {
+			WorkScheduler::waitForProgress();
+		}
 
 		if (bTree->test_break && bTree->test_break(bTree->tbh)) {
 			breaked = true;
 		}
 	}
 	DebugInfo::execution_group_finished(this);
+	ExecutionStats::execution_group_finished(this);
 	DebugInfo::graphviz(graph);
 
 	MEM_freeN(chunkOrder);
 }
 
+void ExecutionGroup::executeFullFrame(ExecutionSystem *graph)
+{
+	const CompositorContext &context = graph->getContext();
+	const bNodeTree *bTree = context.getbNodeTree();
+	if (this->m_width == 0 || this->m_height == 0) {return; } /// @note: break out... no pixels to calculate.
+	if (this->m_numberOfChunks == 0) {return; } /// @note: early break out
+
+	this->m_executionStartTime = PIL_check_seconds_timer();
+	this->m_chunksFinished = 0;
+	/* only report progress of the output groups */
+	this->m_bTree = this->m_isOutput ? bTree : NULL;
+
+	DebugInfo::execution_group_started(this);
+	ExecutionStats::execution_group_started(this);
+
+	for (unsigned int chunkNumber = 0; chunkNumber < this->m_numberOfChunks; chunkNumber++) {
+		scheduleChunk(chunkNumber);
+	}
+	WorkScheduler::finish();
+
+	if (this->m_isOutput && bTree->update_draw) {
+		bTree->update_draw(bTree->udh);
+	}
+
+	DebugInfo::execution_group_finished(this);
+	ExecutionStats::execution_group_finished(this);
+}
+
+bool ExecutionGroup::isFullyExecuted() const
+{
+	for (unsigned int index = 0; index < this->m_numberOfChunks; index++) {
+		if (this->m_chunkExecutionStates[index] != COM_ES_EXECUTED) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void ExecutionGroup::setFullyExecuted()
+{
+	for (unsigned int index = 0; index < this->m_numberOfChunks; index++) {
+		this->m_chunkExecutionStates[index] = COM_ES_EXECUTED;
+	}
+}
+
 MemoryBuffer **ExecutionGroup::getInputBuffersOpenCL(int chunkNumber)
 {
 	rcti rect;
@@ -418,6 +487,13 @@ inline void ExecutionGroup::determineChunkRect(rcti *rect, const unsigned int xC
 	if (this->m_singleThreaded) {
 		BLI_rcti_init(rect, this->m_viewerBorder.xmin, border_width, this->m_viewerBorder.ymin, border_height);
 	}
+	else if (this->m_fullFrame) {
+		const unsigned int miny = yChunk * this->m_chunkSize + this->m_viewerBorder.ymin;
+		const unsigned int width = min((unsigned int) this->m_viewerBorder.xmax, this->m_width);
+		const unsigned int height = min((unsigned int) this->m_viewerBorder.ymax, this->m_height);
+		BLI_rcti_init(rect, min((unsigned int) this->m_viewerBorder.xmin, this->m_width), width,
+		              min(miny, this->m_height), min(miny + this->m_chunkSize, height));
+	}
 	else {
 		const unsigned int minx = xChunk * this->m_chunkSize + this->m_viewerBorder.xmin;
 		const unsigned int miny = yChunk * this->m_chunkSize + this->m_viewerBorder.ymin;
@@ -427,6 +503,18 @@ inline void ExecutionGroup::determineChunkRect(rcti *rect, const unsigned int xC
 	}
 }
 
+unsigned int ExecutionGroup::determineChunkThread(const unsigned int chunkNumber, const unsigned int numberOfThreads) const
+{
+	const unsigned int yChunk = chunkNumber / this->m_numberOfXChunks;
+	const unsigned int xChunk = chunkNumber - (yChunk * this->m_numberOfXChunks);
+
+	/* tiles are scheduled row by row, so give every thread a column of tiles, rows when there is one tile per row */
+	if (this->m_numberOfXChunks > 1) {
+		return (xChunk * numberOfThreads) / this->m_numberOfXChunks;
+	}
+	return (yChunk * numberOfThreads) / this->m_numberOfYChunks;
+}
+
 void ExecutionGroup::determineChunkRect(rcti *rect, const unsigned int chunkNumber) const
 {
 	const unsigned int yChunk = chunkNumber / this->m_numberOfXChunks;
@@ -125,6 +125,13 @@ private:
 	 * @brief Is this Execution group SingleThreaded
 	 */
 	bool m_singleThreaded;
+
+	/**
+	 * @brief is this ExecutionGroup evaluated over its full area at once
+	 * Chunks are then rows of the full width of the group, with all input buffers already calculated.
+	 * @see ExecutionSystem.executeFullFrame
+	 */
+	bool m_fullFrame;
 	
 	/**
 	 * @brief what is the maximum number field of all ReadBufferOperation in this ExecutionGroup.
@@ -375,6 +382,14 @@ public:
 	 * @param system
 	 */
 	void execute(ExecutionSystem *system);
+
+	/**
+	 * @brief calculate all chunks of the ExecutionGroup in parallel
+	 * @note all depending ExecutionGroups must have been calculated before,
+	 * this method will return when all chunks have been calculated.
+	 * @see ExecutionSystem.executeFullFrame
+	 */
+	void executeFullFrame(ExecutionSystem *system);
 	
 	/**
 	 * @brief this method determines the MemoryProxy's where this execution group depends on.
@@ -391,6 +406,12 @@ public:
 	 */
 	void determineChunkRect(rcti *rect, const unsigned int chunkNumber) const;
 
+	/**
+	 * @brief Determine the thread to execute a chunk on, keeping chunks close to each other on the same thread.
+	 * @see WorkScheduler.schedule
+	 */
+	unsigned int determineChunkThread(const unsigned int chunkNumber, const unsigned int numberOfThreads) const;
+
 	/**
 	 * @brief can this ExecutionGroup be scheduled on an OpenCLDevice
 	 * @see WorkScheduler.schedule
@@ -399,6 +420,19 @@ public:
 
 	void setChunksize(int chunksize) { this->m_chunkSize = chunksize; }
 
+	void setFullFrame(bool fullFrame) { this->m_fullFrame = fullFrame; }
+
+	/**
+	 * @brief have all chunks of this ExecutionGroup been calculated
+	 */
+	bool isFullyExecuted() const;
+
+	/**
+	 * @brief mark all chunks as calculated
+	 * @note used when the result of the group has been restored from the ResultCache
+	 */
+	void setFullyExecuted();
+
 	/**
 	 * @brief get the Render priority of this ExecutionGroup
 	 * @see ExecutionSystem.execute
@@ -413,8 +447,9 @@ public:
 
 	void setRenderBorder(float xmin, float xmax, float ymin, float ymax);
 
-	/* allow the DebugInfo class to look at internals */
+	/* allow the DebugInfo and ExecutionStats classes to look at internals */
 	friend class DebugInfo;
+	friend class ExecutionStats;
 
 #ifdef WITH_CXX_GUARDEDALLOC
 	MEM_CXX_CLASS_ALLOC_FUNCS("COM:ExecutionGroup")
@@ -0,0 +1,196 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "COM_ExecutionStats.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <typeinfo>
+#include <map>
+
+extern "C" {
+#include "BLI_threads.h"
+#include "BKE_global.h"
+#include "PIL_time.h"
+}
+
+#include "atomic_ops.h"
+
+#include "COM_ExecutionSystem.h"
+#include "COM_ExecutionGroup.h"
+#include "COM_WorkPackage.h"
+#include "COM_WriteBufferOperation.h"
+
+typedef struct GroupStats {
+	unsigned int index;
+	double startTime;
+	/* wall time of the group, and the time of its chunks summed over all threads */
+	double executionTime;
+	double chunkTime;
+	/* time chunks spent in the queue before a thread picked them up */
+	double queueTime;
+	double maxQueueTime;
+	unsigned int numberOfChunks;
+} GroupStats;
+
+typedef std::map<const ExecutionGroup *, GroupStats> GroupStatsMap;
+
+static GroupStatsMap g_group_stats;
+static ThreadMutex g_group_stats_mutex = BLI_MUTEX_INITIALIZER;
+static double g_execute_start_time;
+
+static size_t g_buffer_memory = 0;
+static size_t g_peak_buffer_memory = 0;
+
+/* name of the operation computing the result of the group, for write buffers the operation writing to it */
+static const char *group_operation_name(const ExecutionGroup *group)
+{
+	NodeOperation *operation = group->getOutputOperation();
+	if (operation->isWriteBufferOperation()) {
+		operation = ((WriteBufferOperation *)operation)->getInput();
+	}
+
+	/* skip the length prefix of the mangled class name */
+	const char *name = typeid(*operation).name();
+	while (*name >= '0' && *name <= '9') {
+		name++;
+	}
+	return name;
+}
+
+bool ExecutionStats::is_enabled()
+{
+	return (G.debug & G_DEBUG_COMPOSITOR) != 0;
+}
+
+void ExecutionStats::execute_started(const ExecutionSystem *system)
+{
+	if (!is_enabled()) {
+		return;
+	}
+
+	g_group_stats.clear();
+	for (unsigned int index = 0; index < system->m_groups.size(); index++) {
+		GroupStats &stats = g_group_stats[system->m_groups[index]];
+		memset(&stats, 0, sizeof(stats));
+		stats.index = index;
+	}
+
+	g_peak_buffer_memory = g_buffer_memory;
+	g_execute_start_time = PIL_check_seconds_timer();
+}
+
+void ExecutionStats::execute_finished(const ExecutionSystem *system)
+{
+	if (!is_enabled()) {
+		return;
+	}
+
+	const double executionTime = PIL_check_seconds_timer() - g_execute_start_time;
+	unsigned int totalChunks = 0;
+	double totalQueueTime = 0.0;
+
+	printf("Compositor execution: %.4f sec, %d groups, peak buffer memory %.2f MB\n",
+	       executionTime, (int)system->m_groups.size(), g_peak_buffer_memory / (1024.0 * 1024.0));
+
+	for (unsigned int index = 0; index < system->m_groups.size(); index++) {
+		const ExecutionGroup *group = system->m_groups[index];
+		const GroupStats &stats = g_group_stats[group];
+		if (stats.numberOfChunks == 0) {
+			continue;
+		}
+
+		printf("  group %u %s (%ux%u%s): ", stats.index, group_operation_name(group),
+		       group->getWidth(), group->getHeight(), group->isComplex() ? ", complex" : "");
+		/* groups only scheduled on demand of other groups have no time of their own */
+		if (stats.executionTime > 0.0) {
+			printf("%.4f sec, ", stats.executionTime);
+		}
+		printf("%u chunks, chunk time %.4f sec, queue wait average %.3f ms max %.3f ms\n",
+		       stats.numberOfChunks, stats.chunkTime,
+		       1000.0 * stats.queueTime / stats.numberOfChunks, 1000.0 * stats.maxQueueTime);
+
+		totalChunks += stats.numberOfChunks;
+		totalQueueTime += stats.queueTime;
+	}
+
+	if (totalChunks) {
+		printf("  work scheduler: %u chunks, queue wait average %.3f ms\n",
+		       totalChunks, 1000.0 * totalQueueTime / totalChunks);
+	}
+}
+
+void ExecutionStats::execution_group_started(const ExecutionGroup *group)
+{
+	if (!is_enabled()) {
+		return;
+	}
+
+	g_group_stats[group].startTime = PIL_check_seconds_timer();
+}
+
+void ExecutionStats::execution_group_finished(const ExecutionGroup *group)
+{
+	if (!is_enabled()) {
+		return;
+	}
+
+	GroupStats &stats = g_group_stats[group];
+	stats.executionTime += PIL_check_seconds_timer() - stats.startTime;
+}
+
+void ExecutionStats::work_package_executed(const WorkPackage *work, double startTime)
+{
+	if (!is_enabled()) {
+		return;
+	}
+
+	const double endTime = PIL_check_seconds_timer();
+	const double queueTime = startTime - work->getScheduledTime();
+
+	BLI_mutex_lock(&g_group_stats_mutex);
+	/* groups are all added when the execution starts, so the map is not modified here */
+	GroupStatsMap::iterator it = g_group_stats.find(work->getExecutionGroup());
+	if (it != g_group_stats.end()) {
+		GroupStats &stats = it->second;
+		stats.chunkTime += endTime - startTime;
+		stats.queueTime += queueTime;
+		if (queueTime > stats.maxQueueTime) {
+			stats.maxQueueTime = queueTime;
+		}
+		stats.numberOfChunks++;
+	}
+	BLI_mutex_unlock(&g_group_stats_mutex);
+}
+
+void ExecutionStats::buffer_allocated(size_t size)
+{
+	const size_t memory = atomic_add_z(&g_buffer_memory, size);
+	size_t peak = g_peak_buffer_memory;
+
+	while (memory > peak) {
+		const size_t prev = atomic_cas_z(&g_peak_buffer_memory, peak, memory);
+		if (prev == peak) {
+			break;
+		}
+		peak = prev;
+	}
+}
+
+void ExecutionStats::buffer_freed(size_t size)
+{
+	atomic_sub_z(&g_buffer_memory, size);
+}
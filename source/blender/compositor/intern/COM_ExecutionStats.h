@@ -0,0 +1,59 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef _COM_ExecutionStats_h
+#define _COM_ExecutionStats_h
+
+#include <stddef.h>
+
+class ExecutionSystem;
+class ExecutionGroup;
+class WorkPackage;
+
+/**
+ * @brief timing and memory statistics of compositor executions
+ *
+ * Enabled with the --debug-compositor command line argument (G_DEBUG_COMPOSITOR).
+ * At the end of every execution a report is printed with the time spent in every ExecutionGroup,
+ * the time chunks waited in the WorkScheduler queues and the peak memory used by MemoryBuffers.
+ *
+ * With tiled execution the operations of a group are evaluated together per pixel,
+ * so time is reported per group, named after the operation computing its result.
+ */
+class ExecutionStats {
+public:
+	static bool is_enabled();
+
+	static void execute_started(const ExecutionSystem *system);
+	static void execute_finished(const ExecutionSystem *system);
+
+	static void execution_group_started(const ExecutionGroup *group);
+	static void execution_group_finished(const ExecutionGroup *group);
+
+	/**
+	 * @brief a chunk of work was taken from the WorkScheduler queue and executed
+	 * @param startTime time the device started executing the work package
+	 */
+	static void work_package_executed(const WorkPackage *work, double startTime);
+
+	/**
+	 * @brief keep track of the memory used by MemoryBuffers, also when statistics are disabled
+	 */
+	static void buffer_allocated(size_t size);
+	static void buffer_freed(size_t size);
+};
+
+#endif
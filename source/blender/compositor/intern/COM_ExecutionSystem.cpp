@@ -22,6 +22,9 @@
 
 #include "COM_ExecutionSystem.h"
 
+#include <algorithm>
+#include <map>
+
 #include "PIL_time.h"
 #include "BLI_utildefines.h"
 extern "C" {
@@ -36,7 +39,10 @@ extern "C" {
 #include "COM_ExecutionGroup.h"
 #include "COM_WorkScheduler.h"
 #include "COM_ReadBufferOperation.h"
+#include "COM_WriteBufferOperation.h"
+#include "COM_ResultCache.h"
 #include "COM_Debug.h"
+#include "COM_ExecutionStats.h"
 
 #ifdef WITH_CXX_GUARDEDALLOC
 #include "MEM_guardedalloc.h"
@@ -51,6 +57,7 @@ ExecutionSystem::ExecutionSystem(RenderData *rd, Scene *scene, bNodeTree *editin
 	this->m_context.setbNodeTree(editingtree);
 	this->m_context.setPreviewHash(editingtree->previews);
 	this->m_context.setFastCalculation(fastcalculation);
+	this->m_cacheGeneration = 0;
 	/* initialize the CompositorContext */
 	if (rendering) {
 		this->m_context.setQuality((CompositorQuality)editingtree->render_quality);
@@ -132,6 +139,10 @@ void ExecutionSystem::execute()
 	editingtree->stats_draw(editingtree->sdh, IFACE_("Compositing | Initializing execution"));
 
 	DebugInfo::execute_started(this);
+	ExecutionStats::execute_started(this);
+	
+	/* results depend on external data read during initialization, so get the generation before that */
+	this->m_cacheGeneration = ResultCache::getGeneration();
 	
 	unsigned int order = 0;
 	for (vector<NodeOperation *>::iterator iter = this->m_operations.begin(); iter != this->m_operations.end(); ++iter) {
@@ -143,13 +154,17 @@ void ExecutionSystem::execute()
 		}
 	}
 	unsigned int index;
+	const bool fullFrame = this->m_context.isFullFrameEnabled();
 
 	// First allocale all write buffer
 	for (index = 0; index < this->m_operations.size(); index++) {
 		NodeOperation *operation = this->m_operations[index];
 		if (operation->isWriteBufferOperation()) {
 			operation->setbNodeTree(this->m_context.getbNodeTree());
-			operation->initExecution();
+			/* with full frame execution buffers are allocated when needed */
+			if (!fullFrame) {
+				operation->initExecution();
+			}
 		}
 	}
 	// Connect read buffers to their write buffers
@@ -171,20 +186,37 @@ void ExecutionSystem::execute()
 	for (index = 0; index < this->m_groups.size(); index++) {
 		ExecutionGroup *executionGroup = this->m_groups[index];
 		executionGroup->setChunksize(this->m_context.getChunksize());
+		executionGroup->setFullFrame(fullFrame);
 		executionGroup->initExecution();
 	}
 
+	restoreCachedResults();
+
 	WorkScheduler::start(this->m_context);
 
-	executeGroups(COM_PRIORITY_HIGH);
-	if (!this->getContext().isFastCalculation()) {
-		executeGroups(COM_PRIORITY_MEDIUM);
-		executeGroups(COM_PRIORITY_LOW);
+	if (fullFrame) {
+		executeFullFrame();
+	}
+	else {
+		executeGroups(COM_PRIORITY_HIGH);
+		if (!this->getContext().isFastCalculation()) {
+			executeGroups(COM_PRIORITY_MEDIUM);
+			executeGroups(COM_PRIORITY_LOW);
+		}
 	}
 
 	WorkScheduler::finish();
 	WorkScheduler::stop();
 
+	if (!fullFrame) {
+		for (index = 0; index < this->m_operations.size(); index++) {
+			NodeOperation *operation = this->m_operations[index];
+			if (operation->isWriteBufferOperation()) {
+				storeCachedResult((WriteBufferOperation *)operation);
+			}
+		}
+	}
+
 	editingtree->stats_draw(editingtree->sdh, IFACE_("Compositing | De-initializing execution"));
 	for (index = 0; index < this->m_operations.size(); index++) {
 		NodeOperation *operation = this->m_operations[index];
@@ -194,6 +226,8 @@ void ExecutionSystem::execute()
 		ExecutionGroup *executionGroup = this->m_groups[index];
 		executionGroup->deinitExecution();
 	}
+
+	ExecutionStats::execute_finished(this);
 }
 
 void ExecutionSystem::executeGroups(CompositorPriority priority)
@@ -208,6 +242,173 @@ void ExecutionSystem::executeGroups(CompositorPriority priority)
 	}
 }
 
+void ExecutionSystem::addGroupWithDependencies(ExecutionGroup *group, vector<ExecutionGroup *> *groups) const
+{
+	if (std::find(groups->begin(), groups->end(), group) != groups->end()) {
+		return;
+	}
+	/* restored groups don't need their inputs */
+	if (this->m_restoredGroups.count(group)) {
+		return;
+	}
+
+	vector<MemoryProxy *> memoryProxies;
+	group->determineDependingMemoryProxies(&memoryProxies);
+	for (unsigned int index = 0; index < memoryProxies.size(); index++) {
+		addGroupWithDependencies(memoryProxies[index]->getExecutor(), groups);
+	}
+
+	groups->push_back(group);
+}
+
+void ExecutionSystem::executeFullFrame()
+{
+	const bNodeTree *editingtree = this->m_context.getbNodeTree();
+	vector<ExecutionGroup *> outputGroups;
+	vector<ExecutionGroup *> groups;
+	unsigned int index;
+
+	findExecutedOutputGroups(&outputGroups);
+	for (index = 0; index < outputGroups.size(); index++) {
+		addGroupWithDependencies(outputGroups[index], &groups);
+	}
+
+	/* count the groups reading every buffer, so it can be freed after the last of them */
+	std::map<MemoryProxy *, int> numberOfReaders;
+	for (index = 0; index < groups.size(); index++) {
+		vector<MemoryProxy *> memoryProxies;
+		groups[index]->determineDependingMemoryProxies(&memoryProxies);
+		for (unsigned int proxyIndex = 0; proxyIndex < memoryProxies.size(); proxyIndex++) {
+			numberOfReaders[memoryProxies[proxyIndex]]++;
+		}
+	}
+
+	for (index = 0; index < groups.size(); index++) {
+		ExecutionGroup *group = groups[index];
+		NodeOperation *outputOperation = group->getOutputOperation();
+
+		if (editingtree->test_break && editingtree->test_break(editingtree->tbh)) {
+			break;
+		}
+
+		if (outputOperation->isWriteBufferOperation()) {
+			initWriteBufferOperation((WriteBufferOperation *)outputOperation);
+		}
+
+		group->executeFullFrame(this);
+
+		if (outputOperation->isWriteBufferOperation()) {
+			storeCachedResult((WriteBufferOperation *)outputOperation);
+		}
+
+		vector<MemoryProxy *> memoryProxies;
+		group->determineDependingMemoryProxies(&memoryProxies);
+		for (unsigned int proxyIndex = 0; proxyIndex < memoryProxies.size(); proxyIndex++) {
+			MemoryProxy *memoryProxy = memoryProxies[proxyIndex];
+			if (--numberOfReaders[memoryProxy] == 0) {
+				memoryProxy->getWriteBufferOperation()->deinitExecution();
+			}
+		}
+	}
+}
+
+void ExecutionSystem::findExecutedOutputGroups(vector<ExecutionGroup *> *result) const
+{
+	this->findOutputExecutionGroup(result, COM_PRIORITY_HIGH);
+	if (!this->getContext().isFastCalculation()) {
+		this->findOutputExecutionGroup(result, COM_PRIORITY_MEDIUM);
+		this->findOutputExecutionGroup(result, COM_PRIORITY_LOW);
+	}
+}
+
+void ExecutionSystem::initWriteBufferOperation(WriteBufferOperation *writeOperation)
+{
+	writeOperation->initExecution();
+	/* connect the read buffers to the newly allocated buffer */
+	for (unsigned int index = 0; index < this->m_operations.size(); index++) {
+		NodeOperation *operation = this->m_operations[index];
+		if (operation->isReadBufferOperation()) {
+			ReadBufferOperation *readOperation = (ReadBufferOperation *)operation;
+			if (readOperation->getMemoryProxy() == writeOperation->getMemoryProxy()) {
+				readOperation->updateMemoryBuffer();
+			}
+		}
+	}
+}
+
+void ExecutionSystem::restoreCachedResults()
+{
+	vector<ExecutionGroup *> groups;
+	findExecutedOutputGroups(&groups);
+	std::set<ExecutionGroup *> visited(groups.begin(), groups.end());
+
+	/* walk upstream from the outputs, stopping at the first restored result of every branch */
+	while (!groups.empty()) {
+		ExecutionGroup *group = groups.back();
+		groups.pop_back();
+
+		vector<MemoryProxy *> memoryProxies;
+		group->determineDependingMemoryProxies(&memoryProxies);
+		for (unsigned int index = 0; index < memoryProxies.size(); index++) {
+			MemoryProxy *memoryProxy = memoryProxies[index];
+			ExecutionGroup *executor = memoryProxy->getExecutor();
+			if (!visited.insert(executor).second) {
+				continue;
+			}
+			if (!restoreCachedResult(memoryProxy->getWriteBufferOperation())) {
+				groups.push_back(executor);
+			}
+		}
+	}
+}
+
+bool ExecutionSystem::restoreCachedResult(WriteBufferOperation *operation)
+{
+	const uint64_t key = operation->getCacheKey();
+	const bool fullFrame = this->m_context.isFullFrameEnabled();
+	MemoryProxy *memoryProxy = operation->getMemoryProxy();
+
+	if (key == 0 || !ResultCache::contains(key)) {
+		return false;
+	}
+
+	/* with full frame execution buffers are not allocated yet */
+	if (fullFrame) {
+		initWriteBufferOperation(operation);
+	}
+	if (!ResultCache::restore(key, memoryProxy->getBuffer())) {
+		if (fullFrame) {
+			operation->deinitExecution();
+		}
+		return false;
+	}
+
+	memoryProxy->getExecutor()->setFullyExecuted();
+	this->m_restoredGroups.insert(memoryProxy->getExecutor());
+	return true;
+}
+
+void ExecutionSystem::storeCachedResult(WriteBufferOperation *operation)
+{
+	const bNodeTree *editingtree = this->m_context.getbNodeTree();
+	MemoryProxy *memoryProxy = operation->getMemoryProxy();
+	ExecutionGroup *executor = memoryProxy->getExecutor();
+	MemoryBuffer *buffer = memoryProxy->getBuffer();
+
+	if (operation->getCacheKey() == 0 || buffer == NULL || buffer->getWidth() == 0 || buffer->getHeight() == 0) {
+		return;
+	}
+	if (this->m_restoredGroups.count(executor) || !executor->isFullyExecuted()) {
+		return;
+	}
+	/* cancelled executions leave incomplete results */
+	if (editingtree->test_break && editingtree->test_break(editingtree->tbh)) {
+		return;
+	}
+
+	ResultCache::store(operation->getCacheKey(), buffer, this->m_cacheGeneration);
+}
+
 void ExecutionSystem::findOutputExecutionGroup(vector<ExecutionGroup *> *result, CompositorPriority priority) const
 {
 	unsigned int index;
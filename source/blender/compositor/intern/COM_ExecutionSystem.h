@@ -21,6 +21,7 @@
  */
 
 class ExecutionGroup;
+class WriteBufferOperation;
 
 #ifndef _COM_ExecutionSystem_h
 #define _COM_ExecutionSystem_h
@@ -31,6 +32,7 @@ class ExecutionGroup;
 #include "BKE_text.h"
 #include "COM_ExecutionGroup.h"
 #include "COM_NodeOperation.h"
+#include <set>
 
 /**
  * @page execution Execution model
@@ -105,6 +107,22 @@ class ExecutionGroup;
  * @see ExecutionSystem.addReadWriteBufferOperations
  * @see NodeOperation.isComplex
  * @see ExecutionGroup class representing the ExecutionGroup
+ *
+ * @section EM_Step5 Step5: execution
+ * By default the output ExecutionGroup's are divided in chunks. For every chunk the areas of interest of the
+ * depending ExecutionGroup's are scheduled first, see ExecutionGroup.scheduleChunkWhenPossible.
+ *
+ * When the full frame execution model is enabled (NTREE_COM_FULL_FRAME), ExecutionGroup's are calculated
+ * one after the other over their full area, in rows which are executed in parallel.
+ * The MemoryBuffer of a WriteBufferOperation is only allocated just before its ExecutionGroup is
+ * calculated, and freed as soon as the last ExecutionGroup reading it has been calculated.
+ * @see ExecutionSystem.executeFullFrame
+ *
+ * @section EM_Step6 Step6: result cache
+ * The buffers of WriteBufferOperation's are kept in the ResultCache after execution.
+ * Before the next execution every ExecutionGroup whose result is found in the cache is restored from it
+ * and marked as calculated, so the groups it depends on are not calculated at all.
+ * @see ExecutionSystem.restoreCachedResults
  */
 
 /**
@@ -131,6 +149,16 @@ private:
 	 */
 	Groups m_groups;
 
+	/**
+	 * @brief ExecutionGroup's whose result was restored from the ResultCache
+	 */
+	std::set<ExecutionGroup *> m_restoredGroups;
+
+	/**
+	 * @brief generation of the ResultCache at the start of the execution
+	 */
+	unsigned int m_cacheGeneration;
+
 private: //methods
 	/**
 	 * find all execution group with output nodes
@@ -177,8 +205,41 @@ public:
 private:
 	void executeGroups(CompositorPriority priority);
 
-	/* allow the DebugInfo class to look at internals */
+	/**
+	 * @brief calculate the output ExecutionGroup's and all groups they depend on over the full frame
+	 * @see ExecutionGroup.executeFullFrame
+	 */
+	void executeFullFrame();
+
+	/**
+	 * @brief add the ExecutionGroup after all ExecutionGroup's it depends on to the list
+	 */
+	void addGroupWithDependencies(ExecutionGroup *group, vector<ExecutionGroup *> *groups) const;
+
+	/**
+	 * @brief find the output ExecutionGroup's that will be calculated
+	 */
+	void findExecutedOutputGroups(vector<ExecutionGroup *> *result) const;
+
+	/**
+	 * @brief allocate the buffer of a WriteBufferOperation and connect its ReadBufferOperation's to it
+	 */
+	void initWriteBufferOperation(WriteBufferOperation *operation);
+
+	/**
+	 * @brief restore results of the ExecutionGroup's needed by the output groups from the ResultCache
+	 */
+	void restoreCachedResults();
+	bool restoreCachedResult(WriteBufferOperation *operation);
+
+	/**
+	 * @brief store the result of a WriteBufferOperation in the ResultCache when it was fully calculated
+	 */
+	void storeCachedResult(WriteBufferOperation *operation);
+
+	/* allow the DebugInfo and ExecutionStats classes to look at internals */
 	friend class DebugInfo;
+	friend class ExecutionStats;
 
 #ifdef WITH_CXX_GUARDEDALLOC
 	MEM_CXX_CLASS_ALLOC_FUNCS("COM:ExecutionSystem")
@@ -21,6 +21,7 @@
  */
 
 #include "COM_MemoryBuffer.h"
+#include "COM_ExecutionStats.h"
 
 #include "MEM_guardedalloc.h"
 
@@ -40,6 +41,12 @@ static unsigned int determine_num_channels(DataType datatype)
 	}
 }
 
+size_t MemoryBuffer::getMemorySize()
+{
+	const size_t value_size = this->m_half_buffer ? sizeof(unsigned short) : sizeof(float);
+	return value_size * this->determineBufferSize() * this->m_num_channels;
+}
+
 unsigned int MemoryBuffer::determineBufferSize()
 {
 	return getWidth() * getHeight();
@@ -62,9 +69,17 @@ MemoryBuffer::MemoryBuffer(MemoryProxy *memoryProxy, unsigned int chunkNumber, r
 	this->m_memoryProxy = memoryProxy;
 	this->m_chunkNumber = chunkNumber;
 	this->m_num_channels = determine_num_channels(memoryProxy->getDataType());
-	this->m_buffer = (float *)MEM_mallocN_aligned(sizeof(float) * determineBufferSize() * this->m_num_channels, 16, "COM_MemoryBuffer");
+	if (memoryProxy->isHalfFloat()) {
+		this->m_buffer = NULL;
+		this->m_half_buffer = (unsigned short *)MEM_mallocN_aligned(sizeof(unsigned short) * determineBufferSize() * this->m_num_channels, 16, "COM_MemoryBuffer half");
+	}
+	else {
+		this->m_buffer = (float *)MEM_mallocN_aligned(sizeof(float) * determineBufferSize() * this->m_num_channels, 16, "COM_MemoryBuffer");
+		this->m_half_buffer = NULL;
+	}
 	this->m_state = COM_MB_ALLOCATED;
 	this->m_datatype = memoryProxy->getDataType();
+	ExecutionStats::buffer_allocated(getMemorySize());
 }
 
 MemoryBuffer::MemoryBuffer(MemoryProxy *memoryProxy, rcti *rect)
@@ -76,8 +91,10 @@ MemoryBuffer::MemoryBuffer(MemoryProxy *memoryProxy, rcti *rect)
 	this->m_chunkNumber = -1;
 	this->m_num_channels = determine_num_channels(memoryProxy->getDataType());
 	this->m_buffer = (float *)MEM_mallocN_aligned(sizeof(float) * determineBufferSize() * this->m_num_channels, 16, "COM_MemoryBuffer");
+	this->m_half_buffer = NULL;
 	this->m_state = COM_MB_TEMPORARILY;
 	this->m_datatype = memoryProxy->getDataType();
+	ExecutionStats::buffer_allocated(getMemorySize());
 }
 MemoryBuffer::MemoryBuffer(DataType dataType, rcti *rect)
 {
@@ -89,27 +106,53 @@ MemoryBuffer::MemoryBuffer(DataType dataType, rcti *rect)
 	this->m_chunkNumber = -1;
 	this->m_num_channels = determine_num_channels(dataType);
 	this->m_buffer = (float *)MEM_mallocN_aligned(sizeof(float) * determineBufferSize() * this->m_num_channels, 16, "COM_MemoryBuffer");
+	this->m_half_buffer = NULL;
 	this->m_state = COM_MB_TEMPORARILY;
 	this->m_datatype = dataType;
+	ExecutionStats::buffer_allocated(getMemorySize());
 }
 MemoryBuffer *MemoryBuffer::duplicate()
 {
 	MemoryBuffer *result = new MemoryBuffer(this->m_memoryProxy, &this->m_rect);
-	memcpy(result->m_buffer, this->m_buffer, this->determineBufferSize() * this->m_num_channels * sizeof(float));
+	if (this->m_half_buffer) {
+		half_to_float_vn(result->m_buffer, this->m_half_buffer, this->determineBufferSize() * this->m_num_channels);
+	}
+	else {
+		memcpy(result->m_buffer, this->m_buffer, this->determineBufferSize() * this->m_num_channels * sizeof(float));
+	}
 	return result;
 }
 void MemoryBuffer::clear()
 {
-	memset(this->m_buffer, 0, this->determineBufferSize() * this->m_num_channels * sizeof(float));
+	if (this->m_half_buffer) {
+		memset(this->m_half_buffer, 0, this->determineBufferSize() * this->m_num_channels * sizeof(unsigned short));
+	}
+	else {
+		memset(this->m_buffer, 0, this->determineBufferSize() * this->m_num_channels * sizeof(float));
+	}
 }
 
 
 float MemoryBuffer::getMaximumValue()
 {
-	float result = this->m_buffer[0];
 	const unsigned int size = this->determineBufferSize();
 	unsigned int i;
 
+	if (this->m_half_buffer) {
+		const unsigned short *hp_src = this->m_half_buffer;
+		float result = half_to_float(hp_src[0]);
+
+		for (i = 0; i < size; i++, hp_src += this->m_num_channels) {
+			float value = half_to_float(*hp_src);
+			if (value > result) {
+				result = value;
+			}
+		}
+
+		return result;
+	}
+
+	float result = this->m_buffer[0];
 	const float *fp_src = this->m_buffer;
 
 	for (i = 0; i < size; i++, fp_src += this->m_num_channels) {
@@ -144,10 +187,15 @@ float MemoryBuffer::getMaximumValue(rcti *rect)
 
 MemoryBuffer::~MemoryBuffer()
 {
+	ExecutionStats::buffer_freed(getMemorySize());
 	if (this->m_buffer) {
 		MEM_freeN(this->m_buffer);
 		this->m_buffer = NULL;
 	}
+	if (this->m_half_buffer) {
+		MEM_freeN(this->m_half_buffer);
+		this->m_half_buffer = NULL;
+	}
 }
 
 void MemoryBuffer::copyContentFrom(MemoryBuffer *otherBuffer)
@@ -168,7 +216,21 @@ void MemoryBuffer::copyContentFrom(MemoryBuffer *otherBuffer)
 	for (otherY = minY; otherY < maxY; otherY++) {
 		otherOffset = ((otherY - otherBuffer->m_rect.ymin) * otherBuffer->m_width + minX - otherBuffer->m_rect.xmin) * this->m_num_channels;
 		offset = ((otherY - this->m_rect.ymin) * this->m_width + minX - this->m_rect.xmin) * this->m_num_channels;
-		memcpy(&this->m_buffer[offset], &otherBuffer->m_buffer[otherOffset], (maxX - minX) * this->m_num_channels * sizeof(float));
+		const int size = (maxX - minX) * this->m_num_channels;
+		if (this->m_half_buffer) {
+			if (otherBuffer->m_half_buffer) {
+				memcpy(&this->m_half_buffer[offset], &otherBuffer->m_half_buffer[otherOffset], size * sizeof(unsigned short));
+			}
+			else {
+				float_to_half_vn(&this->m_half_buffer[offset], &otherBuffer->m_buffer[otherOffset], size);
+			}
+		}
+		else if (otherBuffer->m_half_buffer) {
+			half_to_float_vn(&this->m_buffer[offset], &otherBuffer->m_half_buffer[otherOffset], size);
+		}
+		else {
+			memcpy(&this->m_buffer[offset], &otherBuffer->m_buffer[otherOffset], size * sizeof(float));
+		}
 	}
 }
 
@@ -178,7 +240,14 @@ void MemoryBuffer::writePixel(int x, int y, const float color[4])
 	    y >= this->m_rect.ymin && y < this->m_rect.ymax)
 	{
 		const int offset = (this->m_width * (y - this->m_rect.ymin) + x - this->m_rect.xmin) * this->m_num_channels;
-		memcpy(&this->m_buffer[offset], color, sizeof(float) * this->m_num_channels);
+		if (this->m_half_buffer) {
+			for (unsigned int i = 0; i < this->m_num_channels; i++) {
+				this->m_half_buffer[offset + i] = float_to_half(color[i]);
+			}
+		}
+		else {
+			memcpy(&this->m_buffer[offset], color, sizeof(float) * this->m_num_channels);
+		}
 	}
 }
 
@@ -188,6 +257,13 @@ void MemoryBuffer::addPixel(int x, int y, const float color[4])
 	    y >= this->m_rect.ymin && y < this->m_rect.ymax)
 	{
 		const int offset = (this->m_width * (y - this->m_rect.ymin) + x - this->m_rect.xmin) * this->m_num_channels;
+		if (this->m_half_buffer) {
+			unsigned short *dst = &this->m_half_buffer[offset];
+			for (unsigned int i = 0; i < this->m_num_channels; i++) {
+				dst[i] = float_to_half(half_to_float(dst[i]) + color[i]);
+			}
+			return;
+		}
 		float *dst = &this->m_buffer[offset];
 		const float *src = color;
 		for (int i = 0; i < this->m_num_channels ; i++, dst++, src++) {
@@ -196,6 +272,51 @@ void MemoryBuffer::addPixel(int x, int y, const float color[4])
 	}
 }
 
+/* same as BLI_bilinear_interpolation_wrap_fl, reading half floats */
+void MemoryBuffer::readBilinearHalf(float *result, float u, float v, bool wrap_x, bool wrap_y)
+{
+	const int width = this->m_width;
+	const int height = this->m_height;
+	const int components = this->m_num_channels;
+	float row1[4], row2[4], row3[4], row4[4];
+	float a, b, a_b, ma_b, a_mb, ma_mb;
+	int x1, x2, y1, y2;
+
+	x1 = (int)floor(u);
+	x2 = (int)ceil(u);
+	y1 = (int)floor(v);
+	y2 = (int)ceil(v);
+
+	/* pixel value must be already wrapped, however values at boundaries may flip */
+	if (wrap_x) {
+		if (x1 < 0) x1 = width  - 1;
+		if (x2 >= width) x2 = 0;
+	}
+	if (wrap_y) {
+		if (y1 < 0) y1 = height - 1;
+		if (y2 >= height) y2 = 0;
+	}
+
+	CLAMP(x1, 0, width - 1);
+	CLAMP(x2, 0, width - 1);
+
+	CLAMP(y1, 0, height - 1);
+	CLAMP(y2, 0, height - 1);
+
+	this->readOffset(row1, (width * y1 + x1) * components);
+	this->readOffset(row2, (width * y2 + x1) * components);
+	this->readOffset(row3, (width * y1 + x2) * components);
+	this->readOffset(row4, (width * y2 + x2) * components);
+
+	a = u - floorf(u);
+	b = v - floorf(v);
+	a_b = a * b; ma_b = (1.0f - a) * b; a_mb = a * (1.0f - b); ma_mb = (1.0f - a) * (1.0f - b);
+
+	for (int i = 0; i < components; i++) {
+		result[i] = ma_mb * row1[i] + a_mb * row3[i] + ma_b * row2[i] + a_b * row4[i];
+	}
+}
+
 static void read_ewa_pixel_sampled(void *userdata, int x, int y, float result[4])
 {
 	MemoryBuffer *buffer = (MemoryBuffer *) userdata;
@@ -31,6 +31,7 @@ class MemoryBuffer;
 
 extern "C" {
 #  include "BLI_math.h"
+#  include "BLI_math_half.h"
 #  include "BLI_rect.h"
 }
 
@@ -92,6 +93,12 @@ private:
 	 */
 	float *m_buffer;
 
+	/**
+	 * @brief half float data, used instead of m_buffer for half float buffers
+	 * @see MemoryProxy.isHalfFloat
+	 */
+	unsigned short *m_half_buffer;
+
 	/**
 	 * @brief the number of channels of a single value in the buffer.
 	 * For value buffers this is 1, vector 3 and color 4
@@ -129,11 +136,28 @@ public:
 
 	unsigned int get_num_channels() { return this->m_num_channels; }
 
+	DataType getDataType() const { return this->m_datatype; }
+
 	/**
 	 * @brief get the data of this MemoryBuffer
 	 * @note buffer should already be available in memory
+	 * @note not available for half float buffers, use the read functions
+	 */
+	float *getBuffer()
+	{
+		BLI_assert(!this->isHalfFloat());
+		return this->m_buffer;
+	}
+
+	/**
+	 * @brief get the data of a half float MemoryBuffer
+	 */
+	unsigned short *getHalfBuffer() { return this->m_half_buffer; }
+
+	/**
+	 * @brief is the data stored as half floats
 	 */
-	float *getBuffer() { return this->m_buffer; }
+	bool isHalfFloat() const { return this->m_half_buffer != NULL; }
 	
 	/**
 	 * @brief after execution the state will be set to available by calling this method
@@ -222,8 +246,7 @@ public:
 			int v = y;
 			this->wrap_pixel(u, v, extend_x, extend_y);
 			const int offset = (this->m_width * y + x) * this->m_num_channels;
-			float *buffer = &this->m_buffer[offset];
-			memcpy(result, buffer, sizeof(float) * this->m_num_channels);
+			this->readOffset(result, offset);
 		}
 	}
 
@@ -246,8 +269,7 @@ public:
 		BLI_assert((int)(MEM_allocN_len(this->m_buffer) / sizeof(*this->m_buffer)) ==
 		           (int)(this->determineBufferSize() * COM_NUMBER_OF_CHANNELS));
 #endif
-		float *buffer = &this->m_buffer[offset];
-		memcpy(result, buffer, sizeof(float) * this->m_num_channels);
+		this->readOffset(result, offset);
 	}
 	
 	void writePixel(int x, int y, const float color[4]);
@@ -265,6 +287,10 @@ public:
 			copy_vn_fl(result, this->m_num_channels, 0.0f);
 			return;
 		}
+		if (this->m_half_buffer) {
+			this->readBilinearHalf(result, u, v, extend_x == COM_MB_REPEAT, extend_y == COM_MB_REPEAT);
+			return;
+		}
 		BLI_bilinear_interpolation_wrap_fl(
 		        this->m_buffer, result, this->m_width, this->m_height, this->m_num_channels, u, v,
 		        extend_x == COM_MB_REPEAT, extend_y == COM_MB_REPEAT);
@@ -313,6 +339,26 @@ public:
 private:
 	unsigned int determineBufferSize();
 
+	/**
+	 * @brief number of bytes allocated for the data
+	 */
+	size_t getMemorySize();
+
+	inline void readOffset(float *result, int offset)
+	{
+		if (this->m_half_buffer) {
+			const unsigned short *buffer = &this->m_half_buffer[offset];
+			for (unsigned int i = 0; i < this->m_num_channels; i++) {
+				result[i] = half_to_float(buffer[i]);
+			}
+		}
+		else {
+			memcpy(result, &this->m_buffer[offset], sizeof(float) * this->m_num_channels);
+		}
+	}
+
+	void readBilinearHalf(float *result, float u, float v, bool wrap_x, bool wrap_y);
+
 #ifdef WITH_CXX_GUARDEDALLOC
 	MEM_CXX_CLASS_ALLOC_FUNCS("COM:MemoryBuffer")
 #endif
@@ -68,6 +68,11 @@ private:
 	 */
 	DataType m_datatype;
 
+	/**
+	 * @brief store the buffer as half floats
+	 */
+	bool m_halfFloat;
+
 public:
 	MemoryProxy(DataType type);
 	
@@ -111,6 +116,14 @@ public:
 
 	inline DataType getDataType() { return this->m_datatype; }
 
+	/**
+	 * @brief store the buffer as half floats, halving its memory usage
+	 * Half float buffers can only be read through the MemoryBuffer read functions.
+	 * @see NodeOperationBuilder.determine_half_float_buffers
+	 */
+	void setHalfFloat(bool halfFloat) { this->m_halfFloat = halfFloat; }
+	bool isHalfFloat() const { return this->m_halfFloat; }
+
 #ifdef WITH_CXX_GUARDEDALLOC
 	MEM_CXX_CLASS_ALLOC_FUNCS("COM:MemoryProxy")
 #endif
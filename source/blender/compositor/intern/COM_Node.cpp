@@ -33,6 +33,7 @@ extern "C" {
 #include "COM_TranslateOperation.h"
 
 #include "COM_SocketProxyNode.h"
+#include "COM_ResultCache.h"
 
 #include "COM_defines.h"
 
@@ -104,6 +105,11 @@ void Node::addOutputSocket(DataType datatype, bNodeSocket *bSocket)
 	this->m_outputsockets.push_back(socket);
 }
 
+bool Node::hashSettings(ResultHash &hash, const CompositorContext &/*context*/) const
+{
+	return ResultCache::hashNodeSettings(hash, this->getbNodeTree(), this->getbNode());
+}
+
 NodeOutput *Node::getOutputSocket(unsigned int index) const
 {
 	BLI_assert(index < this->m_outputsockets.size());
@@ -37,6 +37,7 @@
 class Node;
 class NodeOperation;
 class NodeConverter;
+class ResultHash;
 
 /**
  * My node documentation.
@@ -174,6 +175,14 @@ public:
 	 * @param context reference to the CompositorContext
 	 */
 	virtual void convertToOperations(NodeConverter &converter, const CompositorContext &context) const = 0;
+
+	/**
+	 * @brief add the settings of this node to the hash identifying the results of its operations
+	 * By default the settings of the bNode are hashed, nodes that use other data need to add it as well.
+	 * @see ResultCache
+	 * @return false when the results of the operations of this node can't be cached
+	 */
+	virtual bool hashSettings(ResultHash &hash, const CompositorContext &context) const;
 	
 	/**
 	 * Create dummy warning operation, use when we can't get the source data.
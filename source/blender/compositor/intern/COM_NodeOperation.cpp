@@ -40,6 +40,8 @@ NodeOperation::NodeOperation()
 	this->m_height = 0;
 	this->m_isResolutionSet = false;
 	this->m_openCL = false;
+	this->m_spanSupport = false;
+	this->m_useSpanExecution = false;
 	this->m_btree = NULL;
 }
 
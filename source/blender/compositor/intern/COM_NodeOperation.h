@@ -105,6 +105,18 @@ private:
 	 */
 	bool m_openCL;
 
+	/**
+	 * @brief does this operation implement SocketReader.executeSpan
+	 * @note Only applicable if complex is False
+	 */
+	bool m_spanSupport;
+
+	/**
+	 * @brief should this output operation read its input by spans of pixels
+	 * @see ExecutionGroup.initExecution
+	 */
+	bool m_useSpanExecution;
+
 	/**
 	 * @brief mutex reference for very special node initializations
 	 * @note only use when you really know what you are doing.
@@ -245,6 +257,19 @@ public:
 
 	virtual bool isSetOperation() const { return false; }
 
+	/**
+	 * @brief can this operation calculate a span of pixels at once
+	 * @see SocketReader.executeSpan
+	 */
+	bool isSpanSupported() const { return this->m_spanSupport; }
+
+	/**
+	 * @brief let an output operation drive its input by spans instead of pixel by pixel
+	 * @note only set when all operations of the ExecutionGroup support spans
+	 */
+	void setUseSpanExecution(bool useSpanExecution) { this->m_useSpanExecution = useSpanExecution; }
+	bool useSpanExecution() const { return this->m_useSpanExecution; }
+
 	/**
 	 * @brief is this operation of type ReadBufferOperation
 	 * @return [true:false]
@@ -333,6 +358,12 @@ protected:
 	 */
 	void setOpenCL(bool openCL) { this->m_openCL = openCL; }
 
+	/**
+	 * @brief set if this NodeOperation overrides SocketReader.executeSpan
+	 * @note subclasses inheriting from an operation with span support must override executeSpan too
+	 */
+	void setSpanSupport(bool spanSupport) { this->m_spanSupport = spanSupport; }
+
 	/* allow the DebugInfo class to look at internals */
 	friend class DebugInfo;
 
@@ -19,6 +19,8 @@
  *		Lukas Toenne
  */
 
+#include <typeinfo>
+
 extern "C" {
 #include "BLI_utildefines.h"
 }
@@ -28,6 +30,7 @@ extern "C" {
 #include "COM_Debug.h"
 #include "COM_ExecutionSystem.h"
 #include "COM_Node.h"
+#include "COM_ResultCache.h"
 #include "COM_SocketProxyNode.h"
 
 #include "COM_NodeOperation.h"
@@ -45,6 +48,8 @@ extern "C" {
 NodeOperationBuilder::NodeOperationBuilder(const CompositorContext *context, bNodeTree *b_nodetree) :
     m_context(context),
     m_current_node(NULL),
+    m_current_node_hash(0),
+    m_current_node_operations(0),
     m_active_viewer(NULL)
 {
 	m_graph.from_bNodeTree(*context, b_nodetree);
@@ -64,6 +69,10 @@ void NodeOperationBuilder::convertToOperations(ExecutionSystem *system)
 		
 		m_current_node = node;
 		
+		ResultHash hash;
+		m_current_node_hash = node->hashSettings(hash, *m_context) ? hash.get() : 0;
+		m_current_node_operations = 0;
+		
 		DebugInfo::node_to_operations(node);
 		node->convertToOperations(converter, *m_context);
 	}
@@ -118,6 +127,10 @@ void NodeOperationBuilder::convertToOperations(ExecutionSystem *system)
 	
 	prune_operations();
 	
+	determine_half_float_buffers();
+	
+	determine_cache_keys();
+	
 	/* ensure topological (link-based) order of nodes */
 	/*sort_operations();*/ /* not needed yet */
 	
@@ -131,6 +144,14 @@ void NodeOperationBuilder::convertToOperations(ExecutionSystem *system)
 void NodeOperationBuilder::addOperation(NodeOperation *operation)
 {
 	m_operations.push_back(operation);
+	
+	if (m_current_node) {
+		/* operations of a node differ by the order they are added in */
+		ResultHash hash;
+		hash.add(m_current_node_hash);
+		hash.add(m_current_node_operations++);
+		m_operation_hashes[operation] = m_current_node_hash ? hash.get() : 0;
+	}
 }
 
 void NodeOperationBuilder::mapInputSocket(NodeInput *node_socket, NodeOperationInput *operation_socket)
@@ -671,6 +692,132 @@ ExecutionGroup *NodeOperationBuilder::make_group(NodeOperation *op)
 	return group;
 }
 
+void NodeOperationBuilder::determine_half_float_buffers()
+{
+	if (!m_context->isHalfFloatBuffersEnabled())
+		return;
+	
+	/* complex operations access the buffers of their inputs directly, these stay float.
+	 * so do the buffers of OpenCL operations, which are used as host memory of OpenCL images */
+	const bool use_opencl = m_context->getHasActiveOpenCLDevices();
+	std::set<MemoryProxy *> float_proxies;
+	for (Operations::const_iterator it = m_operations.begin(); it != m_operations.end(); ++it) {
+		NodeOperation *op = *it;
+		if (!op->isComplex() && !(use_opencl && op->isOpenCL()))
+			continue;
+		
+		for (int k = 0; k < op->getNumberOfInputSockets(); ++k) {
+			NodeOperationOutput *from = op->getInputSocket(k)->getLink();
+			if (from && from->getOperation().isReadBufferOperation()) {
+				ReadBufferOperation *read_op = (ReadBufferOperation *)(&from->getOperation());
+				float_proxies.insert(read_op->getMemoryProxy());
+			}
+		}
+	}
+	
+	/* values (depth, masks) and vectors keep full precision */
+	for (Operations::const_iterator it = m_operations.begin(); it != m_operations.end(); ++it) {
+		NodeOperation *op = *it;
+		if (!op->isWriteBufferOperation())
+			continue;
+		
+		/* the output of an OpenCL group is read back into the float buffer of its proxy */
+		NodeOperationOutput *from = op->getInputSocket(0)->getLink();
+		if (use_opencl && from && from->getOperation().isOpenCL())
+			continue;
+		
+		MemoryProxy *memproxy = ((WriteBufferOperation *)op)->getMemoryProxy();
+		if (memproxy->getDataType() == COM_DT_COLOR && float_proxies.find(memproxy) == float_proxies.end())
+			memproxy->setHalfFloat(true);
+	}
+}
+
+void NodeOperationBuilder::determine_cache_keys()
+{
+	/* settings of the execution the operations depend on */
+	ResultHash seed;
+	seed.add(m_context->getFramenumber());
+	seed.add((int)m_context->getQuality());
+	seed.add((int)m_context->isRendering());
+	seed.addString(m_context->getViewName());
+	seed.add((int)m_context->isHalfFloatBuffersEnabled());
+	
+	OperationHashMap keys;
+	for (Operations::const_iterator it = m_operations.begin(); it != m_operations.end(); ++it) {
+		NodeOperation *op = *it;
+		if (op->isWriteBufferOperation()) {
+			WriteBufferOperation *write_op = (WriteBufferOperation *)op;
+			write_op->setCacheKey(determine_cache_key(write_op, seed.get(), keys));
+		}
+	}
+}
+
+uint64_t NodeOperationBuilder::determine_cache_key(NodeOperation *operation, uint64_t seed, OperationHashMap &keys) const
+{
+	OperationHashMap::const_iterator it = keys.find(operation);
+	if (it != keys.end())
+		return it->second;
+	
+	uint64_t key = 0;
+	if (operation->isReadBufferOperation()) {
+		/* the result of a read buffer is the result of the write buffer it reads from */
+		ReadBufferOperation *read_op = (ReadBufferOperation *)operation;
+		key = determine_cache_key(read_op->getMemoryProxy()->getWriteBufferOperation(), seed, keys);
+	}
+	else {
+		ResultHash hash;
+		bool cacheable = true;
+		
+		hash.add(seed);
+		hash.addString(typeid(*operation).name());
+		hash.add(operation->getWidth());
+		hash.add(operation->getHeight());
+		for (unsigned int k = 0; k < operation->getNumberOfOutputSockets(); ++k)
+			hash.add((int)operation->getOutputSocket(k)->getDataType());
+		
+		OperationHashMap::const_iterator node_it = m_operation_hashes.find(operation);
+		if (node_it != m_operation_hashes.end()) {
+			cacheable = (node_it->second != 0);
+			hash.add(node_it->second);
+		}
+		else if (operation->isSetOperation()) {
+			/* constants added by the builder itself */
+			float value[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+			operation->readSampled(value, 0.0f, 0.0f, COM_PS_NEAREST);
+			hash.add(value, sizeof(value));
+		}
+		else if (operation->getNumberOfInputSockets() == 0) {
+			/* unknown source of data */
+			cacheable = false;
+		}
+		
+		for (unsigned int k = 0; cacheable && k < operation->getNumberOfInputSockets(); ++k) {
+			NodeOperationOutput *from = operation->getInputSocket(k)->getLink();
+			if (!from) {
+				hash.add(0);
+				continue;
+			}
+			NodeOperation &from_op = from->getOperation();
+			uint64_t input_key = determine_cache_key(&from_op, seed, keys);
+			if (input_key == 0) {
+				cacheable = false;
+				break;
+			}
+			hash.add(input_key);
+			for (unsigned int l = 0; l < from_op.getNumberOfOutputSockets(); ++l) {
+				if (from_op.getOutputSocket(l) == from)
+					hash.add(l);
+			}
+		}
+		
+		if (cacheable)
+			key = hash.get();
+	}
+	
+	keys[operation] = key;
+	return key;
+}
+
 void NodeOperationBuilder::group_operations()
 {
 	for (Operations::const_iterator it = m_operations.begin(); it != m_operations.end(); ++it) {
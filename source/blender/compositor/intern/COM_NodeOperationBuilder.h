@@ -25,6 +25,7 @@
 #include <map>
 #include <set>
 #include <vector>
+#include <stdint.h>
 
 #include "COM_NodeGraph.h"
 
@@ -73,6 +74,8 @@ public:
 	typedef std::vector<NodeOperationInput *> OpInputs;
 	typedef std::map<NodeInput *, OpInputs> OpInputInverseMap;
 	
+	typedef std::map<NodeOperation *, uint64_t> OperationHashMap;
+	
 private:
 	const CompositorContext *m_context;
 	NodeGraph m_graph;
@@ -87,6 +90,12 @@ private:
 	OutputSocketMap m_output_map;
 	
 	Node *m_current_node;
+	/** Hash of the settings of the current node, 0 when its results can't be cached */
+	uint64_t m_current_node_hash;
+	/** Number of operations added for the current node so far */
+	int m_current_node_operations;
+	/** Maps operations to the settings hash of the node they were added for */
+	OperationHashMap m_operation_hashes;
 	
 	/** Operation that will be writing to the viewer image
 	 *  Only one operation can occupy this place at a time,
@@ -155,6 +164,13 @@ protected:
 	/** Sort operations by link dependencies */
 	void sort_operations();
 	
+	/** Store color buffers that are only read per pixel as half floats */
+	void determine_half_float_buffers();
+	
+	/** Determine the keys of write buffer results in the ResultCache */
+	void determine_cache_keys();
+	uint64_t determine_cache_key(NodeOperation *operation, uint64_t seed, OperationHashMap &keys) const;
+	
 	/** Create execution groups */
 	void group_operations();
 	ExecutionGroup *make_group(NodeOperation *op);
@@ -0,0 +1,339 @@
+/*
+ * Copyright 2016, Blender Foundation.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <map>
+#include <vector>
+
+extern "C" {
+#include "BLI_threads.h"
+
+#include "DNA_ID.h"
+
+#include "RNA_access.h"
+}
+
+#include "MEM_guardedalloc.h"
+#include "MEM_CacheLimiterC-Api.h"
+
+#include "COM_MemoryBuffer.h"
+
+#include "COM_ResultCache.h" /* own include */
+
+/* nested structs (curve mappings, color ramps) are hashed up to this depth */
+#define COM_RESULT_HASH_MAX_DEPTH 4
+
+typedef struct ResultCacheEntry {
+	uint64_t key;
+	MemoryBuffer *buffer;
+	MEM_CacheLimiterHandleC *handle;
+} ResultCacheEntry;
+
+typedef std::map<uint64_t, ResultCacheEntry *> ResultCacheMap;
+
+static ThreadMutex s_cacheMutex = BLI_MUTEX_INITIALIZER;
+static ResultCacheMap s_entries;
+static MEM_CacheLimiterC *s_limiter = NULL;
+static unsigned int s_generation = 0;
+
+static size_t result_cache_entry_size(void *data)
+{
+	ResultCacheEntry *entry = (ResultCacheEntry *)data;
+	MemoryBuffer *buffer = entry->buffer;
+	return sizeof(float) * buffer->getWidth() * buffer->getHeight() * buffer->get_num_channels();
+}
+
+/* called by the limiter when the entry is freed to stay within the memory cache limit */
+static void result_cache_entry_destruct(void *data)
+{
+	ResultCacheEntry *entry = (ResultCacheEntry *)data;
+	s_entries.erase(entry->key);
+	delete entry->buffer;
+	delete entry;
+}
+
+bool ResultCache::contains(uint64_t key)
+{
+	BLI_mutex_lock(&s_cacheMutex);
+	bool found = s_entries.find(key) != s_entries.end();
+	BLI_mutex_unlock(&s_cacheMutex);
+	return found;
+}
+
+bool ResultCache::restore(uint64_t key, MemoryBuffer *buffer)
+{
+	bool restored = false;
+
+	BLI_mutex_lock(&s_cacheMutex);
+	ResultCacheMap::iterator it = s_entries.find(key);
+	if (it != s_entries.end()) {
+		ResultCacheEntry *entry = it->second;
+		if (entry->buffer->getWidth() == buffer->getWidth() &&
+		    entry->buffer->getHeight() == buffer->getHeight() &&
+		    entry->buffer->get_num_channels() == buffer->get_num_channels())
+		{
+			buffer->copyContentFrom(entry->buffer);
+			MEM_CacheLimiter_touch(entry->handle);
+			restored = true;
+		}
+	}
+	BLI_mutex_unlock(&s_cacheMutex);
+
+	return restored;
+}
+
+void ResultCache::store(uint64_t key, MemoryBuffer *buffer, unsigned int generation)
+{
+	BLI_mutex_lock(&s_cacheMutex);
+
+	if (generation == s_generation && s_entries.find(key) == s_entries.end()) {
+		if (s_limiter == NULL) {
+			s_limiter = new_MEM_CacheLimiter(result_cache_entry_destruct, result_cache_entry_size);
+		}
+
+		ResultCacheEntry *entry = new ResultCacheEntry;
+		entry->key = key;
+		entry->buffer = new MemoryBuffer(buffer->getDataType(), buffer->getRect());
+		entry->buffer->copyContentFrom(buffer);
+		s_entries[key] = entry;
+
+		entry->handle = MEM_CacheLimiter_insert(s_limiter, entry);
+		MEM_CacheLimiter_ref(entry->handle);
+		MEM_CacheLimiter_enforce_limits(s_limiter);
+		MEM_CacheLimiter_unref(entry->handle);
+	}
+
+	BLI_mutex_unlock(&s_cacheMutex);
+}
+
+unsigned int ResultCache::getGeneration()
+{
+	BLI_mutex_lock(&s_cacheMutex);
+	unsigned int generation = s_generation;
+	BLI_mutex_unlock(&s_cacheMutex);
+	return generation;
+}
+
+void ResultCache::clear()
+{
+	BLI_mutex_lock(&s_cacheMutex);
+
+	/* deleting the limiter doesn't call the destructor of the entries */
+	if (s_limiter) {
+		delete_MEM_CacheLimiter(s_limiter);
+		s_limiter = NULL;
+	}
+	for (ResultCacheMap::iterator it = s_entries.begin(); it != s_entries.end(); ++it) {
+		delete it->second->buffer;
+		delete it->second;
+	}
+	s_entries.clear();
+	s_generation++;
+
+	BLI_mutex_unlock(&s_cacheMutex);
+}
+
+/* ******** Node settings ******** */
+
+static bool hash_rna_struct(ResultHash &hash, PointerRNA *ptr, int depth);
+
+static bool hash_rna_id(ResultHash &hash, ID *id)
+{
+	if (id == NULL) {
+		hash.add((const void *)NULL);
+		return true;
+	}
+
+	/* Render results and images are hashed by pointer only,
+	 * changes to their data clear the whole cache instead.
+	 * Node groups are hashed by the nodes inside of them.
+	 * Other datablocks (textures, masks, movie clips) can change without the compositor knowing. */
+	switch (GS(id->name)) {
+		case ID_SCE:
+		case ID_IM:
+		case ID_NT:
+			hash.add((const void *)id);
+			return true;
+		default:
+			return false;
+	}
+}
+
+static bool hash_rna_property(ResultHash &hash, PointerRNA *ptr, PropertyRNA *prop, int depth)
+{
+	const int length = RNA_property_array_length(ptr, prop);
+
+	hash.addString(RNA_property_identifier(prop));
+
+	switch (RNA_property_type(prop)) {
+		case PROP_BOOLEAN:
+			if (length) {
+				std::vector<int> values(length);
+				RNA_property_boolean_get_array(ptr, prop, &values[0]);
+				hash.add(&values[0], sizeof(int) * length);
+			}
+			else {
+				hash.add(RNA_property_boolean_get(ptr, prop));
+			}
+			break;
+		case PROP_INT:
+			if (length) {
+				std::vector<int> values(length);
+				RNA_property_int_get_array(ptr, prop, &values[0]);
+				hash.add(&values[0], sizeof(int) * length);
+			}
+			else {
+				hash.add(RNA_property_int_get(ptr, prop));
+			}
+			break;
+		case PROP_FLOAT:
+			if (length) {
+				std::vector<float> values(length);
+				RNA_property_float_get_array(ptr, prop, &values[0]);
+				hash.add(&values[0], sizeof(float) * length);
+			}
+			else {
+				hash.add(RNA_property_float_get(ptr, prop));
+			}
+			break;
+		case PROP_ENUM:
+			hash.add(RNA_property_enum_get(ptr, prop));
+			break;
+		case PROP_STRING:
+		{
+			char fixedbuf[256];
+			char *str = RNA_property_string_get_alloc(ptr, prop, fixedbuf, sizeof(fixedbuf), NULL);
+			hash.addString(str);
+			if (str != fixedbuf) {
+				MEM_freeN(str);
+			}
+			break;
+		}
+		case PROP_POINTER:
+		{
+			PointerRNA pointer = RNA_property_pointer_get(ptr, prop);
+			if (pointer.data == NULL) {
+				hash.add((const void *)NULL);
+			}
+			else if (RNA_struct_is_ID(pointer.type)) {
+				return hash_rna_id(hash, (ID *)pointer.data);
+			}
+			else {
+				return hash_rna_struct(hash, &pointer, depth + 1);
+			}
+			break;
+		}
+		case PROP_COLLECTION:
+		{
+			bool hashed = true;
+			RNA_PROP_BEGIN (ptr, itemptr, prop)
+			{
+				if (RNA_struct_is_ID(itemptr.type)) {
+					hashed = hash_rna_id(hash, (ID *)itemptr.data);
+				}
+				else {
+					hashed = hash_rna_struct(hash, &itemptr, depth + 1);
+				}
+				if (!hashed) {
+					break;
+				}
+			}
+			RNA_PROP_END;
+			return hashed;
+		}
+	}
+
+	return true;
+}
+
+static bool hash_rna_struct(ResultHash &hash, PointerRNA *ptr, int depth)
+{
+	if (depth > COM_RESULT_HASH_MAX_DEPTH) {
+		/* deeper nesting isn't expected in node settings, be safe */
+		return false;
+	}
+
+	bool hashed = true;
+	RNA_STRUCT_BEGIN (ptr, prop)
+	{
+		const char *identifier = RNA_property_identifier(prop);
+
+		if (STREQ(identifier, "rna_type")) {
+			continue;
+		}
+		/* generic node properties (location, selection, sockets...) don't change the result */
+		if (depth == 0 && RNA_struct_type_find_property(&RNA_Node, identifier)) {
+			continue;
+		}
+		if (!hash_rna_property(hash, ptr, prop, depth)) {
+			hashed = false;
+			break;
+		}
+	}
+	RNA_STRUCT_END;
+
+	return hashed;
+}
+
+static void hash_node_sockets(ResultHash &hash, ListBase *sockets)
+{
+	for (bNodeSocket *sock = (bNodeSocket *)sockets->first; sock; sock = sock->next) {
+		hash.add((int)sock->type);
+		if (sock->default_value == NULL) {
+			continue;
+		}
+		switch (sock->type) {
+			case SOCK_FLOAT:
+				hash.add(((bNodeSocketValueFloat *)sock->default_value)->value);
+				break;
+			case SOCK_INT:
+				hash.add(((bNodeSocketValueInt *)sock->default_value)->value);
+				break;
+			case SOCK_BOOLEAN:
+				hash.add(((bNodeSocketValueBoolean *)sock->default_value)->value);
+				break;
+			case SOCK_VECTOR:
+				hash.add(((bNodeSocketValueVector *)sock->default_value)->value, sizeof(float) * 3);
+				break;
+			case SOCK_RGBA:
+				hash.add(((bNodeSocketValueRGBA *)sock->default_value)->value, sizeof(float) * 4);
+				break;
+		}
+	}
+}
+
+bool ResultCache::hashNodeSettings(ResultHash &hash, bNodeTree *ntree, bNode *node)
+{
+	PointerRNA ptr;
+
+	hash.addString(node->idname);
+	hash.add((int)node->custom1);
+	hash.add((int)node->custom2);
+	hash.add(node->custom3);
+	hash.add(node->custom4);
+
+	/* unconnected inputs, and outputs for value and color input nodes */
+	hash_node_sockets(hash, &node->inputs);
+	hash_node_sockets(hash, &node->outputs);
+
+	if (node->id && !hash_rna_id(hash, node->id)) {
+		return false;
+	}
+
+	RNA_pointer_create((ID *)ntree, &RNA_Node, node, &ptr);
+	return hash_rna_struct(hash, &ptr, 0);
+}
@@ -0,0 +1,113 @@
+/*
+ * Copyright 2016, Blender Foundation.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef _COM_ResultCache_h_
+#define _COM_ResultCache_h_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "DNA_node_types.h"
+
+class MemoryBuffer;
+
+/**
+ * @brief incremental 64 bit hash identifying the result of an operation
+ * The hash of a result combines the settings of the operation with the hashes of all its inputs.
+ * @see NodeOperationBuilder.determine_cache_keys
+ * @ingroup Memory
+ */
+class ResultHash {
+private:
+	uint64_t m_hash;
+
+public:
+	ResultHash() : m_hash(14695981039346656037ULL) {}
+
+	/**
+	 * @brief add raw data to the hash (FNV-1a)
+	 */
+	void add(const void *data, size_t size)
+	{
+		const unsigned char *bytes = (const unsigned char *)data;
+		for (size_t index = 0; index < size; index++) {
+			m_hash = (m_hash ^ bytes[index]) * 1099511628211ULL;
+		}
+	}
+
+	void add(int value) { add(&value, sizeof(value)); }
+	void add(unsigned int value) { add(&value, sizeof(value)); }
+	void add(float value) { add(&value, sizeof(value)); }
+	void add(uint64_t value) { add(&value, sizeof(value)); }
+	void add(const void *pointer) { add(&pointer, sizeof(pointer)); }
+	void addString(const char *str) { add(str, str ? strlen(str) : 0); add(0); }
+
+	uint64_t get() const { return m_hash; }
+};
+
+/**
+ * @brief results of operations that are kept between executions of the compositor
+ *
+ * Buffers of WriteBufferOperation's are stored by the hash of the operations that calculated them,
+ * so the next execution can restore them instead of calculating the whole upstream part of the tree.
+ * Memory usage is bounded by the MEM_CacheLimiter (memory cache limit in the user preferences).
+ *
+ * Results that depend on data outside of the node tree (render results, images) can't be detected
+ * by the hash alone; the cache is cleared when that data changes, see COM_clearCaches.
+ * @ingroup Memory
+ */
+class ResultCache {
+public:
+	/**
+	 * @brief is there a result stored for the given key
+	 */
+	static bool contains(uint64_t key);
+
+	/**
+	 * @brief copy the stored result for the given key into the buffer
+	 * @return false when no result was found (it might have been freed since calling contains)
+	 */
+	static bool restore(uint64_t key, MemoryBuffer *buffer);
+
+	/**
+	 * @brief store a copy of the buffer as result for the given key
+	 * @param generation: generation of the cache at the time the inputs of the result were read,
+	 * nothing is stored when the cache has been cleared since.
+	 */
+	static void store(uint64_t key, MemoryBuffer *buffer, unsigned int generation);
+
+	/**
+	 * @brief current generation of the cache, increased every time the cache is cleared
+	 */
+	static unsigned int getGeneration();
+
+	/**
+	 * @brief free all stored results
+	 */
+	static void clear();
+
+	/**
+	 * @brief add the settings of a node to the hash
+	 * Settings are read through RNA, so nested data (curves, color ramps) is included as well.
+	 * @return false when the node uses data that can't be hashed and the results depending on it can't be cached
+	 */
+	static bool hashNodeSettings(ResultHash &hash, bNodeTree *ntree, bNode *node);
+};
+
+#endif
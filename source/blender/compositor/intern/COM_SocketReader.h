@@ -81,6 +81,22 @@ protected:
 		executePixelSampled(output, x, y, COM_PS_NEAREST);
 	}
 
+	/**
+	 * @brief calculate a horizontal span of pixels
+	 * @note this method is called for non-complex operations, the default implementation
+	 * calculates the span pixel by pixel. Pointwise operations override it to avoid a virtual
+	 * call per pixel for every input, see NodeOperation.setSpanSupport.
+	 * @param output is a float[4 * length] array to store the result, 4 floats per pixel regardless of the datatype
+	 * @param x the x-coordinate of the first pixel to calculate in image space
+	 * @param y the y-coordinate of the pixels to calculate in image space
+	 * @param length the number of pixels to calculate, at most COM_SPAN_MAX_LENGTH
+	 */
+	virtual void executeSpan(float *output, int x, int y, int length) {
+		for (int i = 0; i < length; i++) {
+			executePixelSampled(&output[i * 4], x + i, y, COM_PS_NEAREST);
+		}
+	}
+
 	/**
 	 * @brief calculate a single pixel using an EWA filter
 	 * @note this method is called for complex
@@ -102,6 +118,9 @@ public:
 	inline void read(float result[4], int x, int y, void *chunkData) {
 		executePixel(result, x, y, chunkData);
 	}
+	inline void readSpan(float *result, int x, int y, int length) {
+		executeSpan(result, x, y, length);
+	}
 	inline void readFiltered(float result[4], float x, float y, float dx[2], float dy[2]) {
 		executePixelFiltered(result, x, y, dx, dy);
 	}
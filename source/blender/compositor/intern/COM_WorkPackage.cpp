@@ -21,9 +21,13 @@
  */
 
 #include "COM_WorkPackage.h"
+#include "COM_ExecutionStats.h"
+
+#include "PIL_time.h"
 
 WorkPackage::WorkPackage(ExecutionGroup *group, unsigned int chunkNumber)
 {
 	this->m_executionGroup = group;
 	this->m_chunkNumber = chunkNumber;
+	this->m_scheduledTime = ExecutionStats::is_enabled() ? PIL_check_seconds_timer() : 0.0;
 }
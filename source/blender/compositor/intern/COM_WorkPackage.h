@@ -42,6 +42,11 @@ private:
 	 * @brief number of the chunk to be executed
 	 */
 	unsigned int m_chunkNumber;
+
+	/**
+	 * @brief time the package was scheduled, for ExecutionStats
+	 */
+	double m_scheduledTime;
 public:
 	/**
 	 * constructor
@@ -60,6 +65,11 @@ public:
 	 */
 	unsigned int getChunkNumber() const { return this->m_chunkNumber; }
 
+	/**
+	 * @brief get the time the package was scheduled
+	 */
+	double getScheduledTime() const { return this->m_scheduledTime; }
+
 #ifdef WITH_CXX_GUARDEDALLOC
 	MEM_CXX_CLASS_ALLOC_FUNCS("COM:WorkPackage")
 #endif
@@ -20,6 +20,7 @@
  *		Monique Dewanchand
  */
 
+#include <deque>
 #include <list>
 #include <stdio.h>
 
@@ -30,6 +31,7 @@
 #include "COM_OpenCLKernels.cl.h"
 #include "clew.h"
 #include "COM_WriteBufferOperation.h"
+#include "COM_ExecutionStats.h"
 
 #include "MEM_guardedalloc.h"
 
@@ -38,6 +40,8 @@
 
 #include "BKE_global.h"
 
+#include "atomic_ops.h"
+
 #if COM_CURRENT_THREADING_MODEL == COM_TM_NOTHREAD
 #  ifndef DEBUG  /* test this so we dont get warnings in debug builds */
 #    warning COM_CURRENT_THREADING_MODEL COM_TM_NOTHREAD is activated. Use only for debugging.
@@ -54,12 +58,34 @@ static vector<CPUDevice*> g_cpudevices;
 static ThreadLocal(CPUDevice *) g_thread_device;
 
 #if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+/**
+ * @brief work scheduled for a single CPUDevice
+ *
+ * Chunks close to each other are scheduled in the same queue, so a thread keeps working on
+ * the same part of the image. A thread without work left takes it from the back of the other
+ * queues, the chunks farthest from the ones their own thread is working on.
+ */
+typedef struct CPUWorkQueue {
+	SpinLock lock;
+	std::deque<WorkPackage *> packages;
+} CPUWorkQueue;
+
 /// @brief list of all thread for every CPUDevice in cpudevices a thread exists
 static ListBase g_cputhreads;
 static bool g_cpuInitialized = false;
-/// @brief all scheduled work for the cpu
-static ThreadQueue *g_cpuqueue;
+/// @brief all scheduled work for the cpu, a queue for every CPUDevice
+static vector<CPUWorkQueue *> g_cpuqueues;
+/// @brief number of work packages in the cpu queues and number of threads waiting for work
+static unsigned int g_cpuQueued;
+static unsigned int g_cpuIdle;
+static bool g_cpuStopping;
+static ThreadCondition g_cpuWorkCondition;
 static ThreadQueue *g_gpuqueue;
+/// @brief number of scheduled work packages not finished yet, and number of finished packages
+static unsigned int g_workPending;
+static unsigned int g_workFinished;
+static ThreadMutex g_workMutex = BLI_MUTEX_INITIALIZER;
+static ThreadCondition g_workFinishedCondition;
 #ifdef COM_OPENCL_ENABLED
 static cl_context g_context;
 static cl_program g_program;
@@ -151,16 +177,104 @@ int COM_isHighlightedbNode(bNode *bnode)
 }
 } // end extern "C"
 
+static void execute_work_package(Device *device, WorkPackage *work)
+{
+	const double startTime = ExecutionStats::is_enabled() ? PIL_check_seconds_timer() : 0.0;
+	device->execute(work);
+	ExecutionStats::work_package_executed(work, startTime);
+}
+
 #if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+static void cpu_queue_push(WorkPackage *work)
+{
+	const unsigned int index = work->getExecutionGroup()->determineChunkThread(work->getChunkNumber(), g_cpuqueues.size());
+	CPUWorkQueue *queue = g_cpuqueues[index];
+
+	BLI_spin_lock(&queue->lock);
+	queue->packages.push_back(work);
+	BLI_spin_unlock(&queue->lock);
+	atomic_add_u(&g_cpuQueued, 1);
+
+	/* threads only wait after checking the queued count, so either they see the new work or they are woken up */
+	if (atomic_add_u(&g_cpuIdle, 0) != 0) {
+		BLI_mutex_lock(&g_workMutex);
+		BLI_condition_notify_one(&g_cpuWorkCondition);
+		BLI_mutex_unlock(&g_workMutex);
+	}
+}
+
+static WorkPackage *cpu_queue_pop(unsigned int index)
+{
+	const unsigned int numberOfQueues = g_cpuqueues.size();
+
+	if (atomic_add_u(&g_cpuQueued, 0) == 0) {
+		return NULL;
+	}
+
+	for (unsigned int offset = 0; offset < numberOfQueues; offset++) {
+		CPUWorkQueue *queue = g_cpuqueues[(index + offset) % numberOfQueues];
+		WorkPackage *work = NULL;
+
+		BLI_spin_lock(&queue->lock);
+		if (!queue->packages.empty()) {
+			/* own work in scheduled order, stolen work from the back */
+			if (offset == 0) {
+				work = queue->packages.front();
+				queue->packages.pop_front();
+			}
+			else {
+				work = queue->packages.back();
+				queue->packages.pop_back();
+			}
+		}
+		BLI_spin_unlock(&queue->lock);
+
+		if (work) {
+			atomic_sub_u(&g_cpuQueued, 1);
+			return work;
+		}
+	}
+	return NULL;
+}
+
+static void work_package_finished()
+{
+	atomic_sub_u(&g_workPending, 1);
+
+	BLI_mutex_lock(&g_workMutex);
+	g_workFinished++;
+	BLI_condition_notify_all(&g_workFinishedCondition);
+	BLI_mutex_unlock(&g_workMutex);
+}
+
 void *WorkScheduler::thread_execute_cpu(void *data)
 {
 	CPUDevice *device = (CPUDevice *)data;
+	const unsigned int index = device->thread_id();
 	WorkPackage *work;
 	BLI_thread_local_set(g_thread_device, device);
-	while ((work = (WorkPackage *)BLI_thread_queue_pop(g_cpuqueue))) {
-		HIGHLIGHT(work);
-		device->execute(work);
-		delete work;
+
+	while (true) {
+		if ((work = cpu_queue_pop(index))) {
+			HIGHLIGHT(work);
+			execute_work_package(device, work);
+			delete work;
+			work_package_finished();
+			continue;
+		}
+
+		BLI_mutex_lock(&g_workMutex);
+		atomic_add_u(&g_cpuIdle, 1);
+		while (!g_cpuStopping && atomic_add_u(&g_cpuQueued, 0) == 0) {
+			BLI_condition_wait(&g_cpuWorkCondition, &g_workMutex);
+		}
+		atomic_sub_u(&g_cpuIdle, 1);
+		const bool stop = g_cpuStopping;
+		BLI_mutex_unlock(&g_workMutex);
+
+		if (stop) {
+			break;
+		}
 	}
 	
 	return NULL;
@@ -173,8 +287,9 @@ void *WorkScheduler::thread_execute_gpu(void *data)
 	
 	while ((work = (WorkPackage *)BLI_thread_queue_pop(g_gpuqueue))) {
 		HIGHLIGHT(work);
-		device->execute(work);
+		execute_work_package(device, work);
 		delete work;
+		work_package_finished();
 	}
 	
 	return NULL;
@@ -187,19 +302,20 @@ void WorkScheduler::schedule(ExecutionGroup *group, int chunkNumber)
 {
 	WorkPackage *package = new WorkPackage(group, chunkNumber);
 #if COM_CURRENT_THREADING_MODEL == COM_TM_NOTHREAD
-	CPUDevice device;
-	device.execute(package);
+	CPUDevice device(0);
+	execute_work_package(&device, package);
 	delete package;
 #elif COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+	atomic_add_u(&g_workPending, 1);
 #ifdef COM_OPENCL_ENABLED
 	if (group->isOpenCL() && g_openclActive) {
 		BLI_thread_queue_push(g_gpuqueue, package);
 	}
 	else {
-		BLI_thread_queue_push(g_cpuqueue, package);
+		cpu_queue_push(package);
 	}
 #else
-	BLI_thread_queue_push(g_cpuqueue, package);
+	cpu_queue_push(package);
 #endif
 #endif
 }
@@ -208,7 +324,18 @@ void WorkScheduler::start(CompositorContext &context)
 {
 #if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
 	unsigned int index;
-	g_cpuqueue = BLI_thread_queue_init();
+	g_cpuQueued = 0;
+	g_cpuIdle = 0;
+	g_cpuStopping = false;
+	g_workPending = 0;
+	g_workFinished = 0;
+	BLI_condition_init(&g_cpuWorkCondition);
+	BLI_condition_init(&g_workFinishedCondition);
+	for (index = 0; index < g_cpudevices.size(); index++) {
+		CPUWorkQueue *queue = new CPUWorkQueue();
+		BLI_spin_init(&queue->lock);
+		g_cpuqueues.push_back(queue);
+	}
 	BLI_init_threads(&g_cputhreads, thread_execute_cpu, g_cpudevices.size());
 	for (index = 0; index < g_cpudevices.size(); index++) {
 		Device *device = g_cpudevices[index];
@@ -233,26 +360,40 @@ void WorkScheduler::start(CompositorContext &context)
 void WorkScheduler::finish()
 {
 #if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
-#ifdef COM_OPENCL_ENABLED
-	if (g_openclActive) {
-		BLI_thread_queue_wait_finish(g_gpuqueue);
-		BLI_thread_queue_wait_finish(g_cpuqueue);
-	}
-	else {
-		BLI_thread_queue_wait_finish(g_cpuqueue);
+	BLI_mutex_lock(&g_workMutex);
+	while (g_workPending != 0) {
+		BLI_condition_wait(&g_workFinishedCondition, &g_workMutex);
 	}
-#else
-	BLI_thread_queue_wait_finish(cpuqueue);
+	BLI_mutex_unlock(&g_workMutex);
 #endif
+}
+void WorkScheduler::waitForProgress()
+{
+#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+	BLI_mutex_lock(&g_workMutex);
+	const unsigned int finished = g_workFinished;
+	while (g_workFinished == finished && g_workPending != 0) {
+		BLI_condition_wait(&g_workFinishedCondition, &g_workMutex);
+	}
+	BLI_mutex_unlock(&g_workMutex);
 #endif
 }
 void WorkScheduler::stop()
 {
 #if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
-	BLI_thread_queue_nowait(g_cpuqueue);
+	BLI_mutex_lock(&g_workMutex);
+	g_cpuStopping = true;
+	BLI_condition_notify_all(&g_cpuWorkCondition);
+	BLI_mutex_unlock(&g_workMutex);
 	BLI_end_threads(&g_cputhreads);
-	BLI_thread_queue_free(g_cpuqueue);
-	g_cpuqueue = NULL;
+	while (g_cpuqueues.size() > 0) {
+		CPUWorkQueue *queue = g_cpuqueues.back();
+		g_cpuqueues.pop_back();
+		BLI_spin_end(&queue->lock);
+		delete queue;
+	}
+	BLI_condition_end(&g_cpuWorkCondition);
+	BLI_condition_end(&g_workFinishedCondition);
 #ifdef COM_OPENCL_ENABLED
 	if (g_openclActive) {
 		BLI_thread_queue_nowait(g_gpuqueue);
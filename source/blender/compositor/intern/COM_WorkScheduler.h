@@ -105,6 +105,12 @@ public:
 	 */
 	static void finish();
 
+	/**
+	 * @brief wait for any scheduled work to be completed.
+	 * Returns immediately when there is no scheduled work left.
+	 */
+	static void waitForProgress();
+
 	/**
 	 * @brief Are there OpenCL capable GPU devices initialized?
 	 * the result of this method is stored in the CompositorContext
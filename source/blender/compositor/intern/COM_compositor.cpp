@@ -33,6 +33,7 @@ extern "C" {
 #include "COM_compositor.h"
 #include "COM_ExecutionSystem.h"
 #include "COM_WorkScheduler.h"
+#include "COM_ResultCache.h"
 #include "clew.h"
 #include "COM_MovieDistortionOperation.h"
 
@@ -104,8 +105,16 @@ void COM_deinitialize()
 	if (is_compositorMutex_init) {
 		BLI_mutex_lock(&s_compositorMutex);
 		WorkScheduler::deinitialize();
+		ResultCache::clear();
 		is_compositorMutex_init = false;
 		BLI_mutex_unlock(&s_compositorMutex);
 		BLI_mutex_end(&s_compositorMutex);
 	}
 }
+
+void COM_clearCaches()
+{
+	/* not locking the compositor mutex, the cache is locked by itself,
+	 * so this doesn't wait for a running execution to finish */
+	ResultCache::clear();
+}
@@ -33,6 +33,11 @@
 #include "COM_SetValueOperation.h"
 #include "COM_GammaCorrectOperation.h"
 #include "COM_FastGaussianBlurOperation.h"
+#include "COM_ResultCache.h"
+
+extern "C" {
+#  include "BKE_camera.h"
+}
 
 DefocusNode::DefocusNode(bNode *editorNode) : Node(editorNode)
 {
@@ -142,3 +147,28 @@ void DefocusNode::convertToOperations(NodeConverter &converter, const Compositor
 		converter.mapOutputSocket(getOutputSocket(), operation->getOutputSocket());
 	}
 }
+
+bool DefocusNode::hashSettings(ResultHash &hash, const CompositorContext &context) const
+{
+	if (!Node::hashSettings(hash, context)) {
+		return false;
+	}
+
+	bNode *node = this->getbNode();
+	NodeDefocus *data = (NodeDefocus *)node->storage;
+	if (!data->no_zbuf) {
+		/* the radius is calculated from the camera, which isn't part of the node settings */
+		Scene *scene = node->id ? (Scene *)node->id : context.getScene();
+		Object *camob = scene ? scene->camera : NULL;
+		hash.add((const void *)camob);
+		if (camob && camob->type == OB_CAMERA) {
+			Camera *camera = (Camera *)camob->data;
+			hash.add(camera->lens);
+			hash.add((int)camera->sensor_fit);
+			hash.add(camera->sensor_x);
+			hash.add(camera->sensor_y);
+			hash.add(BKE_camera_object_dof_distance(camob));
+		}
+	}
+	return true;
+}
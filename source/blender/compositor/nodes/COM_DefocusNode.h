@@ -33,6 +33,7 @@ class DefocusNode : public Node {
 public:
 	DefocusNode(bNode *editorNode);
 	void convertToOperations(NodeConverter &converter, const CompositorContext &context) const;
+	bool hashSettings(ResultHash &hash, const CompositorContext &context) const;
 };
 
 #endif
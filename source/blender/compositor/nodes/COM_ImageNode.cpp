@@ -27,12 +27,19 @@
 #include "COM_MultilayerImageOperation.h"
 #include "COM_ConvertOperation.h"
 #include "BKE_node.h"
+#include "BLI_fileops.h"
+#include "BLI_path_util.h"
 #include "BLI_utildefines.h"
 
 #include "COM_SetValueOperation.h"
 #include "COM_SetVectorOperation.h"
 #include "COM_SetColorOperation.h"
 #include "COM_SeparateColorNode.h"
+#include "COM_ResultCache.h"
+
+extern "C" {
+#  include "IMB_imbuf_types.h"
+}
 
 ImageNode::ImageNode(bNode *editorNode) : Node(editorNode)
 {
@@ -267,3 +274,51 @@ void ImageNode::convertToOperations(NodeConverter &converter, const CompositorCo
 	}
 }
 
+
+bool ImageNode::hashSettings(ResultHash &hash, const CompositorContext &context) const
+{
+	if (!Node::hashSettings(hash, context)) {
+		return false;
+	}
+
+	/* The image is hashed by pointer in the node settings, add which buffer of it is used.
+	 * Painting, reloading or editing the image clears the cache (see cmp_node_image_update),
+	 * files changed on disk are noticed by their modification time. */
+	bNode *node = this->getbNode();
+	Image *image = (Image *)node->id;
+	if (image == NULL) {
+		return true;
+	}
+
+	ImageUser iuser = *(ImageUser *)node->storage;
+	BKE_image_user_frame_calc(&iuser, context.getFramenumber(), 0);
+
+	hash.add((int)image->source);
+	hash.add((int)image->type);
+	hash.add((int)image->alpha_mode);
+	hash.addString(image->colorspace_settings.name);
+	hash.add(iuser.framenr);
+	hash.add((int)iuser.layer);
+	hash.add((int)iuser.pass);
+	hash.add((int)iuser.view);
+	hash.add((int)iuser.multi_index);
+
+	if (ELEM(image->source, IMA_SRC_FILE, IMA_SRC_SEQUENCE, IMA_SRC_MOVIE) &&
+	    BLI_listbase_is_empty(&image->packedfiles))
+	{
+		char filepath[FILE_MAX];
+		BLI_stat_t st;
+
+		BKE_image_user_file_path(&iuser, image, filepath);
+		if (BLI_stat(filepath, &st) == 0) {
+			hash.add((uint64_t)st.st_mtime);
+			hash.add((uint64_t)st.st_size);
+		}
+	}
+
+	/* multilayer passes are read from the render result of the image */
+	if (image->type == IMA_TYPE_MULTILAYER) {
+		hash.add((const void *)image->rr);
+	}
+	return true;
+}
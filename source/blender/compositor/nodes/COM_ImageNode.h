@@ -40,5 +40,6 @@ private:
 public:
 	ImageNode(bNode *editorNode);
 	void convertToOperations(NodeConverter &converter, const CompositorContext &context) const;
+	bool hashSettings(ResultHash &hash, const CompositorContext &context) const;
 
 };
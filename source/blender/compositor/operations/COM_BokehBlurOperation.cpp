@@ -22,7 +22,9 @@
 
 #include "COM_BokehBlurOperation.h"
 #include "BLI_math.h"
+#include "COM_FFTConvolution.h"
 #include "COM_OpenCLDevice.h"
+#include "MEM_guardedalloc.h"
 
 extern "C" {
 #  include "RE_pipeline.h"
@@ -45,6 +47,8 @@ BokehBlurOperation::BokehBlurOperation() : NodeOperation()
 	this->m_inputBoundingBoxReader = NULL;
 
 	this->m_extend_bounds = false;
+	this->m_useFFT = false;
+	this->m_convolved = NULL;
 }
 
 void *BokehBlurOperation::initializeTileData(rcti * /*rect*/)
@@ -54,10 +58,48 @@ void *BokehBlurOperation::initializeTileData(rcti * /*rect*/)
 		updateSize();
 	}
 	void *buffer = getInputOperation(0)->initializeTileData(NULL);
+	if (this->m_useFFT && this->m_convolved == NULL) {
+		this->m_convolved = convolveFFT((MemoryBuffer *)buffer);
+	}
 	unlockMutex();
 	return buffer;
 }
 
+MemoryBuffer *BokehBlurOperation::convolveFFT(MemoryBuffer *inputBuffer)
+{
+	const float max_dim = max(this->getWidth(), this->getHeight());
+	const int pixelSize = this->m_size * max_dim / 100.0f;
+	const int kernelSize = 2 * pixelSize + 1;
+	const float m = this->m_bokehDimension / pixelSize;
+	float *kernel = (float *)MEM_mallocN(sizeof(float) * COM_NUM_CHANNELS_COLOR * kernelSize * kernelSize, __func__);
+	float *elem = kernel;
+
+	/* element (i, j) weights the pixel at offset (pixelSize - i, pixelSize - j), the same bokeh
+	 * samples as executePixel. The offset pixelSize itself isn't sampled there, so the first
+	 * row and column stay empty. */
+	for (int j = 0; j < kernelSize; j++) {
+		for (int i = 0; i < kernelSize; i++, elem += COM_NUM_CHANNELS_COLOR) {
+			if (i == 0 || j == 0) {
+				zero_v4(elem);
+			}
+			else {
+				float u = this->m_bokehMidX - (pixelSize - i) * m;
+				float v = this->m_bokehMidY - (pixelSize - j) * m;
+				this->m_inputBokehProgram->readSampled(elem, u, v, COM_PS_NEAREST);
+			}
+		}
+	}
+
+	MemoryBuffer *result = new MemoryBuffer(COM_DT_COLOR, inputBuffer->getRect());
+	FFTConvolution::convolve(result->getBuffer(), inputBuffer->getBuffer(),
+	                         inputBuffer->getWidth(), inputBuffer->getHeight(),
+	                         kernel, kernelSize, kernelSize, COM_NUM_CHANNELS_COLOR,
+	                         pixelSize, pixelSize, COM_NUM_CHANNELS_COLOR, true);
+	MEM_freeN(kernel);
+
+	return result;
+}
+
 void BokehBlurOperation::initExecution()
 {
 	initMutex();
@@ -74,6 +116,13 @@ void BokehBlurOperation::initExecution()
 	this->m_bokehMidY = height / 2.0f;
 	this->m_bokehDimension = dimension / 2.0f;
 	QualityStepHelper::initExecution(COM_QH_INCREASE);
+
+	/* a fixed size blur convolves the whole image at once, a linked size is only known while executing */
+	if (this->m_sizeavailable && getStep() == 1) {
+		const float max_dim = max(this->getWidth(), this->getHeight());
+		const int pixelSize = this->m_size * max_dim / 100.0f;
+		this->m_useFFT = FFTConvolution::isEfficient(2 * pixelSize + 1, 2 * pixelSize + 1);
+	}
 }
 
 void BokehBlurOperation::executePixel(float output[4], int x, int y, void *data)
@@ -83,7 +132,10 @@ void BokehBlurOperation::executePixel(float output[4], int x, int y, void *data)
 	float bokeh[4];
 
 	this->m_inputBoundingBoxReader->readSampled(tempBoundingBox, x, y, COM_PS_NEAREST);
-	if (tempBoundingBox[0] > 0.0f) {
+	if (tempBoundingBox[0] > 0.0f && this->m_convolved) {
+		this->m_convolved->read(output, x, y);
+	}
+	else if (tempBoundingBox[0] > 0.0f) {
 		float multiplier_accum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
 		MemoryBuffer *inputBuffer = (MemoryBuffer *)data;
 		float *buffer = inputBuffer->getBuffer();
@@ -139,6 +191,11 @@ void BokehBlurOperation::executePixel(float output[4], int x, int y, void *data)
 void BokehBlurOperation::deinitExecution()
 {
 	deinitMutex();
+	if (this->m_convolved) {
+		delete this->m_convolved;
+		this->m_convolved = NULL;
+	}
+	this->m_useFFT = false;
 	this->m_inputProgram = NULL;
 	this->m_inputBokehProgram = NULL;
 	this->m_inputBoundingBoxReader = NULL;
@@ -150,7 +207,13 @@ bool BokehBlurOperation::determineDependingAreaOfInterest(rcti *input, ReadBuffe
 	rcti bokehInput;
 	const float max_dim = max(this->getWidth(), this->getHeight());
 
-	if (this->m_sizeavailable) {
+	if (this->m_useFFT) {
+		newInput.xmin = 0;
+		newInput.ymin = 0;
+		newInput.xmax = this->getWidth();
+		newInput.ymax = this->getHeight();
+	}
+	else if (this->m_sizeavailable) {
 		newInput.xmax = input->xmax + (this->m_size * max_dim / 100.0f);
 		newInput.xmin = input->xmin - (this->m_size * max_dim / 100.0f);
 		newInput.ymax = input->ymax + (this->m_size * max_dim / 100.0f);
@@ -38,6 +38,14 @@ private:
 	float m_bokehMidY;
 	float m_bokehDimension;
 	bool m_extend_bounds;
+	bool m_useFFT;
+	MemoryBuffer *m_convolved;
+
+	/**
+	 * @brief convolve the whole input with the bokeh at once
+	 * Used for large blurs of a fixed size, the result is read by executePixel.
+	 */
+	MemoryBuffer *convolveFFT(MemoryBuffer *inputBuffer);
 public:
 	BokehBlurOperation();
 
@@ -22,12 +22,17 @@
 
 #include "COM_BrightnessOperation.h"
 
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
 BrightnessOperation::BrightnessOperation() : NodeOperation()
 {
 	this->addInputSocket(COM_DT_COLOR);
 	this->addInputSocket(COM_DT_VALUE);
 	this->addInputSocket(COM_DT_VALUE);
 	this->addOutputSocket(COM_DT_COLOR);
+	this->setSpanSupport(true);
 	this->m_inputProgram = NULL;
 }
 void BrightnessOperation::initExecution()
@@ -71,6 +76,45 @@ void BrightnessOperation::executePixelSampled(float output[4], float x, float y,
 	output[3] = inputValue[3];
 }
 
+void BrightnessOperation::executeSpan(float *output, int x, int y, int length)
+{
+	float inputValue[COM_SPAN_MAX_LENGTH * 4];
+	float inputBrightness[COM_SPAN_MAX_LENGTH * 4];
+	float inputContrast[COM_SPAN_MAX_LENGTH * 4];
+
+	this->m_inputProgram->readSpan(inputValue, x, y, length);
+	this->m_inputBrightnessProgram->readSpan(inputBrightness, x, y, length);
+	this->m_inputContrastProgram->readSpan(inputContrast, x, y, length);
+
+	for (int i = 0; i < length * 4; i += 4) {
+		float a, b;
+		float brightness = inputBrightness[i];
+		float contrast = inputContrast[i];
+		brightness /= 100.0f;
+		float delta = contrast / 200.0f;
+		a = 1.0f - delta * 2.0f;
+		/* see executePixelSampled */
+		if (contrast > 0) {
+			a = 1.0f / a;
+			b = a * (brightness - delta);
+		}
+		else {
+			delta *= -1;
+			b = a * (brightness + delta);
+		}
+
+#ifdef __SSE2__
+		const __m128 color = _mm_loadu_ps(&inputValue[i]);
+		_mm_storeu_ps(&output[i], _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a), color), _mm_set1_ps(b)));
+#else
+		output[i] = a * inputValue[i] + b;
+		output[i + 1] = a * inputValue[i + 1] + b;
+		output[i + 2] = a * inputValue[i + 2] + b;
+#endif
+		output[i + 3] = inputValue[i + 3];
+	}
+}
+
 void BrightnessOperation::deinitExecution()
 {
 	this->m_inputProgram = NULL;
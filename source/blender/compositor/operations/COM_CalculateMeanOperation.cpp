@@ -22,8 +22,11 @@
 
 #include "COM_CalculateMeanOperation.h"
 #include "BLI_math.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
+#include "MEM_guardedalloc.h"
+
 extern "C" {
 #include "IMB_colormanagement.h"
 }
@@ -88,45 +91,104 @@ void *CalculateMeanOperation::initializeTileData(rcti *rect)
 
 void CalculateMeanOperation::calculateMean(MemoryBuffer *tile)
 {
-	this->m_result = 0.0f;
-	float *buffer = tile->getBuffer();
-	int size = tile->getWidth() * tile->getHeight();
+	int pixels;
+	double sum = sumPixelValues(tile, false, 0.0f, &pixels);
+	this->m_result = sum / pixels;
+}
+
+typedef struct CalculateMeanTaskData {
+	MemoryBuffer *tile;
+	int setting;
+	bool deviation;
+	float mean;
+	double *sums;
+	int *pixels;
+} CalculateMeanTaskData;
+
+void CalculateMeanOperation::sum_pixel_values_task(void *userdata, const int y)
+{
+	CalculateMeanTaskData *data = (CalculateMeanTaskData *)userdata;
+	const int width = data->tile->getWidth();
+	const float *buffer = data->tile->getBuffer() + (size_t)y * width * 4;
+	const float mean = data->mean;
 	int pixels = 0;
-	float sum = 0.0f;
-	for (int i = 0, offset = 0; i < size; i++, offset += 4) {
+	double sum = 0.0;
+
+	for (int i = 0, offset = 0; i < width; i++, offset += 4) {
 		if (buffer[offset + 3] > 0) {
+			float value = 0.0f;
 			pixels++;
-	
-			switch (this->m_setting) {
-				case 1:
+
+			switch (data->setting) {
+				case 1:  /* rgb combined */
 				{
-					sum += IMB_colormanagement_get_luminance(&buffer[offset]);
+					value = IMB_colormanagement_get_luminance(&buffer[offset]);
 					break;
 				}
-				case 2:
+				case 2:  /* red */
 				{
-					sum += buffer[offset];
+					value = buffer[offset];
 					break;
 				}
-				case 3:
+				case 3:  /* green */
 				{
-					sum += buffer[offset + 1];
+					value = buffer[offset + 1];
 					break;
 				}
-				case 4:
+				case 4:  /* blue */
 				{
-					sum += buffer[offset + 2];
+					value = buffer[offset + 2];
 					break;
 				}
-				case 5:
+				case 5:  /* luminance */
 				{
 					float yuv[3];
 					rgb_to_yuv(buffer[offset], buffer[offset + 1], buffer[offset + 2], &yuv[0], &yuv[1], &yuv[2]);
-					sum += yuv[0];
+					value = yuv[0];
 					break;
 				}
 			}
+
+			if (data->deviation) {
+				/* the single channel settings always added the value itself as well, keep the results */
+				if (ELEM(data->setting, 2, 3, 4)) {
+					sum += value;
+				}
+				sum += (value - mean) * (value - mean);
+			}
+			else {
+				sum += value;
+			}
 		}
 	}
-	this->m_result = sum / pixels;
+
+	data->sums[y] = sum;
+	data->pixels[y] = pixels;
+}
+
+double CalculateMeanOperation::sumPixelValues(MemoryBuffer *tile, bool deviation, float mean, int *r_pixels)
+{
+	const int height = tile->getHeight();
+	CalculateMeanTaskData data;
+	double sum = 0.0;
+
+	data.tile = tile;
+	data.setting = this->m_setting;
+	data.deviation = deviation;
+	data.mean = mean;
+	data.sums = (double *)MEM_mallocN(sizeof(double) * height, __func__);
+	data.pixels = (int *)MEM_mallocN(sizeof(int) * height, __func__);
+
+	BLI_task_parallel_range(0, height, &data, sum_pixel_values_task, tile->getWidth() * height > 10000);
+
+	*r_pixels = 0;
+	for (int y = 0; y < height; y++) {
+		sum += data.sums[y];
+		*r_pixels += data.pixels[y];
+	}
+
+	MEM_freeN(data.sums);
+	MEM_freeN(data.pixels);
+
+	return sum;
 }
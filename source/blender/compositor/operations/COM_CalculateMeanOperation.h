@@ -65,5 +65,15 @@ public:
 	
 protected:
 	void calculateMean(MemoryBuffer *tile);
+
+	/**
+	 * @brief sum the values of all pixels with a positive alpha, rows are summed by multiple threads
+	 * @param deviation: sum the squared differences to mean instead of the values
+	 * @param r_pixels: number of summed pixels
+	 */
+	double sumPixelValues(MemoryBuffer *tile, bool deviation, float mean, int *r_pixels);
+
+private:
+	static void sum_pixel_values_task(void *userdata, const int y);
 };
 #endif
@@ -38,6 +38,7 @@ ColorBalanceASCCDLOperation::ColorBalanceASCCDLOperation() : NodeOperation()
 	this->addInputSocket(COM_DT_VALUE);
 	this->addInputSocket(COM_DT_COLOR);
 	this->addOutputSocket(COM_DT_COLOR);
+	this->setSpanSupport(true);
 	this->m_inputValueOperation = NULL;
 	this->m_inputColorOperation = NULL;
 	this->setResolutionInputSocketIndex(1);
@@ -68,6 +69,25 @@ void ColorBalanceASCCDLOperation::executePixelSampled(float output[4], float x,
 
 }
 
+void ColorBalanceASCCDLOperation::executeSpan(float *output, int x, int y, int length)
+{
+	float inputColor[COM_SPAN_MAX_LENGTH * 4];
+	float value[COM_SPAN_MAX_LENGTH * 4];
+
+	this->m_inputValueOperation->readSpan(value, x, y, length);
+	this->m_inputColorOperation->readSpan(inputColor, x, y, length);
+
+	for (int i = 0; i < length * 4; i += 4) {
+		const float fac = min(1.0f, value[i]);
+		const float mfac = 1.0f - fac;
+
+		output[i] = mfac * inputColor[i] + fac * colorbalance_cdl(inputColor[i], this->m_offset[0], this->m_power[0], this->m_slope[0]);
+		output[i + 1] = mfac * inputColor[i + 1] + fac * colorbalance_cdl(inputColor[i + 1], this->m_offset[1], this->m_power[1], this->m_slope[1]);
+		output[i + 2] = mfac * inputColor[i + 2] + fac * colorbalance_cdl(inputColor[i + 2], this->m_offset[2], this->m_power[2], this->m_slope[2]);
+		output[i + 3] = inputColor[i + 3];
+	}
+}
+
 void ColorBalanceASCCDLOperation::deinitExecution()
 {
 	this->m_inputValueOperation = NULL;
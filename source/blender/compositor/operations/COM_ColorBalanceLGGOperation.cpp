@@ -43,6 +43,7 @@ ColorBalanceLGGOperation::ColorBalanceLGGOperation() : NodeOperation()
 	this->addInputSocket(COM_DT_VALUE);
 	this->addInputSocket(COM_DT_COLOR);
 	this->addOutputSocket(COM_DT_COLOR);
+	this->setSpanSupport(true);
 	this->m_inputValueOperation = NULL;
 	this->m_inputColorOperation = NULL;
 	this->setResolutionInputSocketIndex(1);
@@ -73,6 +74,25 @@ void ColorBalanceLGGOperation::executePixelSampled(float output[4], float x, flo
 
 }
 
+void ColorBalanceLGGOperation::executeSpan(float *output, int x, int y, int length)
+{
+	float inputColor[COM_SPAN_MAX_LENGTH * 4];
+	float value[COM_SPAN_MAX_LENGTH * 4];
+
+	this->m_inputValueOperation->readSpan(value, x, y, length);
+	this->m_inputColorOperation->readSpan(inputColor, x, y, length);
+
+	for (int i = 0; i < length * 4; i += 4) {
+		const float fac = min(1.0f, value[i]);
+		const float mfac = 1.0f - fac;
+
+		output[i] = mfac * inputColor[i] + fac * colorbalance_lgg(inputColor[i], this->m_lift[0], this->m_gamma_inv[0], this->m_gain[0]);
+		output[i + 1] = mfac * inputColor[i + 1] + fac * colorbalance_lgg(inputColor[i + 1], this->m_lift[1], this->m_gamma_inv[1], this->m_gain[1]);
+		output[i + 2] = mfac * inputColor[i + 2] + fac * colorbalance_lgg(inputColor[i + 2], this->m_lift[2], this->m_gamma_inv[2], this->m_gain[2]);
+		output[i + 3] = inputColor[i + 3];
+	}
+}
+
 void ColorBalanceLGGOperation::deinitExecution()
 {
 	this->m_inputValueOperation = NULL;
@@ -34,6 +34,7 @@ ColorRampOperation::ColorRampOperation() : NodeOperation()
 {
 	this->addInputSocket(COM_DT_VALUE);
 	this->addOutputSocket(COM_DT_COLOR);
+	this->setSpanSupport(true);
 
 	this->m_inputProgram = NULL;
 	this->m_colorBand = NULL;
@@ -51,6 +52,16 @@ void ColorRampOperation::executePixelSampled(float output[4], float x, float y,
 	do_colorband(this->m_colorBand, values[0], output);
 }
 
+void ColorRampOperation::executeSpan(float *output, int x, int y, int length)
+{
+	float values[COM_SPAN_MAX_LENGTH * 4];
+
+	this->m_inputProgram->readSpan(values, x, y, length);
+	for (int i = 0; i < length * 4; i += 4) {
+		do_colorband(this->m_colorBand, values[i], &output[i]);
+	}
+}
+
 void ColorRampOperation::deinitExecution()
 {
 	this->m_inputProgram = NULL;
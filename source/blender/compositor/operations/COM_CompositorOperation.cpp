@@ -186,6 +186,39 @@ void CompositorOperation::executeRegion(rcti *rect, unsigned int /*tileNumber*/)
 	}
 #endif
 
+	if (this->useSpanExecution()) {
+		float span[COM_SPAN_MAX_LENGTH * 4];
+		int i;
+
+		for (y = y1; y < y2 && (!breaked); y++) {
+			for (x = x1; x < x2; x += COM_SPAN_MAX_LENGTH) {
+				const int length = min(x2 - x, COM_SPAN_MAX_LENGTH);
+				int input_x = x + dx, input_y = y + dy;
+
+				this->m_imageInput->readSpan(buffer + offset4, input_x, input_y, length);
+				if (this->m_useAlphaInput) {
+					this->m_alphaInput->readSpan(span, input_x, input_y, length);
+					for (i = 0; i < length; i++) {
+						buffer[offset4 + i * COM_NUM_CHANNELS_COLOR + 3] = span[i * 4];
+					}
+				}
+
+				this->m_depthInput->readSpan(span, input_x, input_y, length);
+				for (i = 0; i < length; i++) {
+					zbuffer[offset + i] = span[i * 4];
+				}
+				offset4 += length * COM_NUM_CHANNELS_COLOR;
+				offset += length;
+			}
+			if (isBreaked()) {
+				breaked = true;
+			}
+			offset += add;
+			offset4 += add * COM_NUM_CHANNELS_COLOR;
+		}
+		return;
+	}
+
 	for (y = y1; y < y2 && (!breaked); y++) {
 		for (x = x1; x < x2 && (!breaked); x++) {
 			int input_x = x + dx, input_y = y + dy;
@@ -22,6 +22,10 @@
 
 #include "COM_ConvertOperation.h"
 
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
 extern "C" {
 #include "IMB_colormanagement.h"
 }
@@ -48,6 +52,7 @@ ConvertValueToColorOperation::ConvertValueToColorOperation() : ConvertBaseOperat
 {
 	this->addInputSocket(COM_DT_VALUE);
 	this->addOutputSocket(COM_DT_COLOR);
+	this->setSpanSupport(true);
 }
 
 void ConvertValueToColorOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
@@ -58,6 +63,17 @@ void ConvertValueToColorOperation::executePixelSampled(float output[4], float x,
 	output[3] = 1.0f;
 }
 
+void ConvertValueToColorOperation::executeSpan(float *output, int x, int y, int length)
+{
+	float value[COM_SPAN_MAX_LENGTH * 4];
+
+	this->m_inputOperation->readSpan(value, x, y, length);
+	for (int i = 0; i < length * 4; i += 4) {
+		output[i] = output[i + 1] = output[i + 2] = value[i];
+		output[i + 3] = 1.0f;
+	}
+}
+
 
 /* ******** Color to Value ******** */
 
@@ -65,6 +81,7 @@ ConvertColorToValueOperation::ConvertColorToValueOperation() : ConvertBaseOperat
 {
 	this->addInputSocket(COM_DT_COLOR);
 	this->addOutputSocket(COM_DT_VALUE);
+	this->setSpanSupport(true);
 }
 
 void ConvertColorToValueOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
@@ -74,6 +91,16 @@ void ConvertColorToValueOperation::executePixelSampled(float output[4], float x,
 	output[0] = (inputColor[0] + inputColor[1] + inputColor[2]) / 3.0f;
 }
 
+void ConvertColorToValueOperation::executeSpan(float *output, int x, int y, int length)
+{
+	float inputColor[COM_SPAN_MAX_LENGTH * 4];
+
+	this->m_inputOperation->readSpan(inputColor, x, y, length);
+	for (int i = 0; i < length * 4; i += 4) {
+		output[i] = (inputColor[i] + inputColor[i + 1] + inputColor[i + 2]) / 3.0f;
+	}
+}
+
 
 /* ******** Color to BW ******** */
 
@@ -81,6 +108,7 @@ ConvertColorToBWOperation::ConvertColorToBWOperation() : ConvertBaseOperation()
 {
 	this->addInputSocket(COM_DT_COLOR);
 	this->addOutputSocket(COM_DT_VALUE);
+	this->setSpanSupport(true);
 }
 
 void ConvertColorToBWOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
@@ -90,6 +118,16 @@ void ConvertColorToBWOperation::executePixelSampled(float output[4], float x, fl
 	output[0] = IMB_colormanagement_get_luminance(inputColor);
 }
 
+void ConvertColorToBWOperation::executeSpan(float *output, int x, int y, int length)
+{
+	float inputColor[COM_SPAN_MAX_LENGTH * 4];
+
+	this->m_inputOperation->readSpan(inputColor, x, y, length);
+	for (int i = 0; i < length * 4; i += 4) {
+		output[i] = IMB_colormanagement_get_luminance(&inputColor[i]);
+	}
+}
+
 
 /* ******** Color to Vector ******** */
 
@@ -97,6 +135,7 @@ ConvertColorToVectorOperation::ConvertColorToVectorOperation() : ConvertBaseOper
 {
 	this->addInputSocket(COM_DT_COLOR);
 	this->addOutputSocket(COM_DT_VECTOR);
+	this->setSpanSupport(true);
 }
 
 void ConvertColorToVectorOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
@@ -112,6 +151,13 @@ ConvertValueToVectorOperation::ConvertValueToVectorOperation() : ConvertBaseOper
 {
 	this->addInputSocket(COM_DT_VALUE);
 	this->addOutputSocket(COM_DT_VECTOR);
+	this->setSpanSupport(true);
+}
+
+void ConvertColorToVectorOperation::executeSpan(float *output, int x, int y, int length)
+{
+	/* alpha ends up in the unused fourth channel of the vector */
+	this->m_inputOperation->readSpan(output, x, y, length);
 }
 
 void ConvertValueToVectorOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
@@ -121,6 +167,16 @@ void ConvertValueToVectorOperation::executePixelSampled(float output[4], float x
 	output[0] = output[1] = output[2] = value;
 }
 
+void ConvertValueToVectorOperation::executeSpan(float *output, int x, int y, int length)
+{
+	float value[COM_SPAN_MAX_LENGTH * 4];
+
+	this->m_inputOperation->readSpan(value, x, y, length);
+	for (int i = 0; i < length * 4; i += 4) {
+		output[i] = output[i + 1] = output[i + 2] = value[i];
+	}
+}
+
 
 /* ******** Vector to Color ******** */
 
@@ -128,6 +184,7 @@ ConvertVectorToColorOperation::ConvertVectorToColorOperation() : ConvertBaseOper
 {
 	this->addInputSocket(COM_DT_VECTOR);
 	this->addOutputSocket(COM_DT_COLOR);
+	this->setSpanSupport(true);
 }
 
 void ConvertVectorToColorOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
@@ -136,6 +193,14 @@ void ConvertVectorToColorOperation::executePixelSampled(float output[4], float x
 	output[3] = 1.0f;
 }
 
+void ConvertVectorToColorOperation::executeSpan(float *output, int x, int y, int length)
+{
+	this->m_inputOperation->readSpan(output, x, y, length);
+	for (int i = 0; i < length * 4; i += 4) {
+		output[i + 3] = 1.0f;
+	}
+}
+
 
 /* ******** Vector to Value ******** */
 
@@ -143,6 +208,7 @@ ConvertVectorToValueOperation::ConvertVectorToValueOperation() : ConvertBaseOper
 {
 	this->addInputSocket(COM_DT_VECTOR);
 	this->addOutputSocket(COM_DT_VALUE);
+	this->setSpanSupport(true);
 }
 
 void ConvertVectorToValueOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
@@ -152,6 +218,16 @@ void ConvertVectorToValueOperation::executePixelSampled(float output[4], float x
 	output[0] = (input[0] + input[1] + input[2]) / 3.0f;
 }
 
+void ConvertVectorToValueOperation::executeSpan(float *output, int x, int y, int length)
+{
+	float input[COM_SPAN_MAX_LENGTH * 4];
+
+	this->m_inputOperation->readSpan(input, x, y, length);
+	for (int i = 0; i < length * 4; i += 4) {
+		output[i] = (input[i] + input[i + 1] + input[i + 2]) / 3.0f;
+	}
+}
+
 
 /* ******** RGB to YCC ******** */
 
@@ -306,6 +382,7 @@ ConvertPremulToStraightOperation::ConvertPremulToStraightOperation() : ConvertBa
 {
 	this->addInputSocket(COM_DT_COLOR);
 	this->addOutputSocket(COM_DT_COLOR);
+	this->setSpanSupport(true);
 }
 
 void ConvertPremulToStraightOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
@@ -327,6 +404,26 @@ void ConvertPremulToStraightOperation::executePixelSampled(float output[4], floa
 	output[3] = alpha;
 }
 
+void ConvertPremulToStraightOperation::executeSpan(float *output, int x, int y, int length)
+{
+	float inputValue[COM_SPAN_MAX_LENGTH * 4];
+
+	this->m_inputOperation->readSpan(inputValue, x, y, length);
+	for (int i = 0; i < length * 4; i += 4) {
+		const float alpha = inputValue[i + 3];
+
+		if (fabsf(alpha) < 1e-5f) {
+			zero_v3(&output[i]);
+		}
+		else {
+			mul_v3_v3fl(&output[i], &inputValue[i], 1.0f / alpha);
+		}
+
+		/* never touches the alpha */
+		output[i + 3] = alpha;
+	}
+}
+
 
 /* ******** Straight to Premul ******** */
 
@@ -334,6 +431,7 @@ ConvertStraightToPremulOperation::ConvertStraightToPremulOperation() : ConvertBa
 {
 	this->addInputSocket(COM_DT_COLOR);
 	this->addOutputSocket(COM_DT_COLOR);
+	this->setSpanSupport(true);
 }
 
 void ConvertStraightToPremulOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
@@ -350,6 +448,24 @@ void ConvertStraightToPremulOperation::executePixelSampled(float output[4], floa
 	output[3] = alpha;
 }
 
+void ConvertStraightToPremulOperation::executeSpan(float *output, int x, int y, int length)
+{
+	float inputValue[COM_SPAN_MAX_LENGTH * 4];
+
+	this->m_inputOperation->readSpan(inputValue, x, y, length);
+	for (int i = 0; i < length * 4; i += 4) {
+		const float alpha = inputValue[i + 3];
+#ifdef __SSE2__
+		_mm_storeu_ps(&output[i], _mm_mul_ps(_mm_loadu_ps(&inputValue[i]), _mm_set1_ps(alpha)));
+#else
+		mul_v3_v3fl(&output[i], &inputValue[i], alpha);
+#endif
+
+		/* never touches the alpha */
+		output[i + 3] = alpha;
+	}
+}
+
 
 /* ******** Separate Channels ******** */
 
@@ -357,6 +473,7 @@ SeparateChannelOperation::SeparateChannelOperation() : NodeOperation()
 {
 	this->addInputSocket(COM_DT_COLOR);
 	this->addOutputSocket(COM_DT_VALUE);
+	this->setSpanSupport(true);
 	this->m_inputOperation = NULL;
 }
 void SeparateChannelOperation::initExecution()
@@ -377,6 +494,16 @@ void SeparateChannelOperation::executePixelSampled(float output[4], float x, flo
 	output[0] = input[this->m_channel];
 }
 
+void SeparateChannelOperation::executeSpan(float *output, int x, int y, int length)
+{
+	float input[COM_SPAN_MAX_LENGTH * 4];
+
+	this->m_inputOperation->readSpan(input, x, y, length);
+	for (int i = 0; i < length * 4; i += 4) {
+		output[i] = input[i + this->m_channel];
+	}
+}
+
 
 /* ******** Combine Channels ******** */
 
@@ -387,6 +514,7 @@ CombineChannelsOperation::CombineChannelsOperation() : NodeOperation()
 	this->addInputSocket(COM_DT_VALUE);
 	this->addInputSocket(COM_DT_VALUE);
 	this->addOutputSocket(COM_DT_COLOR);
+	this->setSpanSupport(true);
 	this->setResolutionInputSocketIndex(0);
 	this->m_inputChannel1Operation = NULL;
 	this->m_inputChannel2Operation = NULL;
@@ -431,3 +559,21 @@ void CombineChannelsOperation::executePixelSampled(float output[4], float x, flo
 		output[3] = input[0];
 	}
 }
+
+void CombineChannelsOperation::executeSpan(float *output, int x, int y, int length)
+{
+	SocketReader *inputs[4] = {this->m_inputChannel1Operation,
+	                           this->m_inputChannel2Operation,
+	                           this->m_inputChannel3Operation,
+	                           this->m_inputChannel4Operation};
+	float input[COM_SPAN_MAX_LENGTH * 4];
+
+	for (int channel = 0; channel < 4; channel++) {
+		if (inputs[channel]) {
+			inputs[channel]->readSpan(input, x, y, length);
+			for (int i = 0; i < length * 4; i += 4) {
+				output[i + channel] = input[i];
+			}
+		}
+	}
+}
@@ -20,8 +20,11 @@
  *		Monique Dewanchand
  */
 
+#include <float.h>
+
 #include "COM_DoubleEdgeMaskOperation.h"
 #include "BLI_math.h"
+#include "BLI_task.h"
 #include "DNA_node_types.h"
 #include "MEM_guardedalloc.h"
 
@@ -889,243 +892,229 @@ static void do_adjacentEdgeDetection(unsigned int t, unsigned int rw, unsigned i
 	rsize[2] = in_gsz;
 }
 
-static void do_createEdgeLocationBuffer(unsigned int t, unsigned int rw, unsigned int *lres, float *res, unsigned short *gbuf, unsigned int *innerEdgeOffset, unsigned int *outerEdgeOffset, unsigned int isz, unsigned int gsz)
-{
-	int x;                             // x = pixel loop counter
-	int a;                             // a = temporary pixel index buffer loop counter
-	unsigned int ud;                   // ud = unscaled edge distance
-	unsigned int dmin;                 // dmin = minimum edge distance
-	
-	unsigned int rsl;                  // long used for finding fast 1.0/sqrt
-	unsigned int gradientFillOffset;
-	unsigned int innerAccum = 0;       // for looping inner edge pixel indexes, represents current position from offset
-	unsigned int outerAccum = 0;       // for looping outer edge pixel indexes, represents current position from offset
-	unsigned int gradientAccum = 0;    // for looping gradient pixel indexes, represents current position from offset
-	/*
-	 * Here we compute the size of buffer needed to hold (row,col) coordinates
-	 * for each pixel previously determined to be either gradient, inner edge,
-	 * or outer edge.
-	 *
-	 * Allocation is done by requesting 4 bytes "sizeof(int)" per pixel, even
-	 * though gbuf[] is declared as (unsigned short *) (2 bytes) because we don't
-	 * store the pixel indexes, we only store x,y location of pixel in buffer.
-	 *
-	 * This does make the assumption that x and y can fit in 16 unsigned bits
-	 * so if Blender starts doing renders greater than 65536 in either direction
-	 * this will need to allocate gbuf[] as unsigned int *and allocate 8 bytes
-	 * per flagged pixel.
-	 *
-	 * In general, the buffer on-screen:
-	 *
-	 * Example:  9 by 9 pixel block
-	 *
-	 * . = pixel non-white in both outer and inner mask
-	 * o = pixel white in outer, but not inner mask, adjacent to "." pixel
-	 * g = pixel white in outer, but not inner mask, not adjacent to "." pixel
-	 * i = pixel white in inner mask, adjacent to "g" or "." pixel
-	 * F = pixel white in inner mask, only adjacent to other pixels white in the inner mask
-	 *
-	 *
-	 * .........   <----- pixel #80
-	 * ..oooo...
-	 * .oggggo..
-	 * .oggiggo.
-	 * .ogiFigo.
-	 * .oggiggo.
-	 * .oggggo..
-	 * ..oooo...
-	 * pixel #00 -----> .........
-	 *
-	 * gsz = 18   (18 "g" pixels above)
-	 * isz = 4    (4 "i" pixels above)
-	 * osz = 18   (18 "o" pixels above)
-	 *
-	 *
-	 * The memory in gbuf[] after filling will look like this:
-	 *
-	 * gradientFillOffset (0 pixels)                   innerEdgeOffset (18 pixels)    outerEdgeOffset (22 pixels)
-	 * /                                               /                              /
-	 * /                                               /                              /
-	 * |X   Y   X   Y   X   Y   X   Y   >     <X   Y   X   Y   >     <X   Y   X   Y   X   Y   >     <X   Y   X   Y   | <- (x,y)
-	 * +-------------------------------->     <---------------->     <------------------------>     <----------------+
-	 * |0   2   4   6   8   10  12  14  > ... <68  70  72  74  > ... <80  82  84  86  88  90  > ... <152 154 156 158 | <- bytes
-	 * +-------------------------------->     <---------------->     <------------------------>     <----------------+
-	 * |g0  g0  g1  g1  g2  g2  g3  g3  >     <g17 g17 i0  i0  >     <i2  i2  i3  i3  o0  o0  >     <o16 o16 o17 o17 | <- pixel
-	 *       /                              /                              /
-	 *      /                              /                              /
-	 *        /                              /                              /
-	 * +---------- gradientAccum (18) ---------+      +--- innerAccum (22) ---+      +--- outerAccum (40) ---+
-	 *
-	 *
-	 * Ultimately we do need the pixel's memory buffer index to set the output
-	 * pixel color, but it's faster to reconstruct the memory buffer location
-	 * each iteration of the final gradient calculation than it is to deconstruct
-	 * a memory location into x,y pairs each round.
-	 */
+/*
+ * The general algorithm used to color each gradient pixel is:
+ *
+ * 1.) Find the distance of every pixel to the closest outside edge pixel
+ * and the closest inside edge pixel.
+ * 2.) For each gradient pixel, find proportion of distance from gradient pixel
+ * to inside edge pixel compared to sum of distance to inside edge and distance
+ * to outside edge.
+ *
+ * In an image where:
+ * . = blank (black) pixels, not covered by inner mask or outer mask
+ * + = desired gradient pixels, covered only by outer mask
+ * * = white full mask pixels, covered by at least inner mask
+ *
+ * ...............................
+ * ...............+++++++++++.....
+ * ...+O++++++..++++++++++++++....
+ * ..+++\++++++++++++++++++++.....
+ * .+++++G+++++++++*******+++.....
+ * .+++++|+++++++*********+++.....
+ * .++***I****************+++.....
+ * .++*******************+++......
+ * .+++*****************+++.......
+ * ..+++***************+++........
+ * ....+++**********+++...........
+ * ......++++++++++++.............
+ * ...............................
+ *
+ * O = outside edge pixel
+ * \
+ *  G = gradient pixel
+ *  |
+ *  I = inside edge pixel
+ *
+ *   __
+ *  *note that IO does not need to be a straight line, in fact
+ *  many cases can arise where straight lines do not work
+ *  correctly.
+ *
+ *     __       __     __
+ * d.) Pixel color is assigned as |GO| / ( |GI| + |GO| )
+ *
+ * The distances are found with an exact euclidean distance transform
+ * (Felzenszwalb & Huttenlocher), first along the columns, then along the rows.
+ * Both passes handle columns and rows independently, so they run in parallel,
+ * and the cost no longer depends on the number of edge pixels.
+ * The transform gives the same squared distances as comparing against every
+ * edge pixel.
+ */
 
+/* squared distance of pixels when there are no edge pixels at all */
+#define DEM_DIST_INF 0xffffffff
+/* columns handled by a single task in the vertical pass, so rows are read sequentially */
+#define DEM_COLUMN_CHUNK 64
 
-	gradientFillOffset = 0;                            // since there are likely "more" of these, put it first. :)
-	*innerEdgeOffset = gradientFillOffset + gsz;       // set start of inner edge indexes
-	*outerEdgeOffset = (*innerEdgeOffset) + isz;       // set start of outer edge indexes
-	/* set the accumulators to correct positions */    // set up some accumulator variables for loops
-	gradientAccum = gradientFillOffset;                // each accumulator variable starts at its respective
-	innerAccum = *innerEdgeOffset;                     // section's offset so when we start filling, each
-	outerAccum = *outerEdgeOffset;                     // section fills up it's allocated space in gbuf
-	//uses dmin=row, rsl=col
-	for (x = 0, dmin = 0; x < t; x += rw, dmin++) {
-		for (rsl = 0; rsl < rw; rsl++) {
-			a = x + rsl;
-			if (lres[a] == 2) {                  // it is a gradient pixel flagged by 2
-				ud = gradientAccum << 1;         // double the index to reach correct unsigned short location
-				gbuf[ud] = dmin;                 // insert pixel's row into gradient pixel location buffer
-				gbuf[ud + 1] = rsl;              // insert pixel's column into gradient pixel location buffer
-				gradientAccum++;                 // increment gradient index buffer pointer
+typedef struct DEMDistanceData {
+	unsigned int *lres;
+	float *res;
+	unsigned int *idist;    /* squared distance to the closest inner edge pixel */
+	unsigned int *odist;    /* squared distance to the closest outer edge pixel */
+	int width, height;
+} DEMDistanceData;
+
+/* distance to the closest pixel flagged as edge in the same column */
+static void do_edgeDistanceColumns(const unsigned int *lres, unsigned int *dist, unsigned int flag,
+                                   int width, int height, int xmin, int xmax)
+{
+	int x, y;
+
+	for (y = 0; y < height; y++) {
+		const unsigned int *flags = &lres[y * width];
+		unsigned int *row = &dist[y * width];
+		const unsigned int *prev_row = row - width;
+		for (x = xmin; x < xmax; x++) {
+			if (flags[x] == flag) {
+				row[x] = 0;
 			}
-			else if (lres[a] == 3) {             // it is an outer edge pixel flagged by 3
-				ud = outerAccum << 1;            // double the index to reach correct unsigned short location
-				gbuf[ud] = dmin;                 // insert pixel's row into outer edge pixel location buffer
-				gbuf[ud + 1] = rsl;              // insert pixel's column into outer edge pixel location buffer
-				outerAccum++;                    // increment outer edge index buffer pointer
-				res[a] = 0.0f;                   // set output pixel intensity now since it won't change later
+			else if (y > 0 && prev_row[x] != DEM_DIST_INF) {
+				row[x] = prev_row[x] + 1;
 			}
-			else if (lres[a] == 4) {             // it is an inner edge pixel flagged by 4
-				ud = innerAccum << 1;            // double int index to reach correct unsigned short location
-				gbuf[ud] = dmin;                 // insert pixel's row into inner edge pixel location buffer
-				gbuf[ud + 1] = rsl;              // insert pixel's column into inner edge pixel location buffer
-				innerAccum++;                    // increment inner edge index buffer pointer
-				res[a] = 1.0f;                   // set output pixel intensity now since it won't change later
+			else {
+				row[x] = DEM_DIST_INF;
+			}
+		}
+	}
+	for (y = height - 2; y >= 0; y--) {
+		unsigned int *row = &dist[y * width];
+		const unsigned int *next_row = row + width;
+		for (x = xmin; x < xmax; x++) {
+			if (next_row[x] != DEM_DIST_INF && next_row[x] + 1 < row[x]) {
+				row[x] = next_row[x] + 1;
 			}
 		}
 	}
-	
 }
 
-static void do_fillGradientBuffer(unsigned int rw, float *res, unsigned short *gbuf, unsigned int isz, unsigned int osz, unsigned int gsz, unsigned int innerEdgeOffset, unsigned int outerEdgeOffset)
+static void do_edgeDistanceColumnsTask(void *userdata, const int chunk)
 {
-	int x;                             // x = pixel loop counter
-	int a;                             // a = temporary pixel index buffer loop counter
-	int fsz;                           // size of the frame
-	unsigned int rsl;                  // long used for finding fast 1.0/sqrt
-	float rsf;                         // float used for finding fast 1.0/sqrt
-	const float rsopf = 1.5f;          // constant float used for finding fast 1.0/sqrt
-	
-	unsigned int gradientFillOffset;
-	unsigned int t;
-	unsigned int ud;                   // ud = unscaled edge distance
-	unsigned int dmin;                 // dmin = minimum edge distance
-	float odist;                       // odist = current outer edge distance
-	float idist;                       // idist = current inner edge distance
-	int dx;                            // dx = X-delta (used for distance proportion calculation)
-	int dy;                            // dy = Y-delta (used for distance proportion calculation)
-	
-	/*
-	 * The general algorithm used to color each gradient pixel is:
-	 *
-	 * 1.) Loop through all gradient pixels.
-	 * A.) For each gradient pixel:
-	 * a.) Loop though all outside edge pixels, looking for closest one
-	 * to the gradient pixel we are in.
-	 * b.) Loop through all inside edge pixels, looking for closest one
-	 * to the gradient pixel we are in.
-	 * c.) Find proportion of distance from gradient pixel to inside edge
-	 * pixel compared to sum of distance to inside edge and distance to
-	 * outside edge.
-	 *
-	 * In an image where:
-	 * . = blank (black) pixels, not covered by inner mask or outer mask
-	 * + = desired gradient pixels, covered only by outer mask
-	 * * = white full mask pixels, covered by at least inner mask
-	 *
-	 * ...............................
-	 * ...............+++++++++++.....
-	 * ...+O++++++..++++++++++++++....
-	 * ..+++\++++++++++++++++++++.....
-	 * .+++++G+++++++++*******+++.....
-	 * .+++++|+++++++*********+++.....
-	 * .++***I****************+++.....
-	 * .++*******************+++......
-	 * .+++*****************+++.......
-	 * ..+++***************+++........
-	 * ....+++**********+++...........
-	 * ......++++++++++++.............
-	 * ...............................
-	 *
-	 * O = outside edge pixel
-	 * \
-	 *  G = gradient pixel
-	 *  |
-	 *  I = inside edge pixel
-	 * 
-	 *   __
-	 *  *note that IO does not need to be a straight line, in fact
-	 *  many cases can arise where straight lines do not work
-	 *  correctly.
-	 *
-	 *     __       __     __
-	 * d.) Pixel color is assigned as |GO| / ( |GI| + |GO| )
-	 *
-	 * The implementation does not compute distance, but the reciprocal of the
-	 * distance. This is done to avoid having to compute a square root, as a
-	 * reciprocal square root can be computed faster. Therefore, the code computes
-	 * pixel color as |GI| / (|GI| + |GO|). Since these are reciprocals, GI serves the
-	 * purpose of GO for the proportion calculation.
-	 *
-	 * For the purposes of the minimum distance comparisons, we only check
-	 * the sums-of-squares against eachother, since they are in the same
-	 * mathematical sort-order as if we did go ahead and take square roots
-	 *
-	 * Loop through all gradient pixels.
-	 */
+	DEMDistanceData *data = (DEMDistanceData *)userdata;
+	const int xmin = chunk * DEM_COLUMN_CHUNK;
+	const int xmax = min_ii(xmin + DEM_COLUMN_CHUNK, data->width);
+
+	do_edgeDistanceColumns(data->lres, data->idist, 4, data->width, data->height, xmin, xmax);
+	do_edgeDistanceColumns(data->lres, data->odist, 3, data->width, data->height, xmin, xmax);
+}
+
+/* combine the column distances of a row into squared euclidean distances (lower envelope of parabolas) */
+static void do_edgeDistanceRow(unsigned int *row, int width, int *v, double *z, double *f)
+{
+	int q, k = -1;
 
-	for (x = gsz - 1; x >= 0; x--) {
-		gradientFillOffset = x << 1;
-		t = gbuf[gradientFillOffset];            // calculate column of pixel indexed by gbuf[x]
-		fsz = gbuf[gradientFillOffset + 1];      // calculate row of pixel indexed by gbuf[x]
-		dmin = 0xffffffff;                       // reset min distance to edge pixel
-		for (a = outerEdgeOffset + osz - 1; a >= outerEdgeOffset; a--) {   // loop through all outer edge buffer pixels
-			ud = a << 1;
-			dy = t - gbuf[ud];                   // set dx to gradient pixel column - outer edge pixel row
-			dx = fsz - gbuf[ud + 1];             // set dy to gradient pixel row - outer edge pixel column
-			ud = dx * dx + dy * dy;              // compute sum of squares
-			if (ud < dmin) {                     // if our new sum of squares is less than the current minimum
-				dmin = ud;                       // set a new minimum equal to the new lower value
+	for (q = 0; q < width; q++) {
+		double s = 0.0;
+		if (row[q] == DEM_DIST_INF) {
+			continue;
+		}
+		f[q] = (double)row[q] * (double)row[q];
+		while (k >= 0) {
+			s = ((f[q] + (double)q * q) - (f[v[k]] + (double)v[k] * v[k])) / (2.0 * (q - v[k]));
+			if (s > z[k]) {
+				break;
 			}
+			k--;
 		}
-		odist = (float)(dmin);                   // cast outer min to a float
-		rsf = odist * 0.5f;                      //
-		rsl = *(unsigned int *)&odist;           // use some peculiar properties of the way bits are stored
-		rsl = 0x5f3759df - (rsl >> 1);           // in floats vs. unsigned ints to compute an approximate
-		odist = *(float *)&rsl;                  // reciprocal square root
-		odist = odist * (rsopf - (rsf * odist * odist));   // -- ** this line can be iterated for more accuracy ** --
-		dmin = 0xffffffff;                       // reset min distance to edge pixel
-		for (a = innerEdgeOffset + isz - 1; a >= innerEdgeOffset; a--) {   // loop through all inside edge pixels
-			ud = a << 1;
-			dy = t - gbuf[ud];         // compute delta in Y from gradient pixel to inside edge pixel
-			dx = fsz - gbuf[ud + 1];     // compute delta in X from gradient pixel to inside edge pixel
-			ud = dx * dx + dy * dy;        // compute sum of squares
-			if (ud < dmin) {          // if our new sum of squares is less than the current minimum we've found
-				dmin = ud;           // set a new minimum equal to the new lower value
-			}
+		k++;
+		v[k] = q;
+		z[k] = (k == 0) ? -DBL_MAX : s;
+	}
+
+	if (k < 0) {
+		/* no edge pixels in any column, row stays at infinite distance */
+		return;
+	}
+
+	for (q = 0; q < width; q++) {
+		int j = 0;
+		while (j < k && z[j + 1] < q) {
+			j++;
 		}
-		idist = (float)(dmin);                   // cast inner min to a float
-		rsf = idist * 0.5f;                      //
-		rsl = *(unsigned int *)&idist;           //
-		rsl = 0x5f3759df - (rsl >> 1);           // see notes above
-		idist = *(float *)&rsl;                  //
-		idist = idist * (rsopf - (rsf * idist * idist));   //
-		/*
-		 * Note once again that since we are using reciprocals of distance values our
-		 * proportion is already the correct intensity, and does not need to be
-		 * subtracted from 1.0 like it would have if we used real distances.
-		 */
-		
-		/*
-		 * Here we reconstruct the pixel's memory location in the CompBuf by
-		 * Pixel Index = Pixel Column + ( Pixel Row * Row Width )
-		 */
-		res[gbuf[gradientFillOffset + 1] + (gbuf[gradientFillOffset] * rw)] = (idist / (idist + odist));    //set intensity
+		const double d = (double)(q - v[j]) * (q - v[j]) + f[v[j]];
+		row[q] = (d >= (double)DEM_DIST_INF) ? DEM_DIST_INF : (unsigned int)d;
 	}
-	
+}
+
+static void do_edgeDistanceRowsTask(void *userdata, const int y)
+{
+	DEMDistanceData *data = (DEMDistanceData *)userdata;
+	const int width = data->width;
+	int *v = (int *)MEM_mallocN(sizeof(int) * width, __func__);
+	double *z = (double *)MEM_mallocN(sizeof(double) * width, __func__);
+	double *f = (double *)MEM_mallocN(sizeof(double) * width, __func__);
+
+	do_edgeDistanceRow(&data->idist[y * width], width, v, z, f);
+	do_edgeDistanceRow(&data->odist[y * width], width, v, z, f);
+
+	MEM_freeN(v);
+	MEM_freeN(z);
+	MEM_freeN(f);
+}
+
+/*
+ * The implementation does not compute distance, but the reciprocal of the
+ * distance. This is done to avoid having to compute a square root, as a
+ * reciprocal square root can be computed faster. Therefore, the code computes
+ * pixel color as |GI| / (|GI| + |GO|). Since these are reciprocals, GI serves the
+ * purpose of GO for the proportion calculation.
+ */
+static float do_reciprocalDistance(unsigned int dmin)
+{
+	const float rsopf = 1.5f;                // constant float used for finding fast 1.0/sqrt
+	float dist = (float)(dmin);              // cast min to a float
+	float rsf = dist * 0.5f;                 //
+	unsigned int rsl = *(unsigned int *)&dist;   // use some peculiar properties of the way bits are stored
+	rsl = 0x5f3759df - (rsl >> 1);           // in floats vs. unsigned ints to compute an approximate
+	dist = *(float *)&rsl;                   // reciprocal square root
+	return dist * (rsopf - (rsf * dist * dist));   // -- ** this line can be iterated for more accuracy ** --
+}
+
+static void do_fillGradientTask(void *userdata, const int y)
+{
+	DEMDistanceData *data = (DEMDistanceData *)userdata;
+	const int offset = y * data->width;
+
+	for (int x = 0; x < data->width; x++) {
+		const int a = offset + x;
+		if (data->lres[a] == 2) {                // it is a gradient pixel flagged by 2
+			const float odist = do_reciprocalDistance(data->odist[a]);
+			const float idist = do_reciprocalDistance(data->idist[a]);
+			/*
+			 * Note once again that since we are using reciprocals of distance values our
+			 * proportion is already the correct intensity, and does not need to be
+			 * subtracted from 1.0 like it would have if we used real distances.
+			 */
+			data->res[a] = (idist / (idist + odist));    //set intensity
+		}
+		else if (data->lres[a] == 3) {           // it is an outer edge pixel flagged by 3
+			data->res[a] = 0.0f;
+		}
+		else if (data->lres[a] == 4) {           // it is an inner edge pixel flagged by 4
+			data->res[a] = 1.0f;
+		}
+	}
+}
+
+static void do_fillGradientBuffer(int width, int height, unsigned int *lres, float *res)
+{
+	DEMDistanceData data;
+	const bool use_threading = (width * height) > 10000;
+
+	data.lres = lres;
+	data.res = res;
+	data.width = width;
+	data.height = height;
+	data.idist = (unsigned int *)MEM_mallocN(sizeof(unsigned int) * width * height, "DEM inner distance");
+	data.odist = (unsigned int *)MEM_mallocN(sizeof(unsigned int) * width * height, "DEM outer distance");
+
+	BLI_task_parallel_range(0, (width + DEM_COLUMN_CHUNK - 1) / DEM_COLUMN_CHUNK, &data,
+	                        do_edgeDistanceColumnsTask, use_threading);
+	BLI_task_parallel_range(0, height, &data, do_edgeDistanceRowsTask, use_threading);
+	BLI_task_parallel_range(0, height, &data, do_fillGradientTask, use_threading);
+
+	MEM_freeN(data.idist);
+	MEM_freeN(data.odist);
 }
 
 // end of copy
@@ -1138,16 +1127,11 @@ void DoubleEdgeMaskOperation::doDoubleEdgeMask(float *imask, float *omask, float
 	
 	int rw;                            // rw = pixel row width
 	int t;                             // t = total number of pixels in buffer - 1 (used for loop starts)
-	int fsz;                           // size of the frame
 	
 	unsigned int isz = 0;                // size (in pixels) of inside edge pixel index buffer
 	unsigned int osz = 0;                // size (in pixels) of outside edge pixel index buffer
 	unsigned int gsz = 0;                // size (in pixels) of gradient pixel index buffer
 	unsigned int rsize[3];               // size storage to pass to helper functions
-	unsigned int innerEdgeOffset = 0;    // offset into final buffer where inner edge pixel indexes start
-	unsigned int outerEdgeOffset = 0;    // offset into final buffer where outer edge pixel indexes start
-	
-	unsigned short *gbuf;              // gradient/inner/outer pixel location index buffer
 	
 	if (true) {                    // if both input sockets have some data coming in...
 		
@@ -1211,17 +1195,7 @@ void DoubleEdgeMaskOperation::doDoubleEdgeMask(float *imask, float *omask, float
 			do_allEdgeDetection(t, rw, limask, lomask, lres, res, rsize, isz, osz, gsz);
 		}
 		
-		isz = rsize[0];                          // set edge and gradient buffer sizes once again...
-		osz = rsize[1];                          // the sizes in rsize[] may have been modified
-		gsz = rsize[2];                          // by the do_*EdgeDetection() function.
-		
-		fsz = gsz + isz + osz;                                   // calculate size of pixel index buffer needed
-		gbuf = (unsigned short *)MEM_callocN(sizeof(unsigned short) * fsz * 2, "DEM"); // allocate edge/gradient pixel index buffer
-		
-		do_createEdgeLocationBuffer(t, rw, lres, res, gbuf, &innerEdgeOffset, &outerEdgeOffset, isz, gsz);
-		do_fillGradientBuffer(rw, res, gbuf, isz, osz, gsz, innerEdgeOffset, outerEdgeOffset);
-		
-		MEM_freeN(gbuf);                         // free the gradient index buffer
+		do_fillGradientBuffer(rw, this->getHeight(), lres, res);
 	}
 }
 
@@ -1269,7 +1243,8 @@ void *DoubleEdgeMaskOperation::initializeTileData(rcti *rect)
 	if (this->m_cachedInstance == NULL) {
 		MemoryBuffer *innerMask = (MemoryBuffer *)this->m_inputInnerMask->initializeTileData(rect);
 		MemoryBuffer *outerMask = (MemoryBuffer *)this->m_inputOuterMask->initializeTileData(rect);
-		float *data = (float *)MEM_mallocN(sizeof(float) * this->getWidth() * this->getHeight(), __func__);
+		/* pixels outside of both masks aren't written by the edge detection */
+		float *data = (float *)MEM_callocN(sizeof(float) * this->getWidth() * this->getHeight(), __func__);
 		float *imask = innerMask->getBuffer();
 		float *omask = outerMask->getBuffer();
 		doDoubleEdgeMask(imask, omask, data);
@@ -0,0 +1,649 @@
+/*
+ * Copyright 2016, Blender Foundation.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#include "BLI_math_base.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
+#include "BLI_utildefines.h"
+}
+
+#include "COM_FFTConvolution.h"
+
+/* kernels with less elements are faster to sum per pixel */
+#define FFT_MIN_KERNEL_AREA (20 * 20)
+/* preferred size of the transforms, larger kernels use twice their size */
+#define FFT_BLOCK_SIZE 1024
+/* transform sizes are products of these radices only */
+#define FFT_MAX_RADIX 5
+#define FFT_MAX_FACTORS 32
+
+/* ******** Mixed radix FFT ******** */
+
+typedef struct FFTComplex {
+	float re, im;
+} FFTComplex;
+
+typedef struct FFTPlan {
+	int length;
+	/* pairs of radix and length of the sub-transforms, ending at length 1 */
+	int factors[2 * FFT_MAX_FACTORS];
+	/* exp(-2 * pi * i * k / length), conjugated for the inverse transform */
+	FFTComplex *twiddles;
+	bool inverse;
+} FFTPlan;
+
+BLI_INLINE FFTComplex fft_mul(const FFTComplex a, const FFTComplex b)
+{
+	FFTComplex r;
+	r.re = a.re * b.re - a.im * b.im;
+	r.im = a.re * b.im + a.im * b.re;
+	return r;
+}
+
+BLI_INLINE FFTComplex fft_add(const FFTComplex a, const FFTComplex b)
+{
+	FFTComplex r;
+	r.re = a.re + b.re;
+	r.im = a.im + b.im;
+	return r;
+}
+
+BLI_INLINE FFTComplex fft_sub(const FFTComplex a, const FFTComplex b)
+{
+	FFTComplex r;
+	r.re = a.re - b.re;
+	r.im = a.im - b.im;
+	return r;
+}
+
+/* smallest product of 2, 3 and 5 that is at least n */
+static int fft_good_size(int n)
+{
+	/* there is always a power of two below 2 * n */
+	int best = 2 * n;
+	for (int p2 = 1; p2 < best; p2 *= 2) {
+		for (int p3 = p2; p3 < best; p3 *= 3) {
+			for (int p5 = p3; p5 < best; p5 *= 5) {
+				if (p5 >= n) {
+					best = p5;
+				}
+			}
+		}
+	}
+	return best;
+}
+
+static void fft_plan_init(FFTPlan *plan, int length, bool inverse)
+{
+	const double sign = inverse ? 1.0 : -1.0;
+	int n = length, p = 4, index = 0;
+
+	while (n > 1) {
+		while (n % p) {
+			p = (p == 4) ? 2 : (p == 2) ? 3 : p + 2;
+		}
+		BLI_assert(p <= FFT_MAX_RADIX && index < 2 * FFT_MAX_FACTORS);
+		n /= p;
+		plan->factors[index++] = p;
+		plan->factors[index++] = n;
+	}
+
+	plan->length = length;
+	plan->inverse = inverse;
+	plan->twiddles = (FFTComplex *)MEM_mallocN(sizeof(FFTComplex) * length, "FFT twiddles");
+	for (int k = 0; k < length; k++) {
+		const double phase = sign * 2.0 * M_PI * k / length;
+		plan->twiddles[k].re = (float)cos(phase);
+		plan->twiddles[k].im = (float)sin(phase);
+	}
+}
+
+static void fft_plan_free(FFTPlan *plan)
+{
+	MEM_freeN(plan->twiddles);
+}
+
+static void fft_butterfly_2(FFTComplex *out, const FFTPlan *plan, int fstride, int m)
+{
+	const FFTComplex *tw = plan->twiddles;
+	for (int k = 0; k < m; k++, tw += fstride) {
+		const FFTComplex t = fft_mul(out[k + m], *tw);
+		out[k + m] = fft_sub(out[k], t);
+		out[k] = fft_add(out[k], t);
+	}
+}
+
+static void fft_butterfly_3(FFTComplex *out, const FFTPlan *plan, int fstride, int m)
+{
+	const FFTComplex *tw = plan->twiddles;
+	const float epi3 = tw[fstride * m].im;
+
+	for (int k = 0; k < m; k++) {
+		const FFTComplex s1 = fft_mul(out[k + m], tw[k * fstride]);
+		const FFTComplex s2 = fft_mul(out[k + 2 * m], tw[2 * k * fstride]);
+		const FFTComplex s3 = fft_add(s1, s2);
+		FFTComplex s0 = fft_sub(s1, s2);
+		FFTComplex mid;
+
+		mid.re = out[k].re - 0.5f * s3.re;
+		mid.im = out[k].im - 0.5f * s3.im;
+		s0.re *= epi3;
+		s0.im *= epi3;
+
+		out[k] = fft_add(out[k], s3);
+		out[k + m].re = mid.re - s0.im;
+		out[k + m].im = mid.im + s0.re;
+		out[k + 2 * m].re = mid.re + s0.im;
+		out[k + 2 * m].im = mid.im - s0.re;
+	}
+}
+
+static void fft_butterfly_4(FFTComplex *out, const FFTPlan *plan, int fstride, int m)
+{
+	const FFTComplex *tw = plan->twiddles;
+
+	for (int k = 0; k < m; k++) {
+		const FFTComplex s0 = fft_mul(out[k + m], tw[k * fstride]);
+		const FFTComplex s1 = fft_mul(out[k + 2 * m], tw[2 * k * fstride]);
+		const FFTComplex s2 = fft_mul(out[k + 3 * m], tw[3 * k * fstride]);
+		const FFTComplex s3 = fft_add(s0, s2);
+		const FFTComplex s4 = fft_sub(s0, s2);
+		const FFTComplex s5 = fft_sub(out[k], s1);
+		const FFTComplex a = fft_add(out[k], s1);
+
+		out[k] = fft_add(a, s3);
+		out[k + 2 * m] = fft_sub(a, s3);
+		if (plan->inverse) {
+			out[k + m].re = s5.re - s4.im;
+			out[k + m].im = s5.im + s4.re;
+			out[k + 3 * m].re = s5.re + s4.im;
+			out[k + 3 * m].im = s5.im - s4.re;
+		}
+		else {
+			out[k + m].re = s5.re + s4.im;
+			out[k + m].im = s5.im - s4.re;
+			out[k + 3 * m].re = s5.re - s4.im;
+			out[k + 3 * m].im = s5.im + s4.re;
+		}
+	}
+}
+
+static void fft_butterfly_generic(FFTComplex *out, const FFTPlan *plan, int fstride, int m, int p)
+{
+	const FFTComplex *tw = plan->twiddles;
+	const int n = plan->length;
+	FFTComplex scratch[FFT_MAX_RADIX];
+
+	for (int u = 0; u < m; u++) {
+		for (int q = 0; q < p; q++) {
+			scratch[q] = out[u + q * m];
+		}
+		for (int q = 0, k = u; q < p; q++, k += m) {
+			FFTComplex sum = scratch[0];
+			int twiddle = 0;
+			for (int r = 1; r < p; r++) {
+				twiddle += fstride * k;
+				if (twiddle >= n) {
+					twiddle -= n;
+				}
+				sum = fft_add(sum, fft_mul(scratch[r], tw[twiddle]));
+			}
+			out[k] = sum;
+		}
+	}
+}
+
+/* recursive decimation in time, the input is read with a stride of fstride elements */
+static void fft_work(FFTComplex *out, const FFTComplex *in, const FFTPlan *plan, int fstride, const int *factors)
+{
+	const int p = factors[0];
+	const int m = factors[1];
+
+	if (m == 1) {
+		for (int q = 0; q < p; q++) {
+			out[q] = in[q * fstride];
+		}
+	}
+	else {
+		for (int q = 0; q < p; q++) {
+			fft_work(out + q * m, in + q * fstride, plan, fstride * p, factors + 2);
+		}
+	}
+
+	switch (p) {
+		case 2: fft_butterfly_2(out, plan, fstride, m); break;
+		case 3: fft_butterfly_3(out, plan, fstride, m); break;
+		case 4: fft_butterfly_4(out, plan, fstride, m); break;
+		default: fft_butterfly_generic(out, plan, fstride, m, p); break;
+	}
+}
+
+/* unnormalized transform, out and in can't be the same array */
+static void fft_transform(FFTComplex *out, const FFTComplex *in, const FFTPlan *plan)
+{
+	if (plan->length == 1) {
+		out[0] = in[0];
+	}
+	else {
+		fft_work(out, in, plan, 1, plan->factors);
+	}
+}
+
+/* ******** Convolution ******** */
+
+typedef struct FFTConvolutionData {
+	/* spectrum of the current block, fft_width * fft_height */
+	FFTComplex *data;
+	int fft_width, fft_height;
+	FFTPlan plan_x, plan_y, plan_inverse_x, plan_inverse_y;
+	bool inverse;
+
+	/* source of the current block, image or kernel */
+	const float *source;
+	int source_width, source_height, source_channels;
+	int block_x, block_y, block_width, block_height;
+
+	/* channels of the source packed in the real and imaginary part, -1 for unused */
+	int channel1, channel2;
+	const FFTComplex *spectrum1, *spectrum2;
+
+	/* spectra of the kernel channels, scaled for the inverse transform */
+	FFTComplex *kernel_spectrum1, *kernel_spectrum2;
+	float scale;
+
+	/* result */
+	float *output;
+	int num_channels;
+	int center_x, center_y;
+
+	/* summed area tables of the kernel channels, for normalizing the borders */
+	const double *kernel_sums;
+	int num_kernel_sums, kernel_width, kernel_height;
+
+	int chunk_size;
+} FFTConvolutionData;
+
+static void fft_parallel_range(FFTConvolutionData *data, int total, TaskParallelRangeFunc func)
+{
+	const int num_chunks = min_ii(total, BLI_system_thread_count() * 4);
+	data->chunk_size = (total + num_chunks - 1) / num_chunks;
+	BLI_task_parallel_range(0, (total + data->chunk_size - 1) / data->chunk_size, data, func, num_chunks > 1);
+}
+
+/* fill the rows of the block and transform them */
+static void fft_forward_rows_task(void *userdata, const int chunk)
+{
+	FFTConvolutionData *data = (FFTConvolutionData *)userdata;
+	const int start = chunk * data->chunk_size;
+	const int end = min_ii(start + data->chunk_size, data->fft_height);
+	const int rows = min_ii(data->block_height, data->source_height - data->block_y);
+	const int columns = min_ii(data->block_width, data->source_width - data->block_x);
+	FFTComplex *temp = (FFTComplex *)MEM_mallocN(sizeof(FFTComplex) * data->fft_width, __func__);
+
+	for (int y = start; y < end; y++) {
+		FFTComplex *row = &data->data[y * data->fft_width];
+
+		if (y >= rows) {
+			/* only padding, the transform is zero as well */
+			memset(row, 0, sizeof(FFTComplex) * data->fft_width);
+			continue;
+		}
+
+		const float *src = &data->source[((data->block_y + y) * data->source_width + data->block_x) * data->source_channels];
+		for (int x = 0; x < columns; x++, src += data->source_channels) {
+			temp[x].re = src[data->channel1];
+			temp[x].im = (data->channel2 != -1) ? src[data->channel2] : 0.0f;
+		}
+		memset(&temp[columns], 0, sizeof(FFTComplex) * (data->fft_width - columns));
+
+		fft_transform(row, temp, &data->plan_x);
+	}
+
+	MEM_freeN(temp);
+}
+
+static void fft_columns_task(void *userdata, const int chunk)
+{
+	FFTConvolutionData *data = (FFTConvolutionData *)userdata;
+	const int start = chunk * data->chunk_size;
+	const int end = min_ii(start + data->chunk_size, data->fft_width);
+	const FFTPlan *plan = data->inverse ? &data->plan_inverse_y : &data->plan_y;
+	FFTComplex *temp = (FFTComplex *)MEM_mallocN(sizeof(FFTComplex) * 2 * data->fft_height, __func__);
+	FFTComplex *column = temp + data->fft_height;
+
+	for (int x = start; x < end; x++) {
+		FFTComplex *elem = &data->data[x];
+		for (int y = 0; y < data->fft_height; y++, elem += data->fft_width) {
+			temp[y] = *elem;
+		}
+
+		fft_transform(column, temp, plan);
+
+		elem = &data->data[x];
+		for (int y = 0; y < data->fft_height; y++, elem += data->fft_width) {
+			*elem = column[y];
+		}
+	}
+
+	MEM_freeN(temp);
+}
+
+/**
+ * Multiply the spectrum of the block with the spectra of the kernel.
+ *
+ * The spectrum Z of two real channels a + i * b is split using its symmetry:
+ * A(u) = (Z(u) + conj(Z(-u))) / 2 and B(u) = (Z(u) - conj(Z(-u))) / 2i,
+ * the result A * Ka + i * B * Kb transforms back to the two convolved channels.
+ * Elements u and -u depend on each other, so they are handled together.
+ */
+static void fft_multiply_task(void *userdata, const int chunk)
+{
+	FFTConvolutionData *data = (FFTConvolutionData *)userdata;
+	const int fft_width = data->fft_width;
+	const int fft_height = data->fft_height;
+	const int start = chunk * data->chunk_size;
+	const int end = min_ii(start + data->chunk_size, fft_height / 2 + 1);
+
+	for (int v = start; v < end; v++) {
+		const int v2 = (fft_height - v) % fft_height;
+
+		if (data->spectrum1 == data->spectrum2) {
+			/* same kernel for both channels, no need to split them */
+			for (int row = 0; row < ((v == v2) ? 1 : 2); row++) {
+				const int offset = ((row == 0) ? v : v2) * fft_width;
+				for (int u = 0; u < fft_width; u++) {
+					data->data[offset + u] = fft_mul(data->data[offset + u], data->spectrum1[offset + u]);
+				}
+			}
+			continue;
+		}
+
+		for (int u = 0; u < fft_width; u++) {
+			const int u2 = (fft_width - u) % fft_width;
+			const int index1 = v * fft_width + u;
+			const int index2 = v2 * fft_width + u2;
+
+			if (v == v2 && u > u2) {
+				/* done together with its mirrored element */
+				continue;
+			}
+
+			const FFTComplex z1 = data->data[index1];
+			const FFTComplex z2 = data->data[index2];
+			FFTComplex a, b, ra, rb;
+
+			a.re = 0.5f * (z1.re + z2.re);
+			a.im = 0.5f * (z1.im - z2.im);
+			b.re = 0.5f * (z1.im + z2.im);
+			b.im = 0.5f * (z2.re - z1.re);
+
+			ra = fft_mul(a, data->spectrum1[index1]);
+			rb = fft_mul(b, data->spectrum2[index1]);
+			data->data[index1].re = ra.re - rb.im;
+			data->data[index1].im = ra.im + rb.re;
+
+			a.im = -a.im;
+			b.im = -b.im;
+			ra = fft_mul(a, data->spectrum1[index2]);
+			rb = fft_mul(b, data->spectrum2[index2]);
+			data->data[index2].re = ra.re - rb.im;
+			data->data[index2].im = ra.im + rb.re;
+		}
+	}
+}
+
+/* transform the rows back and add them to the output (overlap-add) */
+static void fft_inverse_rows_task(void *userdata, const int chunk)
+{
+	FFTConvolutionData *data = (FFTConvolutionData *)userdata;
+	const int start = chunk * data->chunk_size;
+	const int end = min_ii(start + data->chunk_size, data->fft_height);
+	const int xmin = max_ii(0, data->center_x - data->block_x);
+	const int xmax = min_ii(data->fft_width, data->source_width + data->center_x - data->block_x);
+	FFTComplex *temp = (FFTComplex *)MEM_mallocN(sizeof(FFTComplex) * data->fft_width, __func__);
+
+	for (int y = start; y < end; y++) {
+		const int yy = data->block_y + y - data->center_y;
+		if (yy < 0 || yy >= data->source_height) {
+			continue;
+		}
+
+		fft_transform(temp, &data->data[y * data->fft_width], &data->plan_inverse_x);
+
+		float *dst = &data->output[(yy * data->source_width + data->block_x - data->center_x + xmin) * 4];
+		for (int x = xmin; x < xmax; x++, dst += 4) {
+			dst[data->channel1] += temp[x].re;
+			if (data->channel2 != -1) {
+				dst[data->channel2] += temp[x].im;
+			}
+		}
+	}
+
+	MEM_freeN(temp);
+}
+
+
+/* split the spectrum of two packed kernel channels, see fft_multiply_task */
+static void fft_split_kernel_task(void *userdata, const int chunk)
+{
+	FFTConvolutionData *data = (FFTConvolutionData *)userdata;
+	const int fft_width = data->fft_width;
+	const int fft_height = data->fft_height;
+	const int start = chunk * data->chunk_size;
+	const int end = min_ii(start + data->chunk_size, fft_height);
+	const float scale = data->scale;
+
+	for (int v = start; v < end; v++) {
+		const int v2 = (fft_height - v) % fft_height;
+		for (int u = 0; u < fft_width; u++) {
+			const int u2 = (fft_width - u) % fft_width;
+			const int index = v * fft_width + u;
+			const FFTComplex z1 = data->data[index];
+			const FFTComplex z2 = data->data[v2 * fft_width + u2];
+
+			if (data->channel2 == -1) {
+				data->kernel_spectrum1[index].re = z1.re * scale;
+				data->kernel_spectrum1[index].im = z1.im * scale;
+			}
+			else {
+				data->kernel_spectrum1[index].re = 0.5f * (z1.re + z2.re) * scale;
+				data->kernel_spectrum1[index].im = 0.5f * (z1.im - z2.im) * scale;
+				data->kernel_spectrum2[index].re = 0.5f * (z1.im + z2.im) * scale;
+				data->kernel_spectrum2[index].im = 0.5f * (z2.re - z1.re) * scale;
+			}
+		}
+	}
+}
+
+static void fft_normalize_task(void *userdata, const int chunk)
+{
+	FFTConvolutionData *data = (FFTConvolutionData *)userdata;
+	const int start = chunk * data->chunk_size;
+	const int end = min_ii(start + data->chunk_size, data->source_height);
+	const int stride = data->kernel_width + 1;
+	const int table_size = stride * (data->kernel_height + 1);
+
+	for (int y = start; y < end; y++) {
+		/* range of kernel elements overlapping the image */
+		const int j0 = max_ii(0, y + data->center_y - data->source_height + 1);
+		const int j1 = min_ii(data->kernel_height, y + data->center_y + 1);
+		float *dst = &data->output[y * data->source_width * 4];
+
+		for (int x = 0; x < data->source_width; x++, dst += 4) {
+			const int i0 = max_ii(0, x + data->center_x - data->source_width + 1);
+			const int i1 = min_ii(data->kernel_width, x + data->center_x + 1);
+
+			for (int ch = 0; ch < data->num_channels; ch++) {
+				const double *sums = &data->kernel_sums[(data->num_kernel_sums == 1 ? 0 : ch) * table_size];
+				const double sum = sums[j1 * stride + i1] - sums[j1 * stride + i0] -
+				                   sums[j0 * stride + i1] + sums[j0 * stride + i0];
+				dst[ch] *= (float)(1.0 / sum);
+			}
+		}
+	}
+}
+
+/* forward transform of the current block */
+static void fft_forward(FFTConvolutionData *data)
+{
+	fft_parallel_range(data, data->fft_height, fft_forward_rows_task);
+	data->inverse = false;
+	fft_parallel_range(data, data->fft_width, fft_columns_task);
+}
+
+/* fit the image in a single block when possible, otherwise use blocks of the preferred size */
+static void fft_block_size(int size, int kernel_size, int *r_block_size, int *r_fft_size)
+{
+	int fft_size = fft_good_size(size + kernel_size - 1);
+	const int preferred_size = fft_good_size(max_ii(FFT_BLOCK_SIZE, 2 * kernel_size));
+
+	if (fft_size > preferred_size) {
+		fft_size = preferred_size;
+	}
+
+	*r_fft_size = fft_size;
+	*r_block_size = min_ii(size, fft_size - kernel_size + 1);
+}
+
+bool FFTConvolution::isEfficient(int kernelWidth, int kernelHeight)
+{
+	return kernelWidth * kernelHeight >= FFT_MIN_KERNEL_AREA;
+}
+
+void FFTConvolution::convolve(float *output, const float *image, int width, int height,
+                              const float *kernel, int kernelWidth, int kernelHeight, int kernelChannels,
+                              int centerX, int centerY, int numChannels, bool normalizeBorders)
+{
+	FFTConvolutionData data;
+	FFTComplex *spectra[4] = {NULL, NULL, NULL, NULL};
+	const int num_spectra = (kernelChannels == 1) ? 1 : numChannels;
+	int block_width, block_height;
+
+	BLI_assert(kernelChannels == 1 || kernelChannels == 4);
+	BLI_assert(numChannels >= 1 && numChannels <= 4);
+
+	memset(&data, 0, sizeof(data));
+	fft_block_size(width, kernelWidth, &block_width, &data.fft_width);
+	fft_block_size(height, kernelHeight, &block_height, &data.fft_height);
+	fft_plan_init(&data.plan_x, data.fft_width, false);
+	fft_plan_init(&data.plan_y, data.fft_height, false);
+	fft_plan_init(&data.plan_inverse_x, data.fft_width, true);
+	fft_plan_init(&data.plan_inverse_y, data.fft_height, true);
+	data.data = (FFTComplex *)MEM_mallocN(sizeof(FFTComplex) * data.fft_width * data.fft_height, "FFT block");
+	data.scale = 1.0f / ((float)data.fft_width * (float)data.fft_height);
+
+	/* spectra of the kernel, the same for every block */
+	data.source = kernel;
+	data.source_width = data.block_width = kernelWidth;
+	data.source_height = data.block_height = kernelHeight;
+	data.source_channels = kernelChannels;
+	for (int ch = 0; ch < num_spectra; ch += 2) {
+		data.channel1 = ch;
+		data.channel2 = (ch + 1 < num_spectra) ? ch + 1 : -1;
+		fft_forward(&data);
+
+		spectra[ch] = (FFTComplex *)MEM_mallocN(sizeof(FFTComplex) * data.fft_width * data.fft_height, "FFT kernel");
+		data.kernel_spectrum1 = spectra[ch];
+		if (data.channel2 != -1) {
+			spectra[ch + 1] = (FFTComplex *)MEM_mallocN(sizeof(FFTComplex) * data.fft_width * data.fft_height, "FFT kernel");
+			data.kernel_spectrum2 = spectra[ch + 1];
+		}
+		fft_parallel_range(&data, data.fft_height, fft_split_kernel_task);
+	}
+
+	for (int y = 0; y < height; y++) {
+		float *dst = &output[y * width * 4];
+		for (int x = 0; x < width; x++, dst += 4) {
+			for (int ch = 0; ch < numChannels; ch++) {
+				dst[ch] = 0.0f;
+			}
+		}
+	}
+
+	/* overlap-add the convolved blocks */
+	data.source = image;
+	data.source_width = width;
+	data.source_height = height;
+	data.source_channels = 4;
+	data.block_width = block_width;
+	data.block_height = block_height;
+	data.output = output;
+	data.num_channels = numChannels;
+	data.center_x = centerX;
+	data.center_y = centerY;
+	for (data.block_y = 0; data.block_y < height; data.block_y += block_height) {
+		for (data.block_x = 0; data.block_x < width; data.block_x += block_width) {
+			for (int ch = 0; ch < numChannels; ch += 2) {
+				data.channel1 = ch;
+				data.channel2 = (ch + 1 < numChannels) ? ch + 1 : -1;
+				data.spectrum1 = spectra[num_spectra == 1 ? 0 : ch];
+				data.spectrum2 = (num_spectra == 1 || data.channel2 == -1) ? data.spectrum1 : spectra[ch + 1];
+
+				fft_forward(&data);
+				fft_parallel_range(&data, data.fft_height / 2 + 1, fft_multiply_task);
+				data.inverse = true;
+				fft_parallel_range(&data, data.fft_width, fft_columns_task);
+				fft_parallel_range(&data, data.fft_height, fft_inverse_rows_task);
+			}
+		}
+	}
+
+	if (normalizeBorders) {
+		const int num_sums = (kernelChannels == 1) ? 1 : numChannels;
+		const int stride = kernelWidth + 1;
+		const int table_size = stride * (kernelHeight + 1);
+		double *sums = (double *)MEM_callocN(sizeof(double) * table_size * num_sums, "FFT kernel sums");
+
+		for (int ch = 0; ch < num_sums; ch++) {
+			double *table = &sums[ch * table_size];
+			for (int j = 0; j < kernelHeight; j++) {
+				const float *src = &kernel[j * kernelWidth * kernelChannels + ch];
+				double row_sum = 0.0;
+				for (int i = 0; i < kernelWidth; i++, src += kernelChannels) {
+					row_sum += *src;
+					table[(j + 1) * stride + i + 1] = table[j * stride + i + 1] + row_sum;
+				}
+			}
+		}
+
+		data.kernel_sums = sums;
+		data.num_kernel_sums = num_sums;
+		data.kernel_width = kernelWidth;
+		data.kernel_height = kernelHeight;
+		fft_parallel_range(&data, height, fft_normalize_task);
+
+		MEM_freeN(sums);
+	}
+
+	for (int ch = 0; ch < 4; ch++) {
+		if (spectra[ch]) {
+			MEM_freeN(spectra[ch]);
+		}
+	}
+	MEM_freeN(data.data);
+	fft_plan_free(&data.plan_x);
+	fft_plan_free(&data.plan_y);
+	fft_plan_free(&data.plan_inverse_x);
+	fft_plan_free(&data.plan_inverse_y);
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright 2016, Blender Foundation.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef _COM_FFTConvolution_h_
+#define _COM_FFTConvolution_h_
+
+/**
+ * @brief convolution of an image with a fixed kernel using the fast fourier transform
+ *
+ * The image is split in blocks that are convolved separately and added together (overlap-add),
+ * so the transforms stay small even for large images. The transform sizes are products of
+ * 2, 3 and 5 instead of powers of two, which keeps the padding around the blocks low.
+ * Rows and columns of the transforms are calculated by multiple threads.
+ *
+ * Two real channels are packed in a single complex transform, so an RGBA image only
+ * needs two forward and two inverse transforms per block.
+ */
+class FFTConvolution {
+public:
+	/**
+	 * @brief is the kernel large enough to make the FFT faster than summing it per pixel
+	 */
+	static bool isEfficient(int kernelWidth, int kernelHeight);
+
+	/**
+	 * @brief convolve an image with a kernel
+	 *
+	 * output(x, y) = sum(kernel(i, j) * image(x + centerX - i, y + centerY - j)),
+	 * pixels outside of the image are zero.
+	 *
+	 * @param output: result, width * height pixels of 4 floats, only the convolved channels are written
+	 * @param image: input, width * height pixels of 4 floats
+	 * @param kernel: kernelWidth * kernelHeight elements of kernelChannels (1 or 4) floats.
+	 * a single channel kernel is used for all channels of the image.
+	 * @param numChannels: number of channels of the image to convolve (1 to 4)
+	 * @param normalizeBorders: divide the result by the sum of the kernel elements that
+	 * overlap the image, so the borders don't darken; the result of summing the kernel per pixel
+	 * and dividing by the accumulated weights.
+	 */
+	static void convolve(float *output, const float *image, int width, int height,
+	                     const float *kernel, int kernelWidth, int kernelHeight, int kernelChannels,
+	                     int centerX, int centerY, int numChannels, bool normalizeBorders);
+};
+
+#endif
@@ -28,6 +28,7 @@ GammaOperation::GammaOperation() : NodeOperation()
 	this->addInputSocket(COM_DT_COLOR);
 	this->addInputSocket(COM_DT_VALUE);
 	this->addOutputSocket(COM_DT_COLOR);
+	this->setSpanSupport(true);
 	this->m_inputProgram = NULL;
 	this->m_inputGammaProgram = NULL;
 }
@@ -53,6 +54,24 @@ void GammaOperation::executePixelSampled(float output[4], float x, float y, Pixe
 	output[3] = inputValue[3];
 }
 
+void GammaOperation::executeSpan(float *output, int x, int y, int length)
+{
+	float inputValue[COM_SPAN_MAX_LENGTH * 4];
+	float inputGamma[COM_SPAN_MAX_LENGTH * 4];
+
+	this->m_inputProgram->readSpan(inputValue, x, y, length);
+	this->m_inputGammaProgram->readSpan(inputGamma, x, y, length);
+
+	for (int i = 0; i < length * 4; i += 4) {
+		const float gamma = inputGamma[i];
+		/* check for negative to avoid nan's */
+		output[i] = inputValue[i] > 0.0f ? powf(inputValue[i], gamma) : inputValue[i];
+		output[i + 1] = inputValue[i + 1] > 0.0f ? powf(inputValue[i + 1], gamma) : inputValue[i + 1];
+		output[i + 2] = inputValue[i + 2] > 0.0f ? powf(inputValue[i + 2], gamma) : inputValue[i + 2];
+		output[i + 3] = inputValue[i + 3];
+	}
+}
+
 void GammaOperation::deinitExecution()
 {
 	this->m_inputProgram = NULL;
@@ -21,6 +21,7 @@
  */
 
 #include "COM_GaussianBokehBlurOperation.h"
+#include "COM_FFTConvolution.h"
 #include "BLI_math.h"
 #include "MEM_guardedalloc.h"
 extern "C" {
@@ -30,6 +31,8 @@ extern "C" {
 GaussianBokehBlurOperation::GaussianBokehBlurOperation() : BlurBaseOperation(COM_DT_COLOR)
 {
 	this->m_gausstab = NULL;
+	this->m_useFFT = false;
+	this->m_convolved = NULL;
 }
 
 void *GaussianBokehBlurOperation::initializeTileData(rcti * /*rect*/)
@@ -39,10 +42,37 @@ void *GaussianBokehBlurOperation::initializeTileData(rcti * /*rect*/)
 		updateGauss();
 	}
 	void *buffer = getInputOperation(0)->initializeTileData(NULL);
+	if (this->m_useFFT && this->m_convolved == NULL) {
+		this->m_convolved = convolveFFT((MemoryBuffer *)buffer);
+	}
 	unlockMutex();
 	return buffer;
 }
 
+MemoryBuffer *GaussianBokehBlurOperation::convolveFFT(MemoryBuffer *inputBuffer)
+{
+	const int width = 2 * this->m_radx + 1;
+	const int height = 2 * this->m_rady + 1;
+	float *kernel = (float *)MEM_mallocN(sizeof(float) * width * height, __func__);
+
+	/* executePixel weights the pixel at offset (i - radx, j - rady) with element (i, j),
+	 * convolution needs the filter mirrored */
+	for (int j = 0; j < height; j++) {
+		for (int i = 0; i < width; i++) {
+			kernel[j * width + i] = this->m_gausstab[(height - 1 - j) * width + (width - 1 - i)];
+		}
+	}
+
+	MemoryBuffer *result = new MemoryBuffer(COM_DT_COLOR, inputBuffer->getRect());
+	FFTConvolution::convolve(result->getBuffer(), inputBuffer->getBuffer(),
+	                         inputBuffer->getWidth(), inputBuffer->getHeight(),
+	                         kernel, width, height, 1,
+	                         this->m_radx, this->m_rady, COM_NUM_CHANNELS_COLOR, true);
+	MEM_freeN(kernel);
+
+	return result;
+}
+
 void GaussianBokehBlurOperation::initExecution()
 {
 	BlurBaseOperation::initExecution();
@@ -51,6 +81,9 @@ void GaussianBokehBlurOperation::initExecution()
 
 	if (this->m_sizeavailable) {
 		updateGauss();
+
+		/* a fixed size blur convolves the whole image at once */
+		this->m_useFFT = getStep() == 1 && FFTConvolution::isEfficient(2 * this->m_radx + 1, 2 * this->m_rady + 1);
 	}
 }
 
@@ -116,6 +149,11 @@ void GaussianBokehBlurOperation::updateGauss()
 
 void GaussianBokehBlurOperation::executePixel(float output[4], int x, int y, void *data)
 {
+	if (this->m_convolved) {
+		this->m_convolved->read(output, x, y);
+		return;
+	}
+
 	float tempColor[4];
 	tempColor[0] = 0;
 	tempColor[1] = 0;
@@ -162,6 +200,11 @@ void GaussianBokehBlurOperation::deinitExecution()
 		MEM_freeN(this->m_gausstab);
 		this->m_gausstab = NULL;
 	}
+	if (this->m_convolved) {
+		delete this->m_convolved;
+		this->m_convolved = NULL;
+	}
+	this->m_useFFT = false;
 
 	deinitMutex();
 }
@@ -30,8 +30,15 @@ class GaussianBokehBlurOperation : public BlurBaseOperation {
 private:
 	float *m_gausstab;
 	int m_radx, m_rady;
+	bool m_useFFT;
+	MemoryBuffer *m_convolved;
 	void updateGauss();
 
+	/**
+	 * @brief convolve the whole input with the filter at once, used for large blurs of a fixed size
+	 */
+	MemoryBuffer *convolveFFT(MemoryBuffer *inputBuffer);
+
 public:
 	GaussianBokehBlurOperation();
 	void initExecution();
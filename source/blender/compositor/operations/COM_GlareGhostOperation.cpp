@@ -22,6 +22,7 @@
 
 #include "COM_GlareGhostOperation.h"
 #include "BLI_math.h"
+#include "BLI_task.h"
 #include "COM_FastGaussianBlurOperation.h"
 
 static float smoothMask(float x, float y)
@@ -37,13 +38,75 @@ static float smoothMask(float x, float y)
 	}
 }
 
+typedef struct GlareGhostTaskData {
+	MemoryBuffer *gbuf;
+	MemoryBuffer *tbuf1;
+	MemoryBuffer *tbuf2;
+	const fRGB *cm;
+	const float *scalef;
+	int n;
+} GlareGhostTaskData;
+
+/* first ghosts from the two blurred copies of the input */
+static void glare_ghost_initial_row_task(void *userdata, const int y)
+{
+	GlareGhostTaskData *data = (GlareGhostTaskData *)userdata;
+	MemoryBuffer *gbuf = data->gbuf;
+	const float sc = 2.13f;
+	const float isc = -0.97f;
+	const float v = ((float)y + 0.5f) / (float)gbuf->getHeight();
+	float u, s, t, sm;
+	fRGB c, tc;
+
+	for (int x = 0; x < gbuf->getWidth(); x++) {
+		u = ((float)x + 0.5f) / (float)gbuf->getWidth();
+		s = (u - 0.5f) * sc + 0.5f;
+		t = (v - 0.5f) * sc + 0.5f;
+		data->tbuf1->readBilinear(c, s * gbuf->getWidth(), t * gbuf->getHeight());
+		sm = smoothMask(s, t);
+		mul_v3_fl(c, sm);
+		s = (u - 0.5f) * isc + 0.5f;
+		t = (v - 0.5f) * isc + 0.5f;
+		data->tbuf2->readBilinear(tc, s * gbuf->getWidth() - 0.5f, t * gbuf->getHeight() - 0.5f);
+		sm = smoothMask(s, t);
+		madd_v3_v3fl(c, tc, sm);
+
+		gbuf->writePixel(x, y, c);
+	}
+}
+
+/* scaled and color modulated copies of the ghosts of the previous iteration */
+static void glare_ghost_iteration_row_task(void *userdata, const int y)
+{
+	GlareGhostTaskData *data = (GlareGhostTaskData *)userdata;
+	MemoryBuffer *gbuf = data->gbuf;
+	const float v = ((float)y + 0.5f) / (float)gbuf->getHeight();
+	float u, s, t, sm;
+	fRGB c, tc;
+
+	for (int x = 0; x < gbuf->getWidth(); x++) {
+		u = ((float)x + 0.5f) / (float)gbuf->getWidth();
+		tc[0] = tc[1] = tc[2] = 0.0f;
+		for (int p = 0; p < 4; p++) {
+			const int np = (data->n << 2) + p;
+			s = (u - 0.5f) * data->scalef[np] + 0.5f;
+			t = (v - 0.5f) * data->scalef[np] + 0.5f;
+			gbuf->readBilinear(c, s * gbuf->getWidth() - 0.5f, t * gbuf->getHeight() - 0.5f);
+			mul_v3_v3(c, data->cm[np]);
+			sm = smoothMask(s, t) * 0.25f;
+			madd_v3_v3fl(tc, c, sm);
+		}
+		data->tbuf1->addPixel(x, y, tc);
+	}
+}
+
 void GlareGhostOperation::generateGlare(float *data, MemoryBuffer *inputTile, NodeGlare *settings)
 {
 	const int qt = 1 << settings->quality;
 	const float s1 = 4.0f / (float)qt, s2 = 2.0f * s1;
-	int x, y, n, p, np;
-	fRGB c, tc, cm[64];
-	float sc, isc, u, v, sm, s, t, ofs, scalef[64];
+	int x, y, n;
+	fRGB cm[64];
+	float ofs, scalef[64];
 	const float cmo = 1.0f - settings->colmod;
 
 	MemoryBuffer *gbuf = inputTile->duplicate();
@@ -76,49 +139,19 @@ void GlareGhostOperation::generateGlare(float *data, MemoryBuffer *inputTile, No
 		if (x & 1) scalef[x] = -0.99f / scalef[x];
 	}
 
-	sc = 2.13;
-	isc = -0.97;
-	for (y = 0; y < gbuf->getHeight() && (!breaked); y++) {
-		v = ((float)y + 0.5f) / (float)gbuf->getHeight();
-		for (x = 0; x < gbuf->getWidth(); x++) {
-			u = ((float)x + 0.5f) / (float)gbuf->getWidth();
-			s = (u - 0.5f) * sc + 0.5f;
-			t = (v - 0.5f) * sc + 0.5f;
-			tbuf1->readBilinear(c, s * gbuf->getWidth(), t * gbuf->getHeight());
-			sm = smoothMask(s, t);
-			mul_v3_fl(c, sm);
-			s = (u - 0.5f) * isc + 0.5f;
-			t = (v - 0.5f) * isc + 0.5f;
-			tbuf2->readBilinear(tc, s * gbuf->getWidth() - 0.5f, t * gbuf->getHeight() - 0.5f);
-			sm = smoothMask(s, t);
-			madd_v3_v3fl(c, tc, sm);
-
-			gbuf->writePixel(x, y, c);
-		}
-		if (isBreaked()) breaked = true;
+	const bool use_threading = gbuf->getWidth() * gbuf->getHeight() > 10000;
+	GlareGhostTaskData task_data = {gbuf, tbuf1, tbuf2, cm, scalef, 0};
 
+	if (!breaked) {
+		BLI_task_parallel_range(0, gbuf->getHeight(), &task_data, glare_ghost_initial_row_task, use_threading);
+		if (isBreaked()) breaked = true;
 	}
 
 	memset(tbuf1->getBuffer(), 0, tbuf1->getWidth() * tbuf1->getHeight() * COM_NUM_CHANNELS_COLOR * sizeof(float));
 	for (n = 1; n < settings->iter && (!breaked); n++) {
-		for (y = 0; y < gbuf->getHeight() && (!breaked); y++) {
-			v = ((float)y + 0.5f) / (float)gbuf->getHeight();
-			for (x = 0; x < gbuf->getWidth(); x++) {
-				u = ((float)x + 0.5f) / (float)gbuf->getWidth();
-				tc[0] = tc[1] = tc[2] = 0.0f;
-				for (p = 0; p < 4; p++) {
-					np = (n << 2) + p;
-					s = (u - 0.5f) * scalef[np] + 0.5f;
-					t = (v - 0.5f) * scalef[np] + 0.5f;
-					gbuf->readBilinear(c, s * gbuf->getWidth() - 0.5f, t * gbuf->getHeight() - 0.5f);
-					mul_v3_v3(c, cm[np]);
-					sm = smoothMask(s, t) * 0.25f;
-					madd_v3_v3fl(tc, c, sm);
-				}
-				tbuf1->addPixel(x, y, tc);
-			}
-			if (isBreaked()) breaked = true;
-		}
+		task_data.n = n;
+		BLI_task_parallel_range(0, gbuf->getHeight(), &task_data, glare_ghost_iteration_row_task, use_threading);
+		if (isBreaked()) breaked = true;
 		memcpy(gbuf->getBuffer(), tbuf1->getBuffer(), tbuf1->getWidth() * tbuf1->getHeight() * COM_NUM_CHANNELS_COLOR * sizeof(float));
 	}
 	memcpy(data, gbuf->getBuffer(), gbuf->getWidth() * gbuf->getHeight() * COM_NUM_CHANNELS_COLOR * sizeof(float));
@@ -22,6 +22,89 @@
 
 #include "COM_GlareSimpleStarOperation.h"
 
+#include "BLI_task.h"
+
+/* columns handled by a single task, so rows are read sequentially */
+#define GLARE_STAR_COLUMN_CHUNK 64
+
+typedef struct GlareStarTaskData {
+	MemoryBuffer *buffer;
+	/* offset of the first neighbour, the second neighbour is mirrored */
+	int ox, oy;
+	/* direction of the lines along which pixels depend on each other */
+	int ux, uy;
+	float f1, f2;
+} GlareStarTaskData;
+
+static void glare_star_pixel(const GlareStarTaskData *data, int x, int y)
+{
+	float c[4] = {0, 0, 0, 0}, tc[4] = {0, 0, 0, 0};
+
+	data->buffer->read(c, x, y);
+	mul_v3_fl(c, data->f1);
+	data->buffer->read(tc, x + data->ox, y + data->oy);
+	madd_v3_v3fl(c, tc, data->f2);
+	data->buffer->read(tc, x - data->ox, y - data->oy);
+	madd_v3_v3fl(c, tc, data->f2);
+	c[3] = 1.0f;
+	data->buffer->writePixel(x, y, c);
+}
+
+/* The buffer is updated in place, every pixel uses the updated value of its neighbour earlier on the
+ * line and the old value of its neighbour later on the line. Lines are independent of each other,
+ * walking them in the order of the original scanlines gives the same result on multiple threads. */
+static void glare_star_line_task(void *userdata, const int index)
+{
+	const GlareStarTaskData *data = (GlareStarTaskData *)userdata;
+	const int width = data->buffer->getWidth();
+	const int height = data->buffer->getHeight();
+
+	if (data->ux == 0) {
+		/* vertical lines */
+		const int xmin = index * GLARE_STAR_COLUMN_CHUNK;
+		const int xmax = min_ii(xmin + GLARE_STAR_COLUMN_CHUNK, width);
+		for (int y = 0; y < height; y++) {
+			for (int x = xmin; x < xmax; x++) {
+				glare_star_pixel(data, x, y);
+			}
+		}
+	}
+	else if (data->uy == 0) {
+		/* horizontal lines */
+		for (int x = 0; x < width; x++) {
+			glare_star_pixel(data, x, index);
+		}
+	}
+	else {
+		/* diagonal lines, index runs over x - y (shifted to be positive) or x + y */
+		int y = (data->ux > 0) ? max_ii(0, height - 1 - index) : max_ii(0, index - (width - 1));
+		int x = (data->ux > 0) ? index - (height - 1) + y : index - y;
+		for (; x >= 0 && x < width && y < height; x += data->ux, y++) {
+			glare_star_pixel(data, x, y);
+		}
+	}
+}
+
+static void glare_star_pass(MemoryBuffer *buffer, int ox, int oy, int ux, int uy, float f1, float f2)
+{
+	const int width = buffer->getWidth();
+	const int height = buffer->getHeight();
+	GlareStarTaskData data = {buffer, ox, oy, ux, uy, f1, f2};
+	int tot_lines;
+
+	if (ux == 0) {
+		tot_lines = (width + GLARE_STAR_COLUMN_CHUNK - 1) / GLARE_STAR_COLUMN_CHUNK;
+	}
+	else if (uy == 0) {
+		tot_lines = height;
+	}
+	else {
+		tot_lines = width + height - 1;
+	}
+
+	BLI_task_parallel_range(0, tot_lines, &data, glare_star_line_task, width * height > 10000);
+}
+
 void GlareSimpleStarOperation::generateGlare(float *data, MemoryBuffer *inputTile, NodeGlare *settings)
 {
 	int i, x, y, ym, yp, xm, xp;
@@ -36,33 +119,15 @@ void GlareSimpleStarOperation::generateGlare(float *data, MemoryBuffer *inputTil
 	for (i = 0; i < settings->iter && (!breaked); i++) {
 //		// (x || x-1, y-1) to (x || x+1, y+1)
 //		// F
-		for (y = 0; y < this->getHeight() && (!breaked); y++) {
-			ym = y - i;
-			yp = y + i;
-			for (x = 0; x < this->getWidth(); x++) {
-				xm = x - i;
-				xp = x + i;
-				tbuf1->read(c, x, y);
-				mul_v3_fl(c, f1);
-				tbuf1->read(tc, (settings->angle ? xm : x), ym);
-				madd_v3_v3fl(c, tc, f2);
-				tbuf1->read(tc, (settings->angle ? xp : x), yp);
-				madd_v3_v3fl(c, tc, f2);
-				c[3] = 1.0f;
-				tbuf1->writePixel(x, y, c);
-
-				tbuf2->read(c, x, y);
-				mul_v3_fl(c, f1);
-				tbuf2->read(tc, xm, (settings->angle ? yp : y));
-				madd_v3_v3fl(c, tc, f2);
-				tbuf2->read(tc, xp, (settings->angle ? ym : y));
-				madd_v3_v3fl(c, tc, f2);
-				c[3] = 1.0f;
-				tbuf2->writePixel(x, y, c);
-			}
-			if (isBreaked()) {
-				breaked = true;
-			}
+		glare_star_pass(tbuf1, (settings->angle ? -i : 0), -i, (settings->angle ? 1 : 0), 1, f1, f2);
+		if (isBreaked()) {
+			breaked = true;
+			break;
+		}
+		glare_star_pass(tbuf2, -i, (settings->angle ? i : 0), (settings->angle ? -1 : 1), (settings->angle ? 1 : 0), f1, f2);
+		if (isBreaked()) {
+			breaked = true;
+			break;
 		}
 //		// B
 		for (y = tbuf1->getHeight() - 1 && (!breaked); y >= 0; y--) {
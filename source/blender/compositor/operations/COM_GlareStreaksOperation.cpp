@@ -22,12 +22,57 @@
 
 #include "COM_GlareStreaksOperation.h"
 #include "BLI_math.h"
+#include "BLI_task.h"
+
+typedef struct GlareStreaksTaskData {
+	MemoryBuffer *tsrc;
+	MemoryBuffer *tdst;
+	int n;
+	float vxp, vyp;
+	float wt;
+	float cmo;
+} GlareStreaksTaskData;
+
+/* a single pass of a streak, rows only read from the source buffer */
+static void glare_streak_row_task(void *userdata, const int y)
+{
+	GlareStreaksTaskData *data = (GlareStreaksTaskData *)userdata;
+	MemoryBuffer *tsrc = data->tsrc;
+	const int width = tsrc->getWidth();
+	const float vxp = data->vxp, vyp = data->vyp;
+	const float wt = data->wt;
+	const float cmo = data->cmo;
+	float *tdstcol = data->tdst->getBuffer() + (size_t)y * width * COM_NUM_CHANNELS_COLOR;
+	float c1[4], c2[4], c3[4], c4[4];
+
+	for (int x = 0; x < width; ++x, tdstcol += 4) {
+		// first pass no offset, always same for every pass, exact copy,
+		// otherwise results in uneven brightness, only need once
+		if (data->n == 0) tsrc->read(c1, x, y); else c1[0] = c1[1] = c1[2] = 0;
+		tsrc->readBilinear(c2, x + vxp, y + vyp);
+		tsrc->readBilinear(c3, x + vxp * 2.0f, y + vyp * 2.0f);
+		tsrc->readBilinear(c4, x + vxp * 3.0f, y + vyp * 3.0f);
+		// modulate color to look vaguely similar to a color spectrum
+		c2[1] *= cmo;
+		c2[2] *= cmo;
+
+		c3[0] *= cmo;
+		c3[1] *= cmo;
+
+		c4[0] *= cmo;
+		c4[2] *= cmo;
+
+		tdstcol[0] = 0.5f * (tdstcol[0] + c1[0] + wt * (c2[0] + wt * (c3[0] + wt * c4[0])));
+		tdstcol[1] = 0.5f * (tdstcol[1] + c1[1] + wt * (c2[1] + wt * (c3[1] + wt * c4[1])));
+		tdstcol[2] = 0.5f * (tdstcol[2] + c1[2] + wt * (c2[2] + wt * (c3[2] + wt * c4[2])));
+		tdstcol[3] = 1.0f;
+	}
+}
 
 void GlareStreaksOperation::generateGlare(float *data, MemoryBuffer *inputTile, NodeGlare *settings)
 {
-	int x, y, n;
+	int n;
 	unsigned int nump = 0;
-	float c1[4], c2[4], c3[4], c4[4];
 	float a, ang = DEG2RADF(360.0f) / (float)settings->angle;
 
 	int size = inputTile->getWidth() * inputTile->getHeight();
@@ -48,33 +93,10 @@ void GlareStreaksOperation::generateGlare(float *data, MemoryBuffer *inputTile,
 			const float vxp = vx * p4, vyp = vy * p4;
 			const float wt = pow((double)settings->fade, (double)p4);
 			const float cmo = 1.0f - (float)pow((double)settings->colmod, (double)n + 1);  // colormodulation amount relative to current pass
-			float *tdstcol = tdst->getBuffer();
-			for (y = 0; y < tsrc->getHeight() && (!breaked); ++y) {
-				for (x = 0; x < tsrc->getWidth(); ++x, tdstcol += 4) {
-					// first pass no offset, always same for every pass, exact copy,
-					// otherwise results in uneven brightness, only need once
-					if (n == 0) tsrc->read(c1, x, y); else c1[0] = c1[1] = c1[2] = 0;
-					tsrc->readBilinear(c2, x + vxp, y + vyp);
-					tsrc->readBilinear(c3, x + vxp * 2.0f, y + vyp * 2.0f);
-					tsrc->readBilinear(c4, x + vxp * 3.0f, y + vyp * 3.0f);
-					// modulate color to look vaguely similar to a color spectrum
-					c2[1] *= cmo;
-					c2[2] *= cmo;
-
-					c3[0] *= cmo;
-					c3[1] *= cmo;
-
-					c4[0] *= cmo;
-					c4[2] *= cmo;
-
-					tdstcol[0] = 0.5f * (tdstcol[0] + c1[0] + wt * (c2[0] + wt * (c3[0] + wt * c4[0])));
-					tdstcol[1] = 0.5f * (tdstcol[1] + c1[1] + wt * (c2[1] + wt * (c3[1] + wt * c4[1])));
-					tdstcol[2] = 0.5f * (tdstcol[2] + c1[2] + wt * (c2[2] + wt * (c3[2] + wt * c4[2])));
-					tdstcol[3] = 1.0f;
-				}
-				if (isBreaked()) {
-					breaked = true;
-				}
+			GlareStreaksTaskData task_data = {tsrc, tdst, n, vxp, vyp, wt, cmo};
+			BLI_task_parallel_range(0, tsrc->getHeight(), &task_data, glare_streak_row_task, size > 10000);
+			if (isBreaked()) {
+				breaked = true;
 			}
 			memcpy(tsrc->getBuffer(), tdst->getBuffer(), sizeof(float) * size4);
 		}
@@ -26,6 +26,7 @@
 #include "COM_OpenCLDevice.h"
 
 #include "BLI_math.h"
+#include "BLI_task.h"
 
 #define ASSERT_XY_RANGE(x, y)  \
 	BLI_assert(x >= 0 && x < this->getWidth() && \
@@ -96,24 +97,57 @@ int InpaintSimpleOperation::mdist(int x, int y)
 	return this->m_manhatten_distance[y * width + x];
 }
 
-bool InpaintSimpleOperation::next_pixel(int &x, int &y, int & curr, int iters)
+/* columns handled by a single task, so rows are read sequentially */
+#define INPAINT_COLUMN_CHUNK 64
+
+typedef struct InpaintTaskData {
+	InpaintSimpleOperation *operation;
+	int start;
+} InpaintTaskData;
+
+/* distance to the closest known pixel in the same column */
+void InpaintSimpleOperation::calc_manhatten_distance_columns_task(void *userdata, const int chunk)
 {
-	int width = this->getWidth();
+	InpaintSimpleOperation *operation = ((InpaintTaskData *)userdata)->operation;
+	int width = operation->getWidth();
+	int height = operation->getHeight();
+	short *m = operation->m_manhatten_distance;
+	const int imin = chunk * INPAINT_COLUMN_CHUNK;
+	const int imax = min_ii(imin + INPAINT_COLUMN_CHUNK, width);
 
-	if (curr >= this->m_area_size) {
-		return false;
+	for (int j = 0; j < height; j++) {
+		for (int i = imin; i < imax; i++) {
+			int r = 0;
+			/* no need to clamp here */
+			if (operation->get_pixel(i, j)[3] < 1.0f) {
+				r = width + height;
+				if (j > 0)
+					r = min_ii(r, m[(j - 1) * width + i] + 1);
+			}
+			m[j * width + i] = r;
+		}
 	}
-	
-	int r = this->m_pixelorder[curr++];
 
-	x = r % width;
-	y = r / width;
+	for (int j = height - 2; j >= 0; j--) {
+		for (int i = imin; i < imax; i++) {
+			m[j * width + i] = min_ii(m[j * width + i], m[(j + 1) * width + i] + 1);
+		}
+	}
+}
 
-	if (this->mdist(x, y) > iters) {
-		return false;
+/* combine the column distances along the rows */
+void InpaintSimpleOperation::calc_manhatten_distance_rows_task(void *userdata, const int j)
+{
+	InpaintSimpleOperation *operation = ((InpaintTaskData *)userdata)->operation;
+	int width = operation->getWidth();
+	short *m = &operation->m_manhatten_distance[j * width];
+
+	for (int i = 1; i < width; i++) {
+		m[i] = min_ii(m[i], m[i - 1] + 1);
+	}
+	for (int i = width - 2; i >= 0; i--) {
+		m[i] = min_ii(m[i], m[i + 1] + 1);
 	}
-	
-	return true;
 }
 
 void InpaintSimpleOperation::calc_manhatten_distance() 
@@ -121,38 +155,19 @@ void InpaintSimpleOperation::calc_manhatten_distance()
 	int width = this->getWidth();
 	int height = this->getHeight();
 	short *m = this->m_manhatten_distance = (short *)MEM_mallocN(sizeof(short) * width * height, __func__);
+	const bool use_threading = (width * height) > 10000;
+	InpaintTaskData data = {this, 0};
 	int *offsets;
 
-	offsets = (int *)MEM_callocN(sizeof(int) * (width + height + 1), "InpaintSimpleOperation offsets");
+	/* the manhattan distance is separable, columns and rows are handled independently */
+	BLI_task_parallel_range(0, (width + INPAINT_COLUMN_CHUNK - 1) / INPAINT_COLUMN_CHUNK, &data,
+	                        calc_manhatten_distance_columns_task, use_threading);
+	BLI_task_parallel_range(0, height, &data, calc_manhatten_distance_rows_task, use_threading);
 
-	for (int j = 0; j < height; j++) {
-		for (int i = 0; i < width; i++) {
-			int r = 0;
-			/* no need to clamp here */
-			if (this->get_pixel(i, j)[3] < 1.0f) {
-				r = width + height;
-				if (i > 0) 
-					r = min_ii(r, m[j * width + i - 1] + 1);
-				if (j > 0) 
-					r = min_ii(r, m[(j - 1) * width + i] + 1);
-			}
-			m[j * width + i] = r;
-		}
-	}
+	offsets = (int *)MEM_callocN(sizeof(int) * (width + height + 1), "InpaintSimpleOperation offsets");
 
-	for (int j = height - 1; j >= 0; j--) {
-		for (int i = width - 1; i >= 0; i--) {
-			int r = m[j * width + i];
-			
-			if (i + 1 < width) 
-				r = min_ii(r, m[j * width + i + 1] + 1);
-			if (j + 1 < height) 
-				r = min_ii(r, m[(j + 1) * width + i] + 1);
-			
-			m[j * width + i] = r;
-			
-			offsets[r]++;
-		}
+	for (int i = 0; i < width * height; i++) {
+		offsets[m[i]]++;
 	}
 	
 	offsets[0] = 0;
@@ -215,6 +230,16 @@ void InpaintSimpleOperation::pix_step(int x, int y)
 	}
 }
 
+void InpaintSimpleOperation::pix_step_task(void *userdata, const int index)
+{
+	InpaintTaskData *data = (InpaintTaskData *)userdata;
+	InpaintSimpleOperation *operation = data->operation;
+	const int r = operation->m_pixelorder[data->start + index];
+	const int width = operation->getWidth();
+
+	operation->pix_step(r % width, r / width);
+}
+
 void *InpaintSimpleOperation::initializeTileData(rcti *rect)
 {
 	if (this->m_cached_buffer_ready) {
@@ -227,12 +252,23 @@ void *InpaintSimpleOperation::initializeTileData(rcti *rect)
 
 		this->calc_manhatten_distance();
 
+		/* pixels only depend on pixels closer to the known area,
+		 * so all pixels at the same distance are filled in parallel */
 		int curr = 0;
-		int x, y;
+		while (curr < this->m_area_size) {
+			const int d = this->m_manhatten_distance[this->m_pixelorder[curr]];
+			int end = curr;
 
-	
-		while (this->next_pixel(x, y, curr, this->m_iterations)) {
-			this->pix_step(x, y);
+			if (d > this->m_iterations) {
+				break;
+			}
+			while (end < this->m_area_size && this->m_manhatten_distance[this->m_pixelorder[end]] == d) {
+				end++;
+			}
+
+			InpaintTaskData data = {this, curr};
+			BLI_task_parallel_range(0, end - curr, &data, pix_step_task, (end - curr) > 1000);
+			curr = end;
 		}
 		this->m_cached_buffer_ready = true;
 	}
@@ -67,8 +67,11 @@ private:
 	void clamp_xy(int &x, int &y);
 	float *get_pixel(int x, int y);
 	int mdist(int x, int y);
-	bool next_pixel(int &x, int &y, int &curr, int iters);
 	void pix_step(int x, int y);
+
+	static void calc_manhatten_distance_columns_task(void *userdata, const int chunk);
+	static void calc_manhatten_distance_rows_task(void *userdata, const int y);
+	static void pix_step_task(void *userdata, const int index);
 };
 
 
@@ -72,6 +72,21 @@ void MathBaseOperation::clampIfNeeded(float *color)
 	}
 }
 
+void MathBaseOperation::clampSpanIfNeeded(float *output, int length)
+{
+	if (this->m_useClamp) {
+		for (int i = 0; i < length * 4; i += 4) {
+			CLAMP(output[i], 0.0f, 1.0f);
+		}
+	}
+}
+
+void MathBaseOperation::readSpanInputs(float *inputValue1, float *inputValue2, int x, int y, int length)
+{
+	this->m_inputValue1Operation->readSpan(inputValue1, x, y, length);
+	this->m_inputValue2Operation->readSpan(inputValue2, x, y, length);
+}
+
 void MathAddOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
 {
 	float inputValue1[4];
@@ -85,6 +100,20 @@ void MathAddOperation::executePixelSampled(float output[4], float x, float y, Pi
 	clampIfNeeded(output);
 }
 
+void MathAddOperation::executeSpan(float *output, int x, int y, int length)
+{
+	float inputValue1[COM_SPAN_MAX_LENGTH * 4];
+	float inputValue2[COM_SPAN_MAX_LENGTH * 4];
+
+	readSpanInputs(inputValue1, inputValue2, x, y, length);
+
+	for (int i = 0; i < length * 4; i += 4) {
+		output[i] = inputValue1[i] + inputValue2[i];
+	}
+
+	clampSpanIfNeeded(output, length);
+}
+
 void MathSubtractOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
 {
 	float inputValue1[4];
@@ -98,6 +127,20 @@ void MathSubtractOperation::executePixelSampled(float output[4], float x, float
 	clampIfNeeded(output);
 }
 
+void MathSubtractOperation::executeSpan(float *output, int x, int y, int length)
+{
+	float inputValue1[COM_SPAN_MAX_LENGTH * 4];
+	float inputValue2[COM_SPAN_MAX_LENGTH * 4];
+
+	readSpanInputs(inputValue1, inputValue2, x, y, length);
+
+	for (int i = 0; i < length * 4; i += 4) {
+		output[i] = inputValue1[i] - inputValue2[i];
+	}
+
+	clampSpanIfNeeded(output, length);
+}
+
 void MathMultiplyOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
 {
 	float inputValue1[4];
@@ -111,6 +154,20 @@ void MathMultiplyOperation::executePixelSampled(float output[4], float x, float
 	clampIfNeeded(output);
 }
 
+void MathMultiplyOperation::executeSpan(float *output, int x, int y, int length)
+{
+	float inputValue1[COM_SPAN_MAX_LENGTH * 4];
+	float inputValue2[COM_SPAN_MAX_LENGTH * 4];
+
+	readSpanInputs(inputValue1, inputValue2, x, y, length);
+
+	for (int i = 0; i < length * 4; i += 4) {
+		output[i] = inputValue1[i] * inputValue2[i];
+	}
+
+	clampSpanIfNeeded(output, length);
+}
+
 void MathDivideOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
 {
 	float inputValue1[4];
@@ -127,6 +184,23 @@ void MathDivideOperation::executePixelSampled(float output[4], float x, float y,
 	clampIfNeeded(output);
 }
 
+void MathDivideOperation::executeSpan(float *output, int x, int y, int length)
+{
+	float inputValue1[COM_SPAN_MAX_LENGTH * 4];
+	float inputValue2[COM_SPAN_MAX_LENGTH * 4];
+
+	readSpanInputs(inputValue1, inputValue2, x, y, length);
+
+	for (int i = 0; i < length * 4; i += 4) {
+		if (inputValue2[i] == 0) /* We don't want to divide by zero. */
+			output[i] = 0.0;
+		else
+			output[i] = inputValue1[i] / inputValue2[i];
+	}
+
+	clampSpanIfNeeded(output, length);
+}
+
 void MathSineOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
 {
 	float inputValue1[4];
@@ -265,6 +339,20 @@ void MathMinimumOperation::executePixelSampled(float output[4], float x, float y
 	clampIfNeeded(output);
 }
 
+void MathMinimumOperation::executeSpan(float *output, int x, int y, int length)
+{
+	float inputValue1[COM_SPAN_MAX_LENGTH * 4];
+	float inputValue2[COM_SPAN_MAX_LENGTH * 4];
+
+	readSpanInputs(inputValue1, inputValue2, x, y, length);
+
+	for (int i = 0; i < length * 4; i += 4) {
+		output[i] = min(inputValue1[i], inputValue2[i]);
+	}
+
+	clampSpanIfNeeded(output, length);
+}
+
 void MathMaximumOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
 {
 	float inputValue1[4];
@@ -278,6 +366,20 @@ void MathMaximumOperation::executePixelSampled(float output[4], float x, float y
 	clampIfNeeded(output);
 }
 
+void MathMaximumOperation::executeSpan(float *output, int x, int y, int length)
+{
+	float inputValue1[COM_SPAN_MAX_LENGTH * 4];
+	float inputValue2[COM_SPAN_MAX_LENGTH * 4];
+
+	readSpanInputs(inputValue1, inputValue2, x, y, length);
+
+	for (int i = 0; i < length * 4; i += 4) {
+		output[i] = max(inputValue1[i], inputValue2[i]);
+	}
+
+	clampSpanIfNeeded(output, length);
+}
+
 void MathRoundOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
 {
 	float inputValue1[4];
@@ -291,6 +393,20 @@ void MathRoundOperation::executePixelSampled(float output[4], float x, float y,
 	clampIfNeeded(output);
 }
 
+void MathRoundOperation::executeSpan(float *output, int x, int y, int length)
+{
+	float inputValue1[COM_SPAN_MAX_LENGTH * 4];
+	float inputValue2[COM_SPAN_MAX_LENGTH * 4];
+
+	readSpanInputs(inputValue1, inputValue2, x, y, length);
+
+	for (int i = 0; i < length * 4; i += 4) {
+		output[i] = round(inputValue1[i]);
+	}
+
+	clampSpanIfNeeded(output, length);
+}
+
 void MathLessThanOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
 {
 	float inputValue1[4];
@@ -304,6 +420,20 @@ void MathLessThanOperation::executePixelSampled(float output[4], float x, float
 	clampIfNeeded(output);
 }
 
+void MathLessThanOperation::executeSpan(float *output, int x, int y, int length)
+{
+	float inputValue1[COM_SPAN_MAX_LENGTH * 4];
+	float inputValue2[COM_SPAN_MAX_LENGTH * 4];
+
+	readSpanInputs(inputValue1, inputValue2, x, y, length);
+
+	for (int i = 0; i < length * 4; i += 4) {
+		output[i] = inputValue1[i] < inputValue2[i] ? 1.0f : 0.0f;
+	}
+
+	clampSpanIfNeeded(output, length);
+}
+
 void MathGreaterThanOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
 {
 	float inputValue1[4];
@@ -317,6 +447,20 @@ void MathGreaterThanOperation::executePixelSampled(float output[4], float x, flo
 	clampIfNeeded(output);
 }
 
+void MathGreaterThanOperation::executeSpan(float *output, int x, int y, int length)
+{
+	float inputValue1[COM_SPAN_MAX_LENGTH * 4];
+	float inputValue2[COM_SPAN_MAX_LENGTH * 4];
+
+	readSpanInputs(inputValue1, inputValue2, x, y, length);
+
+	for (int i = 0; i < length * 4; i += 4) {
+		output[i] = inputValue1[i] > inputValue2[i] ? 1.0f : 0.0f;
+	}
+
+	clampSpanIfNeeded(output, length);
+}
+
 void MathModuloOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
 {
 	float inputValue1[4];
@@ -343,3 +487,16 @@ void MathAbsoluteOperation::executePixelSampled(float output[4], float x, float
 
 	clampIfNeeded(output);
 }
+
+void MathAbsoluteOperation::executeSpan(float *output, int x, int y, int length)
+{
+	float inputValue1[COM_SPAN_MAX_LENGTH * 4];
+
+	this->m_inputValue1Operation->readSpan(inputValue1, x, y, length);
+
+	for (int i = 0; i < length * 4; i += 4) {
+		output[i] = fabs(inputValue1[i]);
+	}
+
+	clampSpanIfNeeded(output, length);
+}
@@ -46,6 +46,12 @@ protected:
 	MathBaseOperation();
 
 	void clampIfNeeded(float color[4]);
+	void clampSpanIfNeeded(float *output, int length);
+
+	/**
+	 * Read the spans of both input values.
+	 */
+	void readSpanInputs(float *inputValue1, float *inputValue2, int x, int y, int length);
 public:
 	/**
 	 * the inner loop of this program
@@ -72,23 +78,27 @@ public:
 
 class MathAddOperation : public MathBaseOperation {
 public:
-	MathAddOperation() : MathBaseOperation() {}
+	MathAddOperation() : MathBaseOperation() { this->setSpanSupport(true); }
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeSpan(float *output, int x, int y, int length);
 };
 class MathSubtractOperation : public MathBaseOperation {
 public:
-	MathSubtractOperation() : MathBaseOperation() {}
+	MathSubtractOperation() : MathBaseOperation() { this->setSpanSupport(true); }
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeSpan(float *output, int x, int y, int length);
 };
 class MathMultiplyOperation : public MathBaseOperation {
 public:
-	MathMultiplyOperation() : MathBaseOperation() {}
+	MathMultiplyOperation() : MathBaseOperation() { this->setSpanSupport(true); }
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeSpan(float *output, int x, int y, int length);
 };
 class MathDivideOperation : public MathBaseOperation {
 public:
-	MathDivideOperation() : MathBaseOperation() {}
+	MathDivideOperation() : MathBaseOperation() { this->setSpanSupport(true); }
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeSpan(float *output, int x, int y, int length);
 };
 class MathSineOperation : public MathBaseOperation {
 public:
@@ -133,28 +143,33 @@ public:
 };
 class MathMinimumOperation : public MathBaseOperation {
 public:
-	MathMinimumOperation() : MathBaseOperation() {}
+	MathMinimumOperation() : MathBaseOperation() { this->setSpanSupport(true); }
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeSpan(float *output, int x, int y, int length);
 };
 class MathMaximumOperation : public MathBaseOperation {
 public:
-	MathMaximumOperation() : MathBaseOperation() {}
+	MathMaximumOperation() : MathBaseOperation() { this->setSpanSupport(true); }
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeSpan(float *output, int x, int y, int length);
 };
 class MathRoundOperation : public MathBaseOperation {
 public:
-	MathRoundOperation() : MathBaseOperation() {}
+	MathRoundOperation() : MathBaseOperation() { this->setSpanSupport(true); }
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeSpan(float *output, int x, int y, int length);
 };
 class MathLessThanOperation : public MathBaseOperation {
 public:
-	MathLessThanOperation() : MathBaseOperation() {}
+	MathLessThanOperation() : MathBaseOperation() { this->setSpanSupport(true); }
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeSpan(float *output, int x, int y, int length);
 };
 class MathGreaterThanOperation : public MathBaseOperation {
 public:
-	MathGreaterThanOperation() : MathBaseOperation() {}
+	MathGreaterThanOperation() : MathBaseOperation() { this->setSpanSupport(true); }
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeSpan(float *output, int x, int y, int length);
 };
 
 class MathModuloOperation : public MathBaseOperation {
@@ -165,8 +180,9 @@ public:
 
 class MathAbsoluteOperation : public MathBaseOperation {
 public:
-	MathAbsoluteOperation() : MathBaseOperation() {}
+	MathAbsoluteOperation() : MathBaseOperation() { this->setSpanSupport(true); }
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeSpan(float *output, int x, int y, int length);
 };
 
 #endif
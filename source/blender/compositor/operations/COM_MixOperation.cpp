@@ -69,6 +69,20 @@ void MixBaseOperation::executePixelSampled(float output[4], float x, float y, Pi
 	output[3] = inputColor1[3];
 }
 
+void MixBaseOperation::readSpanInputs(float *inputValue, float *inputColor1, float *inputColor2,
+                                      int x, int y, int length)
+{
+	this->m_inputValueOperation->readSpan(inputValue, x, y, length);
+	this->m_inputColor1Operation->readSpan(inputColor1, x, y, length);
+	this->m_inputColor2Operation->readSpan(inputColor2, x, y, length);
+
+	if (this->useValueAlphaMultiply()) {
+		for (int i = 0; i < length * 4; i += 4) {
+			inputValue[i] *= inputColor2[i + 3];
+		}
+	}
+}
+
 void MixBaseOperation::determineResolution(unsigned int resolution[2], unsigned int preferredResolution[2])
 {
 	NodeOperationInput *socket;
@@ -104,7 +118,7 @@ void MixBaseOperation::deinitExecution()
 
 MixAddOperation::MixAddOperation() : MixBaseOperation()
 {
-	/* pass */
+	this->setSpanSupport(true);
 }
 
 void MixAddOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
@@ -129,11 +143,37 @@ void MixAddOperation::executePixelSampled(float output[4], float x, float y, Pix
 	clampIfNeeded(output);
 }
 
+void MixAddOperation::executeSpan(float *output, int x, int y, int length)
+{
+	float inputValue[COM_SPAN_MAX_LENGTH * 4];
+	float inputColor1[COM_SPAN_MAX_LENGTH * 4];
+	float inputColor2[COM_SPAN_MAX_LENGTH * 4];
+
+	readSpanInputs(inputValue, inputColor1, inputColor2, x, y, length);
+
+	for (int i = 0; i < length * 4; i += 4) {
+		const float value = inputValue[i];
+#ifdef __SSE2__
+		const __m128 value4 = _mm_set1_ps(value);
+		const __m128 color1 = _mm_loadu_ps(&inputColor1[i]);
+		const __m128 color2 = _mm_loadu_ps(&inputColor2[i]);
+		_mm_storeu_ps(&output[i], _mm_add_ps(color1, _mm_mul_ps(value4, color2)));
+#else
+		output[i] = inputColor1[i] + value * inputColor2[i];
+		output[i + 1] = inputColor1[i + 1] + value * inputColor2[i + 1];
+		output[i + 2] = inputColor1[i + 2] + value * inputColor2[i + 2];
+#endif
+		output[i + 3] = inputColor1[i + 3];
+	}
+
+	clampSpanIfNeeded(output, length);
+}
+
 /* ******** Mix Blend Operation ******** */
 
 MixBlendOperation::MixBlendOperation() : MixBaseOperation()
 {
-	/* pass */
+	this->setSpanSupport(true);
 }
 
 void MixBlendOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
@@ -160,6 +200,34 @@ void MixBlendOperation::executePixelSampled(float output[4], float x, float y, P
 	clampIfNeeded(output);
 }
 
+void MixBlendOperation::executeSpan(float *output, int x, int y, int length)
+{
+	float inputValue[COM_SPAN_MAX_LENGTH * 4];
+	float inputColor1[COM_SPAN_MAX_LENGTH * 4];
+	float inputColor2[COM_SPAN_MAX_LENGTH * 4];
+
+	readSpanInputs(inputValue, inputColor1, inputColor2, x, y, length);
+
+	for (int i = 0; i < length * 4; i += 4) {
+		const float value = inputValue[i];
+		const float valuem = 1.0f - value;
+#ifdef __SSE2__
+		const __m128 value4 = _mm_set1_ps(value);
+		const __m128 valuem4 = _mm_set1_ps(valuem);
+		const __m128 color1 = _mm_loadu_ps(&inputColor1[i]);
+		const __m128 color2 = _mm_loadu_ps(&inputColor2[i]);
+		_mm_storeu_ps(&output[i], _mm_add_ps(_mm_mul_ps(valuem4, color1), _mm_mul_ps(value4, color2)));
+#else
+		output[i] = valuem * inputColor1[i] + value * inputColor2[i];
+		output[i + 1] = valuem * inputColor1[i + 1] + value * inputColor2[i + 1];
+		output[i + 2] = valuem * inputColor1[i + 2] + value * inputColor2[i + 2];
+#endif
+		output[i + 3] = inputColor1[i + 3];
+	}
+
+	clampSpanIfNeeded(output, length);
+}
+
 /* ******** Mix Burn Operation ******** */
 
 MixBurnOperation::MixBurnOperation() : MixBaseOperation()
@@ -274,7 +342,7 @@ void MixColorOperation::executePixelSampled(float output[4], float x, float y, P
 
 MixDarkenOperation::MixDarkenOperation() : MixBaseOperation()
 {
-	/* pass */
+	this->setSpanSupport(true);
 }
 
 void MixDarkenOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
@@ -300,11 +368,39 @@ void MixDarkenOperation::executePixelSampled(float output[4], float x, float y,
 	clampIfNeeded(output);
 }
 
+void MixDarkenOperation::executeSpan(float *output, int x, int y, int length)
+{
+	float inputValue[COM_SPAN_MAX_LENGTH * 4];
+	float inputColor1[COM_SPAN_MAX_LENGTH * 4];
+	float inputColor2[COM_SPAN_MAX_LENGTH * 4];
+
+	readSpanInputs(inputValue, inputColor1, inputColor2, x, y, length);
+
+	for (int i = 0; i < length * 4; i += 4) {
+		const float value = inputValue[i];
+		const float valuem = 1.0f - value;
+#ifdef __SSE2__
+		const __m128 value4 = _mm_set1_ps(value);
+		const __m128 valuem4 = _mm_set1_ps(valuem);
+		const __m128 color1 = _mm_loadu_ps(&inputColor1[i]);
+		const __m128 color2 = _mm_loadu_ps(&inputColor2[i]);
+		_mm_storeu_ps(&output[i], _mm_add_ps(_mm_mul_ps(_mm_min_ps(color1, color2), value4), _mm_mul_ps(color1, valuem4)));
+#else
+		output[i] = min_ff(inputColor1[i], inputColor2[i]) * value + inputColor1[i] * valuem;
+		output[i + 1] = min_ff(inputColor1[i + 1], inputColor2[i + 1]) * value + inputColor1[i + 1] * valuem;
+		output[i + 2] = min_ff(inputColor1[i + 2], inputColor2[i + 2]) * value + inputColor1[i + 2] * valuem;
+#endif
+		output[i + 3] = inputColor1[i + 3];
+	}
+
+	clampSpanIfNeeded(output, length);
+}
+
 /* ******** Mix Difference Operation ******** */
 
 MixDifferenceOperation::MixDifferenceOperation() : MixBaseOperation()
 {
-	/* pass */
+	this->setSpanSupport(true);
 }
 
 void MixDifferenceOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
@@ -330,6 +426,36 @@ void MixDifferenceOperation::executePixelSampled(float output[4], float x, float
 	clampIfNeeded(output);
 }
 
+void MixDifferenceOperation::executeSpan(float *output, int x, int y, int length)
+{
+	float inputValue[COM_SPAN_MAX_LENGTH * 4];
+	float inputColor1[COM_SPAN_MAX_LENGTH * 4];
+	float inputColor2[COM_SPAN_MAX_LENGTH * 4];
+
+	readSpanInputs(inputValue, inputColor1, inputColor2, x, y, length);
+
+	for (int i = 0; i < length * 4; i += 4) {
+		const float value = inputValue[i];
+		const float valuem = 1.0f - value;
+#ifdef __SSE2__
+		const __m128 value4 = _mm_set1_ps(value);
+		const __m128 valuem4 = _mm_set1_ps(valuem);
+		const __m128 color1 = _mm_loadu_ps(&inputColor1[i]);
+		const __m128 color2 = _mm_loadu_ps(&inputColor2[i]);
+		/* clear the sign bit for the absolute difference */
+		const __m128 difference = _mm_andnot_ps(_mm_set1_ps(-0.0f), _mm_sub_ps(color1, color2));
+		_mm_storeu_ps(&output[i], _mm_add_ps(_mm_mul_ps(valuem4, color1), _mm_mul_ps(value4, difference)));
+#else
+		output[i] = valuem * inputColor1[i] + value * fabsf(inputColor1[i] - inputColor2[i]);
+		output[i + 1] = valuem * inputColor1[i + 1] + value * fabsf(inputColor1[i + 1] - inputColor2[i + 1]);
+		output[i + 2] = valuem * inputColor1[i + 2] + value * fabsf(inputColor1[i + 2] - inputColor2[i + 2]);
+#endif
+		output[i + 3] = inputColor1[i + 3];
+	}
+
+	clampSpanIfNeeded(output, length);
+}
+
 /* ******** Mix Difference Operation ******** */
 
 MixDivideOperation::MixDivideOperation() : MixBaseOperation()
@@ -522,7 +648,7 @@ void MixHueOperation::executePixelSampled(float output[4], float x, float y, Pix
 
 MixLightenOperation::MixLightenOperation() : MixBaseOperation()
 {
-	/* pass */
+	this->setSpanSupport(true);
 }
 
 void MixLightenOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
@@ -554,6 +680,32 @@ void MixLightenOperation::executePixelSampled(float output[4], float x, float y,
 	clampIfNeeded(output);
 }
 
+void MixLightenOperation::executeSpan(float *output, int x, int y, int length)
+{
+	float inputValue[COM_SPAN_MAX_LENGTH * 4];
+	float inputColor1[COM_SPAN_MAX_LENGTH * 4];
+	float inputColor2[COM_SPAN_MAX_LENGTH * 4];
+
+	readSpanInputs(inputValue, inputColor1, inputColor2, x, y, length);
+
+	for (int i = 0; i < length * 4; i += 4) {
+		const float value = inputValue[i];
+#ifdef __SSE2__
+		const __m128 value4 = _mm_set1_ps(value);
+		const __m128 color1 = _mm_loadu_ps(&inputColor1[i]);
+		const __m128 color2 = _mm_loadu_ps(&inputColor2[i]);
+		_mm_storeu_ps(&output[i], _mm_max_ps(_mm_mul_ps(value4, color2), color1));
+#else
+		output[i] = max_ff(value * inputColor2[i], inputColor1[i]);
+		output[i + 1] = max_ff(value * inputColor2[i + 1], inputColor1[i + 1]);
+		output[i + 2] = max_ff(value * inputColor2[i + 2], inputColor1[i + 2]);
+#endif
+		output[i + 3] = inputColor1[i + 3];
+	}
+
+	clampSpanIfNeeded(output, length);
+}
+
 /* ******** Mix Linear Light Operation ******** */
 
 MixLinearLightOperation::MixLinearLightOperation() : MixBaseOperation()
@@ -597,7 +749,7 @@ void MixLinearLightOperation::executePixelSampled(float output[4], float x, floa
 
 MixMultiplyOperation::MixMultiplyOperation() : MixBaseOperation()
 {
-	/* pass */
+	this->setSpanSupport(true);
 }
 
 void MixMultiplyOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
@@ -623,6 +775,34 @@ void MixMultiplyOperation::executePixelSampled(float output[4], float x, float y
 	clampIfNeeded(output);
 }
 
+void MixMultiplyOperation::executeSpan(float *output, int x, int y, int length)
+{
+	float inputValue[COM_SPAN_MAX_LENGTH * 4];
+	float inputColor1[COM_SPAN_MAX_LENGTH * 4];
+	float inputColor2[COM_SPAN_MAX_LENGTH * 4];
+
+	readSpanInputs(inputValue, inputColor1, inputColor2, x, y, length);
+
+	for (int i = 0; i < length * 4; i += 4) {
+		const float value = inputValue[i];
+		const float valuem = 1.0f - value;
+#ifdef __SSE2__
+		const __m128 value4 = _mm_set1_ps(value);
+		const __m128 valuem4 = _mm_set1_ps(valuem);
+		const __m128 color1 = _mm_loadu_ps(&inputColor1[i]);
+		const __m128 color2 = _mm_loadu_ps(&inputColor2[i]);
+		_mm_storeu_ps(&output[i], _mm_mul_ps(color1, _mm_add_ps(valuem4, _mm_mul_ps(value4, color2))));
+#else
+		output[i] = inputColor1[i] * (valuem + value * inputColor2[i]);
+		output[i + 1] = inputColor1[i + 1] * (valuem + value * inputColor2[i + 1]);
+		output[i + 2] = inputColor1[i + 2] * (valuem + value * inputColor2[i + 2]);
+#endif
+		output[i + 3] = inputColor1[i + 3];
+	}
+
+	clampSpanIfNeeded(output, length);
+}
+
 /* ******** Mix Ovelray Operation ******** */
 
 MixOverlayOperation::MixOverlayOperation() : MixBaseOperation()
@@ -713,7 +893,7 @@ void MixSaturationOperation::executePixelSampled(float output[4], float x, float
 
 MixScreenOperation::MixScreenOperation() : MixBaseOperation()
 {
-	/* pass */
+	this->setSpanSupport(true);
 }
 
 void MixScreenOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
@@ -740,6 +920,39 @@ void MixScreenOperation::executePixelSampled(float output[4], float x, float y,
 	clampIfNeeded(output);
 }
 
+void MixScreenOperation::executeSpan(float *output, int x, int y, int length)
+{
+	float inputValue[COM_SPAN_MAX_LENGTH * 4];
+	float inputColor1[COM_SPAN_MAX_LENGTH * 4];
+	float inputColor2[COM_SPAN_MAX_LENGTH * 4];
+
+	readSpanInputs(inputValue, inputColor1, inputColor2, x, y, length);
+
+#ifdef __SSE2__
+	const __m128 one4 = _mm_set1_ps(1.0f);
+#endif
+
+	for (int i = 0; i < length * 4; i += 4) {
+		const float value = inputValue[i];
+		const float valuem = 1.0f - value;
+#ifdef __SSE2__
+		const __m128 value4 = _mm_set1_ps(value);
+		const __m128 valuem4 = _mm_set1_ps(valuem);
+		const __m128 color1 = _mm_loadu_ps(&inputColor1[i]);
+		const __m128 color2 = _mm_loadu_ps(&inputColor2[i]);
+		const __m128 factor = _mm_add_ps(valuem4, _mm_mul_ps(value4, _mm_sub_ps(one4, color2)));
+		_mm_storeu_ps(&output[i], _mm_sub_ps(one4, _mm_mul_ps(factor, _mm_sub_ps(one4, color1))));
+#else
+		output[i] = 1.0f - (valuem + value * (1.0f - inputColor2[i])) * (1.0f - inputColor1[i]);
+		output[i + 1] = 1.0f - (valuem + value * (1.0f - inputColor2[i + 1])) * (1.0f - inputColor1[i + 1]);
+		output[i + 2] = 1.0f - (valuem + value * (1.0f - inputColor2[i + 2])) * (1.0f - inputColor1[i + 2]);
+#endif
+		output[i + 3] = inputColor1[i + 3];
+	}
+
+	clampSpanIfNeeded(output, length);
+}
+
 /* ******** Mix Soft Light Operation ******** */
 
 MixSoftLightOperation::MixSoftLightOperation() : MixBaseOperation()
@@ -781,7 +994,7 @@ void MixSoftLightOperation::executePixelSampled(float output[4], float x, float
 
 MixSubtractOperation::MixSubtractOperation() : MixBaseOperation()
 {
-	/* pass */
+	this->setSpanSupport(true);
 }
 
 void MixSubtractOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
@@ -806,6 +1019,32 @@ void MixSubtractOperation::executePixelSampled(float output[4], float x, float y
 	clampIfNeeded(output);
 }
 
+void MixSubtractOperation::executeSpan(float *output, int x, int y, int length)
+{
+	float inputValue[COM_SPAN_MAX_LENGTH * 4];
+	float inputColor1[COM_SPAN_MAX_LENGTH * 4];
+	float inputColor2[COM_SPAN_MAX_LENGTH * 4];
+
+	readSpanInputs(inputValue, inputColor1, inputColor2, x, y, length);
+
+	for (int i = 0; i < length * 4; i += 4) {
+		const float value = inputValue[i];
+#ifdef __SSE2__
+		const __m128 value4 = _mm_set1_ps(value);
+		const __m128 color1 = _mm_loadu_ps(&inputColor1[i]);
+		const __m128 color2 = _mm_loadu_ps(&inputColor2[i]);
+		_mm_storeu_ps(&output[i], _mm_sub_ps(color1, _mm_mul_ps(value4, color2)));
+#else
+		output[i] = inputColor1[i] - value * inputColor2[i];
+		output[i + 1] = inputColor1[i + 1] - value * inputColor2[i + 1];
+		output[i + 2] = inputColor1[i + 2] - value * inputColor2[i + 2];
+#endif
+		output[i + 3] = inputColor1[i + 3];
+	}
+
+	clampSpanIfNeeded(output, length);
+}
+
 /* ******** Mix Value Operation ******** */
 
 MixValueOperation::MixValueOperation() : MixBaseOperation()
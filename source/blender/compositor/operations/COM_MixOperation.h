@@ -24,6 +24,10 @@
 #define _COM_MixBaseOperation_h
 #include "COM_NodeOperation.h"
 
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
 
 /**
  * All this programs converts an input color to an output value.
@@ -50,6 +54,21 @@ protected:
 			CLAMP(color[3], 0.0f, 1.0f);
 		}
 	}
+
+	void clampSpanIfNeeded(float *output, int length)
+	{
+		if (m_useClamp) {
+			for (int i = 0; i < length * 4; i++) {
+				CLAMP(output[i], 0.0f, 1.0f);
+			}
+		}
+	}
+
+	/**
+	 * Read the input spans of the operation, the mix factor gets multiplied
+	 * with the alpha of the second color already when needed.
+	 */
+	void readSpanInputs(float *inputValue, float *inputColor1, float *inputColor2, int x, int y, int length);
 	
 public:
 	/**
@@ -84,12 +103,14 @@ class MixAddOperation : public MixBaseOperation {
 public:
 	MixAddOperation();
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeSpan(float *output, int x, int y, int length);
 };
 
 class MixBlendOperation : public MixBaseOperation {
 public:
 	MixBlendOperation();
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeSpan(float *output, int x, int y, int length);
 };
 
 class MixBurnOperation : public MixBaseOperation {
@@ -108,12 +129,14 @@ class MixDarkenOperation : public MixBaseOperation {
 public:
 	MixDarkenOperation();
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeSpan(float *output, int x, int y, int length);
 };
 
 class MixDifferenceOperation : public MixBaseOperation {
 public:
 	MixDifferenceOperation();
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeSpan(float *output, int x, int y, int length);
 };
 
 class MixDivideOperation : public MixBaseOperation {
@@ -144,6 +167,7 @@ class MixLightenOperation : public MixBaseOperation {
 public:
 	MixLightenOperation();
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeSpan(float *output, int x, int y, int length);
 };
 
 class MixLinearLightOperation : public MixBaseOperation {
@@ -156,6 +180,7 @@ class MixMultiplyOperation : public MixBaseOperation {
 public:
 	MixMultiplyOperation();
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeSpan(float *output, int x, int y, int length);
 };
 
 class MixOverlayOperation : public MixBaseOperation {
@@ -174,6 +199,7 @@ class MixScreenOperation : public MixBaseOperation {
 public:
 	MixScreenOperation();
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeSpan(float *output, int x, int y, int length);
 };
 
 class MixSoftLightOperation : public MixBaseOperation {
@@ -186,6 +212,7 @@ class MixSubtractOperation : public MixBaseOperation {
 public:
 	MixSubtractOperation();
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeSpan(float *output, int x, int y, int length);
 };
 
 class MixValueOperation : public MixBaseOperation {
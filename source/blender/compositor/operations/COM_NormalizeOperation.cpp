@@ -21,6 +21,10 @@
 
 #include "COM_NormalizeOperation.h"
 
+#include "BLI_task.h"
+
+#include "MEM_guardedalloc.h"
+
 NormalizeOperation::NormalizeOperation() : NodeOperation()
 {
 	this->addInputSocket(COM_DT_VALUE);
@@ -80,6 +84,36 @@ bool NormalizeOperation::determineDependingAreaOfInterest(rcti * /*input*/, Read
 /* The code below assumes all data is inside range +- this, and that input buffer is single channel */
 #define BLENDER_ZMAX 10000.0f
 
+typedef struct NormalizeTaskData {
+	MemoryBuffer *tile;
+	float *minv;
+	float *maxv;
+} NormalizeTaskData;
+
+static void normalize_min_max_row_task(void *userdata, const int y)
+{
+	NormalizeTaskData *data = (NormalizeTaskData *)userdata;
+	const int width = data->tile->getWidth();
+	const float *bc = data->tile->getBuffer() + (size_t)y * width;
+
+	float minv = 1.0f + BLENDER_ZMAX;
+	float maxv = -1.0f - BLENDER_ZMAX;
+
+	float value;
+	for (int x = 0; x < width; x++) {
+		value = bc[x];
+		if ((value > maxv) && (value <= BLENDER_ZMAX)) {
+			maxv = value;
+		}
+		if ((value < minv) && (value >= -BLENDER_ZMAX)) {
+			minv = value;
+		}
+	}
+
+	data->minv[y] = minv;
+	data->maxv[y] = maxv;
+}
+
 void *NormalizeOperation::initializeTileData(rcti *rect)
 {
 	lockMutex();
@@ -88,25 +122,24 @@ void *NormalizeOperation::initializeTileData(rcti *rect)
 		/* using generic two floats struct to store x: min  y: mult */
 		NodeTwoFloats *minmult = new NodeTwoFloats();
 
-		float *buffer = tile->getBuffer();
-		int p = tile->getWidth() * tile->getHeight();
-		float *bc = buffer;
+		const int height = tile->getHeight();
+		NormalizeTaskData data;
+		data.tile = tile;
+		data.minv = (float *)MEM_mallocN(sizeof(float) * height, __func__);
+		data.maxv = (float *)MEM_mallocN(sizeof(float) * height, __func__);
+		BLI_task_parallel_range(0, height, &data, normalize_min_max_row_task, tile->getWidth() * height > 10000);
 
 		float minv = 1.0f + BLENDER_ZMAX;
 		float maxv = -1.0f - BLENDER_ZMAX;
 
-		float value;
-		while (p--) {
-			value = bc[0];
-			if ((value > maxv) && (value <= BLENDER_ZMAX)) {
-				maxv = value;
-			}
-			if ((value < minv) && (value >= -BLENDER_ZMAX)) {
-				minv = value;
-			}
-			bc ++;
+		for (int y = 0; y < height; y++) {
+			minv = min_ff(minv, data.minv[y]);
+			maxv = max_ff(maxv, data.maxv[y]);
 		}
 
+		MEM_freeN(data.minv);
+		MEM_freeN(data.maxv);
+
 		minmult->x = minv;
 		/* The rare case of flat buffer  would cause a divide by 0 */
 		minmult->y = ((maxv != minv) ? 1.0f / (maxv - minv) : 0.0f);
@@ -30,6 +30,7 @@ ReadBufferOperation::ReadBufferOperation(DataType datatype) : NodeOperation()
 	this->m_single_value = false;
 	this->m_offset = 0;
 	this->m_buffer = NULL;
+	this->setSpanSupport(true);
 }
 
 void *ReadBufferOperation::initializeTileData(rcti * /*rect*/)
@@ -74,6 +75,22 @@ void ReadBufferOperation::executePixelSampled(float output[4], float x, float y,
 	}
 }
 
+void ReadBufferOperation::executeSpan(float *output, int x, int y, int length)
+{
+	if (m_single_value) {
+		/* write buffer has a single value stored at (0,0) */
+		m_buffer->read(output, 0, 0);
+		for (int i = 1; i < length; i++) {
+			copy_v4_v4(&output[i * 4], output);
+		}
+	}
+	else {
+		for (int i = 0; i < length; i++) {
+			m_buffer->read(&output[i * 4], x + i, y);
+		}
+	}
+}
+
 void ReadBufferOperation::executePixelExtend(float output[4], float x, float y, PixelSampler sampler,
                                              MemoryBufferExtend extend_x, MemoryBufferExtend extend_y)
 {
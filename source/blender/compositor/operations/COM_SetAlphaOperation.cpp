@@ -27,6 +27,7 @@ SetAlphaOperation::SetAlphaOperation() : NodeOperation()
 	this->addInputSocket(COM_DT_COLOR);
 	this->addInputSocket(COM_DT_VALUE);
 	this->addOutputSocket(COM_DT_COLOR);
+	this->setSpanSupport(true);
 	
 	this->m_inputColor = NULL;
 	this->m_inputAlpha = NULL;
@@ -48,6 +49,18 @@ void SetAlphaOperation::executePixelSampled(float output[4], float x, float y, P
 	output[3] = alphaInput[0];
 }
 
+void SetAlphaOperation::executeSpan(float *output, int x, int y, int length)
+{
+	float alphaInput[COM_SPAN_MAX_LENGTH * 4];
+
+	this->m_inputColor->readSpan(output, x, y, length);
+	this->m_inputAlpha->readSpan(alphaInput, x, y, length);
+
+	for (int i = 0; i < length * 4; i += 4) {
+		output[i + 3] = alphaInput[i];
+	}
+}
+
 void SetAlphaOperation::deinitExecution()
 {
 	this->m_inputColor = NULL;
@@ -25,6 +25,7 @@
 SetColorOperation::SetColorOperation() : NodeOperation()
 {
 	this->addOutputSocket(COM_DT_COLOR);
+	this->setSpanSupport(true);
 }
 
 void SetColorOperation::executePixelSampled(float output[4],
@@ -34,6 +35,13 @@ void SetColorOperation::executePixelSampled(float output[4],
 	copy_v4_v4(output, this->m_color);
 }
 
+void SetColorOperation::executeSpan(float *output, int /*x*/, int /*y*/, int length)
+{
+	for (int i = 0; i < length * 4; i += 4) {
+		copy_v4_v4(&output[i], this->m_color);
+	}
+}
+
 void SetColorOperation::determineResolution(unsigned int resolution[2], unsigned int preferredResolution[2])
 {
 	resolution[0] = preferredResolution[0];
@@ -25,6 +25,7 @@
 SetValueOperation::SetValueOperation() : NodeOperation()
 {
 	this->addOutputSocket(COM_DT_VALUE);
+	this->setSpanSupport(true);
 }
 
 void SetValueOperation::executePixelSampled(float output[4],
@@ -34,6 +35,13 @@ void SetValueOperation::executePixelSampled(float output[4],
 	output[0] = this->m_value;
 }
 
+void SetValueOperation::executeSpan(float *output, int /*x*/, int /*y*/, int length)
+{
+	for (int i = 0; i < length * 4; i += 4) {
+		output[i] = this->m_value;
+	}
+}
+
 void SetValueOperation::determineResolution(unsigned int resolution[2], unsigned int preferredResolution[2])
 {
 	resolution[0] = preferredResolution[0];
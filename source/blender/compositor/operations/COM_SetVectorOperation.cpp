@@ -26,6 +26,7 @@
 SetVectorOperation::SetVectorOperation() : NodeOperation()
 {
 	this->addOutputSocket(COM_DT_VECTOR);
+	this->setSpanSupport(true);
 }
 
 void SetVectorOperation::executePixelSampled(float output[4],
@@ -37,6 +38,15 @@ void SetVectorOperation::executePixelSampled(float output[4],
 	output[2] = this->m_z;
 }
 
+void SetVectorOperation::executeSpan(float *output, int /*x*/, int /*y*/, int length)
+{
+	for (int i = 0; i < length * 4; i += 4) {
+		output[i] = this->m_x;
+		output[i + 1] = this->m_y;
+		output[i + 2] = this->m_z;
+	}
+}
+
 void SetVectorOperation::determineResolution(unsigned int resolution[2], unsigned int preferredResolution[2])
 {
 	resolution[0] = preferredResolution[0];
@@ -22,8 +22,11 @@
 
 #include "COM_TonemapOperation.h"
 #include "BLI_math.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
+#include "MEM_guardedalloc.h"
+
 extern "C" {
 #include "IMB_colormanagement.h"
 }
@@ -112,6 +115,43 @@ bool TonemapOperation::determineDependingAreaOfInterest(rcti * /*input*/, ReadBu
 	return false;
 }
 
+/* luminance statistics of a single row, summed in double so large images don't lose precision */
+typedef struct TonemapRowSums {
+	double lav;
+	double cav[3];
+	double lsum;
+	float maxl, minl;
+} TonemapRowSums;
+
+typedef struct TonemapTaskData {
+	MemoryBuffer *tile;
+	TonemapRowSums *rows;
+} TonemapTaskData;
+
+static void tonemap_luminance_row_task(void *userdata, const int y)
+{
+	TonemapTaskData *data = (TonemapTaskData *)userdata;
+	const int width = data->tile->getWidth();
+	const float *bc = data->tile->getBuffer() + (size_t)y * width * COM_NUM_CHANNELS_COLOR;
+	TonemapRowSums *row = &data->rows[y];
+
+	row->lav = row->lsum = 0.0;
+	row->cav[0] = row->cav[1] = row->cav[2] = 0.0;
+	row->maxl = -1e10f;
+	row->minl = 1e10f;
+
+	for (int x = 0; x < width; x++, bc += 4) {
+		float L = IMB_colormanagement_get_luminance(bc);
+		row->lav += L;
+		row->cav[0] += bc[0];
+		row->cav[1] += bc[1];
+		row->cav[2] += bc[2];
+		row->lsum += logf(MAX2(L, 0.0f) + 1e-5f);
+		row->maxl = (L > row->maxl) ? L : row->maxl;
+		row->minl = (L < row->minl) ? L : row->minl;
+	}
+}
+
 void *TonemapOperation::initializeTileData(rcti *rect)
 {
 	lockMutex();
@@ -119,26 +159,35 @@ void *TonemapOperation::initializeTileData(rcti *rect)
 		MemoryBuffer *tile = (MemoryBuffer *)this->m_imageReader->initializeTileData(rect);
 		AvgLogLum *data = new AvgLogLum();
 
-		float *buffer = tile->getBuffer();
+		const int height = tile->getHeight();
+		TonemapTaskData task_data;
+		task_data.tile = tile;
+		task_data.rows = (TonemapRowSums *)MEM_mallocN(sizeof(TonemapRowSums) * height, __func__);
+		BLI_task_parallel_range(0, height, &task_data, tonemap_luminance_row_task,
+		                        tile->getWidth() * height > 10000);
 
-		float lsum = 0.0f;
-		int p = tile->getWidth() * tile->getHeight();
-		float *bc = buffer;
+		double lsum = 0.0;
+		int p = tile->getWidth() * height;
 		float avl, maxl = -1e10f, minl = 1e10f;
-		const float sc = 1.0f / p;
-		float Lav = 0.0f;
-		float cav[4] = {0.0f, 0.0f, 0.0f, 0.0f};
-		while (p--) {
-			float L = IMB_colormanagement_get_luminance(bc);
-			Lav += L;
-			add_v3_v3(cav, bc);
-			lsum += logf(MAX2(L, 0.0f) + 1e-5f);
-			maxl = (L > maxl) ? L : maxl;
-			minl = (L < minl) ? L : minl;
-			bc += 4;
+		const double sc = 1.0 / p;
+		double Lav = 0.0;
+		double cav[3] = {0.0, 0.0, 0.0};
+		for (int y = 0; y < height; y++) {
+			const TonemapRowSums *row = &task_data.rows[y];
+			Lav += row->lav;
+			cav[0] += row->cav[0];
+			cav[1] += row->cav[1];
+			cav[2] += row->cav[2];
+			lsum += row->lsum;
+			maxl = (row->maxl > maxl) ? row->maxl : maxl;
+			minl = (row->minl < minl) ? row->minl : minl;
 		}
+		MEM_freeN(task_data.rows);
+
 		data->lav = Lav * sc;
-		mul_v3_v3fl(data->cav, cav, sc);
+		data->cav[0] = cav[0] * sc;
+		data->cav[1] = cav[1] * sc;
+		data->cav[2] = cav[2] * sc;
 		maxl = log((double)maxl + 1e-5); minl = log((double)minl + 1e-5); avl = lsum * sc;
 		data->auto_key = (maxl > minl) ? ((maxl - avl) / (maxl - minl)) : 1.0f;
 		float al = exp((double)avl);
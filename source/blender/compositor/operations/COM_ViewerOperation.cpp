@@ -96,23 +96,45 @@ void ViewerOperation::executeRegion(rcti *rect, unsigned int /*tileNumber*/)
 	const int offsetadd4 = offsetadd * 4;
 	int offset = (y1 * this->getWidth() + x1);
 	int offset4 = offset * 4;
-	float alpha[4], depth[4];
+	float alpha[COM_SPAN_MAX_LENGTH * 4], depth[COM_SPAN_MAX_LENGTH * 4];
 	int x;
 	int y;
+	int i;
 	bool breaked = false;
 
 	for (y = y1; y < y2 && (!breaked); y++) {
-		for (x = x1; x < x2; x++) {
-			this->m_imageInput->readSampled(&(buffer[offset4]), x, y, COM_PS_NEAREST);
-			if (this->m_useAlphaInput) {
-				this->m_alphaInput->readSampled(alpha, x, y, COM_PS_NEAREST);
-				buffer[offset4 + 3] = alpha[0];
+		if (this->useSpanExecution()) {
+			for (x = x1; x < x2; x += COM_SPAN_MAX_LENGTH) {
+				const int length = min(x2 - x, COM_SPAN_MAX_LENGTH);
+				this->m_imageInput->readSpan(&(buffer[offset4]), x, y, length);
+				if (this->m_useAlphaInput) {
+					this->m_alphaInput->readSpan(alpha, x, y, length);
+					for (i = 0; i < length; i++) {
+						buffer[offset4 + i * 4 + 3] = alpha[i * 4];
+					}
+				}
+				this->m_depthInput->readSpan(depth, x, y, length);
+				for (i = 0; i < length; i++) {
+					depthbuffer[offset + i] = depth[i * 4];
+				}
+
+				offset += length;
+				offset4 += length * 4;
+			}
+		}
+		else {
+			for (x = x1; x < x2; x++) {
+				this->m_imageInput->readSampled(&(buffer[offset4]), x, y, COM_PS_NEAREST);
+				if (this->m_useAlphaInput) {
+					this->m_alphaInput->readSampled(alpha, x, y, COM_PS_NEAREST);
+					buffer[offset4 + 3] = alpha[0];
+				}
+				this->m_depthInput->readSampled(depth, x, y, COM_PS_NEAREST);
+				depthbuffer[offset] = depth[0];
+
+				offset ++;
+				offset4 += 4;
 			}
-			this->m_depthInput->readSampled(depth, x, y, COM_PS_NEAREST);
-			depthbuffer[offset] = depth[0];
-
-			offset ++;
-			offset4 += 4;
 		}
 		if (isBreaked()) {
 			breaked = true;
@@ -26,6 +26,7 @@
 WrapOperation::WrapOperation(DataType datatype) : ReadBufferOperation(datatype)
 {
 	this->m_wrappingType = CMP_NODE_WRAP_NONE;
+	this->setSpanSupport(false);
 }
 
 inline float WrapOperation::getWrappedOriginalXPos(float x)
@@ -42,6 +43,12 @@ inline float WrapOperation::getWrappedOriginalYPos(float y)
 	return fmodf(y, this->getHeight());
 }
 
+void WrapOperation::executeSpan(float *output, int x, int y, int length)
+{
+	/* don't use the span reading of ReadBufferOperation, wrapping is done per pixel */
+	NodeOperation::executeSpan(output, x, y, length);
+}
+
 void WrapOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
 {
 	float nx, ny;
@@ -25,12 +25,15 @@
 #include <stdio.h>
 #include "COM_OpenCLDevice.h"
 
+#include "MEM_guardedalloc.h"
+
 WriteBufferOperation::WriteBufferOperation(DataType datatype) : NodeOperation()
 {
 	this->addInputSocket(datatype);
 	this->m_memoryProxy = new MemoryProxy(datatype);
 	this->m_memoryProxy->setWriteBufferOperation(this);
 	this->m_memoryProxy->setExecutor(NULL);
+	this->m_cacheKey = 0;
 }
 WriteBufferOperation::~WriteBufferOperation()
 {
@@ -60,23 +63,38 @@ void WriteBufferOperation::deinitExecution()
 void WriteBufferOperation::executeRegion(rcti *rect, unsigned int /*tileNumber*/)
 {
 	MemoryBuffer *memoryBuffer = this->m_memoryProxy->getBuffer();
-	float *buffer = memoryBuffer->getBuffer();
 	const int num_channels = memoryBuffer->get_num_channels();
+	const int width = memoryBuffer->getWidth();
+	int x1 = rect->xmin;
+	int y1 = rect->ymin;
+	int x2 = rect->xmax;
+	int y2 = rect->ymax;
+
+	/* half float buffers are calculated a row at a time and converted afterwards,
+	 * with room for reads of the last pixel that write all color channels */
+	const bool half_float = memoryBuffer->isHalfFloat();
+	float *buffer = half_float ? NULL : memoryBuffer->getBuffer();
+	float *row_buffer = NULL;
+	if (half_float) {
+		row_buffer = (float *)MEM_mallocN(sizeof(float) * ((x2 - x1) * num_channels + COM_NUM_CHANNELS_COLOR),
+		                                  "WriteBufferOperation row");
+	}
+
 	if (this->m_input->isComplex()) {
 		void *data = this->m_input->initializeTileData(rect);
-		int x1 = rect->xmin;
-		int y1 = rect->ymin;
-		int x2 = rect->xmax;
-		int y2 = rect->ymax;
 		int x;
 		int y;
 		bool breaked = false;
 		for (y = y1; y < y2 && (!breaked); y++) {
-			int offset4 = (y * memoryBuffer->getWidth() + x1) * num_channels;
+			float *row = half_float ? row_buffer : &buffer[(y * width + x1) * num_channels];
+			int offset4 = 0;
 			for (x = x1; x < x2; x++) {
-				this->m_input->read(&(buffer[offset4]), x, y, data);
+				this->m_input->read(&(row[offset4]), x, y, data);
 				offset4 += num_channels;
 			}
+			if (half_float) {
+				float_to_half_vn(&memoryBuffer->getHalfBuffer()[(y * width + x1) * num_channels], row, (x2 - x1) * num_channels);
+			}
 			if (isBreaked()) {
 				breaked = true;
 			}
@@ -87,26 +105,60 @@ void WriteBufferOperation::executeRegion(rcti *rect, unsigned int /*tileNumber*/
 			data = NULL;
 		}
 	}
-	else {
-		int x1 = rect->xmin;
-		int y1 = rect->ymin;
-		int x2 = rect->xmax;
-		int y2 = rect->ymax;
+	else if (this->useSpanExecution()) {
+		float span[COM_SPAN_MAX_LENGTH * 4];
 
+		int x;
+		int y;
+		int i;
+		bool breaked = false;
+		for (y = y1; y < y2 && (!breaked); y++) {
+			float *row = half_float ? row_buffer : &buffer[(y * width + x1) * num_channels];
+			int offset = 0;
+			for (x = x1; x < x2; x += COM_SPAN_MAX_LENGTH) {
+				const int length = min(x2 - x, COM_SPAN_MAX_LENGTH);
+				this->m_input->readSpan(span, x, y, length);
+				if (num_channels == 4) {
+					memcpy(&row[offset], span, sizeof(float) * 4 * length);
+				}
+				else {
+					for (i = 0; i < length; i++) {
+						memcpy(&row[offset + i * num_channels], &span[i * 4], sizeof(float) * num_channels);
+					}
+				}
+				offset += length * num_channels;
+			}
+			if (half_float) {
+				float_to_half_vn(&memoryBuffer->getHalfBuffer()[(y * width + x1) * num_channels], row, (x2 - x1) * num_channels);
+			}
+			if (isBreaked()) {
+				breaked = true;
+			}
+		}
+	}
+	else {
 		int x;
 		int y;
 		bool breaked = false;
 		for (y = y1; y < y2 && (!breaked); y++) {
-			int offset4 = (y * memoryBuffer->getWidth() + x1) * num_channels;
+			float *row = half_float ? row_buffer : &buffer[(y * width + x1) * num_channels];
+			int offset4 = 0;
 			for (x = x1; x < x2; x++) {
-				this->m_input->readSampled(&(buffer[offset4]), x, y, COM_PS_NEAREST);
+				this->m_input->readSampled(&(row[offset4]), x, y, COM_PS_NEAREST);
 				offset4 += num_channels;
 			}
+			if (half_float) {
+				float_to_half_vn(&memoryBuffer->getHalfBuffer()[(y * width + x1) * num_channels], row, (x2 - x1) * num_channels);
+			}
 			if (isBreaked()) {
 				breaked = true;
 			}
 		}
 	}
+
+	if (row_buffer) {
+		MEM_freeN(row_buffer);
+	}
 	memoryBuffer->setCreatedState();
 }
 
@@ -115,6 +167,8 @@ void WriteBufferOperation::executeOpenCLRegion(OpenCLDevice *device, rcti * /*re
 {
 	float *outputFloatBuffer = outputBuffer->getBuffer();
 	cl_int error;
+	/* OpenCL images use the float buffers as host memory, see determine_half_float_buffers */
+	BLI_assert(!this->getMemoryProxy()->isHalfFloat());
 	/*
 	 * 1. create cl_mem from outputbuffer
 	 * 2. call NodeOperation (input) executeOpenCLChunk(.....)
@@ -26,6 +26,7 @@
 #include "COM_NodeOperation.h"
 #include "COM_MemoryProxy.h"
 #include "COM_SocketReader.h"
+#include <stdint.h>
 /**
  * @brief NodeOperation to write to a tile
  * @ingroup Operation
@@ -34,6 +35,7 @@ class WriteBufferOperation : public NodeOperation {
 	MemoryProxy *m_memoryProxy;
 	bool m_single_value; /* single value stored in buffer */
 	NodeOperation *m_input;
+	uint64_t m_cacheKey; /* key of the result in the ResultCache, 0 when it can't be cached */
 public:
 	WriteBufferOperation(DataType datatype);
 	~WriteBufferOperation();
@@ -51,6 +53,8 @@ public:
 	inline NodeOperation *getInput() {
 		return m_input;
 	}
+	void setCacheKey(uint64_t key) { this->m_cacheKey = key; }
+	uint64_t getCacheKey() const { return this->m_cacheKey; }
 
 };
 #endif
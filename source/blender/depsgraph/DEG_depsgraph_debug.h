@@ -90,6 +90,22 @@ void DEG_stats_simple(const struct Depsgraph *graph,
 
 void DEG_debug_graphviz(const struct Depsgraph *graph, FILE *stream, const char *label, bool show_eval);
 
+/* ************************************************ */
+/* Evaluation Tracing */
+
+/* Start recording evaluated operations of all graphs.
+ * If filepath is given, the trace is written there by DEG_debug_trace_end().
+ */
+void DEG_debug_trace_begin(const char *filepath);
+
+/* Stop recording evaluated operations, recorded data is kept. */
+void DEG_debug_trace_end(void);
+
+/* Write recorded operations in Chrome Trace Event format,
+ * which can be viewed with chrome://tracing.
+ */
+bool DEG_debug_trace_write(const char *filepath);
+
 /* ************************************************ */
 
 /* Compare two dependency graphs. */
@@ -382,6 +382,22 @@ DepsRelation *Depsgraph::add_new_relation(DepsNode *from, DepsNode *to,
 	return rel;
 }
 
+DepsRelation *Depsgraph::find_relation(const DepsNode *from,
+                                       const DepsNode *to,
+                                       const char *description) const
+{
+	for (DepsNode::Relations::const_iterator it = from->outlinks.begin();
+	     it != from->outlinks.end();
+	     ++it)
+	{
+		DepsRelation *rel = *it;
+		if (rel->to == to && STREQ(rel->name, description)) {
+			return rel;
+		}
+	}
+	return NULL;
+}
+
 /* ************************ */
 /* Relationships Management */
 
@@ -393,7 +409,8 @@ DepsRelation::DepsRelation(DepsNode *from,
     to(to),
     name(description),
     type(type),
-    flag(0)
+    flag(0),
+    owner_id(NULL)
 {
 #ifndef NDEBUG
 /*
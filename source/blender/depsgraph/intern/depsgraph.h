@@ -81,6 +81,12 @@ struct DepsRelation {
 	eDepsRelation_Type type;      /* type */
 	int flag;                     /* (eDepsRelation_Flag) */
 
+	/* ID which was being built when relation was added, used by partial
+	 * relations update to know which relations are to be re-created.
+	 * NULL for relations added outside of per-object building.
+	 */
+	const ID *owner_id;
+
 	DepsRelation(DepsNode *from,
 	             DepsNode *to,
 	             eDepsRelation_Type type,
@@ -98,6 +104,7 @@ struct Depsgraph {
 	typedef unordered_set<SubgraphDepsNode *> Subgraphs;
 	typedef unordered_set<OperationDepsNode *> EntryTags;
 	typedef vector<OperationDepsNode *> OperationNodes;
+	typedef unordered_set<const ID *> IDSet;
 
 	Depsgraph();
 	~Depsgraph();
@@ -153,6 +160,11 @@ struct Depsgraph {
 	                               eDepsRelation_Type type,
 	                               const char *description);
 
+	/* Find existing relation between two nodes with the given description. */
+	DepsRelation *find_relation(const DepsNode *from,
+	                            const DepsNode *to,
+	                            const char *description) const;
+
 	/* Tag a specific node as needing updates. */
 	void add_entry_tag(OperationDepsNode *node);
 
@@ -174,6 +186,11 @@ struct Depsgraph {
 	/* Indicates whether relations needs to be updated. */
 	bool need_update;
 
+	/* IDs which relations were tagged for update without tagging the whole
+	 * graph. Used to only re-create relations of those IDs when possible.
+	 */
+	IDSet id_relations_tags;
+
 	/* Quick-Access Temp Data ............. */
 
 	/* Nodes which have been tagged as "directly modified". */
@@ -259,6 +259,312 @@ static void deg_graph_build_finalize(Depsgraph *graph)
 	}
 }
 
+/* ************************ */
+/* Partial Relations Update */
+
+/* Find base of the scene which is used by the given ID.
+ *
+ * NOTE: Only pointers are compared, ID might have been freed already.
+ */
+static Base *deg_scene_base_find(Scene *scene, const ID *id)
+{
+	for (Base *base = (Base *)scene->base.first; base != NULL; base = base->next) {
+		if (&base->object->id == id) {
+			return base;
+		}
+	}
+	return NULL;
+}
+
+/* Partial update only handles objects which nodes and relations are only
+ * built from their own base.
+ */
+static bool deg_object_partial_update_supported(Object *ob)
+{
+	return (ob->proxy == NULL) &&
+	       (ob->proxy_from == NULL) &&
+	       (ob->dup_group == NULL) &&
+	       (ob->flag & OB_FROMGROUP) == 0 &&
+	       (ob->rigidbody_object == NULL) &&
+	       (ob->rigidbody_constraint == NULL);
+}
+
+/* Restore layers of ID nodes to the state they've got after nodes building,
+ * so they can be flushed again from scratch.
+ */
+static void deg_graph_reset_layers(Depsgraph *graph, Scene *scene)
+{
+	if (scene->set) {
+		deg_graph_reset_layers(graph, scene->set);
+	}
+	else {
+		for (Depsgraph::IDNodeMap::const_iterator it = graph->id_hash.begin();
+		     it != graph->id_hash.end();
+		     ++it)
+		{
+			IDDepsNode *id_node = it->second;
+			id_node->layers = (1 << 20) - 1;
+		}
+	}
+
+	/* Matches base iteration of the node builder. */
+	unordered_set<Group *> groups;
+	for (Base *base = (Base *)scene->base.first; base; base = base->next) {
+		Object *ob = base->object;
+		IDDepsNode *id_node = graph->find_id_node(&ob->id);
+		if (id_node != NULL) {
+			id_node->layers = base->lay;
+		}
+		if (ob->proxy) {
+			id_node = graph->find_id_node(&ob->proxy->id);
+			if (id_node != NULL) {
+				id_node->layers = base->lay;
+			}
+		}
+		if (ob->dup_group && groups.find(ob->dup_group) == groups.end()) {
+			groups.insert(ob->dup_group);
+			for (GroupObject *go = (GroupObject *)ob->dup_group->gobject.first;
+			     go != NULL;
+			     go = go->next)
+			{
+				id_node = graph->find_id_node(&go->ob->id);
+				if (id_node != NULL) {
+					id_node->layers = base->lay;
+				}
+			}
+		}
+	}
+}
+
+/* Re-create nodes and relations of the objects which relations were tagged
+ * for update, leaving the rest of the graph untouched.
+ *
+ * Returns false if the update could not be done partially. The graph is
+ * to be rebuilt from scratch then.
+ */
+static bool deg_graph_relations_update_partial(Depsgraph *graph,
+                                               Main *bmain,
+                                               Scene *scene)
+{
+	typedef pair<OperationDepsNode *, OperationDepsNode *> ComponentBounds;
+	typedef unordered_map<ComponentDepsNode *, ComponentBounds> ComponentBoundsMap;
+
+	/* Transitive reduction removes relations which we can't restore. */
+	if (G.debug_value == 799) {
+		return false;
+	}
+
+	vector<Base *> bases;
+	for (Depsgraph::IDSet::const_iterator it = graph->id_relations_tags.begin();
+	     it != graph->id_relations_tags.end();
+	     ++it)
+	{
+		Base *base = deg_scene_base_find(scene, *it);
+		if (base == NULL || !deg_object_partial_update_supported(base->object)) {
+			return false;
+		}
+		bases.push_back(base);
+	}
+
+	/* 1) Re-create nodes of tagged objects.
+	 *
+	 * Operations which are still needed are re-used, so all the relations
+	 * from other objects to them stay valid.
+	 */
+	BKE_main_id_tag_all(bmain, LIB_TAG_DOIT, false);
+	for (Depsgraph::IDNodeMap::const_iterator it = graph->id_hash.begin();
+	     it != graph->id_hash.end();
+	     ++it)
+	{
+		it->second->id->tag |= LIB_TAG_DOIT;
+	}
+
+	ComponentBoundsMap component_bounds;
+	for (vector<Base *>::const_iterator it = bases.begin(); it != bases.end(); ++it) {
+		Object *ob = (*it)->object;
+		IDDepsNode *id_node = graph->find_id_node(&ob->id);
+		for (IDDepsNode::ComponentMap::const_iterator it_comp = id_node->components.begin();
+		     it_comp != id_node->components.end();
+		     ++it_comp)
+		{
+			ComponentDepsNode *comp_node = it_comp->second;
+			component_bounds[comp_node] = ComponentBounds(comp_node->get_entry_operation(),
+			                                              comp_node->get_exit_operation());
+			comp_node->entry_operation = NULL;
+			comp_node->exit_operation = NULL;
+		}
+		id_node->eval_flags = 0;
+		ob->id.tag &= ~LIB_TAG_DOIT;
+	}
+
+	DepsgraphNodeBuilder::OperationSet touched_operations;
+	DepsgraphNodeBuilder node_builder(bmain, graph);
+	node_builder.set_touched_operations(&touched_operations);
+	for (vector<Base *>::const_iterator it = bases.begin(); it != bases.end(); ++it) {
+		node_builder.build_object(scene, *it, (*it)->object);
+	}
+
+	/* Remove operations which are not used anymore, remembering which
+	 * other objects had relations to them.
+	 */
+	Depsgraph::IDSet owners;
+	unordered_set<OperationDepsNode *> removed_operations;
+	for (vector<Base *>::const_iterator it = bases.begin(); it != bases.end(); ++it) {
+		Object *ob = (*it)->object;
+		IDDepsNode *id_node = graph->find_id_node(&ob->id);
+		vector<ComponentDepsNode *> components;
+		for (IDDepsNode::ComponentMap::const_iterator it_comp = id_node->components.begin();
+		     it_comp != id_node->components.end();
+		     ++it_comp)
+		{
+			components.push_back(it_comp->second);
+		}
+		for (vector<ComponentDepsNode *>::const_iterator it_comp = components.begin();
+		     it_comp != components.end();
+		     ++it_comp)
+		{
+			ComponentDepsNode *comp_node = *it_comp;
+			vector<OperationDepsNode *> unused_operations;
+			for (ComponentDepsNode::OperationMap::const_iterator it_op = comp_node->operations.begin();
+			     it_op != comp_node->operations.end();
+			     ++it_op)
+			{
+				OperationDepsNode *op_node = it_op->second;
+				if (touched_operations.find(op_node) == touched_operations.end()) {
+					unused_operations.push_back(op_node);
+				}
+			}
+			for (vector<OperationDepsNode *>::const_iterator it_op = unused_operations.begin();
+			     it_op != unused_operations.end();
+			     ++it_op)
+			{
+				OperationDepsNode *op_node = *it_op;
+				for (OperationDepsNode::Relations::const_iterator it_rel = op_node->inlinks.begin();
+				     it_rel != op_node->inlinks.end();
+				     ++it_rel)
+				{
+					owners.insert((*it_rel)->owner_id);
+				}
+				for (OperationDepsNode::Relations::const_iterator it_rel = op_node->outlinks.begin();
+				     it_rel != op_node->outlinks.end();
+				     ++it_rel)
+				{
+					owners.insert((*it_rel)->owner_id);
+				}
+				graph->entry_tags.erase(op_node);
+				removed_operations.insert(op_node);
+				comp_node->remove_operation((eDepsOperation_Code)op_node->opcode, op_node->name);
+			}
+
+			/* Relations of other objects are built using component's entry
+			 * and exit operations, so they must not change. New components
+			 * might be also used by relations which failed to be added before.
+			 */
+			if (comp_node->operations.empty()) {
+				id_node->remove_component(comp_node->type, comp_node->name);
+				continue;
+			}
+			ComponentBoundsMap::const_iterator it_bounds = component_bounds.find(comp_node);
+			if (it_bounds == component_bounds.end() ||
+			    it_bounds->second.first != comp_node->get_entry_operation() ||
+			    it_bounds->second.second != comp_node->get_exit_operation())
+			{
+				return false;
+			}
+		}
+	}
+
+	if (!removed_operations.empty()) {
+		size_t num_operations = 0;
+		for (size_t i = 0; i < graph->operations.size(); ++i) {
+			OperationDepsNode *op_node = graph->operations[i];
+			if (removed_operations.find(op_node) == removed_operations.end()) {
+				graph->operations[num_operations++] = op_node;
+			}
+		}
+		graph->operations.resize(num_operations);
+	}
+
+	/* Objects which lost relations to removed operations are to be rebuilt as well. */
+	vector<Object *> objects;
+	for (vector<Base *>::const_iterator it = bases.begin(); it != bases.end(); ++it) {
+		objects.push_back((*it)->object);
+		owners.erase(&(*it)->object->id);
+	}
+	for (Depsgraph::IDSet::const_iterator it = owners.begin(); it != owners.end(); ++it) {
+		Base *base = (*it != NULL) ? deg_scene_base_find(scene, *it) : NULL;
+		if (base == NULL || !deg_object_partial_update_supported(base->object)) {
+			return false;
+		}
+		objects.push_back(base->object);
+	}
+
+	/* 2) Remove relations which were built for the tagged objects, and build
+	 * them again. Relations which are shared with other objects might already
+	 * be in the graph, those are not added twice.
+	 */
+	for (vector<Base *>::const_iterator it = bases.begin(); it != bases.end(); ++it) {
+		Object *ob = (*it)->object;
+		IDDepsNode *id_node = graph->find_id_node(&ob->id);
+		for (IDDepsNode::ComponentMap::const_iterator it_comp = id_node->components.begin();
+		     it_comp != id_node->components.end();
+		     ++it_comp)
+		{
+			ComponentDepsNode *comp_node = it_comp->second;
+			for (ComponentDepsNode::OperationMap::const_iterator it_op = comp_node->operations.begin();
+			     it_op != comp_node->operations.end();
+			     ++it_op)
+			{
+				OperationDepsNode *op_node = it_op->second;
+				DEPSNODE_RELATIONS_ITER_BEGIN(op_node->inlinks, rel)
+				{
+					if (rel->owner_id == &ob->id) {
+						OBJECT_GUARDED_DELETE(rel, DepsRelation);
+					}
+				}
+				DEPSNODE_RELATIONS_ITER_END;
+				DEPSNODE_RELATIONS_ITER_BEGIN(op_node->outlinks, rel)
+				{
+					if (rel->owner_id == &ob->id) {
+						OBJECT_GUARDED_DELETE(rel, DepsRelation);
+					}
+				}
+				DEPSNODE_RELATIONS_ITER_END;
+			}
+		}
+	}
+
+	BKE_main_id_tag_all(bmain, LIB_TAG_DOIT, false);
+	DepsgraphRelationBuilder relation_builder(graph);
+	relation_builder.set_skip_existing_relations(true);
+	for (vector<Object *>::const_iterator it = objects.begin(); it != objects.end(); ++it) {
+		Object *ob = *it;
+		relation_builder.set_owner_id(&ob->id);
+		relation_builder.build_object(bmain, scene, ob);
+	}
+
+	/* 3) Detect cycles from scratch, they might have been solved by the update. */
+	for (Depsgraph::OperationNodes::const_iterator it_op = graph->operations.begin();
+	     it_op != graph->operations.end();
+	     ++it_op)
+	{
+		OperationDepsNode *op_node = *it_op;
+		for (OperationDepsNode::Relations::const_iterator it_rel = op_node->inlinks.begin();
+		     it_rel != op_node->inlinks.end();
+		     ++it_rel)
+		{
+			(*it_rel)->flag &= ~DEPSREL_FLAG_CYCLIC;
+		}
+	}
+	deg_graph_detect_cycles(graph);
+
+	/* 4) Flush visibility layer and re-schedule nodes for update. */
+	deg_graph_reset_layers(graph, scene);
+	deg_graph_build_finalize(graph);
+
+	return true;
+}
+
 /* ******************** */
 /* Graph Building API's */
 
@@ -310,6 +616,29 @@ void DEG_graph_tag_relations_update(Depsgraph *graph)
 	graph->need_update = true;
 }
 
+/* Tag relations of a given ID in the graph for update. */
+void DEG_graph_id_tag_relations_update(Depsgraph *graph, ID *id)
+{
+	/* ID is not in the graph, so its relations can't affect it. */
+	if (graph->find_id_node(id) == NULL) {
+		return;
+	}
+	graph->id_relations_tags.insert(id);
+}
+
+/* Tag relations of a given ID for update in all graphs. */
+void DEG_id_tag_relations_update(Main *bmain, ID *id)
+{
+	for (Scene *scene = (Scene *)bmain->scene.first;
+	     scene != NULL;
+	     scene = (Scene *)scene->id.next)
+	{
+		if (scene->depsgraph != NULL) {
+			DEG_graph_id_tag_relations_update(scene->depsgraph, id);
+		}
+	}
+}
+
 /* Tag all relations for update. */
 void DEG_relations_tag_update(Main *bmain)
 {
@@ -337,14 +666,27 @@ void DEG_scene_relations_update(Main *bmain, Scene *scene)
 
 	Depsgraph *graph = scene->depsgraph;
 	if (!graph->need_update) {
-		/* Graph is up to date, nothing to do. */
-		return;
+		if (graph->id_relations_tags.empty()) {
+			/* Graph is up to date, nothing to do. */
+			return;
+		}
+		/* Only some of the IDs changed relations, try to avoid full rebuild. */
+		bool updated = deg_graph_relations_update_partial(graph, bmain, scene);
+		graph->id_relations_tags.clear();
+		if (updated) {
+			/* Check partial update gives same results as the full one. */
+			if (G.debug_value == 798) {
+				DEG_debug_scene_relations_validate(bmain, scene);
+			}
+			return;
+		}
 	}
 
 	/* Clear all previous nodes and operations. */
 	graph->clear_all_nodes();
 	graph->operations.clear();
 	graph->entry_tags.clear();
+	graph->id_relations_tags.clear();
 
 	/* Build new nodes and relations. */
 	DEG_graph_build_from_scene(graph, bmain, scene);
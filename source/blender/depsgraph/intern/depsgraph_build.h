@@ -64,9 +64,20 @@ struct OperationDepsNode;
 struct RootPChanMap;
 
 struct DepsgraphNodeBuilder {
+	typedef unordered_set<OperationDepsNode *> OperationSet;
+
 	DepsgraphNodeBuilder(Main *bmain, Depsgraph *graph);
 	~DepsgraphNodeBuilder();
 
+	/* Partial update: re-use operations which already exist in the graph
+	 * instead of creating new ones, and collect all operations which were
+	 * (re-)added by the builder into the given set.
+	 */
+	void set_touched_operations(OperationSet *touched_operations)
+	{
+		m_touched_operations = touched_operations;
+	}
+
 	RootDepsNode *add_root_node();
 	IDDepsNode *add_id_node(ID *id);
 	TimeSourceDepsNode *add_time_source(ID *id);
@@ -130,6 +141,7 @@ struct DepsgraphNodeBuilder {
 private:
 	Main *m_bmain;
 	Depsgraph *m_graph;
+	OperationSet *m_touched_operations;
 };
 
 struct RootKey
@@ -244,6 +256,12 @@ struct DepsgraphRelationBuilder
 {
 	DepsgraphRelationBuilder(Depsgraph *graph);
 
+	/* ID which owns relations added from now on. */
+	void set_owner_id(const ID *owner_id) { m_owner_id = owner_id; }
+
+	/* Partial update: don't add relations which already exist in the graph. */
+	void set_skip_existing_relations(bool skip) { m_skip_existing_relations = skip; }
+
 	template <typename KeyFrom, typename KeyTo>
 	void add_relation(const KeyFrom &key_from, const KeyTo &key_to,
 	                  eDepsRelation_Type type, const char *description);
@@ -301,6 +319,8 @@ protected:
 
 private:
 	Depsgraph *m_graph;
+	const ID *m_owner_id;
+	bool m_skip_existing_relations;
 };
 
 struct DepsNodeHandle
@@ -111,7 +111,8 @@ extern "C" {
 
 DepsgraphNodeBuilder::DepsgraphNodeBuilder(Main *bmain, Depsgraph *graph) :
     m_bmain(bmain),
-    m_graph(graph)
+    m_graph(graph),
+    m_touched_operations(NULL)
 {
 }
 
@@ -194,6 +195,21 @@ OperationDepsNode *DepsgraphNodeBuilder::add_operation_node(
 		op_node = comp_node->add_operation(optype, op, opcode, description);
 		m_graph->operations.push_back(op_node);
 	}
+	else if (m_touched_operations != NULL &&
+	         m_touched_operations->find(op_node) == m_touched_operations->end())
+	{
+		/* Partial update: keep the node and its relations, only refresh the
+		 * callback since data it's bound to might have been re-allocated.
+		 */
+		op_node->evaluate = op;
+		op_node->optype = optype;
+		if (optype == DEPSOP_TYPE_INIT) {
+			comp_node->entry_operation = op_node;
+		}
+		else if (optype == DEPSOP_TYPE_POST) {
+			comp_node->exit_operation = op_node;
+		}
+	}
 	else {
 		fprintf(stderr, "add_operation: Operation already exists - %s has %s at %p\n",
 		        comp_node->identifier().c_str(),
@@ -201,6 +217,9 @@ OperationDepsNode *DepsgraphNodeBuilder::add_operation_node(
 		        op_node);
 		BLI_assert(!"Should not happen!");
 	}
+	if (m_touched_operations != NULL) {
+		m_touched_operations->insert(op_node);
+	}
 	return op_node;
 }
 
@@ -234,7 +253,17 @@ OperationDepsNode *DepsgraphNodeBuilder::find_operation_node(
         const string &description)
 {
 	ComponentDepsNode *comp_node = add_component_node(id, comp_type, comp_name);
-	return comp_node->has_operation(opcode, description);
+	OperationDepsNode *op_node = comp_node->has_operation(opcode, description);
+	if (op_node != NULL &&
+	    m_touched_operations != NULL &&
+	    m_touched_operations->find(op_node) == m_touched_operations->end())
+	{
+		/* Partial update: operation is left from the previous build and is
+		 * only considered existing once it's added again.
+		 */
+		return NULL;
+	}
+	return op_node;
 }
 
 
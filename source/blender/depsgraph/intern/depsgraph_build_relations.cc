@@ -123,7 +123,9 @@ RNAPathKey::RNAPathKey(ID *id, const char *path) :
 }
 
 DepsgraphRelationBuilder::DepsgraphRelationBuilder(Depsgraph *graph) :
-    m_graph(graph)
+    m_graph(graph),
+    m_owner_id(NULL),
+    m_skip_existing_relations(false)
 {
 }
 
@@ -209,7 +211,13 @@ void DepsgraphRelationBuilder::add_time_relation(TimeSourceDepsNode *timesrc,
                                                  const char *description)
 {
 	if (timesrc && node_to) {
-		m_graph->add_new_relation(timesrc, node_to, DEPSREL_TYPE_TIME, description);
+		if (m_skip_existing_relations &&
+		    m_graph->find_relation(timesrc, node_to, description) != NULL)
+		{
+			return;
+		}
+		DepsRelation *rel = m_graph->add_new_relation(timesrc, node_to, DEPSREL_TYPE_TIME, description);
+		rel->owner_id = m_owner_id;
 	}
 	else {
 		DEG_DEBUG_PRINTF("add_time_relation(%p = %s, %p = %s, %s) Failed\n",
@@ -226,7 +234,13 @@ void DepsgraphRelationBuilder::add_operation_relation(
         const char *description)
 {
 	if (node_from && node_to) {
-		m_graph->add_new_relation(node_from, node_to, type, description);
+		if (m_skip_existing_relations &&
+		    m_graph->find_relation(node_from, node_to, description) != NULL)
+		{
+			return;
+		}
+		DepsRelation *rel = m_graph->add_new_relation(node_from, node_to, type, description);
+		rel->owner_id = m_owner_id;
 	}
 	else {
 		DEG_DEBUG_PRINTF("add_operation_relation(%p = %s, %p = %s, %d, %s) Failed\n",
@@ -253,6 +267,9 @@ void DepsgraphRelationBuilder::build_scene(Main *bmain, Scene *scene)
 	for (Base *base = (Base *)scene->base.first; base; base = base->next) {
 		Object *ob = base->object;
 
+		/* Relations are owned by the base object they're built for. */
+		set_owner_id(&ob->id);
+
 		/* object itself */
 		build_object(bmain, scene, ob);
 
@@ -272,6 +289,7 @@ void DepsgraphRelationBuilder::build_scene(Main *bmain, Scene *scene)
 			build_group(bmain, scene, ob, ob->dup_group);
 		}
 	}
+	set_owner_id(NULL);
 
 	/* rigidbody */
 	if (scene->rigidbody_world) {
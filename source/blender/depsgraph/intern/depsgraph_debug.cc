@@ -32,16 +32,23 @@
 
 //#include <stdlib.h>
 #include <string.h>
+#include <algorithm>
+
+#include "PIL_time.h"
 
 extern "C" {
 #include "BLI_utildefines.h"
+#include "BLI_fileops.h"
 #include "BLI_listbase.h"
 #include "BLI_ghash.h"
+#include "BLI_path_util.h"
 #include "BLI_string.h"
 
 #include "DNA_scene_types.h"
 #include "DNA_userdef_types.h"
 
+#include "BKE_depsgraph.h"
+
 #include "DEG_depsgraph.h"
 #include "DEG_depsgraph_debug.h"
 #include "DEG_depsgraph_build.h"
@@ -50,6 +57,8 @@ extern "C" {
 #include "WM_types.h"
 }  /* extern "C" */
 
+#include "atomic_ops.h"
+
 #include "depsgraph_debug.h"
 #include "depsnode.h"
 #include "depsnode_component.h"
@@ -982,22 +991,81 @@ DepsgraphStatsID *DEG_stats_id(ID *id)
 	return DepsgraphDebug::get_id_stats(id, false);
 }
 
+/* Operation identifier which doesn't depend on memory layout. */
+static string deg_debug_operation_key(const OperationDepsNode *node)
+{
+	return node->owner->identifier() + " . " + node->identifier();
+}
+
+static string deg_debug_relation_key(const DepsRelation *rel)
+{
+	string from = (rel->from->type == DEPSNODE_TYPE_OPERATION)
+	                  ? deg_debug_operation_key((OperationDepsNode *)rel->from)
+	                  : rel->from->identifier();
+	return from + " -> " + deg_debug_operation_key((OperationDepsNode *)rel->to) +
+	       " (" + rel->name + ")";
+}
+
+static void deg_debug_collect_keys(const Depsgraph *graph,
+                                   set<string> &operations,
+                                   set<string> &relations)
+{
+	for (Depsgraph::OperationNodes::const_iterator it_op = graph->operations.begin();
+	     it_op != graph->operations.end();
+	     ++it_op)
+	{
+		OperationDepsNode *node = *it_op;
+		operations.insert(deg_debug_operation_key(node));
+		for (OperationDepsNode::Relations::const_iterator it_rel = node->inlinks.begin();
+		     it_rel != node->inlinks.end();
+		     ++it_rel)
+		{
+			relations.insert(deg_debug_relation_key(*it_rel));
+		}
+	}
+}
+
+static bool deg_debug_compare_keys(const set<string> &keys1,
+                                   const set<string> &keys2,
+                                   const char *what)
+{
+	bool equal = true;
+	for (set<string>::const_iterator it = keys1.begin(); it != keys1.end(); ++it) {
+		if (keys2.find(*it) == keys2.end()) {
+			fprintf(stderr, "  %s only in first graph: %s\n", what, it->c_str());
+			equal = false;
+		}
+	}
+	for (set<string>::const_iterator it = keys2.begin(); it != keys2.end(); ++it) {
+		if (keys1.find(*it) == keys1.end()) {
+			fprintf(stderr, "  %s only in second graph: %s\n", what, it->c_str());
+			equal = false;
+		}
+	}
+	return equal;
+}
+
 bool DEG_debug_compare(const struct Depsgraph *graph1,
                        const struct Depsgraph *graph2)
 {
 	BLI_assert(graph1 != NULL);
 	BLI_assert(graph2 != NULL);
-	if (graph1->operations.size() != graph2->operations.size()) {
-		return false;
-	}
-	/* TODO(sergey): Currently we only do real stupid check,
-	 * which is fast but which isn't 100% reliable.
+	/* Compare sets of operations and relations between them, using their
+	 * identifiers. Duplicated relations are considered to be the same.
 	 *
-	 * Would be cool to make it more robust, but it's good enough
-	 * for now. Also, proper graph check is actually NP-complex
-	 * problem..
+	 * This is not a full isomorphism check (which is NP-complete problem),
+	 * but identifiers are unique enough for the graphs built from the
+	 * same scene.
 	 */
-	return true;
+	set<string> operations1, operations2;
+	set<string> relations1, relations2;
+	deg_debug_collect_keys(graph1, operations1, relations1);
+	deg_debug_collect_keys(graph2, operations2, relations2);
+	bool equal = deg_debug_compare_keys(operations1, operations2, "Operation");
+	if (!deg_debug_compare_keys(relations1, relations2, "Relation")) {
+		equal = false;
+	}
+	return equal;
 }
 
 bool DEG_debug_scene_relations_validate(Main *bmain,
@@ -1211,3 +1279,286 @@ void DEG_stats_simple(const Depsgraph *graph, size_t *r_outer,
 	}
 }
 
+
+/* ****************** */
+/* Evaluation Tracing */
+
+/* Raw event, recorded during evaluation. Node pointer is only valid until
+ * the end of evaluation of the frame.
+ */
+struct DepsgraphTraceEvent {
+	const OperationDepsNode *node;
+	double start_time;
+	double end_time;
+};
+
+/* Event with all the data resolved, which is safe to keep after the graph
+ * has been changed or freed.
+ */
+struct DepsgraphTraceRecord {
+	string name;
+	string id_name;
+	string component;
+	int thread_id;
+	double start_time;
+	double end_time;
+};
+
+struct DepsgraphTraceFrame {
+	float ctime;
+	double start_time;
+	double end_time;
+	/* Sum of all operations evaluation time. */
+	double work;
+	/* Longest chain of dependent operations, in evaluation time. */
+	double critical_path;
+	size_t num_operations;
+};
+
+typedef vector<DepsgraphTraceEvent> DepsgraphTraceEvents;
+
+static struct {
+	/* Events of the frame which is being evaluated, per thread. */
+	vector<DepsgraphTraceEvents> thread_events;
+	vector<DepsgraphTraceRecord> records;
+	vector<DepsgraphTraceFrame> frames;
+	double start_time;
+	double frame_start_time;
+	/* Trace is recorded for one graph evaluation at a time. */
+	uint32_t frame_active;
+	char filepath[FILE_MAX];
+} deg_trace;
+
+bool DepsgraphDebug::trace_enabled = false;
+
+bool DepsgraphDebug::trace_frame_begin(const EvaluationContext *UNUSED(eval_ctx),
+                                       int num_threads)
+{
+	if (!trace_enabled) {
+		return false;
+	}
+	if (atomic_cas_uint32(&deg_trace.frame_active, 0, 1) != 0) {
+		/* Other graph is being traced already. */
+		return false;
+	}
+	if (deg_trace.thread_events.size() < (size_t)num_threads) {
+		deg_trace.thread_events.resize(num_threads);
+	}
+	deg_trace.frame_start_time = PIL_check_seconds_timer();
+	return true;
+}
+
+void DepsgraphDebug::trace_task(int thread_id,
+                                const OperationDepsNode *node,
+                                double start_time,
+                                double end_time)
+{
+	DepsgraphTraceEvent event;
+	event.node = node;
+	event.start_time = start_time;
+	event.end_time = end_time;
+	deg_trace.thread_events[thread_id].push_back(event);
+}
+
+static bool deg_trace_event_cmp(const pair<DepsgraphTraceEvent, int> &a,
+                                const pair<DepsgraphTraceEvent, int> &b)
+{
+	if (a.first.start_time == b.first.start_time) {
+		return a.first.end_time < b.first.end_time;
+	}
+	return a.first.start_time < b.first.start_time;
+}
+
+void DepsgraphDebug::trace_frame_end(const EvaluationContext *eval_ctx)
+{
+	DepsgraphTraceFrame frame;
+	frame.ctime = eval_ctx->ctime;
+	frame.start_time = deg_trace.frame_start_time;
+	frame.end_time = PIL_check_seconds_timer();
+	frame.work = 0.0;
+	frame.critical_path = 0.0;
+
+	/* Operation only starts after all its parents are finished, so ordering
+	 * by start time gives a valid topological order of evaluated operations.
+	 */
+	vector<pair<DepsgraphTraceEvent, int> > events;
+	for (size_t thread_id = 0; thread_id < deg_trace.thread_events.size(); ++thread_id) {
+		DepsgraphTraceEvents &thread_events = deg_trace.thread_events[thread_id];
+		for (DepsgraphTraceEvents::const_iterator it = thread_events.begin();
+		     it != thread_events.end();
+		     ++it)
+		{
+			events.push_back(pair<DepsgraphTraceEvent, int>(*it, (int)thread_id));
+		}
+		thread_events.clear();
+	}
+	std::sort(events.begin(), events.end(), deg_trace_event_cmp);
+	frame.num_operations = events.size();
+
+	/* Longest path to every evaluated operation, including its own time. */
+	unordered_map<const OperationDepsNode *, double> path_time;
+	for (size_t i = 0; i < events.size(); ++i) {
+		const DepsgraphTraceEvent &event = events[i].first;
+		const OperationDepsNode *node = event.node;
+		const double duration = event.end_time - event.start_time;
+		double parents_time = 0.0;
+		for (OperationDepsNode::Relations::const_iterator it_rel = node->inlinks.begin();
+		     it_rel != node->inlinks.end();
+		     ++it_rel)
+		{
+			unordered_map<const OperationDepsNode *, double>::const_iterator it_path =
+			        path_time.find((const OperationDepsNode *)(*it_rel)->from);
+			if (it_path != path_time.end()) {
+				parents_time = std::max(parents_time, it_path->second);
+			}
+		}
+		path_time[node] = parents_time + duration;
+		frame.critical_path = std::max(frame.critical_path, parents_time + duration);
+		frame.work += duration;
+
+		/* No-op nodes are only recorded to keep paths connected. */
+		if (node->is_noop()) {
+			continue;
+		}
+		DepsgraphTraceRecord record;
+		record.name = node->identifier();
+		record.id_name = node->owner->owner->id->name;
+		record.component = get_component_name(node->owner->type, node->owner->name);
+		record.thread_id = events[i].second;
+		record.start_time = event.start_time;
+		record.end_time = event.end_time;
+		deg_trace.records.push_back(record);
+	}
+	deg_trace.frames.push_back(frame);
+
+	printf("Depsgraph trace at frame %.2f: %d operations, wall %.3f ms, "
+	       "work %.3f ms, critical path %.3f ms, parallelism %.2f\n",
+	       frame.ctime,
+	       (int)frame.num_operations,
+	       (frame.end_time - frame.start_time) * 1000.0,
+	       frame.work * 1000.0,
+	       frame.critical_path * 1000.0,
+	       (frame.critical_path > 0.0) ? frame.work / frame.critical_path : 0.0);
+
+	atomic_cas_uint32(&deg_trace.frame_active, 1, 0);
+}
+
+/* Write string as a JSON string literal. */
+static void deg_trace_write_string(FILE *f, const string &str)
+{
+	fputc('"', f);
+	for (size_t i = 0; i < str.size(); ++i) {
+		const unsigned char c = str[i];
+		if (c == '"' || c == '\\') {
+			fputc('\\', f);
+			fputc(c, f);
+		}
+		else if (c < 0x20) {
+			fprintf(f, "\\u%04x", c);
+		}
+		else {
+			fputc(c, f);
+		}
+	}
+	fputc('"', f);
+}
+
+/* Timestamps in Chrome trace are in microseconds. */
+static double deg_trace_timestamp(double time)
+{
+	return (time - deg_trace.start_time) * 1e6;
+}
+
+void DEG_debug_trace_begin(const char *filepath)
+{
+	deg_trace.thread_events.clear();
+	deg_trace.records.clear();
+	deg_trace.frames.clear();
+	deg_trace.start_time = PIL_check_seconds_timer();
+	if (filepath != NULL) {
+		BLI_strncpy(deg_trace.filepath, filepath, sizeof(deg_trace.filepath));
+	}
+	else {
+		deg_trace.filepath[0] = '\0';
+	}
+	DepsgraphDebug::trace_enabled = true;
+}
+
+void DEG_debug_trace_end(void)
+{
+	if (!DepsgraphDebug::trace_enabled) {
+		return;
+	}
+	DepsgraphDebug::trace_enabled = false;
+	if (deg_trace.filepath[0] != '\0') {
+		DEG_debug_trace_write(deg_trace.filepath);
+		deg_trace.filepath[0] = '\0';
+	}
+}
+
+bool DEG_debug_trace_write(const char *filepath)
+{
+	FILE *f = BLI_fopen(filepath, "w");
+	if (f == NULL) {
+		fprintf(stderr, "Depsgraph trace: failed to open '%s' for writing\n", filepath);
+		return false;
+	}
+
+	int num_threads = (int)deg_trace.thread_events.size();
+
+	fprintf(f, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+	fprintf(f, "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 0, \"tid\": 0, "
+	           "\"args\": {\"name\": \"Depsgraph\"}}");
+	for (int thread_id = 0; thread_id < num_threads; ++thread_id) {
+		fprintf(f, ",\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 0, \"tid\": %d, "
+		           "\"args\": {\"name\": \"%s %d\"}}",
+		        thread_id, (thread_id == 0) ? "Main" : "Worker", thread_id);
+	}
+	fprintf(f, ",\n{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 0, "
+	           "\"args\": {\"name\": \"Frames\"}}");
+
+	for (vector<DepsgraphTraceFrame>::const_iterator it = deg_trace.frames.begin();
+	     it != deg_trace.frames.end();
+	     ++it)
+	{
+		const DepsgraphTraceFrame &frame = *it;
+		fprintf(f, ",\n{\"name\": \"Frame %.2f\", \"cat\": \"frame\", \"ph\": \"X\", "
+		           "\"pid\": 1, \"tid\": 0, \"ts\": %.3f, \"dur\": %.3f, "
+		           "\"args\": {\"operations\": %d, \"work_ms\": %.3f, "
+		           "\"critical_path_ms\": %.3f, \"parallelism\": %.3f}}",
+		        frame.ctime,
+		        deg_trace_timestamp(frame.start_time),
+		        (frame.end_time - frame.start_time) * 1e6,
+		        (int)frame.num_operations,
+		        frame.work * 1000.0,
+		        frame.critical_path * 1000.0,
+		        (frame.critical_path > 0.0) ? frame.work / frame.critical_path : 0.0);
+	}
+
+	for (vector<DepsgraphTraceRecord>::const_iterator it = deg_trace.records.begin();
+	     it != deg_trace.records.end();
+	     ++it)
+	{
+		const DepsgraphTraceRecord &record = *it;
+		fprintf(f, ",\n{\"name\": ");
+		deg_trace_write_string(f, record.name);
+		fprintf(f, ", \"cat\": ");
+		deg_trace_write_string(f, record.id_name);
+		fprintf(f, ", \"ph\": \"X\", \"pid\": 0, \"tid\": %d, \"ts\": %.3f, \"dur\": %.3f, "
+		           "\"args\": {\"id\": ",
+		        record.thread_id,
+		        deg_trace_timestamp(record.start_time),
+		        (record.end_time - record.start_time) * 1e6);
+		deg_trace_write_string(f, record.id_name);
+		fprintf(f, ", \"component\": ");
+		deg_trace_write_string(f, record.component);
+		fprintf(f, "}}");
+	}
+
+	fprintf(f, "\n]}\n");
+	fclose(f);
+
+	printf("Depsgraph trace: written %d operations of %d frames to '%s'\n",
+	       (int)deg_trace.records.size(), (int)deg_trace.frames.size(), filepath);
+	return true;
+}
@@ -65,6 +65,18 @@ struct DepsgraphDebug {
 	                           const OperationDepsNode *node,
 	                           double time);
 
+	/* Evaluation trace, low overhead per-thread recording of evaluated
+	 * operations which can be exported in Chrome Trace Event format.
+	 */
+	static bool trace_enabled;
+
+	static bool trace_frame_begin(const EvaluationContext *eval_ctx, int num_threads);
+	static void trace_frame_end(const EvaluationContext *eval_ctx);
+	static void trace_task(int thread_id,
+	                       const OperationDepsNode *node,
+	                       double start_time,
+	                       double end_time);
+
 	static DepsgraphStatsID *get_id_stats(ID *id, bool create);
 	static DepsgraphStatsComponent *get_component_stats(DepsgraphStatsID *id_stats,
 	                                                    const string &name,
@@ -30,12 +30,15 @@
  * Evaluation engine entrypoints for Depsgraph Engine.
  */
 
+#include <algorithm>
+
 #include "MEM_guardedalloc.h"
 
 #include "PIL_time.h"
 
 extern "C" {
 #include "BLI_utildefines.h"
+#include "BLI_math_base.h"
 #include "BLI_task.h"
 
 #include "BKE_depsgraph.h"
@@ -118,50 +121,135 @@ void DEG_evaluation_context_free(EvaluationContext *eval_ctx)
 /* ********************** */
 /* Evaluation Entrypoints */
 
-/* Forward declarations. */
-static void schedule_children(TaskPool *pool,
-                              Depsgraph *graph,
-                              OperationDepsNode *node,
-                              const int layers);
+typedef vector<OperationDepsNode *> ReadyOperations;
 
 struct DepsgraphEvalState {
 	EvaluationContext *eval_ctx;
 	Depsgraph *graph;
 	int layers;
+	/* Number of operations evaluated, for statistics. */
+	uint32_t num_evaluated;
+	/* Record evaluated operations into the trace. */
+	bool do_trace;
+	/* Storage for the children which became ready, indexed by thread ID,
+	 * so tasks don't allocate it every time.
+	 */
+	vector<ReadyOperations> ready_per_thread;
 };
 
+/* Operations with longest path to the graph sink go first. */
+static bool eval_priority_greater(const OperationDepsNode *a,
+                                  const OperationDepsNode *b)
+{
+	return a->eval_priority > b->eval_priority;
+}
+
+static void deg_task_evaluate_node(DepsgraphEvalState *state,
+                                   OperationDepsNode *node,
+                                   const int thread_id)
+{
+	if (node->is_noop()) {
+		if (state->do_trace) {
+			/* Still needed to follow dependency paths through the node. */
+			double time = PIL_check_seconds_timer();
+			DepsgraphDebug::trace_task(thread_id, node, time, time);
+		}
+		return;
+	}
+
+	/* Get context. */
+	// TODO: who initialises this? "Init" operations aren't able to initialise it!!!
+	/* TODO(sergey): Wedon't use component contexts at this moment. */
+	/* ComponentDepsNode *comp = node->owner; */
+	BLI_assert(node->owner != NULL);
+
+	/* Take note of current time. */
+	double start_time = PIL_check_seconds_timer();
+	DepsgraphDebug::task_started(state->graph, node);
+
+	/* Should only be the case for NOOPs, which never get to this point. */
+	BLI_assert(node->evaluate);
+
+	/* Perform operation. */
+	node->evaluate(state->eval_ctx);
+
+	/* Note how long this took. */
+	double end_time = PIL_check_seconds_timer();
+	DepsgraphDebug::task_completed(state->graph,
+	                               node,
+	                               end_time - start_time);
+	if (state->do_trace) {
+		DepsgraphDebug::trace_task(thread_id, node, start_time, end_time);
+	}
+
+	atomic_add_uint32(&state->num_evaluated, 1);
+}
+
+/* Collect children of the node which became ready for evaluation.
+ *
+ * Only the thread which resolves the last pending dependency of a child
+ * sees the counter dropping to zero, so no locking is needed here.
+ */
+static void collect_ready_children(OperationDepsNode *node,
+                                   const int layers,
+                                   ReadyOperations &ready)
+{
+	for (OperationDepsNode::Relations::const_iterator it = node->outlinks.begin();
+	     it != node->outlinks.end();
+	     ++it)
+	{
+		DepsRelation *rel = *it;
+		OperationDepsNode *child = (OperationDepsNode *)rel->to;
+		BLI_assert(child->type == DEPSNODE_TYPE_OPERATION);
+
+		/* Cyclic relations are not counted as pending links. */
+		if (rel->flag & DEPSREL_FLAG_CYCLIC) {
+			continue;
+		}
+
+		IDDepsNode *id_child = child->owner->owner;
+		if ((id_child->layers & layers) != 0 &&
+		    (child->flag & DEPSOP_FLAG_NEEDS_UPDATE) != 0)
+		{
+			BLI_assert(child->num_links_pending > 0);
+			if (atomic_sub_uint32(&child->num_links_pending, 1) == 0) {
+				child->scheduled = true;
+				ready.push_back(child);
+			}
+		}
+	}
+}
+
 static void deg_task_run_func(TaskPool *pool,
                               void *taskdata,
-                              int UNUSED(threadid))
+                              int threadid)
 {
 	DepsgraphEvalState *state = (DepsgraphEvalState *)BLI_task_pool_userdata(pool);
 	OperationDepsNode *node = (OperationDepsNode *)taskdata;
+	ReadyOperations &ready = state->ready_per_thread[threadid];
 
-	if (!node->is_noop()) {
-		/* Get context. */
-		// TODO: who initialises this? "Init" operations aren't able to initialise it!!!
-		/* TODO(sergey): Wedon't use component contexts at this moment. */
-		/* ComponentDepsNode *comp = node->owner; */
-		BLI_assert(node->owner != NULL);
-
-		/* Take note of current time. */
-		double start_time = PIL_check_seconds_timer();
-		DepsgraphDebug::task_started(state->graph, node);
-
-		/* Should only be the case for NOOPs, which never get to this point. */
-		BLI_assert(node->evaluate);
+	while (node != NULL) {
+		deg_task_evaluate_node(state, node, threadid);
 
-		/* Perform operation. */
-		node->evaluate(state->eval_ctx);
+		ready.clear();
+		collect_ready_children(node, state->layers, ready);
+		if (ready.empty()) {
+			break;
+		}
 
-		/* Note how long this took. */
-		double end_time = PIL_check_seconds_timer();
-		DepsgraphDebug::task_completed(state->graph,
-		                               node,
-		                               end_time - start_time);
+		/* Continue with the most critical child in this thread, avoiding
+		 * round-trip through the task scheduler. Other children are pushed
+		 * to the head of the queue, least critical first so the most
+		 * critical one ends up being picked first.
+		 */
+		if (ready.size() > 1) {
+			std::sort(ready.begin(), ready.end(), eval_priority_greater);
+			for (size_t i = ready.size() - 1; i > 0; --i) {
+				BLI_task_pool_push(pool, deg_task_run_func, ready[i], false, TASK_PRIORITY_HIGH);
+			}
+		}
+		node = ready[0];
 	}
-
-	schedule_children(pool, state->graph, node, state->layers);
 }
 
 static void calculate_pending_parents(Depsgraph *graph, int layers)
@@ -201,6 +289,9 @@ static void calculate_pending_parents(Depsgraph *graph, int layers)
 	}
 }
 
+/* Priority of the node is the cost of the longest (critical) path from it
+ * to any of the nodes which don't have dependants.
+ */
 static void calculate_eval_priority(OperationDepsNode *node)
 {
 	if (node->done) {
@@ -211,8 +302,7 @@ static void calculate_eval_priority(OperationDepsNode *node)
 	if (node->flag & DEPSOP_FLAG_NEEDS_UPDATE) {
 		/* XXX standard cost of a node, could be estimated somewhat later on */
 		const float cost = 1.0f;
-		/* NOOP nodes have no cost */
-		node->eval_priority = node->is_noop() ? cost : 0.0f;
+		float children_priority = 0.0f;
 
 		for (OperationDepsNode::Relations::const_iterator it = node->outlinks.begin();
 		     it != node->outlinks.end();
@@ -222,8 +312,11 @@ static void calculate_eval_priority(OperationDepsNode *node)
 			OperationDepsNode *to = (OperationDepsNode *)rel->to;
 			BLI_assert(to->type == DEPSNODE_TYPE_OPERATION);
 			calculate_eval_priority(to);
-			node->eval_priority += to->eval_priority;
+			children_priority = max_ff(children_priority, to->eval_priority);
 		}
+
+		/* NOOP nodes have no cost */
+		node->eval_priority = (node->is_noop() ? 0.0f : cost) + children_priority;
 	}
 	else {
 		node->eval_priority = 0.0f;
@@ -234,7 +327,7 @@ static void schedule_graph(TaskPool *pool,
                            Depsgraph *graph,
                            const int layers)
 {
-	BLI_spin_lock(&graph->lock);
+	ReadyOperations ready;
 	for (Depsgraph::OperationNodes::const_iterator it = graph->operations.begin();
 	     it != graph->operations.end();
 	     ++it)
@@ -245,51 +338,15 @@ static void schedule_graph(TaskPool *pool,
 		    node->num_links_pending == 0 &&
 		    (id_node->layers & layers) != 0)
 		{
-			BLI_task_pool_push(pool, deg_task_run_func, node, false, TASK_PRIORITY_LOW);
 			node->scheduled = true;
+			ready.push_back(node);
 		}
 	}
-	BLI_spin_unlock(&graph->lock);
-}
-
-static void schedule_children(TaskPool *pool,
-                              Depsgraph *graph,
-                              OperationDepsNode *node,
-                              const int layers)
-{
-	for (OperationDepsNode::Relations::const_iterator it = node->outlinks.begin();
-	     it != node->outlinks.end();
-	     ++it)
-	{
-		DepsRelation *rel = *it;
-		OperationDepsNode *child = (OperationDepsNode *)rel->to;
-		BLI_assert(child->type == DEPSNODE_TYPE_OPERATION);
 
-		if (child->scheduled) {
-			/* Happens when having cyclic dependencies. */
-			continue;
-		}
-
-		IDDepsNode *id_child = child->owner->owner;
-		if ((id_child->layers & layers) != 0 &&
-		    (child->flag & DEPSOP_FLAG_NEEDS_UPDATE) != 0)
-		{
-			if ((rel->flag & DEPSREL_FLAG_CYCLIC) == 0) {
-				BLI_assert(child->num_links_pending > 0);
-				atomic_sub_uint32(&child->num_links_pending, 1);
-			}
-
-			if (child->num_links_pending == 0) {
-				BLI_spin_lock(&graph->lock);
-				bool need_schedule = !child->scheduled;
-				child->scheduled = true;
-				BLI_spin_unlock(&graph->lock);
-
-				if (need_schedule) {
-					BLI_task_pool_push(pool, deg_task_run_func, child, false, TASK_PRIORITY_LOW);
-				}
-			}
-		}
+	/* Queue is FIFO for the low priority tasks, push most critical first. */
+	std::sort(ready.begin(), ready.end(), eval_priority_greater);
+	for (ReadyOperations::const_iterator it = ready.begin(); it != ready.end(); ++it) {
+		BLI_task_pool_push(pool, deg_task_run_func, *it, false, TASK_PRIORITY_LOW);
 	}
 }
 
@@ -321,10 +378,16 @@ void DEG_evaluate_on_refresh_ex(EvaluationContext *eval_ctx,
 	state.eval_ctx = eval_ctx;
 	state.graph = graph;
 	state.layers = layers;
+	state.num_evaluated = 0;
 
 	TaskScheduler *task_scheduler = BLI_task_scheduler_get();
 	TaskPool *task_pool = BLI_task_pool_create(task_scheduler, &state);
 
+	state.ready_per_thread.resize(BLI_task_scheduler_num_threads(task_scheduler));
+	for (size_t i = 0; i < state.ready_per_thread.size(); ++i) {
+		state.ready_per_thread[i].reserve(16);
+	}
+
 	if (G.debug & G_DEBUG_DEPSGRAPH_NO_THREADS) {
 		BLI_pool_set_num_threads(task_pool, 1);
 	}
@@ -350,12 +413,28 @@ void DEG_evaluate_on_refresh_ex(EvaluationContext *eval_ctx,
 	}
 
 	DepsgraphDebug::eval_begin(eval_ctx);
+	state.do_trace = DepsgraphDebug::trace_enabled &&
+	                 DepsgraphDebug::trace_frame_begin(eval_ctx,
+	                                                   BLI_task_scheduler_num_threads(task_scheduler));
+
+	double start_time = PIL_check_seconds_timer();
 
 	schedule_graph(task_pool, graph, layers);
 
 	BLI_task_pool_work_and_wait(task_pool);
 	BLI_task_pool_free(task_pool);
 
+	if (G.debug & G_DEBUG_DEPSGRAPH) {
+		printf("Depsgraph evaluation at frame %.2f: %u operations in %.6f sec\n",
+		       eval_ctx->ctime,
+		       state.num_evaluated,
+		       PIL_check_seconds_timer() - start_time);
+	}
+
+	if (state.do_trace) {
+		DepsgraphDebug::trace_frame_end(eval_ctx);
+	}
+
 	DepsgraphDebug::eval_end(eval_ctx);
 
 	/* Clear any uncleared tags - just in case. */
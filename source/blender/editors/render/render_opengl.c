@@ -480,6 +480,8 @@ static bool screen_opengl_render_init(bContext *C, wmOperator *op)
 
 	if (is_sequencer) {
 		is_view_context = false;
+		/* frames are rendered in the main thread, the prefetch thread would render along with it */
+		BKE_sequencer_prefetch_stop();
 	}
 	else {
 		/* ensure we have a 3d view */
@@ -590,7 +592,7 @@ static void screen_opengl_render_end(bContext *C, OGLRender *oglrender)
 	if (oglrender->mh) {
 		if (BKE_imtype_is_movie(scene->r.im_format.imtype)) {
 			for (i = 0; i < oglrender->totvideos; i++) {
-				oglrender->mh->end_movie(oglrender->movie_ctx_arr[i]);
+				oglrender->mh->end_movie(oglrender->movie_ctx_arr[i], oglrender->reports);
 				oglrender->mh->context_free(oglrender->movie_ctx_arr[i]);
 			}
 		}
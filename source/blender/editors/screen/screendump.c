@@ -332,7 +332,7 @@ static void screenshot_freejob(void *sjv)
 
 	if (sj->movie_handle) {
 		bMovieHandle *mh = sj->movie_handle;
-		mh->end_movie(sj->movie_ctx);
+		mh->end_movie(sj->movie_ctx, &sj->reports);
 		mh->context_free(sj->movie_ctx);
 	}
 
@@ -440,7 +440,7 @@ static void screenshot_startjob(void *sjv, short *stop, short *do_update, float
 	}
 	
 	if (mh) {
-		mh->end_movie(sj->movie_ctx);
+		mh->end_movie(sj->movie_ctx, &sj->reports);
 		mh->context_free(sj->movie_ctx);
 		sj->movie_handle = NULL;
 	}
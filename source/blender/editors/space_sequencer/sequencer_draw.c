@@ -58,6 +58,9 @@
 #include "BIF_gl.h"
 #include "BIF_glutil.h"
 
+#include "BLF_api.h"
+#include "BLT_translation.h"
+
 #include "GPU_basic_shader.h"
 
 #include "ED_anim_api.h"
@@ -900,7 +903,8 @@ void ED_sequencer_special_preview_clear(void)
 	sequencer_special_update_set(NULL);
 }
 
-ImBuf *sequencer_ibuf_get(struct Main *bmain, Scene *scene, SpaceSeq *sseq, int cfra, int frame_ofs, const char *viewname)
+ImBuf *sequencer_ibuf_get(struct Main *bmain, Scene *scene, SpaceSeq *sseq, int cfra, int frame_ofs, const char *viewname,
+                          const bool use_prefetch)
 {
 	SeqRenderData context;
 	ImBuf *ibuf;
@@ -935,12 +939,18 @@ ImBuf *sequencer_ibuf_get(struct Main *bmain, Scene *scene, SpaceSeq *sseq, int
 	 */
 	G.is_break = false;
 
-	if (special_seq_update)
+	if (special_seq_update) {
+		BKE_sequencer_prefetch_stop();
 		ibuf = BKE_sequencer_give_ibuf_direct(&context, cfra + frame_ofs, special_seq_update);
-	else if (!U.prefetchframes) // XXX || (G.f & G_PLAYANIM) == 0) {
-		ibuf = BKE_sequencer_give_ibuf(&context, cfra + frame_ofs, sseq->chanshown);
-	else
+	}
+	else if (use_prefetch) {
+		/* renders ahead of the current frame when prefetch frames are set in the user preferences */
 		ibuf = BKE_sequencer_give_ibuf_threaded(&context, cfra + frame_ofs, sseq->chanshown);
+	}
+	else {
+		BKE_sequencer_prefetch_stop();
+		ibuf = BKE_sequencer_give_ibuf(&context, cfra + frame_ofs, sseq->chanshown);
+	}
 
 	/* restore state so real rendering would be canceled (if needed) */
 	G.is_break = is_break;
@@ -1110,6 +1120,7 @@ void draw_image_seq(const bContext *C, Scene *scene, ARegion *ar, SpaceSeq *sseq
 	const bool draw_gpencil = ((sseq->flag & SEQ_SHOW_GPENCIL) && sseq->gpd);
 	const char *names[2] = {STEREO_LEFT_NAME, STEREO_RIGHT_NAME};
 	bool draw_metadata = false;
+	bool use_prefetch;
 
 	if (G.is_rendering == false && (scene->r.seq_flag & R_SEQ_GL_PREV) == 0) {
 		/* stop all running jobs, except screen one. currently previews frustrate Render
@@ -1142,8 +1153,11 @@ void draw_image_seq(const bContext *C, Scene *scene, ARegion *ar, SpaceSeq *sseq
 		return;
 	}
 
+	/* render ahead of the current frame during playback */
+	use_prefetch = (ED_screen_animation_playing(CTX_wm_manager(C)) != NULL && !draw_overlay);
+
 	/* for now we only support Left/Right */
-	ibuf = sequencer_ibuf_get(bmain, scene, sseq, cfra, frame_ofs, names[sseq->multiview_eye]);
+	ibuf = sequencer_ibuf_get(bmain, scene, sseq, cfra, frame_ofs, names[sseq->multiview_eye], use_prefetch);
 
 	if ((ibuf == NULL) ||
 	    (ibuf->rect == NULL && ibuf->rect_float == NULL))
@@ -1439,6 +1453,29 @@ void draw_image_seq(const bContext *C, Scene *scene, ARegion *ar, SpaceSeq *sseq
 	}
 }
 
+/* below the frame rate, how many shown frames were rendered ahead, and the frame rate
+ * sustained since playback started */
+void draw_prefetch_stats_seq(const rcti *rect)
+{
+	char printable[64];
+	int tot_ready, tot_shown;
+	float fps;
+
+	if (!BKE_sequencer_prefetch_stats_get(&tot_ready, &tot_shown, &fps)) {
+		return;
+	}
+
+	BLI_snprintf(printable, sizeof(printable), IFACE_("prefetched: %d/%d, sustained fps: %.2f"),
+	             tot_ready, tot_shown, fps);
+
+	UI_ThemeColor((tot_ready < tot_shown) ? TH_REDALERT : TH_TEXT_HI);
+#ifdef WITH_INTERNATIONAL
+	BLF_draw_default(rect->xmin + U.widget_unit, rect->ymax - 2 * U.widget_unit, 0.0f, printable, sizeof(printable));
+#else
+	BLF_draw_default_ascii(rect->xmin + U.widget_unit, rect->ymax - 2 * U.widget_unit, 0.0f, printable, sizeof(printable));
+#endif
+}
+
 #if 0
 void drawprefetchseqspace(Scene *scene, ARegion *UNUSED(ar), SpaceSeq *sseq)
 {
@@ -591,6 +591,7 @@ static void sequencer_preview_region_draw(const bContext *C, ARegion *ar)
 		rcti rect;
 		ED_region_visible_rect(ar, &rect);
 		ED_scene_draw_fps(scene, &rect);
+		draw_prefetch_stats_seq(&rect);
 	}
 }
 
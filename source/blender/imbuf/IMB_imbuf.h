@@ -119,6 +119,16 @@ struct ImBuf *IMB_testiffname(const char *filepath, int flags);
  */
 struct ImBuf *IMB_loadiffname(const char *filepath, int flags, char colorspace[IM_MAX_SPACE]);
 
+/**
+ * Load an image for a thumbnail, formats which can read a reduced resolution
+ * give an image no smaller than max_thumb_size, others the full image.
+ * r_width and r_height are the size of the full image.
+ *
+ * \attention Defined in readimage.c
+ */
+struct ImBuf *IMB_thumb_load_image(const char *filepath, int flags, size_t max_thumb_size,
+                                   char colorspace[IM_MAX_SPACE], size_t *r_width, size_t *r_height);
+
 /**
  *
  * \attention Defined in allocimbuf.c
@@ -298,6 +308,8 @@ void IMB_close_anim_proxies(struct anim *anim);
 int ismovie(const char *filepath);
 void IMB_anim_set_preseek(struct anim *anim, int preseek);
 int IMB_anim_get_preseek(struct anim *anim);
+void IMB_anim_set_decode_ahead(struct anim *anim, bool use_decode_ahead);
+void IMB_anim_decode_ahead_free_idle(struct anim *anim);
 
 /**
  *
@@ -366,6 +378,19 @@ struct ImBuf *IMB_onehalf(struct ImBuf *ibuf1);
  */
 struct ImBuf *IMB_scaleImBuf(struct ImBuf *ibuf, unsigned int newx, unsigned int newy);
 
+typedef enum IMB_ScaleFilter {
+	IMB_SCALE_FILTER_BOX = 0,       /* same as IMB_scaleImBuf */
+	IMB_SCALE_FILTER_BILINEAR = 1,
+	IMB_SCALE_FILTER_BICUBIC = 2,
+	IMB_SCALE_FILTER_LANCZOS = 3,
+} IMB_ScaleFilter;
+
+/**
+ *
+ * \attention Defined in scaling.c
+ */
+struct ImBuf *IMB_scaleImBuf_filter(struct ImBuf *ibuf, unsigned int newx, unsigned int newy, IMB_ScaleFilter filter);
+
 /**
  *
  * \attention Defined in scaling.c
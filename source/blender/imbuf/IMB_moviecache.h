@@ -48,6 +48,9 @@ typedef void  *(*MovieCacheGetPriorityDataFP) (void *userkey);
 typedef int    (*MovieCacheGetItemPriorityFP) (void *last_userkey, void *priority_data);
 typedef void   (*MovieCachePriorityDeleterFP) (void *priority_data);
 
+/* called when the cache limiter frees a buffer of the cache, before the buffer is freed */
+typedef void   (*MovieCacheEvictFP) (struct ImBuf *ibuf, void *userkey);
+
 void IMB_moviecache_init(void);
 void IMB_moviecache_destruct(void);
 
@@ -56,6 +59,7 @@ void IMB_moviecache_set_getdata_callback(struct MovieCache *cache, MovieCacheGet
 void IMB_moviecache_set_priority_callback(struct MovieCache *cache, MovieCacheGetPriorityDataFP getprioritydatafp,
                                           MovieCacheGetItemPriorityFP getitempriorityfp,
                                           MovieCachePriorityDeleterFP prioritydeleterfp);
+void IMB_moviecache_set_evict_callback(struct MovieCache *cache, MovieCacheEvictFP evictfp);
 
 void IMB_moviecache_put(struct MovieCache *cache, void *userkey, struct ImBuf *ibuf);
 bool IMB_moviecache_put_if_possible(struct MovieCache *cache, void *userkey, struct ImBuf *ibuf);
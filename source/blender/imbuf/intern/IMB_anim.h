@@ -168,7 +168,11 @@ struct anim {
 	int64_t last_pts;
 	int64_t next_pts;
 	AVPacket next_packet;
+
+	/* frames decoded ahead in a thread, see IMB_anim_set_decode_ahead */
+	struct AnimDecodeAhead *decode_ahead;
 #endif
+	bool use_decode_ahead;
 
 	char index_dir[768];
 
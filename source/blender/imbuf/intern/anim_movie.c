@@ -67,9 +67,12 @@
 #include "BLI_utildefines.h"
 #include "BLI_string.h"
 #include "BLI_path_util.h"
+#include "BLI_threads.h"
 
 #include "MEM_guardedalloc.h"
 
+#include "PIL_time.h"
+
 #include "BKE_global.h"
 
 #ifdef WITH_AVI
@@ -209,6 +212,7 @@ static void free_anim_avi(struct anim *anim)
 
 #ifdef WITH_FFMPEG
 static void free_anim_ffmpeg(struct anim *anim);
+static void ffmpeg_decode_ahead_free(struct anim *anim);
 #endif
 
 void IMB_free_anim(struct anim *anim)
@@ -247,6 +251,11 @@ void IMB_close_anim_proxies(struct anim *anim)
 	if (anim == NULL)
 		return;
 
+#ifdef WITH_FFMPEG
+	/* the decoder thread uses the indices */
+	ffmpeg_decode_ahead_free(anim);
+#endif
+
 	IMB_free_indices(anim);
 }
 
@@ -512,6 +521,10 @@ static int startffmpeg(struct anim *anim)
 
 	pCodecCtx->workaround_bugs = 1;
 
+	/* libavcodec uses the threads the codec supports */
+	pCodecCtx->thread_count = BLI_system_thread_count();
+	pCodecCtx->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+
 	if (avcodec_open2(pCodecCtx, pCodec, NULL) < 0) {
 		avformat_close_input(&pFormatCtx);
 		return -1;
@@ -1161,10 +1174,175 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position,
 	return anim->last_frame;
 }
 
+/* Decoding ahead: a thread per anim decodes and converts the frames following the last
+ * requested one into a ring buffer, with ffmpeg_fetchibuf, so continuing playback only
+ * takes frames which are ready. Other requests restart decoding from the new frame.
+ *
+ * The frames are not in the memory cache, so the thread and its frames are freed when no
+ * frame was requested for a while, see IMB_anim_decode_ahead_free_idle. */
+
+#define ANIM_DECODE_AHEAD_FRAMES 8
+/* seconds without requests after which the decoder thread and its frames are freed */
+#define ANIM_DECODE_AHEAD_IDLE_TIME 1.0
+
+typedef struct AnimDecodeAhead {
+	ListBase threads;
+	ThreadMutex mutex;
+	ThreadCondition cond;
+
+	/* frames first to first + tot - 1, at index position % ANIM_DECODE_AHEAD_FRAMES */
+	ImBuf *frames[ANIM_DECODE_AHEAD_FRAMES];
+	int first, tot;
+	IMB_Timecode_Type tc;
+
+	/* time of the last request, only accessed by the thread reading frames */
+	double last_fetch;
+
+	/* incremented when restarting from another frame, frames decoded before are dropped */
+	int generation;
+	bool stop;
+} AnimDecodeAhead;
+
+static void *ffmpeg_decode_ahead_thread(void *anim_v)
+{
+	struct anim *anim = anim_v;
+	AnimDecodeAhead *da = anim->decode_ahead;
+
+	BLI_mutex_lock(&da->mutex);
+
+	while (!da->stop) {
+		const int position = da->first + da->tot;
+		const int generation = da->generation;
+		const IMB_Timecode_Type tc = da->tc;
+		ImBuf *ibuf;
+
+		if (da->tot == ANIM_DECODE_AHEAD_FRAMES || position >= anim->duration) {
+			BLI_condition_wait(&da->cond, &da->mutex);
+			continue;
+		}
+
+		BLI_mutex_unlock(&da->mutex);
+		ibuf = ffmpeg_fetchibuf(anim, position, tc);
+		BLI_mutex_lock(&da->mutex);
+
+		if (generation == da->generation) {
+			da->frames[position % ANIM_DECODE_AHEAD_FRAMES] = ibuf;
+			da->tot++;
+			BLI_condition_notify_all(&da->cond);
+		}
+		else if (ibuf) {
+			IMB_freeImBuf(ibuf);
+		}
+	}
+
+	BLI_mutex_unlock(&da->mutex);
+
+	return NULL;
+}
+
+static void ffmpeg_decode_ahead_drop_frames(AnimDecodeAhead *da, int tot)
+{
+	for (; tot > 0; tot--) {
+		ImBuf **frame = &da->frames[da->first % ANIM_DECODE_AHEAD_FRAMES];
+
+		if (*frame) {
+			IMB_freeImBuf(*frame);
+			*frame = NULL;
+		}
+		da->first++;
+		da->tot--;
+	}
+}
+
+static void ffmpeg_decode_ahead_start(struct anim *anim, int position, IMB_Timecode_Type tc)
+{
+	AnimDecodeAhead *da = MEM_callocN(sizeof(AnimDecodeAhead), "anim decode ahead");
+
+	BLI_mutex_init(&da->mutex);
+	BLI_condition_init(&da->cond);
+	da->first = position;
+	da->tc = tc;
+	anim->decode_ahead = da;
+
+	BLI_init_threads(&da->threads, ffmpeg_decode_ahead_thread, 1);
+	BLI_insert_thread(&da->threads, anim);
+}
+
+static void ffmpeg_decode_ahead_free(struct anim *anim)
+{
+	AnimDecodeAhead *da = anim->decode_ahead;
+
+	if (da == NULL) {
+		return;
+	}
+
+	BLI_mutex_lock(&da->mutex);
+	da->stop = true;
+	BLI_condition_notify_all(&da->cond);
+	BLI_mutex_unlock(&da->mutex);
+
+	BLI_end_threads(&da->threads);
+
+	ffmpeg_decode_ahead_drop_frames(da, da->tot);
+	BLI_condition_end(&da->cond);
+	BLI_mutex_end(&da->mutex);
+	MEM_freeN(da);
+
+	anim->decode_ahead = NULL;
+}
+
+static ImBuf *ffmpeg_decode_ahead_fetchibuf(struct anim *anim, int position, IMB_Timecode_Type tc)
+{
+	AnimDecodeAhead *da;
+	ImBuf *ibuf;
+
+	if (anim->decode_ahead == NULL) {
+		/* opened here, the decoder thread and the caller share the index */
+		if (tc != IMB_TC_NONE) {
+			IMB_anim_open_index(anim, tc);
+		}
+		ffmpeg_decode_ahead_start(anim, position, tc);
+	}
+
+	da = anim->decode_ahead;
+	da->last_fetch = PIL_check_seconds_timer();
+
+	BLI_mutex_lock(&da->mutex);
+
+	if (tc != da->tc || position < da->first || position > da->first + da->tot) {
+		/* restart from the requested frame, ffmpeg_fetchibuf seeks there */
+		ffmpeg_decode_ahead_drop_frames(da, da->tot);
+		da->first = position;
+		da->tc = tc;
+		da->generation++;
+	}
+	else {
+		/* frames before the requested one are not needed anymore */
+		ffmpeg_decode_ahead_drop_frames(da, position - da->first);
+	}
+
+	BLI_condition_notify_all(&da->cond);
+
+	while (da->tot == 0) {
+		BLI_condition_wait(&da->cond, &da->mutex);
+	}
+
+	ibuf = da->frames[position % ANIM_DECODE_AHEAD_FRAMES];
+	if (ibuf) {
+		IMB_refImBuf(ibuf);
+	}
+
+	BLI_mutex_unlock(&da->mutex);
+
+	return ibuf;
+}
+
 static void free_anim_ffmpeg(struct anim *anim)
 {
 	if (anim == NULL) return;
 
+	ffmpeg_decode_ahead_free(anim);
+
 	if (anim->pCodecCtx) {
 		avcodec_close(anim->pCodecCtx);
 		avformat_close_input(&anim->pFormatCtx);
@@ -1360,9 +1538,13 @@ struct ImBuf *IMB_anim_absolute(struct anim *anim, int position,
 #endif
 #ifdef WITH_FFMPEG
 		case ANIM_FFMPEG:
-			ibuf = ffmpeg_fetchibuf(anim, position, tc);
-			if (ibuf)
-				anim->curposition = position;
+			/* sets curposition, which is only used by the decoder thread with decoding ahead */
+			if (anim->use_decode_ahead) {
+				ibuf = ffmpeg_decode_ahead_fetchibuf(anim, position, tc);
+			}
+			else {
+				ibuf = ffmpeg_fetchibuf(anim, position, tc);
+			}
 			filter_y = 0; /* done internally */
 			break;
 #endif
@@ -1370,7 +1552,7 @@ struct ImBuf *IMB_anim_absolute(struct anim *anim, int position,
 
 	if (ibuf) {
 		if (filter_y) IMB_filtery(ibuf);
-		BLI_snprintf(ibuf->name, sizeof(ibuf->name), "%s.%04d", anim->name, anim->curposition + 1);
+		BLI_snprintf(ibuf->name, sizeof(ibuf->name), "%s.%04d", anim->name, position + 1);
 		
 	}
 	return(ibuf);
@@ -1420,3 +1602,33 @@ int IMB_anim_get_preseek(struct anim *anim)
 {
 	return anim->preseek;
 }
+
+/* Decode the frames following the requested ones in a thread, so playback doesn't wait for
+ * decoding. Only movies read with FFmpeg are decoded ahead. Not for use when multiple threads
+ * read frames from the same anim. */
+void IMB_anim_set_decode_ahead(struct anim *anim, bool use_decode_ahead)
+{
+	anim->use_decode_ahead = use_decode_ahead;
+
+#ifdef WITH_FFMPEG
+	if (!use_decode_ahead) {
+		ffmpeg_decode_ahead_free(anim);
+	}
+#endif
+}
+
+/* Free the decoder thread and the frames decoded ahead when no frame was requested for
+ * ANIM_DECODE_AHEAD_IDLE_TIME, they are started again by the next request. To be called
+ * regularly by users of decoding ahead, from the thread reading frames. */
+void IMB_anim_decode_ahead_free_idle(struct anim *anim)
+{
+#ifdef WITH_FFMPEG
+	AnimDecodeAhead *da = anim->decode_ahead;
+
+	if (da && PIL_check_seconds_timer() - da->last_fetch > ANIM_DECODE_AHEAD_IDLE_TIME) {
+		ffmpeg_decode_ahead_free(anim);
+	}
+#else
+	UNUSED_VARS(anim);
+#endif
+}
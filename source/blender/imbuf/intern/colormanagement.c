@@ -43,6 +43,7 @@
 #include "DNA_movieclip_types.h"
 #include "DNA_scene_types.h"
 #include "DNA_space_types.h"
+#include "DNA_userdef_types.h"
 
 #include "IMB_imbuf.h"
 #include "IMB_imbuf_types.h"
@@ -61,6 +62,7 @@
 #include "BKE_appdir.h"
 #include "BKE_colortools.h"
 #include "BKE_context.h"
+#include "BKE_global.h"
 #include "BKE_image.h"
 #include "BKE_main.h"
 
@@ -106,6 +108,10 @@ typedef struct ColormanageProcessor {
 	OCIO_ConstProcessorRcPtr *processor;
 	CurveMapping *curve_mapping;
 	bool is_data_result;
+
+	/* lookup table used instead of the processor for buffers, see display_lut_apply */
+	struct DisplayLUT *display_lut;
+	float display_lut_gain;
 } ColormanageProcessor;
 
 static struct global_glsl_state {
@@ -129,6 +135,8 @@ static struct global_glsl_state {
 	struct OCIO_GLSLDrawState *transform_ocio_glsl_state;
 } global_glsl_state;
 
+static void display_lut_free_all(void);
+
 /*********************** Color managed cache *************************/
 
 /* Cache Implementation Notes
@@ -696,6 +704,8 @@ void colormanagement_exit(void)
 	if (global_glsl_state.transform_ocio_glsl_state)
 		OCIO_freeOGLState(global_glsl_state.transform_ocio_glsl_state);
 
+	display_lut_free_all();
+
 	colormanage_free_config();
 }
 
@@ -1230,6 +1240,387 @@ const char *IMB_colormanagement_get_rect_colorspace(ImBuf *ibuf)
 	return ibuf->rect_colorspace->name;
 }
 
+/*********************** Display transform lookup tables *************************/
+
+/* Display transforms of whole buffers can be done with a 3D lookup table baked from the
+ * OCIO processor, which is much faster than running the processor for every pixel.
+ *
+ * Scene linear values are mapped to the table with a shaper made from the bits of the
+ * floating point value, which is a cheap piecewise linear approximation of log2, so
+ * lattice points are spread evenly over the stops from near black to DISPLAY_LUT_MAX.
+ * Pixels outside of this range go through the exact processor.
+ *
+ * Tables are baked without exposure, which is a gain applied to the pixels before the
+ * lookup, so tweaking exposure does not need a new table. After baking the table is
+ * compared to the exact processor and only used when the error is within the tolerance
+ * from the user preferences, a bigger table is tried when the first one is not precise enough.
+ */
+
+#define DISPLAY_LUT_OFFSET (1.0f / 1024.0f)
+#define DISPLAY_LUT_MAX 64.0f
+#define DISPLAY_LUT_TEST_STEPS 16
+#define DISPLAY_LUT_MAX_CACHED 4
+
+typedef struct DisplayLUT {
+	struct DisplayLUT *next, *prev;
+
+	/* settings the table is baked for */
+	char look[MAX_COLORSPACE_NAME];
+	char view[MAX_COLORSPACE_NAME];
+	char display[MAX_COLORSPACE_NAME];
+	float gamma;
+	float tolerance;
+
+	/* processors using the table, protected by display_lut_lock */
+	int users;
+
+	/* size^3 RGB values with red varying fastest, NULL when no table within the tolerance
+	 * could be baked, so it is not tried again on every redraw */
+	float *table;
+	int size;
+
+	/* lattice coordinate = (bits of value + DISPLAY_LUT_OFFSET - shaper_offset) * shaper_scale */
+	unsigned int shaper_offset;
+	float shaper_scale;
+} DisplayLUT;
+
+static ListBase global_display_luts = {NULL, NULL};
+static ThreadMutex display_lut_lock = BLI_MUTEX_INITIALIZER;
+
+BLI_INLINE unsigned int display_lut_float_bits(float value)
+{
+	union { float f; unsigned int i; } u;
+	u.f = value;
+	return u.i;
+}
+
+BLI_INLINE float display_lut_bits_float(unsigned int bits)
+{
+	union { float f; unsigned int i; } u;
+	u.i = bits;
+	return u.f;
+}
+
+BLI_INLINE bool display_lut_in_domain(const float rgb[3])
+{
+	/* also false for NaN */
+	return (rgb[0] >= 0.0f && rgb[0] <= DISPLAY_LUT_MAX &&
+	        rgb[1] >= 0.0f && rgb[1] <= DISPLAY_LUT_MAX &&
+	        rgb[2] >= 0.0f && rgb[2] <= DISPLAY_LUT_MAX);
+}
+
+BLI_INLINE float display_lut_shaper(const DisplayLUT *lut, float value)
+{
+	return (float)(int)(display_lut_float_bits(value + DISPLAY_LUT_OFFSET) - lut->shaper_offset) * lut->shaper_scale;
+}
+
+static float display_lut_shaper_inverse(const DisplayLUT *lut, float coord)
+{
+	unsigned int bits = lut->shaper_offset + (unsigned int)(coord / lut->shaper_scale + 0.5f);
+	return max_ff(display_lut_bits_float(bits) - DISPLAY_LUT_OFFSET, 0.0f);
+}
+
+/* axes in the order of decreasing fractions, indexed by the comparisons of the fractions,
+ * the tetrahedron containing the point goes from the first corner of the cell to the last
+ * one stepping along the axes in this order (two of the combinations can't happen) */
+static const char display_lut_tetrahedra[8][3] = {
+	{2, 1, 0}, {2, 1, 0}, {1, 2, 0}, {1, 0, 2},
+	{2, 0, 1}, {0, 2, 1}, {0, 1, 2}, {0, 1, 2},
+};
+
+/* tetrahedral interpolation, with rgb inside of the domain */
+static void display_lut_lookup(const DisplayLUT *lut, const float rgb[3], float r_rgb[3])
+{
+	const int size = lut->size;
+	const int stride[3] = {3, 3 * size, 3 * size * size};
+	float coord[3], d[3];
+	int index[3], i;
+	const char *order;
+	const float *c000, *ca, *cb, *c111;
+	float w0, wa, wb, w1;
+
+	for (i = 0; i < 3; i++) {
+		coord[i] = display_lut_shaper(lut, rgb[i]);
+		index[i] = min_ii((int)coord[i], size - 2);
+		d[i] = min_ff(coord[i] - index[i], 1.0f);
+	}
+
+	order = display_lut_tetrahedra[((d[0] > d[1]) << 2) | ((d[1] > d[2]) << 1) | (d[0] > d[2])];
+
+	c000 = lut->table + stride[0] * index[0] + stride[1] * index[1] + stride[2] * index[2];
+	ca = c000 + stride[order[0]];
+	cb = ca + stride[order[1]];
+	c111 = c000 + stride[0] + stride[1] + stride[2];
+
+	w0 = 1.0f - d[order[0]];
+	wa = d[order[0]] - d[order[1]];
+	wb = d[order[1]] - d[order[2]];
+	w1 = d[order[2]];
+
+	for (i = 0; i < 3; i++) {
+		r_rgb[i] = w0 * c000[i] + wa * ca[i] + wb * cb[i] + w1 * c111[i];
+	}
+}
+
+static void display_lut_processor_apply(OCIO_ConstProcessorRcPtr *processor, float *buffer, int width, int height)
+{
+	OCIO_PackedImageDesc *img;
+
+	img = OCIO_createOCIO_PackedImageDesc(
+	        buffer, width, height, 3, sizeof(float),
+	        3 * sizeof(float), (size_t)3 * sizeof(float) * width);
+
+	OCIO_processorApply(processor, img);
+
+	OCIO_PackedImageDescRelease(img);
+}
+
+/* largest difference between the table and the processor at the centers of cells spread over the table */
+static float display_lut_error(const DisplayLUT *lut, OCIO_ConstProcessorRcPtr *processor)
+{
+	const int tot = DISPLAY_LUT_TEST_STEPS * DISPLAY_LUT_TEST_STEPS * DISPLAY_LUT_TEST_STEPS;
+	const float step = (float)(lut->size - 1) / DISPLAY_LUT_TEST_STEPS;
+	float *values = MEM_mallocN(sizeof(float) * DISPLAY_LUT_TEST_STEPS, "display lut test values");
+	float *buffer = MEM_mallocN(sizeof(float) * 3 * tot, "display lut test buffer");
+	float *exact = MEM_mallocN(sizeof(float) * 3 * tot, "display lut test exact");
+	float error = 0.0f;
+	int i, j, r, g, b;
+
+	for (i = 0; i < DISPLAY_LUT_TEST_STEPS; i++) {
+		values[i] = display_lut_shaper_inverse(lut, floorf(i * step) + 0.5f);
+	}
+
+	for (b = 0, i = 0; b < DISPLAY_LUT_TEST_STEPS; b++) {
+		for (g = 0; g < DISPLAY_LUT_TEST_STEPS; g++) {
+			for (r = 0; r < DISPLAY_LUT_TEST_STEPS; r++, i++) {
+				buffer[3 * i + 0] = values[r];
+				buffer[3 * i + 1] = values[g];
+				buffer[3 * i + 2] = values[b];
+			}
+		}
+	}
+
+	memcpy(exact, buffer, sizeof(float) * 3 * tot);
+	display_lut_processor_apply(processor, exact, tot, 1);
+
+	for (i = 0; i < tot; i++) {
+		float rgb[3];
+
+		display_lut_lookup(lut, &buffer[3 * i], rgb);
+
+		/* only the displayed range matters */
+		for (j = 0; j < 3; j++) {
+			error = max_ff(error, fabsf(CLAMPIS(rgb[j], 0.0f, 1.0f) - CLAMPIS(exact[3 * i + j], 0.0f, 1.0f)));
+		}
+	}
+
+	MEM_freeN(values);
+	MEM_freeN(buffer);
+	MEM_freeN(exact);
+
+	return error;
+}
+
+static bool display_lut_bake(DisplayLUT *lut, OCIO_ConstProcessorRcPtr *processor, int size)
+{
+	float *values = MEM_mallocN(sizeof(float) * size, "display lut values");
+	float *table = MEM_mallocN(sizeof(float) * 3 * size * size * size, "display lut table");
+	float *fp = table;
+	float error;
+	int r, g, b;
+
+	lut->size = size;
+	lut->shaper_offset = display_lut_float_bits(DISPLAY_LUT_OFFSET);
+	lut->shaper_scale = (float)(size - 1) /
+	                    (float)(display_lut_float_bits(DISPLAY_LUT_MAX + DISPLAY_LUT_OFFSET) - lut->shaper_offset);
+
+	for (r = 0; r < size; r++) {
+		values[r] = display_lut_shaper_inverse(lut, r);
+	}
+
+	for (b = 0; b < size; b++) {
+		for (g = 0; g < size; g++) {
+			for (r = 0; r < size; r++, fp += 3) {
+				fp[0] = values[r];
+				fp[1] = values[g];
+				fp[2] = values[b];
+			}
+		}
+	}
+
+	display_lut_processor_apply(processor, table, size * size, size);
+	lut->table = table;
+
+	MEM_freeN(values);
+
+	error = display_lut_error(lut, processor);
+
+	if (G.debug & G_DEBUG) {
+		printf("Color management: baked %dx%dx%d display LUT for %s / %s / %s, error %.3f levels\n",
+		       size, size, size, lut->display, lut->view, lut->look, 255.0f * error);
+	}
+
+	if (255.0f * error > lut->tolerance) {
+		MEM_freeN(lut->table);
+		lut->table = NULL;
+		return false;
+	}
+
+	return true;
+}
+
+static DisplayLUT *display_lut_acquire(const ColorManagedViewSettings *view_settings,
+                                       const ColorManagedDisplaySettings *display_settings)
+{
+	const float tolerance = U.display_lut_tolerance;
+	DisplayLUT *lut;
+
+	if (tolerance <= 0.0f) {
+		return NULL;
+	}
+
+	BLI_mutex_lock(&display_lut_lock);
+
+	for (lut = global_display_luts.first; lut; lut = lut->next) {
+		if (STREQ(lut->look, view_settings->look) &&
+		    STREQ(lut->view, view_settings->view_transform) &&
+		    STREQ(lut->display, display_settings->display_device) &&
+		    lut->gamma == view_settings->gamma &&
+		    lut->tolerance == tolerance)
+		{
+			break;
+		}
+	}
+
+	if (lut) {
+		/* most recently used first */
+		BLI_remlink(&global_display_luts, lut);
+	}
+	else {
+		OCIO_ConstProcessorRcPtr *processor;
+		DisplayLUT *lut_iter, *lut_next;
+		int tot_cached = 0;
+
+		lut = MEM_callocN(sizeof(DisplayLUT), "display lut");
+		BLI_strncpy(lut->look, view_settings->look, sizeof(lut->look));
+		BLI_strncpy(lut->view, view_settings->view_transform, sizeof(lut->view));
+		BLI_strncpy(lut->display, display_settings->display_device, sizeof(lut->display));
+		lut->gamma = view_settings->gamma;
+		lut->tolerance = tolerance;
+
+		processor = create_display_buffer_processor(lut->look, lut->view, lut->display, 0.0f, lut->gamma,
+		                                            global_role_scene_linear);
+		if (processor) {
+			if (!display_lut_bake(lut, processor, 33)) {
+				display_lut_bake(lut, processor, 65);
+			}
+			OCIO_processorRelease(processor);
+		}
+
+		/* free least recently used tables not used by processors */
+		for (lut_iter = global_display_luts.first; lut_iter; lut_iter = lut_next) {
+			lut_next = lut_iter->next;
+
+			if (++tot_cached >= DISPLAY_LUT_MAX_CACHED && lut_iter->users == 0) {
+				BLI_remlink(&global_display_luts, lut_iter);
+				MEM_SAFE_FREE(lut_iter->table);
+				MEM_freeN(lut_iter);
+			}
+		}
+	}
+
+	BLI_addhead(&global_display_luts, lut);
+	lut->users++;
+
+	BLI_mutex_unlock(&display_lut_lock);
+
+	return lut;
+}
+
+static void display_lut_release(DisplayLUT *lut)
+{
+	BLI_mutex_lock(&display_lut_lock);
+	lut->users--;
+	BLI_mutex_unlock(&display_lut_lock);
+}
+
+static void display_lut_free_all(void)
+{
+	DisplayLUT *lut;
+
+	for (lut = global_display_luts.first; lut; lut = lut->next) {
+		BLI_assert(lut->users == 0);
+		MEM_SAFE_FREE(lut->table);
+	}
+	BLI_freelistN(&global_display_luts);
+}
+
+/* use a lookup table for the display transform of buffers, when enabled in the user preferences */
+static void display_processor_lut_ensure(ColormanageProcessor *cm_processor,
+                                         const ColorManagedViewSettings *view_settings,
+                                         const ColorManagedDisplaySettings *display_settings)
+{
+	ColorManagedViewSettings default_view_settings;
+	DisplayLUT *lut;
+
+	if (cm_processor->processor == NULL) {
+		return;
+	}
+
+	if (view_settings == NULL) {
+		init_default_view_settings(display_settings, &default_view_settings);
+		view_settings = &default_view_settings;
+	}
+
+	lut = display_lut_acquire(view_settings, display_settings);
+
+	if (lut && lut->table == NULL) {
+		display_lut_release(lut);
+		lut = NULL;
+	}
+
+	if (lut) {
+		cm_processor->display_lut = lut;
+		cm_processor->display_lut_gain = powf(2.0f, view_settings->exposure);
+	}
+}
+
+/* same as applying the processor, predivide works like OCIO_processorApplyRGBA_predivide */
+static void display_lut_apply(ColormanageProcessor *cm_processor, float *buffer, int width, int height,
+                              int channels, bool predivide)
+{
+	const DisplayLUT *lut = cm_processor->display_lut;
+	const float gain = cm_processor->display_lut_gain;
+	const size_t tot = (size_t)width * height;
+	float *pixel;
+	size_t i;
+
+	predivide = predivide && (channels == 4);
+
+	for (i = 0, pixel = buffer; i < tot; i++, pixel += channels) {
+		float alpha = 1.0f, rgb[3];
+
+		if (predivide && pixel[3] != 1.0f && pixel[3] != 0.0f) {
+			alpha = pixel[3];
+			mul_v3_v3fl(rgb, pixel, gain / alpha);
+		}
+		else {
+			mul_v3_v3fl(rgb, pixel, gain);
+		}
+
+		if (display_lut_in_domain(rgb)) {
+			display_lut_lookup(lut, rgb, rgb);
+			mul_v3_v3fl(pixel, rgb, alpha);
+		}
+		else if (predivide) {
+			OCIO_processorApplyRGBA_predivide(cm_processor->processor, pixel);
+		}
+		else {
+			OCIO_processorApplyRGB(cm_processor->processor, pixel);
+		}
+	}
+}
+
 /*********************** Threaded display buffer transform routines *************************/
 
 typedef struct DisplayBufferThread {
@@ -1515,7 +1906,8 @@ static bool is_ibuf_rect_in_display_space(ImBuf *ibuf, const ColorManagedViewSet
 
 static void colormanage_display_buffer_process_ex(ImBuf *ibuf, float *display_buffer, unsigned char *display_buffer_byte,
                                                   const ColorManagedViewSettings *view_settings,
-                                                  const ColorManagedDisplaySettings *display_settings)
+                                                  const ColorManagedDisplaySettings *display_settings,
+                                                  const bool use_display_lut)
 {
 	ColormanageProcessor *cm_processor = NULL;
 	bool skip_transform = false;
@@ -1529,9 +1921,14 @@ static void colormanage_display_buffer_process_ex(ImBuf *ibuf, float *display_bu
 		skip_transform = is_ibuf_rect_in_display_space(ibuf, view_settings, display_settings);
 	}
 
-	if (skip_transform == false)
+	if (skip_transform == false) {
 		cm_processor = IMB_colormanagement_display_processor_new(view_settings, display_settings);
 
+		if (use_display_lut) {
+			display_processor_lut_ensure(cm_processor, view_settings, display_settings);
+		}
+	}
+
 	display_buffer_apply_threaded(ibuf, ibuf->rect_float, (unsigned char *) ibuf->rect,
 	                              display_buffer, display_buffer_byte, cm_processor);
 
@@ -1543,7 +1940,8 @@ static void colormanage_display_buffer_process(ImBuf *ibuf, unsigned char *displ
                                                const ColorManagedViewSettings *view_settings,
                                                const ColorManagedDisplaySettings *display_settings)
 {
-	colormanage_display_buffer_process_ex(ibuf, NULL, display_buffer, view_settings, display_settings);
+	/* display buffers are only drawn, so they can use the lookup table */
+	colormanage_display_buffer_process_ex(ibuf, NULL, display_buffer, view_settings, display_settings, true);
 }
 
 /*********************** Threaded processor transform routines *************************/
@@ -1833,7 +2231,7 @@ static void colormanagement_imbuf_make_display_space(ImBuf *ibuf, const ColorMan
 		imb_addrectImBuf(ibuf);
 
 	colormanage_display_buffer_process_ex(ibuf, ibuf->rect_float, (unsigned char *)ibuf->rect,
-	                                      view_settings, display_settings);
+	                                      view_settings, display_settings, false);
 }
 
 void IMB_colormanagement_imbuf_make_display_space(ImBuf *ibuf, const ColorManagedViewSettings *view_settings,
@@ -2942,7 +3340,10 @@ void IMB_colormanagement_processor_apply(ColormanageProcessor *cm_processor, flo
 		}
 	}
 
-	if (cm_processor->processor && channels >= 3) {
+	if (cm_processor->display_lut && channels >= 3) {
+		display_lut_apply(cm_processor, buffer, width, height, channels, predivide);
+	}
+	else if (cm_processor->processor && channels >= 3) {
 		OCIO_PackedImageDesc *img;
 
 		/* apply OCIO processor */
@@ -2966,6 +3367,8 @@ void IMB_colormanagement_processor_free(ColormanageProcessor *cm_processor)
 		curvemapping_free(cm_processor->curve_mapping);
 	if (cm_processor->processor)
 		OCIO_processorRelease(cm_processor->processor);
+	if (cm_processor->display_lut)
+		display_lut_release(cm_processor->display_lut);
 
 	MEM_freeN(cm_processor);
 }
@@ -36,6 +36,7 @@
 #include "BLI_string.h"
 #include "BLI_fileops.h"
 #include "BLI_ghash.h"
+#include "BLI_task.h"
 
 #include "IMB_indexer.h"
 #include "IMB_anim.h"
@@ -842,20 +843,41 @@ static void index_rebuild_ffmpeg_finish(FFmpegIndexBuilderContext *context, int
 	MEM_freeN(context);
 }
 
+typedef struct ProxyOutputTaskData {
+	FFmpegIndexBuilderContext *context;
+	AVFrame *in_frame;
+} ProxyOutputTaskData;
+
+static void index_rebuild_ffmpeg_proxy_output_cb(void *userdata, const int i)
+{
+	ProxyOutputTaskData *data = userdata;
+
+	add_to_proxy_output_ffmpeg(data->context->proxy_ctx[i], data->in_frame);
+}
+
 static void index_rebuild_ffmpeg_proc_decoded_frame(
 	FFmpegIndexBuilderContext *context, 
 	AVPacket * curr_packet,
 	AVFrame *in_frame)
 {
-	int i;
+	int i, num_proxy_outputs = 0;
 	unsigned long long s_pos = context->seek_pos;
 	unsigned long long s_dts = context->seek_pos_dts;
 	unsigned long long pts = av_get_pts_from_frame(context->iFormatCtx, in_frame);
+	ProxyOutputTaskData data;
 
 	for (i = 0; i < context->num_proxy_sizes; i++) {
-		add_to_proxy_output_ffmpeg(context->proxy_ctx[i], in_frame);
+		if (context->proxy_ctx[i]) {
+			num_proxy_outputs++;
+		}
 	}
 
+	/* every proxy size has its own scaler and encoder, the decoded frame is shared */
+	data.context = context;
+	data.in_frame = in_frame;
+	BLI_task_parallel_range(0, context->num_proxy_sizes, &data, index_rebuild_ffmpeg_proxy_output_cb,
+	                        num_proxy_outputs > 1);
+
 	if (!context->start_pts_set) {
 		context->start_pts = pts;
 		context->start_pts_set = true;
@@ -1125,7 +1147,7 @@ static void index_rebuild_fallback(FallbackIndexBuilderContext *context,
 
 				struct ImBuf *s_ibuf = IMB_dupImBuf(tmp_ibuf);
 
-				IMB_scalefastImBuf(s_ibuf, x, y);
+				IMB_scaleImBuf_filter(s_ibuf, x, y, IMB_SCALE_FILTER_BICUBIC);
 
 				IMB_convert_rgba_to_abgr(s_ibuf);
 	
@@ -1157,6 +1179,7 @@ IndexBuildContext *IMB_anim_index_rebuild_context(struct anim *anim, IMB_Timecod
 {
 	IndexBuildContext *context = NULL;
 	IMB_Proxy_Size proxy_sizes_to_build = proxy_sizes_in_use;
+	IMB_Timecode_Type tcs_to_build = tcs_in_use;
 	int i;
 
 	/* Don't generate the same file twice! */
@@ -1177,6 +1200,26 @@ IndexBuildContext *IMB_anim_index_rebuild_context(struct anim *anim, IMB_Timecod
 				}
 			}
 		}
+
+#ifdef WITH_FFMPEG
+		/* proxies of strips sharing a movie may be built at the same time */
+		for (i = 0; i < IMB_TC_MAX_SLOT; ++i) {
+			IMB_Timecode_Type tc = tc_types[i];
+			if (tc & tcs_to_build) {
+				char filename[FILE_MAX];
+				void **filename_key_p;
+
+				get_tc_filename(anim, tc, filename);
+
+				if (!BLI_gset_ensure_p_ex(file_list, filename, &filename_key_p)) {
+					*filename_key_p = BLI_strdup(filename);
+				}
+				else {
+					tcs_to_build &= ~tc;
+				}
+			}
+		}
+#endif
 	}
 	
 	if (!overwrite) {
@@ -1205,12 +1248,12 @@ IndexBuildContext *IMB_anim_index_rebuild_context(struct anim *anim, IMB_Timecod
 	switch (anim->curtype) {
 #ifdef WITH_FFMPEG
 		case ANIM_FFMPEG:
-			context = index_ffmpeg_create_context(anim, tcs_in_use, proxy_sizes_to_build, quality);
+			context = index_ffmpeg_create_context(anim, tcs_to_build, proxy_sizes_to_build, quality);
 			break;
 #endif
 #ifdef WITH_AVI
 		default:
-			context = index_fallback_create_context(anim, tcs_in_use, proxy_sizes_to_build, quality);
+			context = index_fallback_create_context(anim, tcs_to_build, proxy_sizes_to_build, quality);
 			break;
 #endif
 	}
@@ -1220,7 +1263,7 @@ IndexBuildContext *IMB_anim_index_rebuild_context(struct anim *anim, IMB_Timecod
 
 	return context;
 
-	UNUSED_VARS(tcs_in_use, proxy_sizes_in_use, quality);
+	UNUSED_VARS(tcs_to_build, proxy_sizes_in_use, quality);
 }
 
 void IMB_anim_index_rebuild(struct IndexBuildContext *context,
@@ -1292,7 +1335,7 @@ void IMB_anim_set_index_dir(struct anim *anim, const char *dir)
 	}
 	BLI_strncpy(anim->index_dir, dir, sizeof(anim->index_dir));
 
-	IMB_free_indices(anim);
+	IMB_close_anim_proxies(anim);
 }
 
 struct anim *IMB_anim_open_proxy(
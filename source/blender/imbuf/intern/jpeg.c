@@ -62,7 +62,8 @@ static void skip_input_data(j_decompress_ptr cinfo, long num_bytes);
 static void term_source(j_decompress_ptr cinfo);
 static void memory_source(j_decompress_ptr cinfo, const unsigned char *buffer, size_t size);
 static boolean handle_app1(j_decompress_ptr cinfo);
-static ImBuf *ibJpegImageFromCinfo(struct jpeg_decompress_struct *cinfo, int flags);
+static ImBuf *ibJpegImageFromCinfo(struct jpeg_decompress_struct *cinfo, int flags, size_t max_size,
+                                   size_t *r_width, size_t *r_height);
 
 static const uchar jpeg_default_quality = 75;
 static uchar ibuf_quality;
@@ -271,7 +272,9 @@ static boolean handle_app1(j_decompress_ptr cinfo)
 }
 
 
-static ImBuf *ibJpegImageFromCinfo(struct jpeg_decompress_struct *cinfo, int flags)
+/* when max_size is given, the image is decoded scaled down as long as it stays at least that big */
+static ImBuf *ibJpegImageFromCinfo(struct jpeg_decompress_struct *cinfo, int flags, size_t max_size,
+                                   size_t *r_width, size_t *r_height)
 {
 	JSAMPARRAY row_pointer;
 	JSAMPLE *buffer = NULL;
@@ -289,14 +292,33 @@ static ImBuf *ibJpegImageFromCinfo(struct jpeg_decompress_struct *cinfo, int fla
 	jpeg_save_markers(cinfo, JPEG_COM, 0xffff);
 
 	if (jpeg_read_header(cinfo, false) == JPEG_HEADER_OK) {
-		x = cinfo->image_width;
-		y = cinfo->image_height;
 		depth = cinfo->num_components;
 
+		if (r_width) {
+			*r_width = cinfo->image_width;
+			*r_height = cinfo->image_height;
+		}
+
+		if (max_size) {
+			/* libjpeg scales by 1/2, 1/4 or 1/8 while decoding the DCT blocks,
+			 * which is much faster than decoding the full image */
+			const size_t size = MAX2(cinfo->image_width, cinfo->image_height);
+
+			cinfo->scale_num = 1;
+			cinfo->scale_denom = 8;
+			while (cinfo->scale_denom > 1 && size / cinfo->scale_denom < max_size) {
+				cinfo->scale_denom /= 2;
+			}
+			cinfo->dct_method = JDCT_IFAST;
+		}
+
 		if (cinfo->jpeg_color_space == JCS_YCCK) cinfo->out_color_space = JCS_CMYK;
 
 		jpeg_start_decompress(cinfo);
 
+		x = cinfo->output_width;
+		y = cinfo->output_height;
+
 		if (flags & IB_test) {
 			jpeg_abort_decompress(cinfo);
 			ibuf = IMB_allocImBuf(x, y, 8 * depth, 0);
@@ -428,7 +450,8 @@ next_stamp_marker:
 	return(ibuf);
 }
 
-ImBuf *imb_load_jpeg(const unsigned char *buffer, size_t size, int flags, char colorspace[IM_MAX_SPACE])
+static ImBuf *imb_load_jpeg_ex(const unsigned char *buffer, size_t size, int flags, size_t max_size,
+                               char colorspace[IM_MAX_SPACE], size_t *r_width, size_t *r_height)
 {
 	struct jpeg_decompress_struct _cinfo, *cinfo = &_cinfo;
 	struct my_error_mgr jerr;
@@ -453,11 +476,22 @@ ImBuf *imb_load_jpeg(const unsigned char *buffer, size_t size, int flags, char c
 	jpeg_create_decompress(cinfo);
 	memory_source(cinfo, buffer, size);
 
-	ibuf = ibJpegImageFromCinfo(cinfo, flags);
+	ibuf = ibJpegImageFromCinfo(cinfo, flags, max_size, r_width, r_height);
 	
 	return(ibuf);
 }
 
+ImBuf *imb_load_jpeg(const unsigned char *buffer, size_t size, int flags, char colorspace[IM_MAX_SPACE])
+{
+	return imb_load_jpeg_ex(buffer, size, flags, 0, colorspace, NULL, NULL);
+}
+
+ImBuf *imb_thumbnail_jpeg(const unsigned char *buffer, size_t size, int flags, size_t max_thumb_size,
+                          char colorspace[IM_MAX_SPACE], size_t *r_width, size_t *r_height)
+{
+	return imb_load_jpeg_ex(buffer, size, flags, max_thumb_size, colorspace, r_width, r_height);
+}
+
 
 static void write_jpeg(struct jpeg_compress_struct *cinfo, struct ImBuf *ibuf)
 {
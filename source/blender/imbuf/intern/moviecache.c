@@ -73,6 +73,8 @@ typedef struct MovieCache {
 	MovieCacheGetItemPriorityFP getitempriorityfp;
 	MovieCachePriorityDeleterFP prioritydeleterfp;
 
+	MovieCacheEvictFP evictfp;
+
 	struct BLI_mempool *keys_pool;
 	struct BLI_mempool *items_pool;
 	struct BLI_mempool *userkeys_pool;
@@ -95,6 +97,7 @@ typedef struct MovieCacheItem {
 	ImBuf *ibuf;
 	MEM_CacheLimiterHandleC *c_handle;
 	void *priority_data;
+	void *userkey;
 } MovieCacheItem;
 
 static unsigned int moviecache_hashhash(const void *keyv)
@@ -180,6 +183,10 @@ static void IMB_moviecache_destructor(void *p)
 
 		PRINT("%s: cache '%s' destroy item %p buffer %p\n", __func__, cache->name, item, item->ibuf);
 
+		if (cache->evictfp) {
+			cache->evictfp(item->ibuf, item->userkey);
+		}
+
 		IMB_freeImBuf(item->ibuf);
 
 		item->ibuf = NULL;
@@ -334,6 +341,13 @@ void IMB_moviecache_set_priority_callback(struct MovieCache *cache, MovieCacheGe
 	cache->prioritydeleterfp = prioritydeleterfp;
 }
 
+/* Buffers freed to stay within the memory cache limit are passed to the callback first,
+ * it's called with the limiter locked, so it must not put or get buffers from any cache. */
+void IMB_moviecache_set_evict_callback(MovieCache *cache, MovieCacheEvictFP evictfp)
+{
+	cache->evictfp = evictfp;
+}
+
 static void do_moviecache_put(MovieCache *cache, void *userkey, ImBuf *ibuf, bool need_lock)
 {
 	MovieCacheKey *key;
@@ -357,6 +371,7 @@ static void do_moviecache_put(MovieCache *cache, void *userkey, ImBuf *ibuf, boo
 	item->cache_owner = cache;
 	item->c_handle = NULL;
 	item->priority_data = NULL;
+	item->userkey = key->userkey;
 
 	if (cache->getprioritydatafp) {
 		item->priority_data = cache->getprioritydatafp(userkey);
@@ -60,7 +60,9 @@ _CRTIMP void __cdecl _invalid_parameter_noinfo(void)
 #include "MEM_guardedalloc.h"
 
 #include "BLI_blenlib.h"
+#include "BLI_math_base.h"
 #include "BLI_math_color.h"
+#include "BLI_math_vector.h"
 #include "BLI_threads.h"
 
 #include "BKE_idprop.h"
@@ -95,6 +97,7 @@ _CRTIMP void __cdecl _invalid_parameter_noinfo(void)
 #include <ImfMultiView.h>
 #include <ImfMultiPartInputFile.h>
 #include <ImfInputPart.h>
+#include <ImfTiledInputPart.h>
 #include <ImfOutputPart.h>
 #include <ImfMultiPartOutputFile.h>
 #include <ImfTiledOutputPart.h>
@@ -113,6 +116,9 @@ extern "C"
 {
 /* prototype */
 static struct ExrPass *imb_exr_get_pass(ListBase *lb, char *passname);
+static bool imb_exr_begin_read_layers(struct ExrHandle *data);
+static void imb_exr_pass_set_rect(struct ExrHandle *data, struct ExrPass *pass, float *rect);
+static bool imb_exr_is_multilayer_file(MultiPartInputFile& file);
 static bool exr_has_multiview(MultiPartInputFile& file);
 static bool exr_has_multipart_file(MultiPartInputFile& file);
 static bool exr_has_alpha(MultiPartInputFile& file);
@@ -1249,6 +1255,23 @@ void IMB_exrmultiview_write_channels(void *handle, const char *viewname)
 	}
 }
 
+/* check if exr was saved with previous versions of blender which flipped images */
+static bool imb_exr_is_flipped(ExrHandle *data)
+{
+	const StringAttribute *ta = data->ifile->header(0).findTypedAttribute <StringAttribute> ("BlenderMultiChannel");
+	return (ta && STREQLEN(ta->value().c_str(), "Blender V2.43", 13)); /* 'previous multilayer attribute, flipped */
+}
+
+static void imb_exr_insert_read_slice(ExrHandle *data, FrameBuffer& frameBuffer, ExrChannel *echan, bool flip)
+{
+	if (flip)
+		frameBuffer.insert(echan->m->internal_name, Slice(Imf::FLOAT,  (char *)echan->rect,
+		                                                 echan->xstride * sizeof(float), echan->ystride * sizeof(float)));
+	else
+		frameBuffer.insert(echan->m->internal_name, Slice(Imf::FLOAT,  (char *)(echan->rect + echan->xstride * (data->height - 1) * data->width),
+		                                                 echan->xstride * sizeof(float), -echan->ystride * sizeof(float)));
+}
+
 void IMB_exr_read_channels(void *handle)
 {
 	ExrHandle *data = (ExrHandle *)handle;
@@ -1256,10 +1279,7 @@ void IMB_exr_read_channels(void *handle)
 	int numparts = data->ifile->parts();
 	std::vector<FrameBuffer> frameBuffers(numparts);
 	std::vector<InputPart> inputParts;
-
-	/* check if exr was saved with previous versions of blender which flipped images */
-	const StringAttribute *ta = data->ifile->header(0).findTypedAttribute <StringAttribute> ("BlenderMultiChannel");
-	short flip = (ta && STREQLEN(ta->value().c_str(), "Blender V2.43", 13)); /* 'previous multilayer attribute, flipped */
+	const bool flip = imb_exr_is_flipped(data);
 
 	exr_printf("\nIMB_exr_read_channels\n%s %-6s %-22s \"%s\"\n---------------------------------------------------------------------\n", "p", "view", "name", "internal_name");
 
@@ -1267,12 +1287,7 @@ void IMB_exr_read_channels(void *handle)
 		exr_printf("%d %-6s %-22s \"%s\"\n", echan->m->part_number, echan->m->view.c_str(), echan->m->name.c_str(), echan->m->internal_name.c_str());
 
 		if (echan->rect) {
-			if (flip)
-				frameBuffers[echan->m->part_number].insert(echan->m->internal_name, Slice(Imf::FLOAT,  (char *)echan->rect,
-				                                      echan->xstride * sizeof(float), echan->ystride * sizeof(float)));
-			else
-				frameBuffers[echan->m->part_number].insert(echan->m->internal_name, Slice(Imf::FLOAT,  (char *)(echan->rect + echan->xstride * (data->height - 1) * data->width),
-				                                      echan->xstride * sizeof(float), -echan->ystride * sizeof(float)));
+			imb_exr_insert_read_slice(data, frameBuffers[echan->m->part_number], echan, flip);
 		}
 		else
 			printf("warning, channel with no rect set %s\n", echan->m->internal_name.c_str());
@@ -1289,7 +1304,6 @@ void IMB_exr_read_channels(void *handle)
 			Header header = inputParts[i].header();
 			exr_printf("readPixels:readPixels[%d]: min.y: %d, max.y: %d\n", i, header.dataWindow().min.y, header.dataWindow().max.y);
 			inputParts[i].readPixels(header.dataWindow().min.y, header.dataWindow().max.y);
-			inputParts[i].readPixels(0, data->height - 1);
 		}
 	}
 	catch (const std::exception& exc) {
@@ -1297,6 +1311,106 @@ void IMB_exr_read_channels(void *handle)
 	}
 }
 
+/* Open a multilayer file without reading any of its passes, those are read on demand with IMB_exr_read_pass.
+ * Returns 0 when the file is not a multilayer file, the handle has to be closed in any case. */
+int IMB_exr_begin_read_multilayer(void *handle, const char *filename, int *width, int *height)
+{
+	ExrHandle *data = (ExrHandle *)handle;
+
+	if (!(BLI_exists(filename) && BLI_file_size(filename) > 32)) {   /* 32 is arbitrary, but zero length files crashes exr */
+		return 0;
+	}
+
+	try {
+		data->ifile_stream = new IFileStream(filename);
+		data->ifile = new MultiPartInputFile(*(data->ifile_stream));
+	}
+	catch (const std::exception &) {
+		delete data->ifile;
+		delete data->ifile_stream;
+
+		data->ifile = NULL;
+		data->ifile_stream = NULL;
+		return 0;
+	}
+
+	imb_exr_get_views(*data->ifile, *data->multiView);
+
+	/* same as imb_load_openexr with IB_multilayer, singlelayer multiview files are loaded as images */
+	if (IMB_exr_has_singlelayer_multiview(data) || !imb_exr_is_multilayer_file(*data->ifile)) {
+		return 0;
+	}
+
+	Box2i dw = data->ifile->header(0).dataWindow();
+	data->width = *width  = dw.max.x - dw.min.x + 1;
+	data->height = *height = dw.max.y - dw.min.y + 1;
+
+	return imb_exr_begin_read_layers(data);
+}
+
+/* Read one pass of a handle opened with IMB_exr_begin_read_multilayer, only the parts of the file with
+ * channels of the pass are read. Scanlines are decoded in parallel by the OpenEXR thread pool.
+ * Returns NULL when the pass doesn't have totchan channels, the returned buffer is owned by the caller. */
+float *IMB_exr_read_pass(void *handle, const char *layname, const char *passname, const char *viewname, int totchan)
+{
+	ExrHandle *data = (ExrHandle *)handle;
+	ExrLayer *lay;
+	ExrPass *pass;
+	float *rect;
+	int a;
+
+	lay = (ExrLayer *)BLI_findstring(&data->layers, layname, offsetof(ExrLayer, name));
+	if (lay == NULL) {
+		return NULL;
+	}
+
+	for (pass = (ExrPass *)lay->passes.first; pass; pass = pass->next) {
+		if (STREQ(pass->internal_name, passname) && STREQ(pass->view, viewname)) {
+			break;
+		}
+	}
+	if (pass == NULL || pass->totchan == 0 || pass->totchan != totchan) {
+		return NULL;
+	}
+
+	const int numparts = data->ifile->parts();
+	const bool flip = imb_exr_is_flipped(data);
+	std::vector<FrameBuffer> frameBuffers(numparts);
+	std::vector<bool> use_part(numparts, false);
+
+	rect = (float *)MEM_mapallocN(data->width * data->height * pass->totchan * sizeof(float), "pass rect");
+	imb_exr_pass_set_rect(data, pass, rect);
+
+	for (a = 0; a < pass->totchan; a++) {
+		ExrChannel *echan = pass->chan[a];
+
+		imb_exr_insert_read_slice(data, frameBuffers[echan->m->part_number], echan, flip);
+		use_part[echan->m->part_number] = true;
+	}
+
+	try {
+		for (int i = 0; i < numparts; i++) {
+			if (use_part[i]) {
+				InputPart in (*data->ifile, i);
+				const Box2i dw = in.header().dataWindow();
+
+				in.setFrameBuffer(frameBuffers[i]);
+				in.readPixels(dw.min.y, dw.max.y);
+			}
+		}
+	}
+	catch (const std::exception& exc) {
+		std::cerr << "OpenEXR-readPixels: ERROR: " << exc.what() << std::endl;
+	}
+
+	/* the buffer is owned by the caller now */
+	for (a = 0; a < pass->totchan; a++) {
+		pass->chan[a]->rect = NULL;
+	}
+
+	return rect;
+}
+
 void IMB_exr_multilayer_convert(void *handle, void *base,
                                 void * (*addview)(void *base, const char *str),
                                 void * (*addlayer)(void *base, const char *str),
@@ -1563,26 +1677,54 @@ static ExrPass *imb_exr_get_pass(ListBase *lb, char *passname)
 }
 
 /* creates channels, makes a hierarchy and assigns memory to channels */
-static ExrHandle *imb_exr_begin_read_mem(IStream &file_stream, MultiPartInputFile &file, int width, int height)
+/* offset of a channel in the interleaved buffer of its pass */
+static int imb_exr_pass_channel_offset(ExrPass *pass, int a)
+{
+	/* we can have RGB(A), XYZ(W), UVA */
+	if (pass->totchan == 3 || pass->totchan == 4) {
+		const char *order;
+		const char *chan_id_p;
+
+		if (pass->chan[0]->chan_id == 'B' || pass->chan[1]->chan_id == 'B' ||  pass->chan[2]->chan_id == 'B')
+			order = "RGBA";
+		else if (pass->chan[0]->chan_id == 'Y' || pass->chan[1]->chan_id == 'Y' ||  pass->chan[2]->chan_id == 'Y')
+			order = "XYZW";
+		else
+			order = "UVA";
+
+		chan_id_p = pass->chan[a]->chan_id ? strchr(order, pass->chan[a]->chan_id) : NULL;
+		return chan_id_p ? (int)(chan_id_p - order) : 0;
+	}
+
+	/* single channel or unknown */
+	return a;
+}
+
+/* point the channels of a pass into its interleaved buffer */
+static void imb_exr_pass_set_rect(ExrHandle *data, ExrPass *pass, float *rect)
+{
+	int a;
+
+	for (a = 0; a < pass->totchan; a++) {
+		ExrChannel *echan = pass->chan[a];
+		echan->rect = rect + imb_exr_pass_channel_offset(pass, a);
+		echan->xstride = pass->totchan;
+		echan->ystride = data->width * pass->totchan;
+	}
+}
+
+/* build the hierarchical layer list from the channels of the file, without allocating memory for the passes */
+static bool imb_exr_begin_read_layers(ExrHandle *data)
 {
 	ExrLayer *lay;
 	ExrPass *pass;
 	ExrChannel *echan;
-	ExrHandle *data = (ExrHandle *)IMB_exr_get_handle();
 	int a;
 	char layname[EXR_TOT_MAXNAME], passname[EXR_TOT_MAXNAME];
 
-	data->ifile_stream = &file_stream;
-	data->ifile = &file;
-
-	data->width = width;
-	data->height = height;
-
 	std::vector<MultiViewChannelName> channels;
 	GetChannelsInMultiPartFile(*data->ifile, channels);
 
-	imb_exr_get_views(*data->ifile, *data->multiView);
-
 	for (size_t i = 0; i < channels.size(); i++) {
 		IMB_exr_add_channel(data, NULL, channels[i].name.c_str(), channels[i].view.c_str(), 0, 0, NULL, false);
 
@@ -1624,64 +1766,45 @@ static ExrHandle *imb_exr_begin_read_mem(IStream &file_stream, MultiPartInputFil
 	}
 	if (echan) {
 		printf("error, too many channels in one pass: %s\n", echan->m->name.c_str());
+		return false;
+	}
+
+	/* with some heuristics, try to merge the channels in buffers */
+	for (lay = (ExrLayer *)data->layers.first; lay; lay = lay->next) {
+		for (pass = (ExrPass *)lay->passes.first; pass; pass = pass->next) {
+			for (a = 0; a < pass->totchan; a++) {
+				pass->chan_id[imb_exr_pass_channel_offset(pass, a)] = pass->chan[a]->chan_id;
+			}
+		}
+	}
+
+	return true;
+}
+
+static ExrHandle *imb_exr_begin_read_mem(IStream &file_stream, MultiPartInputFile &file, int width, int height)
+{
+	ExrLayer *lay;
+	ExrPass *pass;
+	ExrHandle *data = (ExrHandle *)IMB_exr_get_handle();
+
+	data->ifile_stream = &file_stream;
+	data->ifile = &file;
+
+	data->width = width;
+	data->height = height;
+
+	imb_exr_get_views(*data->ifile, *data->multiView);
+
+	if (!imb_exr_begin_read_layers(data)) {
 		IMB_exr_close(data);
 		return NULL;
 	}
 
-	/* with some heuristics, try to merge the channels in buffers */
 	for (lay = (ExrLayer *)data->layers.first; lay; lay = lay->next) {
 		for (pass = (ExrPass *)lay->passes.first; pass; pass = pass->next) {
 			if (pass->totchan) {
 				pass->rect = (float *)MEM_mapallocN(width * height * pass->totchan * sizeof(float), "pass rect");
-				if (pass->totchan == 1) {
-					echan = pass->chan[0];
-					echan->rect = pass->rect;
-					echan->xstride = 1;
-					echan->ystride = width;
-					pass->chan_id[0] = echan->chan_id;
-				}
-				else {
-					char lookup[256];
-
-					memset(lookup, 0, sizeof(lookup));
-
-					/* we can have RGB(A), XYZ(W), UVA */
-					if (pass->totchan == 3 || pass->totchan == 4) {
-						if (pass->chan[0]->chan_id == 'B' || pass->chan[1]->chan_id == 'B' ||  pass->chan[2]->chan_id == 'B') {
-							lookup[(unsigned int)'R'] = 0;
-							lookup[(unsigned int)'G'] = 1;
-							lookup[(unsigned int)'B'] = 2;
-							lookup[(unsigned int)'A'] = 3;
-						}
-						else if (pass->chan[0]->chan_id == 'Y' || pass->chan[1]->chan_id == 'Y' ||  pass->chan[2]->chan_id == 'Y') {
-							lookup[(unsigned int)'X'] = 0;
-							lookup[(unsigned int)'Y'] = 1;
-							lookup[(unsigned int)'Z'] = 2;
-							lookup[(unsigned int)'W'] = 3;
-						}
-						else {
-							lookup[(unsigned int)'U'] = 0;
-							lookup[(unsigned int)'V'] = 1;
-							lookup[(unsigned int)'A'] = 2;
-						}
-						for (a = 0; a < pass->totchan; a++) {
-							echan = pass->chan[a];
-							echan->rect = pass->rect + lookup[(unsigned int)echan->chan_id];
-							echan->xstride = pass->totchan;
-							echan->ystride = width * pass->totchan;
-							pass->chan_id[(unsigned int)lookup[(unsigned int)echan->chan_id]] = echan->chan_id;
-						}
-					}
-					else { /* unknown */
-						for (a = 0; a < pass->totchan; a++) {
-							echan = pass->chan[a];
-							echan->rect = pass->rect + a;
-							echan->xstride = pass->totchan;
-							echan->ystride = width * pass->totchan;
-							pass->chan_id[a] = echan->chan_id;
-						}
-					}
-				}
+				imb_exr_pass_set_rect(data, pass, pass->rect);
 			}
 		}
 	}
@@ -1928,6 +2051,52 @@ static bool imb_exr_is_multi(MultiPartInputFile& file)
 	return false;
 }
 
+/* RGBA slices for a buffer of 4 floats per pixel, luma and chroma go in the RGB slots */
+static void exr_rgba_framebuffer(MultiPartInputFile& file, FrameBuffer& frameBuffer, float *first,
+                                 int xstride, int ystride)
+{
+	if (exr_has_rgb(file)) {
+		frameBuffer.insert(exr_rgba_channelname(file, "R"),
+		                   Slice(Imf::FLOAT,  (char *) first, xstride, ystride));
+		frameBuffer.insert(exr_rgba_channelname(file, "G"),
+		                   Slice(Imf::FLOAT,  (char *) (first + 1), xstride, ystride));
+		frameBuffer.insert(exr_rgba_channelname(file, "B"),
+		                   Slice(Imf::FLOAT,  (char *) (first + 2), xstride, ystride));
+	}
+	else if (exr_has_luma(file)) {
+		frameBuffer.insert(exr_rgba_channelname(file, "Y"),
+		                   Slice(Imf::FLOAT,  (char *) first, xstride, ystride));
+		frameBuffer.insert(exr_rgba_channelname(file, "BY"),
+		                   Slice(Imf::FLOAT,  (char *) (first + 1), xstride, ystride, 1, 1, 0.5f));
+		frameBuffer.insert(exr_rgba_channelname(file, "RY"),
+		                   Slice(Imf::FLOAT,  (char *) (first + 2), xstride, ystride, 1, 1, 0.5f));
+	}
+
+	/* 1.0 is fill value, this still needs to be assigned even when (is_alpha == 0) */
+	frameBuffer.insert(exr_rgba_channelname(file, "A"),
+	                   Slice(Imf::FLOAT,  (char *) (first + 3), xstride, ystride, 1, 1, 1.0f));
+}
+
+static void exr_luma_to_rgb(MultiPartInputFile& file, float *rect, size_t totpixel)
+{
+	size_t a;
+
+	if (exr_has_chroma(file)) {
+		for (a = 0; a < totpixel; ++a) {
+			float *color = rect + a * 4;
+			ycc_to_rgb(color[0] * 255.0f, color[1] * 255.0f, color[2] * 255.0f,
+			           &color[0], &color[1], &color[2],
+			           BLI_YCC_ITU_BT709);
+		}
+	}
+	else {
+		for (a = 0; a < totpixel; ++a) {
+			float *color = rect + a * 4;
+			color[1] = color[2] = color[0];
+		}
+	}
+}
+
 struct ImBuf *imb_load_openexr(const unsigned char *mem, size_t size, int flags, char colorspace[IM_MAX_SPACE])
 {
 	struct ImBuf *ibuf = NULL;
@@ -2013,26 +2182,7 @@ struct ImBuf *imb_load_openexr(const unsigned char *mem, size_t size, int flags,
 					/* but, since we read y-flipped (negative y stride) we move to last scanline */
 					first += 4 * (height - 1) * width;
 
-					if (has_rgb) {
-						frameBuffer.insert(exr_rgba_channelname(*file, "R"),
-						                   Slice(Imf::FLOAT,  (char *) first, xstride, ystride));
-						frameBuffer.insert(exr_rgba_channelname(*file, "G"),
-						                   Slice(Imf::FLOAT,  (char *) (first + 1), xstride, ystride));
-						frameBuffer.insert(exr_rgba_channelname(*file, "B"),
-						                   Slice(Imf::FLOAT,  (char *) (first + 2), xstride, ystride));
-					}
-					else if (has_luma) {
-						frameBuffer.insert(exr_rgba_channelname(*file, "Y"),
-						                   Slice(Imf::FLOAT,  (char *) first, xstride, ystride));
-						frameBuffer.insert(exr_rgba_channelname(*file, "BY"),
-						                   Slice(Imf::FLOAT,  (char *) (first + 1), xstride, ystride, 1, 1, 0.5f));
-						frameBuffer.insert(exr_rgba_channelname(*file, "RY"),
-						                   Slice(Imf::FLOAT,  (char *) (first + 2), xstride, ystride, 1, 1, 0.5f));
-					}
-
-					/* 1.0 is fill value, this still needs to be assigned even when (is_alpha == 0) */
-					frameBuffer.insert(exr_rgba_channelname(*file, "A"),
-					                   Slice(Imf::FLOAT,  (char *) (first + 3), xstride, ystride, 1, 1, 1.0f));
+					exr_rgba_framebuffer(*file, frameBuffer, first, xstride, ystride);
 
 					if (exr_has_zbuffer(*file)) {
 						float *firstz;
@@ -2058,21 +2208,7 @@ struct ImBuf *imb_load_openexr(const unsigned char *mem, size_t size, int flags,
 					//     IMB_rect_from_float(ibuf);
 
 					if (!has_rgb && has_luma) {
-						size_t a;
-						if (exr_has_chroma(*file)) {
-							for (a = 0; a < (size_t) ibuf->x * ibuf->y; ++a) {
-								float *color = ibuf->rect_float + a * 4;
-								ycc_to_rgb(color[0] * 255.0f, color[1] * 255.0f, color[2] * 255.0f,
-								           &color[0], &color[1], &color[2],
-								           BLI_YCC_ITU_BT709);
-							}
-						}
-						else {
-							for (a = 0; a < (size_t) ibuf->x * ibuf->y; ++a) {
-								float *color = ibuf->rect_float + a * 4;
-								color[1] = color[2] = color[0];
-							}
-						}
+						exr_luma_to_rgb(*file, ibuf->rect_float, (size_t)ibuf->x * ibuf->y);
 					}
 
 					/* file is no longer needed */
@@ -2102,6 +2238,173 @@ struct ImBuf *imb_load_openexr(const unsigned char *mem, size_t size, int flags,
 
 }
 
+/* Scanlines are compressed together in blocks, which are always decompressed whole. */
+static int exr_lines_per_block(Compression compression)
+{
+	switch (compression) {
+		case ZIP_COMPRESSION:
+		case PXR24_COMPRESSION:
+			return 16;
+		case PIZ_COMPRESSION:
+		case B44_COMPRESSION:
+		case B44A_COMPRESSION:
+#if OPENEXR_VERSION_MAJOR >= 2 && OPENEXR_VERSION_MINOR >= 2
+		case DWAA_COMPRESSION:
+#endif
+			return 32;
+#if OPENEXR_VERSION_MAJOR >= 2 && OPENEXR_VERSION_MINOR >= 2
+		case DWAB_COMPRESSION:
+			return 256;
+#endif
+		default:
+			return 1;
+	}
+}
+
+/* Thumbnails only read the pixels they need: the smallest mipmap level still bigger than the
+ * thumbnail of tiled files, and the blocks of scanlines holding every few lines of other files.
+ * Each block is read once, blocks in between are only left out when the lines are further apart
+ * than a block (16 lines for ZIP, 32 for PIZ, 256 for DWAB). */
+struct ImBuf *imb_thumbnail_openexr(const unsigned char *mem, size_t size, int flags, size_t max_thumb_size,
+                                    char colorspace[IM_MAX_SPACE], size_t *r_width, size_t *r_height)
+{
+	struct ImBuf *ibuf = NULL;
+	Mem_IStream *membuf = NULL;
+	MultiPartInputFile *file = NULL;
+	float *level_rect = NULL, *block_rect = NULL;
+
+	if (imb_is_a_openexr(mem) == 0) return(NULL);
+
+	colorspace_set_default_role(colorspace, IM_MAX_SPACE, COLOR_ROLE_DEFAULT_FLOAT);
+
+	try
+	{
+		membuf = new Mem_IStream((unsigned char *)mem, size);
+		file = new MultiPartInputFile(*membuf);
+
+		/* multilayer files are loaded as usual */
+		if (imb_exr_is_multi(*file)) {
+			delete file;
+			delete membuf;
+			return NULL;
+		}
+
+		const Header& header = file->header(0);
+		const Box2i dw = header.dataWindow();
+		const int width  = dw.max.x - dw.min.x + 1;
+		const int height = dw.max.y - dw.min.y + 1;
+		const int xstride = sizeof(float) * 4;
+		const bool is_tiled = header.hasTileDescription() && header.tileDescription().mode != ONE_LEVEL;
+		int level_width = width, level_height = height;
+		int step, x, y;
+
+		*r_width = width;
+		*r_height = height;
+
+		if (is_tiled) {
+			TiledInputPart in(*file, 0);
+			FrameBuffer frameBuffer;
+			int level = 0;
+			const int totlevel = (in.levelMode() == MIPMAP_LEVELS) ? in.numLevels() :
+			                     min_ii(in.numXLevels(), in.numYLevels());
+
+			while (level + 1 < totlevel &&
+			       (size_t)max_ii(in.levelWidth(level + 1), in.levelHeight(level + 1)) >= max_thumb_size)
+			{
+				level++;
+			}
+
+			const Box2i lw = in.dataWindowForLevel(level, level);
+			level_width = lw.max.x - lw.min.x + 1;
+			level_height = lw.max.y - lw.min.y + 1;
+
+			level_rect = (float *)MEM_mapallocN(sizeof(float) * 4 * level_width * level_height, "exr thumbnail level");
+			exr_rgba_framebuffer(*file, frameBuffer, level_rect - 4 * (lw.min.x + lw.min.y * level_width),
+			                     xstride, xstride * level_width);
+
+			in.setFrameBuffer(frameBuffer);
+			in.readTiles(0, in.numXTiles(level) - 1, 0, in.numYTiles(level) - 1, level, level);
+		}
+
+		step = max_ii(1, max_ii(level_width, level_height) / max_ii((int)max_thumb_size, 1));
+
+		ibuf = IMB_allocImBuf(max_ii(level_width / step, 1), max_ii(level_height / step, 1),
+		                      exr_has_alpha(*file) ? 32 : 24, IB_rectfloat);
+		ibuf->ftype = IMB_FTYPE_OPENEXR;
+
+		if (is_tiled) {
+			for (y = 0; y < ibuf->y; y++) {
+				const float *src = level_rect + 4 * (size_t)y * step * level_width;
+				float *dst = ibuf->rect_float + 4 * (size_t)(ibuf->y - 1 - y) * ibuf->x;
+
+				for (x = 0; x < ibuf->x; x++, dst += 4, src += 4 * step) {
+					copy_v4_v4(dst, src);
+				}
+			}
+		}
+		else {
+			InputPart in(*file, 0);
+			const int block_lines = min_ii(exr_lines_per_block(header.compression()), height);
+			int block_y = dw.min.y - block_lines;
+
+			block_rect = (float *)MEM_mallocN(sizeof(float) * 4 * width * block_lines, "exr thumbnail block");
+
+			for (y = 0; y < ibuf->y; y++) {
+				const int line_y = dw.min.y + y * step;
+				const int first_y = dw.min.y + ((line_y - dw.min.y) / block_lines) * block_lines;
+				const float *src;
+				float *dst = ibuf->rect_float + 4 * (size_t)(ibuf->y - 1 - y) * ibuf->x;
+
+				/* lines closer than a block share it, read the whole block once */
+				if (first_y != block_y) {
+					FrameBuffer frameBuffer;
+
+					/* slices are addressed with image coordinates, point the block to read at the buffer */
+					exr_rgba_framebuffer(*file, frameBuffer, block_rect - 4 * (dw.min.x + (ptrdiff_t)first_y * width),
+					                     xstride, xstride * width);
+					in.setFrameBuffer(frameBuffer);
+					in.readPixels(first_y, min_ii(first_y + block_lines - 1, dw.max.y));
+					block_y = first_y;
+				}
+
+				src = block_rect + 4 * (size_t)(line_y - block_y) * width;
+				for (x = 0; x < ibuf->x; x++, dst += 4, src += 4 * step) {
+					copy_v4_v4(dst, src);
+				}
+			}
+		}
+
+		if (!exr_has_rgb(*file) && exr_has_luma(*file)) {
+			exr_luma_to_rgb(*file, ibuf->rect_float, (size_t)ibuf->x * ibuf->y);
+		}
+
+		if (flags & IB_alphamode_detect)
+			ibuf->flags |= IB_alphamode_premul;
+
+		if (level_rect) {
+			MEM_freeN(level_rect);
+		}
+		if (block_rect) {
+			MEM_freeN(block_rect);
+		}
+		delete file;
+		delete membuf;
+
+		return(ibuf);
+	}
+	catch (const std::exception& exc)
+	{
+		std::cerr << exc.what() << std::endl;
+		if (ibuf) IMB_freeImBuf(ibuf);
+		if (level_rect) MEM_freeN(level_rect);
+		if (block_rect) MEM_freeN(block_rect);
+		delete file;
+		delete membuf;
+
+		return (0);
+	}
+}
+
 void imb_initopenexr(void)
 {
 	int num_threads = BLI_system_thread_count();
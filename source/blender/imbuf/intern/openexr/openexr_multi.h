@@ -59,6 +59,7 @@ void  IMB_exr_add_channel(void *handle,
                           bool use_half_float);
 
 int     IMB_exr_begin_read(void *handle, const char *filename, int *width, int *height);
+int     IMB_exr_begin_read_multilayer(void *handle, const char *filename, int *width, int *height);
 int     IMB_exr_begin_write(void *handle, const char *filename, int width, int height, int compress, const struct StampData *stamp);
 void    IMB_exrtile_begin_write(void *handle, const char *filename, int mipmap, int width, int height, int tilex, int tiley);
 
@@ -66,6 +67,7 @@ void    IMB_exr_set_channel(void *handle, const char *layname, const char *passn
 float  *IMB_exr_channel_rect(void *handle, const char *layname, const char *passname, const char *view);
 
 void    IMB_exr_read_channels(void *handle);
+float  *IMB_exr_read_pass(void *handle, const char *layname, const char *passname, const char *viewname, int totchan);
 void    IMB_exr_write_channels(void *handle);
 void    IMB_exrtile_write_channels(void *handle, int partx, int party, int level, const char *viewname);
 void    IMB_exrmultiview_write_channels(void *handle, const char *viewname);
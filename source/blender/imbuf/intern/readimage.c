@@ -238,6 +238,67 @@ ImBuf *IMB_loadiffname(const char *filepath, int flags, char colorspace[IM_MAX_S
 	return ibuf;
 }
 
+ImBuf *IMB_thumb_load_image(const char *filepath, int flags, size_t max_thumb_size,
+                            char colorspace[IM_MAX_SPACE], size_t *r_width, size_t *r_height)
+{
+	ImBuf *ibuf = NULL;
+	const ImFileType *type;
+	char effective_colorspace[IM_MAX_SPACE] = "";
+	unsigned char *mem;
+	size_t size;
+	int file;
+
+	BLI_assert(!BLI_path_is_rel(filepath));
+
+	if (!imb_is_filepath_format(filepath)) {
+		file = BLI_open(filepath, O_BINARY | O_RDONLY, 0);
+		if (file == -1)
+			return NULL;
+
+		size = BLI_file_descriptor_size(file);
+
+		imb_mmap_lock();
+		mem = mmap(NULL, size, PROT_READ, MAP_SHARED, file, 0);
+		imb_mmap_unlock();
+
+		if (mem != (unsigned char *) -1) {
+			if (colorspace)
+				BLI_strncpy(effective_colorspace, colorspace, sizeof(effective_colorspace));
+
+			for (type = IMB_FILE_TYPES; type < IMB_FILE_TYPES_LAST; type++) {
+				if (type->load_thumbnail) {
+					ibuf = type->load_thumbnail(mem, size, flags, max_thumb_size, effective_colorspace, r_width, r_height);
+					if (ibuf) {
+						imb_handle_alpha(ibuf, flags, colorspace, effective_colorspace);
+						break;
+					}
+				}
+			}
+
+			imb_mmap_lock();
+			if (munmap(mem, size))
+				fprintf(stderr, "%s: couldn't unmap file %s\n", __func__, filepath);
+			imb_mmap_unlock();
+		}
+
+		close(file);
+	}
+
+	/* formats without reduced resolution reads */
+	if (ibuf == NULL) {
+		ibuf = IMB_loadiffname(filepath, flags, colorspace);
+		if (ibuf) {
+			*r_width = ibuf->x;
+			*r_height = ibuf->y;
+		}
+	}
+	else {
+		BLI_strncpy(ibuf->name, filepath, sizeof(ibuf->name));
+	}
+
+	return ibuf;
+}
+
 ImBuf *IMB_testiffname(const char *filepath, int flags)
 {
 	ImBuf *ibuf;
@@ -32,9 +32,20 @@
  */
 
 
+#include <math.h>
+#include <string.h>
+
+#if defined(__AVX__)
+#  include <immintrin.h>
+#elif defined(__SSE2__)
+#  include <emmintrin.h>
+#endif
+
 #include "BLI_utildefines.h"
+#include "BLI_math_base.h"
 #include "BLI_math_color.h"
 #include "BLI_math_interp.h"
+#include "BLI_task.h"
 #include "MEM_guardedalloc.h"
 
 #include "imbuf.h"
@@ -881,151 +892,240 @@ static bool q_scale_linear_interpolation(
 	return true;
 }
 
-static ImBuf *scaledownx(struct ImBuf *ibuf, int newx)
-{
-	const int do_rect = (ibuf->rect != NULL);
-	const int do_float = (ibuf->rect_float != NULL);
-	const size_t rect_size = ibuf->x * ibuf->y * 4;
+/* Passes of IMB_scaleImBuf with fewer output pixels run on the calling thread. */
+#define SCALE_THREADED_LIMIT (128 * 128)
 
-	uchar *rect, *_newrect, *newrect;
-	float *rectf, *_newrectf, *newrectf;
-	float sample, add, val[4], nval[4], valf[4], nvalf[4];
-	int x, y;
+/* Source rows of an output row of the vertical passes, every column has the same sample
+ * positions so they are computed once, and the output is computed a row at a time. */
+typedef struct ScaleRowSpan {
+	int row;            /* first source row */
+	int tot;            /* source rows entirely inside the output row (downscaling) */
+	float sample_prev;  /* part of the previous source row belonging to the previous output row */
+	float sample;
+} ScaleRowSpan;
+
+typedef struct ScaleTaskData {
+	ImBuf *ibuf;
+	uchar *newrect;
+	float *newrectf;
+	int newsize;
+	float add;
+	ScaleRowSpan *spans;
+} ScaleTaskData;
+
+static void scale_task_data_init(ScaleTaskData *data, ImBuf *ibuf, uchar *newrect, float *newrectf,
+                                 int newsize, float add)
+{
+	memset(data, 0, sizeof(*data));
+	data->ibuf = ibuf;
+	data->newrect = newrect;
+	data->newrectf = newrectf;
+	data->newsize = newsize;
+	data->add = add;
+}
 
-	rectf = _newrectf = newrectf = NULL;
-	rect = _newrect = newrect = NULL;
+static void scaledownx_task_cb(void *userdata, const int y)
+{
+	ScaleTaskData *data = userdata;
+	ImBuf *ibuf = data->ibuf;
+	const int newx = data->newsize;
+	const float add = data->add;
+	const bool do_rect = (data->newrect != NULL);
+	const bool do_float = (data->newrectf != NULL);
+
+	uchar *rect, *newrect;
+	float *rectf, *newrectf;
+	float sample, val[4], nval[4], valf[4], nvalf[4];
+	int x;
+
+	rectf = newrectf = NULL;
+	rect = newrect = NULL;
 	nval[0] =  nval[1] = nval[2] = nval[3] = 0.0f;
 	nvalf[0] = nvalf[1] = nvalf[2] = nvalf[3] = 0.0f;
 
-	if (!do_rect && !do_float) return (ibuf);
-
 	if (do_rect) {
-		_newrect = MEM_mallocN(newx * ibuf->y * sizeof(uchar) * 4, "scaledownx");
-		if (_newrect == NULL) return(ibuf);
+		rect = (uchar *)ibuf->rect + (size_t)y * ibuf->x * 4;
+		newrect = data->newrect + (size_t)y * newx * 4;
 	}
 	if (do_float) {
-		_newrectf = MEM_mallocN(newx * ibuf->y * sizeof(float) * 4, "scaledownxf");
-		if (_newrectf == NULL) {
-			if (_newrect) MEM_freeN(_newrect);
-			return(ibuf);
-		}
+		rectf = ibuf->rect_float + (size_t)y * ibuf->x * 4;
+		newrectf = data->newrectf + (size_t)y * newx * 4;
 	}
 
-	add = (ibuf->x - 0.01) / newx;
+	sample = 0.0f;
+	val[0] =  val[1] = val[2] = val[3] = 0.0f;
+	valf[0] = valf[1] = valf[2] = valf[3] = 0.0f;
 
-	if (do_rect) {
-		rect = (uchar *) ibuf->rect;
-		newrect = _newrect;
-	}
-	if (do_float) {
-		rectf = ibuf->rect_float;
-		newrectf = _newrectf;
-	}
-		
-	for (y = ibuf->y; y > 0; y--) {
-		sample = 0.0f;
-		val[0] =  val[1] = val[2] = val[3] = 0.0f;
-		valf[0] = valf[1] = valf[2] = valf[3] = 0.0f;
+	for (x = newx; x > 0; x--) {
+		if (do_rect) {
+			nval[0] = -val[0] * sample;
+			nval[1] = -val[1] * sample;
+			nval[2] = -val[2] * sample;
+			nval[3] = -val[3] * sample;
+		}
+		if (do_float) {
+			nvalf[0] = -valf[0] * sample;
+			nvalf[1] = -valf[1] * sample;
+			nvalf[2] = -valf[2] * sample;
+			nvalf[3] = -valf[3] * sample;
+		}
 
-		for (x = newx; x > 0; x--) {
-			if (do_rect) {
-				nval[0] = -val[0] * sample;
-				nval[1] = -val[1] * sample;
-				nval[2] = -val[2] * sample;
-				nval[3] = -val[3] * sample;
-			}
-			if (do_float) {
-				nvalf[0] = -valf[0] * sample;
-				nvalf[1] = -valf[1] * sample;
-				nvalf[2] = -valf[2] * sample;
-				nvalf[3] = -valf[3] * sample;
-			}
-			
-			sample += add;
+		sample += add;
+
+		while (sample >= 1.0f) {
+			sample -= 1.0f;
 
-			while (sample >= 1.0f) {
-				sample -= 1.0f;
-				
-				if (do_rect) {
-					nval[0] += rect[0];
-					nval[1] += rect[1];
-					nval[2] += rect[2];
-					nval[3] += rect[3];
-					rect += 4;
-				}
-				if (do_float) {
-					nvalf[0] += rectf[0];
-					nvalf[1] += rectf[1];
-					nvalf[2] += rectf[2];
-					nvalf[3] += rectf[3];
-					rectf += 4;
-				}
-			}
-			
 			if (do_rect) {
-				val[0] = rect[0]; val[1] = rect[1]; val[2] = rect[2]; val[3] = rect[3];
+				nval[0] += rect[0];
+				nval[1] += rect[1];
+				nval[2] += rect[2];
+				nval[3] += rect[3];
 				rect += 4;
-				
-				newrect[0] = ((nval[0] + sample * val[0]) / add + 0.5f);
-				newrect[1] = ((nval[1] + sample * val[1]) / add + 0.5f);
-				newrect[2] = ((nval[2] + sample * val[2]) / add + 0.5f);
-				newrect[3] = ((nval[3] + sample * val[3]) / add + 0.5f);
-				
-				newrect += 4;
 			}
 			if (do_float) {
-				
-				valf[0] = rectf[0]; valf[1] = rectf[1]; valf[2] = rectf[2]; valf[3] = rectf[3];
+				nvalf[0] += rectf[0];
+				nvalf[1] += rectf[1];
+				nvalf[2] += rectf[2];
+				nvalf[3] += rectf[3];
 				rectf += 4;
-				
-				newrectf[0] = ((nvalf[0] + sample * valf[0]) / add);
-				newrectf[1] = ((nvalf[1] + sample * valf[1]) / add);
-				newrectf[2] = ((nvalf[2] + sample * valf[2]) / add);
-				newrectf[3] = ((nvalf[3] + sample * valf[3]) / add);
-				
-				newrectf += 4;
 			}
-			
-			sample -= 1.0f;
 		}
+
+		if (do_rect) {
+			val[0] = rect[0]; val[1] = rect[1]; val[2] = rect[2]; val[3] = rect[3];
+			rect += 4;
+
+			newrect[0] = ((nval[0] + sample * val[0]) / add + 0.5f);
+			newrect[1] = ((nval[1] + sample * val[1]) / add + 0.5f);
+			newrect[2] = ((nval[2] + sample * val[2]) / add + 0.5f);
+			newrect[3] = ((nval[3] + sample * val[3]) / add + 0.5f);
+
+			newrect += 4;
+		}
+		if (do_float) {
+
+			valf[0] = rectf[0]; valf[1] = rectf[1]; valf[2] = rectf[2]; valf[3] = rectf[3];
+			rectf += 4;
+
+			newrectf[0] = ((nvalf[0] + sample * valf[0]) / add);
+			newrectf[1] = ((nvalf[1] + sample * valf[1]) / add);
+			newrectf[2] = ((nvalf[2] + sample * valf[2]) / add);
+			newrectf[3] = ((nvalf[3] + sample * valf[3]) / add);
+
+			newrectf += 4;
+		}
+
+		sample -= 1.0f;
 	}
 
+	/* see bug [#26502] */
+	BLI_assert(!do_rect || rect == (uchar *)ibuf->rect + (size_t)(y + 1) * ibuf->x * 4);
+	BLI_assert(!do_float || rectf == ibuf->rect_float + (size_t)(y + 1) * ibuf->x * 4);
+}
+
+static ImBuf *scaledownx(struct ImBuf *ibuf, int newx)
+{
+	const int do_rect = (ibuf->rect != NULL);
+	const int do_float = (ibuf->rect_float != NULL);
+
+	uchar *_newrect = NULL;
+	float *_newrectf = NULL;
+	ScaleTaskData data;
+
+	if (!do_rect && !do_float) return (ibuf);
+
+	if (do_rect) {
+		_newrect = MEM_mallocN(newx * ibuf->y * sizeof(uchar) * 4, "scaledownx");
+		if (_newrect == NULL) return(ibuf);
+	}
+	if (do_float) {
+		_newrectf = MEM_mallocN(newx * ibuf->y * sizeof(float) * 4, "scaledownxf");
+		if (_newrectf == NULL) {
+			if (_newrect) MEM_freeN(_newrect);
+			return(ibuf);
+		}
+	}
+
+	scale_task_data_init(&data, ibuf, _newrect, _newrectf, newx, (ibuf->x - 0.01) / newx);
+
+	BLI_task_parallel_range(0, ibuf->y, &data, scaledownx_task_cb,
+	                        ((size_t)newx * ibuf->y > SCALE_THREADED_LIMIT));
+
 	if (do_rect) {
-		// printf("%ld %ld\n", (uchar *)rect - ((uchar *)ibuf->rect), rect_size);
-		BLI_assert((uchar *)rect - ((uchar *)ibuf->rect) == rect_size); /* see bug [#26502] */
 		imb_freerectImBuf(ibuf);
 		ibuf->mall |= IB_rect;
 		ibuf->rect = (unsigned int *) _newrect;
 	}
 	if (do_float) {
-		// printf("%ld %ld\n", rectf - ibuf->rect_float, rect_size);
-		BLI_assert((rectf - ibuf->rect_float) == rect_size); /* see bug [#26502] */
 		imb_freerectfloatImBuf(ibuf);
 		ibuf->mall |= IB_rectfloat;
 		ibuf->rect_float = _newrectf;
 	}
-	(void)rect_size; /* UNUSED in release builds */
-	
+
 	ibuf->x = newx;
 	return(ibuf);
 }
 
+static void scaledowny_task_cb(void *userdata, const int y)
+{
+	ScaleTaskData *data = userdata;
+	ImBuf *ibuf = data->ibuf;
+	const ScaleRowSpan *span = &data->spans[y];
+	const size_t skipx = 4 * (size_t)ibuf->x;
+	const float add = data->add;
+	size_t i;
+	int row;
+
+	/* same arithmetic as the horizontal pass, for every channel of the row at once,
+	 * the value of the previous source row is 0 for the first output row */
+	if (data->newrect) {
+		const uchar *rect = (uchar *)ibuf->rect + span->row * skipx;
+		const uchar *rect_prev = (y > 0) ? rect - skipx : NULL;
+		uchar *newrect = data->newrect + y * skipx;
+
+		for (i = 0; i < skipx; i++) {
+			const uchar *src = rect + i;
+			float val = rect_prev ? rect_prev[i] : 0.0f;
+			float nval = -val * span->sample_prev;
+
+			for (row = 0; row < span->tot; row++, src += skipx) {
+				nval += src[0];
+			}
+			val = src[0];
+
+			newrect[i] = ((nval + span->sample * val) / add + 0.5f);
+		}
+	}
+	if (data->newrectf) {
+		const float *rectf = ibuf->rect_float + span->row * skipx;
+		const float *rectf_prev = (y > 0) ? rectf - skipx : NULL;
+		float *newrectf = data->newrectf + y * skipx;
+
+		for (i = 0; i < skipx; i++) {
+			const float *src = rectf + i;
+			float valf = rectf_prev ? rectf_prev[i] : 0.0f;
+			float nvalf = -valf * span->sample_prev;
+
+			for (row = 0; row < span->tot; row++, src += skipx) {
+				nvalf += src[0];
+			}
+			valf = src[0];
+
+			newrectf[i] = ((nvalf + span->sample * valf) / add);
+		}
+	}
+}
 
 static ImBuf *scaledowny(struct ImBuf *ibuf, int newy)
 {
 	const int do_rect = (ibuf->rect != NULL);
 	const int do_float = (ibuf->rect_float != NULL);
-	const size_t rect_size = ibuf->x * ibuf->y * 4;
-
-	uchar *rect, *_newrect, *newrect;
-	float *rectf, *_newrectf, *newrectf;
-	float sample, add, val[4], nval[4], valf[4], nvalf[4];
-	int x, y, skipx;
 
-	rectf = _newrectf = newrectf = NULL;
-	rect = _newrect = newrect = NULL;
-	nval[0] =  nval[1] = nval[2] = nval[3] = 0.0f;
-	nvalf[0] = nvalf[1] = nvalf[2] = nvalf[3] = 0.0f;
+	uchar *_newrect = NULL;
+	float *_newrectf = NULL;
+	ScaleTaskData data;
+	float sample;
+	int y, row;
 
 	if (!do_rect && !do_float) return (ibuf);
 
@@ -1041,112 +1141,64 @@ static ImBuf *scaledowny(struct ImBuf *ibuf, int newy)
 		}
 	}
 
-	add = (ibuf->y - 0.01) / newy;
-	skipx = 4 * ibuf->x;
+	scale_task_data_init(&data, ibuf, _newrect, _newrectf, newy, (ibuf->y - 0.01) / newy);
+	data.spans = MEM_mallocN(sizeof(*data.spans) * newy, "scaledowny spans");
 
-	for (x = skipx - 4; x >= 0; x -= 4) {
-		if (do_rect) {
-			rect = ((uchar *) ibuf->rect) + x;
-			newrect = _newrect + x;
-		}
-		if (do_float) {
-			rectf = ibuf->rect_float + x;
-			newrectf = _newrectf + x;
-		}
-		
-		sample = 0.0f;
-		val[0] =  val[1] = val[2] = val[3] = 0.0f;
-		valf[0] = valf[1] = valf[2] = valf[3] = 0.0f;
+	sample = 0.0f;
+	row = 0;
+	for (y = 0; y < newy; y++) {
+		ScaleRowSpan *span = &data.spans[y];
 
-		for (y = newy; y > 0; y--) {
-			if (do_rect) {
-				nval[0] = -val[0] * sample;
-				nval[1] = -val[1] * sample;
-				nval[2] = -val[2] * sample;
-				nval[3] = -val[3] * sample;
-			}
-			if (do_float) {
-				nvalf[0] = -valf[0] * sample;
-				nvalf[1] = -valf[1] * sample;
-				nvalf[2] = -valf[2] * sample;
-				nvalf[3] = -valf[3] * sample;
-			}
-			
-			sample += add;
+		span->row = row;
+		span->tot = 0;
+		span->sample_prev = sample;
 
-			while (sample >= 1.0f) {
-				sample -= 1.0f;
-				
-				if (do_rect) {
-					nval[0] += rect[0];
-					nval[1] += rect[1];
-					nval[2] += rect[2];
-					nval[3] += rect[3];
-					rect += skipx;
-				}
-				if (do_float) {
-					nvalf[0] += rectf[0];
-					nvalf[1] += rectf[1];
-					nvalf[2] += rectf[2];
-					nvalf[3] += rectf[3];
-					rectf += skipx;
-				}
-			}
+		sample += data.add;
 
-			if (do_rect) {
-				val[0] = rect[0]; val[1] = rect[1]; val[2] = rect[2]; val[3] = rect[3];
-				rect += skipx;
-				
-				newrect[0] = ((nval[0] + sample * val[0]) / add + 0.5f);
-				newrect[1] = ((nval[1] + sample * val[1]) / add + 0.5f);
-				newrect[2] = ((nval[2] + sample * val[2]) / add + 0.5f);
-				newrect[3] = ((nval[3] + sample * val[3]) / add + 0.5f);
-				
-				newrect += skipx;
-			}
-			if (do_float) {
-				
-				valf[0] = rectf[0]; valf[1] = rectf[1]; valf[2] = rectf[2]; valf[3] = rectf[3];
-				rectf += skipx;
-				
-				newrectf[0] = ((nvalf[0] + sample * valf[0]) / add);
-				newrectf[1] = ((nvalf[1] + sample * valf[1]) / add);
-				newrectf[2] = ((nvalf[2] + sample * valf[2]) / add);
-				newrectf[3] = ((nvalf[3] + sample * valf[3]) / add);
-				
-				newrectf += skipx;
-			}
-			
+		while (sample >= 1.0f) {
 			sample -= 1.0f;
+			span->tot++;
 		}
+
+		span->sample = sample;
+		row += span->tot + 1;
+
+		sample -= 1.0f;
 	}
+	BLI_assert(row == ibuf->y); /* see bug [#26502] */
+
+	BLI_task_parallel_range(0, newy, &data, scaledowny_task_cb,
+	                        ((size_t)ibuf->x * newy > SCALE_THREADED_LIMIT));
+
+	MEM_freeN(data.spans);
 
 	if (do_rect) {
-		// printf("%ld %ld\n", (uchar *)rect - ((uchar *)ibuf->rect), rect_size);
-		BLI_assert((uchar *)rect - ((uchar *)ibuf->rect) == rect_size); /* see bug [#26502] */
 		imb_freerectImBuf(ibuf);
 		ibuf->mall |= IB_rect;
 		ibuf->rect = (unsigned int *) _newrect;
 	}
 	if (do_float) {
-		// printf("%ld %ld\n", rectf - ibuf->rect_float, rect_size);
-		BLI_assert((rectf - ibuf->rect_float) == rect_size); /* see bug [#26502] */
 		imb_freerectfloatImBuf(ibuf);
 		ibuf->mall |= IB_rectfloat;
 		ibuf->rect_float = (float *) _newrectf;
 	}
-	(void)rect_size; /* UNUSED in release builds */
-	
+
 	ibuf->y = newy;
 	return(ibuf);
 }
 
-
-static ImBuf *scaleupx(struct ImBuf *ibuf, int newx)
+static void scaleupx_task_cb(void *userdata, const int y)
 {
-	uchar *rect, *_newrect = NULL, *newrect;
-	float *rectf, *_newrectf = NULL, *newrectf;
-	float sample, add;
+	ScaleTaskData *data = userdata;
+	ImBuf *ibuf = data->ibuf;
+	const int newx = data->newsize;
+	const float add = data->add;
+	const bool do_rect = (data->newrect != NULL);
+	const bool do_float = (data->newrectf != NULL);
+
+	uchar *rect = NULL, *newrect = NULL;
+	float *rectf = NULL, *newrectf = NULL;
+	float sample;
 	float val_a, nval_a, diff_a;
 	float val_b, nval_b, diff_b;
 	float val_g, nval_g, diff_g;
@@ -1155,23 +1207,140 @@ static ImBuf *scaleupx(struct ImBuf *ibuf, int newx)
 	float val_bf, nval_bf, diff_bf;
 	float val_gf, nval_gf, diff_gf;
 	float val_rf, nval_rf, diff_rf;
-	int x, y;
-	bool do_rect = false, do_float = false;
+	int x;
 
 	val_a = nval_a = diff_a = val_b = nval_b = diff_b = 0;
 	val_g = nval_g = diff_g = val_r = nval_r = diff_r = 0;
 	val_af = nval_af = diff_af = val_bf = nval_bf = diff_bf = 0;
 	val_gf = nval_gf = diff_gf = val_rf = nval_rf = diff_rf = 0;
+
+	sample = 0;
+
+	if (do_rect) {
+		rect = (uchar *)ibuf->rect + (size_t)y * ibuf->x * 4;
+		newrect = data->newrect + (size_t)y * newx * 4;
+
+		val_a = rect[0];
+		nval_a = rect[4];
+		diff_a = nval_a - val_a;
+		val_a += 0.5f;
+
+		val_b = rect[1];
+		nval_b = rect[5];
+		diff_b = nval_b - val_b;
+		val_b += 0.5f;
+
+		val_g = rect[2];
+		nval_g = rect[6];
+		diff_g = nval_g - val_g;
+		val_g += 0.5f;
+
+		val_r = rect[3];
+		nval_r = rect[7];
+		diff_r = nval_r - val_r;
+		val_r += 0.5f;
+
+		rect += 8;
+	}
+	if (do_float) {
+		rectf = ibuf->rect_float + (size_t)y * ibuf->x * 4;
+		newrectf = data->newrectf + (size_t)y * newx * 4;
+
+		val_af = rectf[0];
+		nval_af = rectf[4];
+		diff_af = nval_af - val_af;
+
+		val_bf = rectf[1];
+		nval_bf = rectf[5];
+		diff_bf = nval_bf - val_bf;
+
+		val_gf = rectf[2];
+		nval_gf = rectf[6];
+		diff_gf = nval_gf - val_gf;
+
+		val_rf = rectf[3];
+		nval_rf = rectf[7];
+		diff_rf = nval_rf - val_rf;
+
+		rectf += 8;
+	}
+	for (x = newx; x > 0; x--) {
+		if (sample >= 1.0f) {
+			sample -= 1.0f;
+
+			if (do_rect) {
+				val_a = nval_a;
+				nval_a = rect[0];
+				diff_a = nval_a - val_a;
+				val_a += 0.5f;
+
+				val_b = nval_b;
+				nval_b = rect[1];
+				diff_b = nval_b - val_b;
+				val_b += 0.5f;
+
+				val_g = nval_g;
+				nval_g = rect[2];
+				diff_g = nval_g - val_g;
+				val_g += 0.5f;
+
+				val_r = nval_r;
+				nval_r = rect[3];
+				diff_r = nval_r - val_r;
+				val_r += 0.5f;
+				rect += 4;
+			}
+			if (do_float) {
+				val_af = nval_af;
+				nval_af = rectf[0];
+				diff_af = nval_af - val_af;
+
+				val_bf = nval_bf;
+				nval_bf = rectf[1];
+				diff_bf = nval_bf - val_bf;
+
+				val_gf = nval_gf;
+				nval_gf = rectf[2];
+				diff_gf = nval_gf - val_gf;
+
+				val_rf = nval_rf;
+				nval_rf = rectf[3];
+				diff_rf = nval_rf - val_rf;
+				rectf += 4;
+			}
+		}
+		if (do_rect) {
+			newrect[0] = val_a + sample * diff_a;
+			newrect[1] = val_b + sample * diff_b;
+			newrect[2] = val_g + sample * diff_g;
+			newrect[3] = val_r + sample * diff_r;
+			newrect += 4;
+		}
+		if (do_float) {
+			newrectf[0] = val_af + sample * diff_af;
+			newrectf[1] = val_bf + sample * diff_bf;
+			newrectf[2] = val_gf + sample * diff_gf;
+			newrectf[3] = val_rf + sample * diff_rf;
+			newrectf += 4;
+		}
+		sample += add;
+	}
+}
+
+static ImBuf *scaleupx(struct ImBuf *ibuf, int newx)
+{
+	uchar *_newrect = NULL;
+	float *_newrectf = NULL;
+	ScaleTaskData data;
+
 	if (ibuf == NULL) return(NULL);
 	if (ibuf->rect == NULL && ibuf->rect_float == NULL) return (ibuf);
 
 	if (ibuf->rect) {
-		do_rect = true;
 		_newrect = MEM_mallocN(newx * ibuf->y * sizeof(int), "scaleupx");
 		if (_newrect == NULL) return(ibuf);
 	}
 	if (ibuf->rect_float) {
-		do_float = true;
 		_newrectf = MEM_mallocN(newx * ibuf->y * sizeof(float) * 4, "scaleupxf");
 		if (_newrectf == NULL) {
 			if (_newrect) MEM_freeN(_newrect);
@@ -1179,167 +1348,80 @@ static ImBuf *scaleupx(struct ImBuf *ibuf, int newx)
 		}
 	}
 
-	add = (ibuf->x - 1.001) / (newx - 1.0);
-
-	rect = (uchar *) ibuf->rect;
-	rectf = (float *) ibuf->rect_float;
-	newrect = _newrect;
-	newrectf = _newrectf;
+	scale_task_data_init(&data, ibuf, _newrect, _newrectf, newx, (ibuf->x - 1.001) / (newx - 1.0));
 
-	for (y = ibuf->y; y > 0; y--) {
+	BLI_task_parallel_range(0, ibuf->y, &data, scaleupx_task_cb,
+	                        ((size_t)newx * ibuf->y > SCALE_THREADED_LIMIT));
 
-		sample = 0;
-		
-		if (do_rect) {
-			val_a = rect[0];
-			nval_a = rect[4];
-			diff_a = nval_a - val_a;
-			val_a += 0.5f;
-
-			val_b = rect[1];
-			nval_b = rect[5];
-			diff_b = nval_b - val_b;
-			val_b += 0.5f;
-
-			val_g = rect[2];
-			nval_g = rect[6];
-			diff_g = nval_g - val_g;
-			val_g += 0.5f;
-
-			val_r = rect[3];
-			nval_r = rect[7];
-			diff_r = nval_r - val_r;
-			val_r += 0.5f;
-
-			rect += 8;
-		}
-		if (do_float) {
-			val_af = rectf[0];
-			nval_af = rectf[4];
-			diff_af = nval_af - val_af;
-	
-			val_bf = rectf[1];
-			nval_bf = rectf[5];
-			diff_bf = nval_bf - val_bf;
-
-			val_gf = rectf[2];
-			nval_gf = rectf[6];
-			diff_gf = nval_gf - val_gf;
-
-			val_rf = rectf[3];
-			nval_rf = rectf[7];
-			diff_rf = nval_rf - val_rf;
-
-			rectf += 8;
-		}
-		for (x = newx; x > 0; x--) {
-			if (sample >= 1.0f) {
-				sample -= 1.0f;
-
-				if (do_rect) {
-					val_a = nval_a;
-					nval_a = rect[0];
-					diff_a = nval_a - val_a;
-					val_a += 0.5f;
-
-					val_b = nval_b;
-					nval_b = rect[1];
-					diff_b = nval_b - val_b;
-					val_b += 0.5f;
-
-					val_g = nval_g;
-					nval_g = rect[2];
-					diff_g = nval_g - val_g;
-					val_g += 0.5f;
-
-					val_r = nval_r;
-					nval_r = rect[3];
-					diff_r = nval_r - val_r;
-					val_r += 0.5f;
-					rect += 4;
-				}
-				if (do_float) {
-					val_af = nval_af;
-					nval_af = rectf[0];
-					diff_af = nval_af - val_af;
-	
-					val_bf = nval_bf;
-					nval_bf = rectf[1];
-					diff_bf = nval_bf - val_bf;
-
-					val_gf = nval_gf;
-					nval_gf = rectf[2];
-					diff_gf = nval_gf - val_gf;
-
-					val_rf = nval_rf;
-					nval_rf = rectf[3];
-					diff_rf = nval_rf - val_rf;
-					rectf += 4;
-				}
-			}
-			if (do_rect) {
-				newrect[0] = val_a + sample * diff_a;
-				newrect[1] = val_b + sample * diff_b;
-				newrect[2] = val_g + sample * diff_g;
-				newrect[3] = val_r + sample * diff_r;
-				newrect += 4;
-			}
-			if (do_float) {
-				newrectf[0] = val_af + sample * diff_af;
-				newrectf[1] = val_bf + sample * diff_bf;
-				newrectf[2] = val_gf + sample * diff_gf;
-				newrectf[3] = val_rf + sample * diff_rf;
-				newrectf += 4;
-			}
-			sample += add;
-		}
-	}
-
-	if (do_rect) {
+	if (_newrect) {
 		imb_freerectImBuf(ibuf);
 		ibuf->mall |= IB_rect;
 		ibuf->rect = (unsigned int *) _newrect;
 	}
-	if (do_float) {
+	if (_newrectf) {
 		imb_freerectfloatImBuf(ibuf);
 		ibuf->mall |= IB_rectfloat;
 		ibuf->rect_float = (float *) _newrectf;
 	}
-	
+
 	ibuf->x = newx;
 	return(ibuf);
 }
 
+static void scaleupy_task_cb(void *userdata, const int y)
+{
+	ScaleTaskData *data = userdata;
+	ImBuf *ibuf = data->ibuf;
+	const ScaleRowSpan *span = &data->spans[y];
+	const size_t skipx = 4 * (size_t)ibuf->x;
+	/* images of a single row are interpolated with themselves */
+	const size_t skipnext = (span->row + 1 < ibuf->y) ? skipx : 0;
+	size_t i;
+
+	/* same arithmetic as the horizontal pass, for every channel of the row at once */
+	if (data->newrect) {
+		const uchar *rect = (uchar *)ibuf->rect + span->row * skipx;
+		uchar *newrect = data->newrect + y * skipx;
+
+		for (i = 0; i < skipx; i++) {
+			float val = rect[i];
+			const float nval = rect[i + skipnext];
+			const float diff = nval - val;
+			val += 0.5f;
+
+			newrect[i] = val + span->sample * diff;
+		}
+	}
+	if (data->newrectf) {
+		const float *rectf = ibuf->rect_float + span->row * skipx;
+		float *newrectf = data->newrectf + y * skipx;
+
+		for (i = 0; i < skipx; i++) {
+			const float valf = rectf[i];
+			const float nvalf = rectf[i + skipnext];
+			const float difff = nvalf - valf;
+
+			newrectf[i] = valf + span->sample * difff;
+		}
+	}
+}
+
 static ImBuf *scaleupy(struct ImBuf *ibuf, int newy)
 {
-	uchar *rect, *_newrect = NULL, *newrect;
-	float *rectf, *_newrectf = NULL, *newrectf;
-	float sample, add;
-	float val_a, nval_a, diff_a;
-	float val_b, nval_b, diff_b;
-	float val_g, nval_g, diff_g;
-	float val_r, nval_r, diff_r;
-	float val_af, nval_af, diff_af;
-	float val_bf, nval_bf, diff_bf;
-	float val_gf, nval_gf, diff_gf;
-	float val_rf, nval_rf, diff_rf;
-	int x, y, skipx;
-	bool do_rect = false, do_float = false;
+	uchar *_newrect = NULL;
+	float *_newrectf = NULL;
+	ScaleTaskData data;
+	float sample;
+	int y, row;
 
-	val_a = nval_a = diff_a = val_b = nval_b = diff_b = 0;
-	val_g = nval_g = diff_g = val_r = nval_r = diff_r = 0;
-	val_af = nval_af = diff_af = val_bf = nval_bf = diff_bf = 0;
-	val_gf = nval_gf = diff_gf = val_rf = nval_rf = diff_rf = 0;
 	if (ibuf == NULL) return(NULL);
 	if (ibuf->rect == NULL && ibuf->rect_float == NULL) return (ibuf);
 
 	if (ibuf->rect) {
-		do_rect = true;
 		_newrect = MEM_mallocN(ibuf->x * newy * sizeof(int), "scaleupy");
 		if (_newrect == NULL) return(ibuf);
 	}
 	if (ibuf->rect_float) {
-		do_float = true;
 		_newrectf = MEM_mallocN(ibuf->x * newy * sizeof(float) * 4, "scaleupyf");
 		if (_newrectf == NULL) {
 			if (_newrect) MEM_freeN(_newrect);
@@ -1347,140 +1429,43 @@ static ImBuf *scaleupy(struct ImBuf *ibuf, int newy)
 		}
 	}
 
-	add = (ibuf->y - 1.001) / (newy - 1.0);
-	skipx = 4 * ibuf->x;
-
-	rect = (uchar *) ibuf->rect;
-	rectf = (float *) ibuf->rect_float;
-	newrect = _newrect;
-	newrectf = _newrectf;
+	scale_task_data_init(&data, ibuf, _newrect, _newrectf, newy, (ibuf->y - 1.001) / (newy - 1.0));
+	data.spans = MEM_mallocN(sizeof(*data.spans) * newy, "scaleupy spans");
 
-	for (x = ibuf->x; x > 0; x--) {
+	sample = 0.0f;
+	row = 0;
+	for (y = 0; y < newy; y++) {
+		ScaleRowSpan *span = &data.spans[y];
 
-		sample = 0;
-		if (do_rect) {
-			rect = ((uchar *)ibuf->rect) + 4 * (x - 1);
-			newrect = _newrect + 4 * (x - 1);
-
-			val_a = rect[0];
-			nval_a = rect[skipx];
-			diff_a = nval_a - val_a;
-			val_a += 0.5f;
-
-			val_b = rect[1];
-			nval_b = rect[skipx + 1];
-			diff_b = nval_b - val_b;
-			val_b += 0.5f;
-
-			val_g = rect[2];
-			nval_g = rect[skipx + 2];
-			diff_g = nval_g - val_g;
-			val_g += 0.5f;
-
-			val_r = rect[3];
-			nval_r = rect[skipx + 3];
-			diff_r = nval_r - val_r;
-			val_r += 0.5f;
-
-			rect += 2 * skipx;
+		if (sample >= 1.0f) {
+			sample -= 1.0f;
+			row++;
 		}
-		if (do_float) {
-			rectf = ibuf->rect_float + 4 * (x - 1);
-			newrectf = _newrectf + 4 * (x - 1);
 
-			val_af = rectf[0];
-			nval_af = rectf[skipx];
-			diff_af = nval_af - val_af;
-	
-			val_bf = rectf[1];
-			nval_bf = rectf[skipx + 1];
-			diff_bf = nval_bf - val_bf;
+		span->row = row;
+		span->tot = 0;
+		span->sample_prev = 0.0f;
+		span->sample = sample;
 
-			val_gf = rectf[2];
-			nval_gf = rectf[skipx + 2];
-			diff_gf = nval_gf - val_gf;
+		sample += data.add;
+	}
 
-			val_rf = rectf[3];
-			nval_rf = rectf[skipx + 3];
-			diff_rf = nval_rf - val_rf;
+	BLI_task_parallel_range(0, newy, &data, scaleupy_task_cb,
+	                        ((size_t)ibuf->x * newy > SCALE_THREADED_LIMIT));
 
-			rectf += 2 * skipx;
-		}
-		
-		for (y = newy; y > 0; y--) {
-			if (sample >= 1.0f) {
-				sample -= 1.0f;
-
-				if (do_rect) {
-					val_a = nval_a;
-					nval_a = rect[0];
-					diff_a = nval_a - val_a;
-					val_a += 0.5f;
-
-					val_b = nval_b;
-					nval_b = rect[1];
-					diff_b = nval_b - val_b;
-					val_b += 0.5f;
-
-					val_g = nval_g;
-					nval_g = rect[2];
-					diff_g = nval_g - val_g;
-					val_g += 0.5f;
-
-					val_r = nval_r;
-					nval_r = rect[3];
-					diff_r = nval_r - val_r;
-					val_r += 0.5f;
-					rect += skipx;
-				}
-				if (do_float) {
-					val_af = nval_af;
-					nval_af = rectf[0];
-					diff_af = nval_af - val_af;
-	
-					val_bf = nval_bf;
-					nval_bf = rectf[1];
-					diff_bf = nval_bf - val_bf;
-
-					val_gf = nval_gf;
-					nval_gf = rectf[2];
-					diff_gf = nval_gf - val_gf;
-
-					val_rf = nval_rf;
-					nval_rf = rectf[3];
-					diff_rf = nval_rf - val_rf;
-					rectf += skipx;
-				}
-			}
-			if (do_rect) {
-				newrect[0] = val_a + sample * diff_a;
-				newrect[1] = val_b + sample * diff_b;
-				newrect[2] = val_g + sample * diff_g;
-				newrect[3] = val_r + sample * diff_r;
-				newrect += skipx;
-			}
-			if (do_float) {
-				newrectf[0] = val_af + sample * diff_af;
-				newrectf[1] = val_bf + sample * diff_bf;
-				newrectf[2] = val_gf + sample * diff_gf;
-				newrectf[3] = val_rf + sample * diff_rf;
-				newrectf += skipx;
-			}
-			sample += add;
-		}
-	}
+	MEM_freeN(data.spans);
 
-	if (do_rect) {
+	if (_newrect) {
 		imb_freerectImBuf(ibuf);
 		ibuf->mall |= IB_rect;
 		ibuf->rect = (unsigned int *) _newrect;
 	}
-	if (do_float) {
+	if (_newrectf) {
 		imb_freerectfloatImBuf(ibuf);
 		ibuf->mall |= IB_rectfloat;
 		ibuf->rect_float = (float *) _newrectf;
 	}
-	
+
 	ibuf->y = newy;
 	return(ibuf);
 }
@@ -1575,6 +1560,351 @@ struct ImBuf *IMB_scaleImBuf(struct ImBuf *ibuf, unsigned int newx, unsigned int
 	return(ibuf);
 }
 
+/* ------------------------------------------------------------------------- */
+/* Filtered scaling, see IMB_scaleImBuf_filter
+ *
+ * Separable resampling: a horizontal pass into a float buffer of newx * y pixels, then a vertical
+ * pass into the new buffers. Every output pixel is a normalized weighted sum of the source pixels
+ * within the support of the filter kernel, which is widened by the scale factor when downscaling,
+ * so all source pixels contribute. Pixels outside of the image are the ones at its border. */
+
+typedef float (*ScaleFilterKernelFn)(float x);
+
+static float scale_filter_bilinear(float x)
+{
+	x = fabsf(x);
+	return (x < 1.0f) ? 1.0f - x : 0.0f;
+}
+
+/* Catmull-Rom spline, goes through the source pixels */
+static float scale_filter_bicubic(float x)
+{
+	x = fabsf(x);
+	if (x < 1.0f) {
+		return (1.5f * x - 2.5f) * x * x + 1.0f;
+	}
+	else if (x < 2.0f) {
+		return ((-0.5f * x + 2.5f) * x - 4.0f) * x + 2.0f;
+	}
+	return 0.0f;
+}
+
+static float scale_filter_sinc(float x)
+{
+	if (x == 0.0f) {
+		return 1.0f;
+	}
+	x *= (float)M_PI;
+	return sinf(x) / x;
+}
+
+/* Lanczos with three lobes */
+static float scale_filter_lanczos(float x)
+{
+	x = fabsf(x);
+	return (x < 3.0f) ? scale_filter_sinc(x) * scale_filter_sinc(x / 3.0f) : 0.0f;
+}
+
+/* Source pixels and their weights for every pixel of one dimension of the output. */
+typedef struct ScaleFilterWeights {
+	int *first;       /* first source pixel */
+	int *tot;         /* number of source pixels */
+	float *weights;   /* weights of the source pixels, 'stride' for every output pixel */
+	int stride;
+} ScaleFilterWeights;
+
+static void scale_filter_weights_init(ScaleFilterWeights *fw, int size, int newsize,
+                                      ScaleFilterKernelFn kernel, float radius)
+{
+	const float scale = (float)size / (float)newsize;
+	const float kernel_scale = max_ff(scale, 1.0f);
+	const float support = radius * kernel_scale;
+	int i;
+
+	/* pixels from floor(center - support) to ceil(center + support) */
+	fw->stride = min_ii((int)ceilf(2.0f * support) + 2, size);
+	fw->first = MEM_mallocN(sizeof(int) * newsize, "scale filter first");
+	fw->tot = MEM_mallocN(sizeof(int) * newsize, "scale filter tot");
+	fw->weights = MEM_callocN(sizeof(float) * fw->stride * newsize, "scale filter weights");
+
+	for (i = 0; i < newsize; i++) {
+		const float center = ((float)i + 0.5f) * scale;
+		const int start = (int)floorf(center - support);
+		const int end = (int)ceilf(center + support);
+		const int first = max_ii(start, 0);
+		const int last = min_ii(end, size - 1);
+		float *weights = fw->weights + (size_t)i * fw->stride;
+		float sum = 0.0f;
+		int j, k;
+
+		/* pixels outside of the image add to the border pixels */
+		for (j = start; j <= end; j++) {
+			const float w = kernel(((float)j + 0.5f - center) / kernel_scale);
+			if (w != 0.0f) {
+				weights[CLAMPIS(j, first, last) - first] += w;
+				sum += w;
+			}
+		}
+
+		fw->first[i] = first;
+		fw->tot[i] = last - first + 1;
+		BLI_assert(fw->tot[i] <= fw->stride);
+
+		if (sum != 0.0f) {
+			for (k = 0; k < fw->tot[i]; k++) {
+				weights[k] /= sum;
+			}
+		}
+	}
+}
+
+static void scale_filter_weights_free(ScaleFilterWeights *fw)
+{
+	MEM_freeN(fw->first);
+	MEM_freeN(fw->tot);
+	MEM_freeN(fw->weights);
+}
+
+typedef struct ScaleFilterTaskData {
+	const ScaleFilterWeights *fw;
+	int x, newx, channels;
+	const uchar *rect;
+	const float *rectf;
+	uchar *newrect;
+	float *newrectf;
+} ScaleFilterTaskData;
+
+/* horizontal pass, from a byte or float row to a float row */
+static void scale_filter_x_task_cb(void *userdata, const int y)
+{
+	const ScaleFilterTaskData *data = userdata;
+	const ScaleFilterWeights *fw = data->fw;
+	const int channels = data->channels;
+	float *out = data->newrectf + (size_t)y * data->newx * channels;
+	int i, k, c;
+
+	if (data->rect) {
+		const uchar *row = data->rect + (size_t)y * data->x * 4;
+
+		for (i = 0; i < data->newx; i++, out += 4) {
+			const uchar *in = row + (size_t)fw->first[i] * 4;
+			const float *weights = fw->weights + (size_t)i * fw->stride;
+#ifdef __SSE2__
+			const __m128i zero = _mm_setzero_si128();
+			__m128 sum = _mm_setzero_ps();
+
+			for (k = 0; k < fw->tot[i]; k++, in += 4) {
+				int pixel;
+				__m128i pixel_i;
+
+				memcpy(&pixel, in, sizeof(pixel));
+				pixel_i = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(pixel), zero), zero);
+				sum = _mm_add_ps(sum, _mm_mul_ps(_mm_cvtepi32_ps(pixel_i), _mm_set1_ps(weights[k])));
+			}
+			_mm_storeu_ps(out, sum);
+#else
+			out[0] = out[1] = out[2] = out[3] = 0.0f;
+			for (k = 0; k < fw->tot[i]; k++, in += 4) {
+				out[0] += weights[k] * in[0];
+				out[1] += weights[k] * in[1];
+				out[2] += weights[k] * in[2];
+				out[3] += weights[k] * in[3];
+			}
+#endif
+		}
+	}
+	else {
+		const float *row = data->rectf + (size_t)y * data->x * channels;
+
+		for (i = 0; i < data->newx; i++, out += channels) {
+			const float *in = row + (size_t)fw->first[i] * channels;
+			const float *weights = fw->weights + (size_t)i * fw->stride;
+
+#ifdef __SSE2__
+			if (channels == 4) {
+				__m128 sum = _mm_setzero_ps();
+
+				for (k = 0; k < fw->tot[i]; k++, in += 4) {
+					sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(in), _mm_set1_ps(weights[k])));
+				}
+				_mm_storeu_ps(out, sum);
+				continue;
+			}
+#endif
+			for (c = 0; c < channels; c++) {
+				out[c] = 0.0f;
+			}
+			for (k = 0; k < fw->tot[i]; k++, in += channels) {
+				for (c = 0; c < channels; c++) {
+					out[c] += weights[k] * in[c];
+				}
+			}
+		}
+	}
+}
+
+/* r_sum = w * row, or r_sum += w * row */
+BLI_INLINE void scale_filter_madd_row(float *r_sum, const float *row, const float w, const int len, const bool init)
+{
+	int i = 0;
+
+#if defined(__AVX__)
+	const __m256 w8 = _mm256_set1_ps(w);
+	for (; i + 8 <= len; i += 8) {
+		__m256 value = _mm256_mul_ps(_mm256_loadu_ps(row + i), w8);
+		if (!init) {
+			value = _mm256_add_ps(value, _mm256_loadu_ps(r_sum + i));
+		}
+		_mm256_storeu_ps(r_sum + i, value);
+	}
+#elif defined(__SSE2__)
+	const __m128 w4 = _mm_set1_ps(w);
+	for (; i + 4 <= len; i += 4) {
+		__m128 value = _mm_mul_ps(_mm_loadu_ps(row + i), w4);
+		if (!init) {
+			value = _mm_add_ps(value, _mm_loadu_ps(r_sum + i));
+		}
+		_mm_storeu_ps(r_sum + i, value);
+	}
+#endif
+	for (; i < len; i++) {
+		r_sum[i] = init ? w * row[i] : r_sum[i] + w * row[i];
+	}
+}
+
+/* floats of a byte row accumulated at once by the vertical pass */
+#define SCALE_FILTER_SPAN 256
+
+/* vertical pass, from float rows to a byte or float row */
+static void scale_filter_y_task_cb(void *userdata, const int y)
+{
+	const ScaleFilterTaskData *data = userdata;
+	const ScaleFilterWeights *fw = data->fw;
+	const int len = data->newx * data->channels;
+	const float *in = data->rectf + (size_t)fw->first[y] * len;
+	const float *weights = fw->weights + (size_t)y * fw->stride;
+	int k;
+
+	if (data->newrect) {
+		uchar *out = data->newrect + (size_t)y * len;
+		float sum[SCALE_FILTER_SPAN];
+		int start, i;
+
+		for (start = 0; start < len; start += SCALE_FILTER_SPAN) {
+			const int span = min_ii(SCALE_FILTER_SPAN, len - start);
+
+			for (k = 0; k < fw->tot[y]; k++) {
+				scale_filter_madd_row(sum, in + (size_t)k * len + start, weights[k], span, k == 0);
+			}
+			for (i = 0; i < span; i++) {
+				out[start + i] = (sum[i] <= 0.0f) ? 0 : (sum[i] >= 255.0f) ? 255 : (uchar)(sum[i] + 0.5f);
+			}
+		}
+	}
+	else {
+		float *out = data->newrectf + (size_t)y * len;
+
+		for (k = 0; k < fw->tot[y]; k++) {
+			scale_filter_madd_row(out, in + (size_t)k * len, weights[k], len, k == 0);
+		}
+	}
+}
+
+static void scale_filter_buffer(ImBuf *ibuf, const uchar *rect, const float *rectf, int channels,
+                                uchar *newrect, float *newrectf, int newx, int newy,
+                                ScaleFilterKernelFn kernel, float radius)
+{
+	ScaleFilterWeights fw;
+	ScaleFilterTaskData data = {NULL};
+	float *rowsf = MEM_mallocN(sizeof(float) * (size_t)newx * ibuf->y * channels, "scale filter rows");
+
+	data.x = ibuf->x;
+	data.newx = newx;
+	data.channels = channels;
+
+	scale_filter_weights_init(&fw, ibuf->x, newx, kernel, radius);
+	data.fw = &fw;
+	data.rect = rect;
+	data.rectf = rectf;
+	data.newrectf = rowsf;
+	BLI_task_parallel_range(0, ibuf->y, &data, scale_filter_x_task_cb,
+	                        ((size_t)newx * ibuf->y > SCALE_THREADED_LIMIT));
+	scale_filter_weights_free(&fw);
+
+	scale_filter_weights_init(&fw, ibuf->y, newy, kernel, radius);
+	data.fw = &fw;
+	data.rect = NULL;
+	data.rectf = rowsf;
+	data.newrect = newrect;
+	data.newrectf = newrectf;
+	BLI_task_parallel_range(0, newy, &data, scale_filter_y_task_cb,
+	                        ((size_t)newx * newy > SCALE_THREADED_LIMIT));
+	scale_filter_weights_free(&fw);
+
+	MEM_freeN(rowsf);
+}
+
+/* Scale with a filter kernel, IMB_SCALE_FILTER_BOX is the same as IMB_scaleImBuf. The filters with
+ * negative lobes (bicubic, Lanczos) can overshoot, byte results are clamped, float results not. */
+struct ImBuf *IMB_scaleImBuf_filter(struct ImBuf *ibuf, unsigned int newx, unsigned int newy, IMB_ScaleFilter filter)
+{
+	ScaleFilterKernelFn kernel;
+	float radius;
+
+	if (filter == IMB_SCALE_FILTER_BOX) {
+		return IMB_scaleImBuf(ibuf, newx, newy);
+	}
+
+	if (ibuf == NULL) return (NULL);
+	if (ibuf->rect == NULL && ibuf->rect_float == NULL) return (ibuf);
+	if (newx == 0 || newy == 0) return (ibuf);
+
+	if (newx == ibuf->x && newy == ibuf->y) { return ibuf; }
+
+	switch (filter) {
+		case IMB_SCALE_FILTER_BICUBIC:
+			kernel = scale_filter_bicubic;
+			radius = 2.0f;
+			break;
+		case IMB_SCALE_FILTER_LANCZOS:
+			kernel = scale_filter_lanczos;
+			radius = 3.0f;
+			break;
+		case IMB_SCALE_FILTER_BILINEAR:
+		default:
+			kernel = scale_filter_bilinear;
+			radius = 1.0f;
+			break;
+	}
+
+	/* scale the Z-buffer first, ibuf->x and ibuf->y change below */
+	scalefast_Z_ImBuf(ibuf, newx, newy);
+
+	if (ibuf->rect) {
+		uchar *newrect = MEM_mallocN((size_t)newx * newy * 4, "scale filter rect");
+
+		scale_filter_buffer(ibuf, (uchar *)ibuf->rect, NULL, 4, newrect, NULL, newx, newy, kernel, radius);
+
+		imb_freerectImBuf(ibuf);
+		ibuf->mall |= IB_rect;
+		ibuf->rect = (unsigned int *)newrect;
+	}
+	if (ibuf->rect_float) {
+		float *newrectf = MEM_mallocN(sizeof(float) * (size_t)newx * newy * ibuf->channels, "scale filter rectf");
+
+		scale_filter_buffer(ibuf, NULL, ibuf->rect_float, ibuf->channels, NULL, newrectf, newx, newy, kernel, radius);
+
+		imb_freerectfloatImBuf(ibuf);
+		ibuf->mall |= IB_rectfloat;
+		ibuf->rect_float = newrectf;
+	}
+
+	ibuf->x = newx;
+	ibuf->y = newy;
+
+	return ibuf;
+}
+
 struct imbufRGBA {
 	float r, g, b, a;
 };
@@ -321,6 +321,7 @@ static ImBuf *thumb_create_ex(
 	char cheight[40] = "0";
 	short tsize = 128;
 	short ex, ey;
+	size_t image_width = 0, image_height = 0;  /* of the full image, thumbnails may be read at a lower resolution */
 	float scaledx, scaledy;
 	BLI_stat_t info;
 
@@ -364,7 +365,8 @@ static ImBuf *thumb_create_ex(
 				if (img == NULL) {
 					switch (source) {
 						case THB_SOURCE_IMAGE:
-							img = IMB_loadiffname(file_path, IB_rect | IB_metadata, NULL);
+							img = IMB_thumb_load_image(file_path, IB_rect | IB_metadata, tsize, NULL,
+							                           &image_width, &image_height);
 							break;
 						case THB_SOURCE_BLEND:
 							img = IMB_thumb_load_blend(file_path, blen_group, blen_id);
@@ -381,8 +383,12 @@ static ImBuf *thumb_create_ex(
 					if (BLI_stat(file_path, &info) != -1) {
 						BLI_snprintf(mtime, sizeof(mtime), "%ld", (long int)info.st_mtime);
 					}
-					BLI_snprintf(cwidth, sizeof(cwidth), "%d", img->x);
-					BLI_snprintf(cheight, sizeof(cheight), "%d", img->y);
+					if (source != THB_SOURCE_IMAGE) {
+						image_width = img->x;
+						image_height = img->y;
+					}
+					BLI_snprintf(cwidth, sizeof(cwidth), "%d", (int)image_width);
+					BLI_snprintf(cheight, sizeof(cheight), "%d", (int)image_height);
 				}
 			}
 			else if (THB_SOURCE_MOVIE == source) {
@@ -425,7 +431,8 @@ static ImBuf *thumb_create_ex(
 				imb_freerectfloatImBuf(img);
 			}
 
-			IMB_scaleImBuf(img, ex, ey);
+			/* bicubic keeps thumbnails sharper than averaging pixels */
+			IMB_scaleImBuf_filter(img, ex, ey, IMB_SCALE_FILTER_BICUBIC);
 		}
 		BLI_snprintf(desc, sizeof(desc), "Thumbnail for %s", uri);
 		IMB_metadata_change_field(img, "Description", desc);
@@ -331,6 +331,10 @@ enum {
 	LIB_TAG_ID_RECALC_DATA  = 1 << 13,
 	LIB_TAG_ANIM_NO_RECALC  = 1 << 14,
 	LIB_TAG_ID_RECALC_ALL   = (LIB_TAG_ID_RECALC | LIB_TAG_ID_RECALC_DATA),
+
+	/* RESET_AFTER_USE tag datablocks kept as-is from the current state when reading an undo step
+	 * (see BLO_memfile_tag_identical), their runtime data may still need to be cleared. */
+	LIB_TAG_UNDO_OLD_ID_REUSED = 1 << 15,
 };
 
 /* To filter ID types (filter_id) */
@@ -77,6 +77,7 @@ enum eSDNA_StructCompare {
 struct SDNA *DNA_sdna_from_data(const void *data, const int datalen, bool do_endian_swap);
 void DNA_sdna_free(struct SDNA *sdna);
 
+int DNA_struct_find_nr_ex(const struct SDNA *sdna, const char *str, int *index_last);
 int DNA_struct_find_nr(struct SDNA *sdna, const char *str);
 void DNA_struct_switch_endian(struct SDNA *oldsdna, int oldSDNAnr, char *data);
 char *DNA_struct_get_compareflags(struct SDNA *sdna, struct SDNA *newsdna);
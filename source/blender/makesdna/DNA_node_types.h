@@ -410,6 +410,8 @@ typedef struct bNodeTree {
 #define NTREE_COM_GROUPNODE_BUFFER	8	/* use groupnode buffers */
 #define NTREE_VIEWER_BORDER			16	/* use a border for viewer nodes */
 #define NTREE_IS_LOCALIZED			32	/* tree is localized copy, free when deleting node groups */
+#define NTREE_COM_FULL_FRAME		64	/* evaluate compositor nodes on full frame buffers instead of tiles */
+#define NTREE_COM_HALF_FLOAT		128	/* store intermediate compositor color buffers as half floats */
 
 /* XXX not nice, but needed as a temporary flags
  * for group updates after library linking.
@@ -566,7 +566,13 @@ typedef struct UserDef {
 	struct WalkNavigation walk_navigation;
 
 	short opensubdiv_compute_type;
-	char pad5[6];
+	short pad5;
+	float display_lut_tolerance;	/* max error of baked display transform LUTs in 8 bit levels, 0 to disable */
+
+	int sequencer_disk_cache_limit;	/* in megabytes, 0 disables the sequencer disk cache */
+	short sequencer_disk_cache_compression;	/* eUserpref_SeqDiskCacheCompression */
+	short pad6;
+	char sequencer_disk_cache_dir[768];	/* FILE_MAXDIR length */
 } UserDef;
 
 extern UserDef U; /* from blenkernel blender.c */
@@ -613,6 +619,7 @@ typedef enum eUserPref_Flag {
 	USER_NONEGFRAMES		= (1 << 24),
 	USER_TXT_TABSTOSPACES_DISABLE	= (1 << 25),
 	USER_TOOLTIPS_PYTHON    = (1 << 26),
+	USER_FILECOMPRESS_FAST	= (1 << 27),
 } eUserPref_Flag;
 
 /* flag */
@@ -902,6 +909,13 @@ typedef enum eOpensubdiv_Computee_Type {
 	USER_OPENSUBDIV_COMPUTE_GLSL_COMPUTE = 6,
 } eOpensubdiv_Computee_Type;
 
+/* UserDef.sequencer_disk_cache_compression */
+typedef enum eUserpref_SeqDiskCacheCompression {
+	USER_SEQ_DISK_CACHE_COMPRESS_NONE = 0,
+	USER_SEQ_DISK_CACHE_COMPRESS_FAST = 1,  /* LZO */
+	USER_SEQ_DISK_CACHE_COMPRESS_HIGH = 2,  /* LZMA */
+} eUserpref_SeqDiskCacheCompression;
+
 #ifdef __cplusplus
 }
 #endif
@@ -39,6 +39,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
 
 #include "MEM_guardedalloc.h" // for MEM_freeN MEM_mallocN MEM_callocN
 
@@ -298,15 +299,18 @@ static short *findstruct_name(SDNA *sdna, const char *str)
 
 /**
  * Returns the index of the struct info for the struct with the specified name.
+ *
+ * \param index_last: Index of the last struct found, checked first and updated on success.
+ * Callers which may run in multiple threads pass their own instead of \a sdna->lastfind.
  */
-int DNA_struct_find_nr(SDNA *sdna, const char *str)
+int DNA_struct_find_nr_ex(const SDNA *sdna, const char *str, int *index_last)
 {
 	const short *sp = NULL;
 
-	if (sdna->lastfind < sdna->nr_structs) {
-		sp = sdna->structs[sdna->lastfind];
+	if (*index_last < sdna->nr_structs) {
+		sp = sdna->structs[*index_last];
 		if (strcmp(sdna->types[sp[0]], str) == 0) {
-			return sdna->lastfind;
+			return *index_last;
 		}
 	}
 
@@ -319,7 +323,7 @@ int DNA_struct_find_nr(SDNA *sdna, const char *str)
 
 		if (index_p) {
 			a = GET_INT_FROM_POINTER(*index_p);
-			sdna->lastfind = a;
+			*index_last = a;
 		}
 		else {
 			a = -1;
@@ -335,7 +339,7 @@ int DNA_struct_find_nr(SDNA *sdna, const char *str)
 			sp = sdna->structs[a];
 
 			if (strcmp(sdna->types[sp[0]], str) == 0) {
-				sdna->lastfind = a;
+				*index_last = a;
 				return a;
 			}
 		}
@@ -344,6 +348,11 @@ int DNA_struct_find_nr(SDNA *sdna, const char *str)
 #endif
 }
 
+int DNA_struct_find_nr(SDNA *sdna, const char *str)
+{
+	return DNA_struct_find_nr_ex(sdna, str, &sdna->lastfind);
+}
+
 /* ************************* END DIV ********************** */
 
 /* ************************* READ DNA ********************** */
@@ -1038,6 +1047,8 @@ static void reconstruct_struct(
 	 * If element is a struct, call recursive.
 	 */
 	int a, elemcount, elen, eleno, mul, mulo, firststructtypenr;
+	/* local lookup caches, this may run in multiple threads (see parallel struct reading in readfile) */
+	int index_last_old = INT_MAX, index_last_new = INT_MAX;
 	const short *spo, *spc, *sppo;
 	const char *type;
 	char *cpo, *cpc;
@@ -1077,8 +1088,8 @@ static void reconstruct_struct(
 			cpo = find_elem(oldsdna, type, name, spo, data, &sppo);
 			
 			if (cpo) {
-				oldSDNAnr = DNA_struct_find_nr(oldsdna, type);
-				curSDNAnr = DNA_struct_find_nr(newsdna, type);
+				oldSDNAnr = DNA_struct_find_nr_ex(oldsdna, type, &index_last_old);
+				curSDNAnr = DNA_struct_find_nr_ex(newsdna, type, &index_last_new);
 				
 				/* array! */
 				mul = DNA_elem_array_size(name);
@@ -1125,6 +1136,7 @@ void DNA_struct_switch_endian(SDNA *oldsdna, int oldSDNAnr, char *data)
 	 * If element is a struct, call recursive.
 	 */
 	int a, mul, elemcount, elen, elena, firststructtypenr;
+	int index_last_old = INT_MAX;
 	const short *spo, *spc;
 	char *cpo, *cur, cval;
 	const char *type, *name;
@@ -1152,7 +1164,7 @@ void DNA_struct_switch_endian(SDNA *oldsdna, int oldSDNAnr, char *data)
 			/* where does the old data start (is there one?) */
 			cpo = find_elem(oldsdna, type, name, spo, data, NULL);
 			if (cpo) {
-				oldSDNAnr = DNA_struct_find_nr(oldsdna, type);
+				oldSDNAnr = DNA_struct_find_nr_ex(oldsdna, type, &index_last_old);
 				
 				mul = DNA_elem_array_size(name);
 				elena = elen / mul;
@@ -1250,6 +1262,7 @@ void DNA_struct_switch_endian(SDNA *oldsdna, int oldSDNAnr, char *data)
 void *DNA_struct_reconstruct(SDNA *newsdna, SDNA *oldsdna, char *compflags, int oldSDNAnr, int blocks, void *data)
 {
 	int a, curSDNAnr, curlen = 0, oldlen;
+	int index_last = INT_MAX;
 	const short *spo, *spc;
 	char *cur, *cpc, *cpo;
 	const char *type;
@@ -1258,7 +1271,7 @@ void *DNA_struct_reconstruct(SDNA *newsdna, SDNA *oldsdna, char *compflags, int
 	spo = oldsdna->structs[oldSDNAnr];
 	type = oldsdna->types[spo[0]];
 	oldlen = oldsdna->typelens[spo[0]];
-	curSDNAnr = DNA_struct_find_nr(newsdna, type);
+	curSDNAnr = DNA_struct_find_nr_ex(newsdna, type, &index_last);
 
 	/* init data and alloc */
 	if (curSDNAnr != -1) {
@@ -79,6 +79,23 @@ static void rna_Depsgraph_debug_stats(Depsgraph *graph, ReportList *reports)
 	            ops, rels, outer);
 }
 
+static void rna_Depsgraph_debug_trace_begin(Depsgraph *UNUSED(graph))
+{
+	DEG_debug_trace_begin(NULL);
+}
+
+static void rna_Depsgraph_debug_trace_end(Depsgraph *UNUSED(graph))
+{
+	DEG_debug_trace_end();
+}
+
+static void rna_Depsgraph_debug_trace_write(Depsgraph *UNUSED(graph), ReportList *reports, const char *filename)
+{
+	if (!DEG_debug_trace_write(filename)) {
+		BKE_reportf(reports, RPT_ERROR, "Cannot write trace to '%s'", filename);
+	}
+}
+
 #else
 
 static void rna_def_depsgraph(BlenderRNA *brna)
@@ -102,6 +119,19 @@ static void rna_def_depsgraph(BlenderRNA *brna)
 	func = RNA_def_function(srna, "debug_stats", "rna_Depsgraph_debug_stats");
 	RNA_def_function_ui_description(func, "Report the number of elements in the Dependency Graph");
 	RNA_def_function_flag(func, FUNC_USE_REPORTS);
+
+	func = RNA_def_function(srna, "debug_trace_begin", "rna_Depsgraph_debug_trace_begin");
+	RNA_def_function_ui_description(func, "Start recording evaluated operations of all dependency graphs");
+
+	func = RNA_def_function(srna, "debug_trace_end", "rna_Depsgraph_debug_trace_end");
+	RNA_def_function_ui_description(func, "Stop recording evaluated operations");
+
+	func = RNA_def_function(srna, "debug_trace_write", "rna_Depsgraph_debug_trace_write");
+	RNA_def_function_ui_description(func, "Write recorded operations in Chrome Trace Event format");
+	RNA_def_function_flag(func, FUNC_USE_REPORTS);
+	parm = RNA_def_string_file_path(func, "filename", NULL, FILE_MAX, "File Name",
+	                                "File in which to store the trace (JSON)");
+	RNA_def_property_flag(parm, PROP_REQUIRED);
 }
 
 void RNA_def_depsgraph(BlenderRNA *brna)
@@ -8176,6 +8176,16 @@ static void rna_def_composite_nodetree(BlenderRNA *brna)
 	RNA_def_property_boolean_sdna(prop, NULL, "flag", NTREE_COM_GROUPNODE_BUFFER);
 	RNA_def_property_ui_text(prop, "Buffer Groups", "Enable buffering of group nodes");
 
+	prop = RNA_def_property(srna, "use_full_frame", PROP_BOOLEAN, PROP_NONE);
+	RNA_def_property_boolean_sdna(prop, NULL, "flag", NTREE_COM_FULL_FRAME);
+	RNA_def_property_ui_text(prop, "Full Frame", "Calculate nodes one after the other on full frame buffers "
+	                                             "instead of tiles, freeing buffers once they are no longer needed");
+
+	prop = RNA_def_property(srna, "use_half_float_buffers", PROP_BOOLEAN, PROP_NONE);
+	RNA_def_property_boolean_sdna(prop, NULL, "flag", NTREE_COM_HALF_FLOAT);
+	RNA_def_property_ui_text(prop, "Half Float Buffers", "Store intermediate color buffers in half precision, "
+	                                                     "halving their memory usage (values and vectors keep full precision)");
+
 	prop = RNA_def_property(srna, "use_two_pass", PROP_BOOLEAN, PROP_NONE);
 	RNA_def_property_boolean_sdna(prop, NULL, "flag", NTREE_TWO_PASS);
 	RNA_def_property_ui_text(prop, "Two Pass", "Use two pass execution during editing: first calculate fast nodes, "
@@ -4008,6 +4008,13 @@ static void rna_def_userdef_system(BlenderRNA *brna)
 		{0, NULL, 0, NULL, NULL}
 	};
 
+	static EnumPropertyItem seq_disk_cache_compression_items[] = {
+		{USER_SEQ_DISK_CACHE_COMPRESS_NONE, "NONE", 0, "None", "Write frames uncompressed"},
+		{USER_SEQ_DISK_CACHE_COMPRESS_FAST, "FAST", 0, "Fast", "Fast lossless compression (LZO)"},
+		{USER_SEQ_DISK_CACHE_COMPRESS_HIGH, "HIGH", 0, "High", "Slower lossless compression with smaller files (LZMA)"},
+		{0, NULL, 0, NULL, NULL}
+	};
+
 	srna = RNA_def_struct(brna, "UserPreferencesSystem", NULL);
 	RNA_def_struct_sdna(srna, "UserDef");
 	RNA_def_struct_nested(brna, srna, "UserPreferences");
@@ -4145,6 +4152,19 @@ static void rna_def_userdef_system(BlenderRNA *brna)
 	RNA_def_property_ui_text(prop, "Memory Cache Limit", "Memory cache limit (in megabytes)");
 	RNA_def_property_update(prop, 0, "rna_Userdef_memcache_update");
 
+	prop = RNA_def_property(srna, "sequencer_disk_cache_limit", PROP_INT, PROP_NONE);
+	RNA_def_property_int_sdna(prop, NULL, "sequencer_disk_cache_limit");
+	RNA_def_property_range(prop, 0, INT_MAX);
+	RNA_def_property_ui_range(prop, 0, 1024 * 256, 1024, -1);
+	RNA_def_property_ui_text(prop, "Sequencer Disk Cache Limit",
+	                         "Disk space used to keep sequencer frames freed from the memory cache, "
+	                         "which are loaded back instead of rendered again (in megabytes, 0 to disable)");
+
+	prop = RNA_def_property(srna, "sequencer_disk_cache_compression", PROP_ENUM, PROP_NONE);
+	RNA_def_property_enum_sdna(prop, NULL, "sequencer_disk_cache_compression");
+	RNA_def_property_enum_items(prop, seq_disk_cache_compression_items);
+	RNA_def_property_ui_text(prop, "Sequencer Disk Cache Compression", "Compression of frames in the sequencer disk cache");
+
 	prop = RNA_def_property(srna, "frame_server_port", PROP_INT, PROP_NONE);
 	RNA_def_property_int_sdna(prop, NULL, "frameserverport");
 	RNA_def_property_range(prop, 0, 32727);
@@ -4179,6 +4199,15 @@ static void rna_def_userdef_system(BlenderRNA *brna)
 	RNA_def_property_ui_text(prop, "Image Draw Method", "Method used for displaying images on the screen");
 	RNA_def_property_update(prop, 0, "rna_userdef_update");
 
+	prop = RNA_def_property(srna, "display_lut_tolerance", PROP_FLOAT, PROP_NONE);
+	RNA_def_property_float_sdna(prop, NULL, "display_lut_tolerance");
+	RNA_def_property_range(prop, 0.0f, 4.0f);
+	RNA_def_property_ui_range(prop, 0.0f, 2.0f, 10, 2);
+	RNA_def_property_ui_text(prop, "Display LUT Tolerance",
+	                         "Maximum error in 8 bit display levels of the lookup table baked from the display "
+	                         "transform to draw images faster (0 to always use the exact transform)");
+	RNA_def_property_update(prop, 0, "rna_userdef_update");
+
 	prop = RNA_def_property(srna, "anisotropic_filter", PROP_ENUM, PROP_NONE);
 	RNA_def_property_enum_sdna(prop, NULL, "anisotropic_filter");
 	RNA_def_property_enum_items(prop, anisotropic_items);
@@ -4582,6 +4611,12 @@ static void rna_def_userdef_filepaths(BlenderRNA *brna)
 	RNA_def_property_boolean_sdna(prop, NULL, "flag", USER_FILECOMPRESS);
 	RNA_def_property_ui_text(prop, "Compress File", "Enable file compression when saving .blend files");
 
+	prop = RNA_def_property(srna, "use_file_compression_fast", PROP_BOOLEAN, PROP_NONE);
+	RNA_def_property_boolean_sdna(prop, NULL, "flag", USER_FILECOMPRESS_FAST);
+	RNA_def_property_ui_text(prop, "Fast Compression",
+	                         "Use multi-threaded block compression for compressed .blend files "
+	                         "(faster saving and loading, larger files)");
+
 	prop = RNA_def_property(srna, "use_load_ui", PROP_BOOLEAN, PROP_NONE);
 	RNA_def_property_boolean_negative_sdna(prop, NULL, "flag", USER_FILENOUI);
 	RNA_def_property_ui_text(prop, "Load UI", "Load user interface setup when loading .blend files");
@@ -4626,6 +4661,11 @@ static void rna_def_userdef_filepaths(BlenderRNA *brna)
 	RNA_def_property_string_sdna(prop, NULL, "render_cachedir");
 	RNA_def_property_ui_text(prop, "Render Cache Path", "Where to cache raw render results");
 
+	prop = RNA_def_property(srna, "sequencer_disk_cache_directory", PROP_STRING, PROP_DIRPATH);
+	RNA_def_property_string_sdna(prop, NULL, "sequencer_disk_cache_dir");
+	RNA_def_property_ui_text(prop, "Sequencer Disk Cache Path",
+	                         "Where to cache sequencer frames freed from memory (temporary directory when empty)");
+
 	prop = RNA_def_property(srna, "image_editor", PROP_STRING, PROP_FILEPATH);
 	RNA_def_property_string_sdna(prop, NULL, "image_editor");
 	RNA_def_property_ui_text(prop, "Image Editor", "Path to an image editor");
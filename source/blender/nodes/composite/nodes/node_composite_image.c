@@ -43,6 +43,10 @@
 #  include "RE_pipeline.h"
 #endif
 
+#ifdef WITH_COMPOSITOR
+#  include "COM_compositor.h"
+#endif
+
 /* **************** IMAGE (and RenderResult, multilayer image) ******************** */
 
 static bNodeSocketTemplate cmp_node_rlayers_out[] = {
@@ -334,8 +338,13 @@ static void cmp_node_image_verify_outputs(bNodeTree *ntree, bNode *node)
 static void cmp_node_image_update(bNodeTree *ntree, bNode *node)
 {
 	/* avoid unnecessary updates, only changes to the image/image user data are of interest */
-	if (node->update & NODE_UPDATE_ID)
+	if (node->update & NODE_UPDATE_ID) {
 		cmp_node_image_verify_outputs(ntree, node);
+#ifdef WITH_COMPOSITOR
+		/* image was reloaded or painted, cached compositor results may be outdated */
+		COM_clearCaches();
+#endif
+	}
 }
 
 static void node_composit_init_image(bNodeTree *ntree, bNode *node)
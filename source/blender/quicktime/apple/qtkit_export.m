@@ -750,10 +750,11 @@ int append_qt(
 }
 
 
-void end_qt(void *context_v)
+int end_qt(void *context_v, ReportList *reports)
 {
 	NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
 	QuicktimeExport *qtexport = context_v;
+	int success = 1;
 
 	if (qtexport->movie) {
 		
@@ -816,8 +817,9 @@ void end_qt(void *context_v)
 			dict = [NSDictionary dictionaryWithObject:[NSNumber numberWithBool:YES]
 			        forKey:QTMovieFlatten];
 
-			if (dict) {
-				[qtexport->movie writeToFile:qtexport->filename withAttributes:dict];
+			if (dict == nil || ![qtexport->movie writeToFile:qtexport->filename withAttributes:dict]) {
+				BKE_report(reports, RPT_ERROR, "\nUnable to write the movie file");
+				success = 0;
 			}
 			
 			/* Delete temp files */
@@ -828,7 +830,10 @@ void end_qt(void *context_v)
 		}
 		else {
 			/* Flush update of the movie file */
-			[qtexport->movie updateMovieFile];
+			if (![qtexport->movie updateMovieFile]) {
+				BKE_report(reports, RPT_ERROR, "\nUnable to write the movie file");
+				success = 0;
+			}
 			
 			[qtexport->movie invalidate];
 		}
@@ -846,6 +851,8 @@ void end_qt(void *context_v)
 	
 	[QTMovie exitQTKitOnThread];
 	[pool drain];
+
+	return success;
 }
 
 
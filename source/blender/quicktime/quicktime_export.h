@@ -57,7 +57,7 @@ struct Scene;
 
 int start_qt(void *context_v, struct Scene *scene, struct RenderData *rd, int rectx, int recty, struct ReportList *reports, bool preview, const char *suffix);	//for movie handle (BKE writeavi.c now)
 int append_qt(void *context_v, struct RenderData *rd, int start_frame, int frame, int *pixels, int rectx, int recty, const char *suffix, struct ReportList *reports);
-void end_qt(void *context_v);
+int end_qt(void *context_v, struct ReportList *reports);
 void filepath_qt(char *string, struct RenderData *rd, bool preview, const char *suffix);
 void *context_create_qt(void);
 void context_free_qt(void *context_v);
@@ -179,6 +179,11 @@ typedef struct RenderResult {
 	char *error;
 
 	struct StampData *stamp_data;
+
+	/* multilayer image file, passes are read when first used, see RE_MultilayerReadPass */
+	char *exr_filepath;
+	char exr_colorspace[64];
+	bool exr_predivide;
 } RenderResult;
 
 
@@ -306,6 +311,8 @@ void RE_PreviewRender(struct Render *re, struct Main *bmain, struct Scene *scene
 bool RE_ReadRenderResult(struct Scene *scene, struct Scene *scenode);
 bool RE_WriteRenderResult(struct ReportList *reports, RenderResult *rr, const char *filename, struct ImageFormatData *imf, const bool multiview, const char *view);
 struct RenderResult *RE_MultilayerConvert(void *exrhandle, const char *colorspace, bool predivide, int rectx, int recty);
+struct RenderResult *RE_MultilayerOpen(const char *filepath, const char *colorspace, bool predivide);
+bool RE_MultilayerReadPass(struct RenderResult *rr, struct RenderPass *rpass);
 
 extern const float default_envmap_layout[];
 bool RE_WriteEnvmapResult(struct ReportList *reports, struct Scene *scene, struct EnvMap *env, const char *relpath, const char imtype, float layout[12]);
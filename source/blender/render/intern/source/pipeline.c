@@ -3500,16 +3500,20 @@ static void get_videos_dimensions(
 	BKE_scene_multiview_videos_dimensions_get(rd, width, height, r_width, r_height);
 }
 
-static void re_movie_free_all(Render *re, bMovieHandle *mh, int totvideos)
+/* returns false when a movie could not be finished, errors are in the render reports */
+static bool re_movie_free_all(Render *re, bMovieHandle *mh, int totvideos)
 {
+	bool ok = true;
 	int i;
 
 	for (i = 0; i < totvideos; i++) {
-		mh->end_movie(re->movie_ctx_arr[i]);
+		ok &= (mh->end_movie(re->movie_ctx_arr[i], re->reports) != 0);
 		mh->context_free(re->movie_ctx_arr[i]);
 	}
 
 	MEM_SAFE_FREE(re->movie_ctx_arr);
+
+	return ok;
 }
 
 /* saves images to disk */
@@ -3762,7 +3766,9 @@ void RE_BlenderAnim(Render *re, Main *bmain, Scene *scene, Object *camera_overri
 	
 	/* end movie */
 	if (is_movie) {
-		re_movie_free_all(re, mh, totvideos);
+		if (!re_movie_free_all(re, mh, totvideos)) {
+			G.is_break = true;
+		}
 	}
 	
 	if (totskipped && totrendered == 0)
@@ -118,6 +118,8 @@ void render_result_free(RenderResult *res)
 		MEM_freeN(res->error);
 	if (res->stamp_data)
 		MEM_freeN(res->stamp_data);
+	if (res->exr_filepath)
+		MEM_freeN(res->exr_filepath);
 
 	MEM_freeN(res);
 }
@@ -943,7 +945,8 @@ RenderResult *render_result_new_from_exr(void *exrhandle, const char *colorspace
 			rpass->rectx = rectx;
 			rpass->recty = recty;
 
-			if (rpass->channels >= 3) {
+			/* passes not read yet are converted by RE_MultilayerReadPass */
+			if (rpass->rect && rpass->channels >= 3) {
 				IMB_colormanagement_transform(rpass->rect, rpass->rectx, rpass->recty, rpass->channels,
 				                              colorspace, to_colorspace, predivide);
 			}
@@ -953,6 +956,84 @@ RenderResult *render_result_new_from_exr(void *exrhandle, const char *colorspace
 	return rr;
 }
 
+/* Open a multilayer file without reading its passes, they are read by RE_MultilayerReadPass when first used.
+ * Returns NULL when the file is not a multilayer OpenEXR file. */
+RenderResult *RE_MultilayerOpen(const char *filepath, const char *colorspace, bool predivide)
+{
+	RenderResult *rr;
+	void *exrhandle = IMB_exr_get_handle();
+	int rectx, recty;
+
+	if (IMB_exr_begin_read_multilayer(exrhandle, filepath, &rectx, &recty) == 0) {
+		IMB_exr_close(exrhandle);
+		return NULL;
+	}
+
+	rr = render_result_new_from_exr(exrhandle, colorspace, predivide, rectx, recty);
+	IMB_exr_close(exrhandle);
+
+	rr->exr_filepath = BLI_strdup(filepath);
+	BLI_strncpy(rr->exr_colorspace, colorspace, sizeof(rr->exr_colorspace));
+	rr->exr_predivide = predivide;
+
+	return rr;
+}
+
+/* passes of an image can be requested by the compositor and the interface at the same time */
+static ThreadMutex exr_pass_read_lock = BLI_MUTEX_INITIALIZER;
+
+/* Ensure the pass buffer is read from the file of a render result opened with RE_MultilayerOpen,
+ * returns false when the pass has no buffer.
+ *
+ * The file is opened again for every pass, so it isn't kept open (and locked on Windows) and the
+ * headers are those of the current file, in case it was written again since it was opened. Passes
+ * which changed size or channels in the meantime are not read. */
+bool RE_MultilayerReadPass(RenderResult *rr, RenderPass *rpass)
+{
+	RenderLayer *rl;
+	bool ok;
+
+	if (rr->exr_filepath == NULL) {
+		return (rpass->rect != NULL);
+	}
+
+	BLI_mutex_lock(&exr_pass_read_lock);
+
+	if (rpass->rect == NULL) {
+		for (rl = rr->layers.first; rl; rl = rl->next) {
+			if (BLI_findindex(&rl->passes, rpass) != -1) {
+				break;
+			}
+		}
+
+		if (rl) {
+			void *exrhandle = IMB_exr_get_handle();
+			int rectx, recty;
+
+			if (IMB_exr_begin_read_multilayer(exrhandle, rr->exr_filepath, &rectx, &recty) &&
+			    rectx == rpass->rectx && recty == rpass->recty)
+			{
+				rpass->rect = IMB_exr_read_pass(exrhandle, rl->name, rpass->internal_name, rpass->view,
+				                                rpass->channels);
+			}
+			IMB_exr_close(exrhandle);
+
+			if (rpass->rect && rpass->channels >= 3) {
+				const char *to_colorspace = IMB_colormanagement_role_colorspace_name_get(COLOR_ROLE_SCENE_LINEAR);
+
+				IMB_colormanagement_transform(rpass->rect, rpass->rectx, rpass->recty, rpass->channels,
+				                              rr->exr_colorspace, to_colorspace, rr->exr_predivide);
+			}
+		}
+	}
+
+	ok = (rpass->rect != NULL);
+
+	BLI_mutex_unlock(&exr_pass_read_lock);
+
+	return ok;
+}
+
 void render_result_view_new(RenderResult *rr, const char *viewname)
 {
 	RenderView *rv = MEM_callocN(sizeof(RenderView), "new render view");
@@ -1084,6 +1165,15 @@ bool RE_WriteRenderResult(ReportList *reports, RenderResult *rr, const char *fil
 	width = rr->rectx;
 	height = rr->recty;
 
+	/* passes of multilayer images which were not used yet */
+	if (rr->exr_filepath) {
+		for (rl = rr->layers.first; rl; rl = rl->next) {
+			for (rpass = rl->passes.first; rpass; rpass = rpass->next) {
+				RE_MultilayerReadPass(rr, rpass);
+			}
+		}
+	}
+
 	if (imf && imf->imtype == R_IMF_IMTYPE_OPENEXR && multiview) {
 		/* single layer OpenEXR */
 		const char *RGBAZ[] = {"R", "G", "B", "A", "Z"};
@@ -84,6 +84,7 @@
 #include "BKE_scene.h"
 #include "BKE_screen.h"
 
+#include "BLO_blend_defs.h"
 #include "BLO_readfile.h"
 #include "BLO_writefile.h"
 
@@ -358,7 +359,7 @@ static int wm_read_exotic(const char *name)
 {
 	int len;
 	gzFile gzfile;
-	char header[7];
+	char header[BLEND_BLOCK_LZO_MAGIC_LEN];
 	int retval;
 
 	/* make sure we're not trying to read a directory.... */
@@ -375,7 +376,9 @@ static int wm_read_exotic(const char *name)
 		else {
 			len = gzread(gzfile, header, sizeof(header));
 			gzclose(gzfile);
-			if (len == sizeof(header) && STREQLEN(header, "BLENDER", 7)) {
+			if ((len >= 7 && STREQLEN(header, "BLENDER", 7)) ||
+			    (len == BLEND_BLOCK_LZO_MAGIC_LEN && STREQLEN(header, BLEND_BLOCK_LZO_MAGIC, BLEND_BLOCK_LZO_MAGIC_LEN)))
+			{
 				retval = BKE_READ_EXOTIC_OK_BLEND;
 			}
 			else {
@@ -1087,6 +1090,7 @@ int wm_file_write(bContext *C, const char *filepath, int fileflags, ReportList *
 		}
 
 		BKE_BIT_TEST_SET(G.fileflags, fileflags & G_FILE_COMPRESS, G_FILE_COMPRESS);
+		BKE_BIT_TEST_SET(G.fileflags, fileflags & G_FILE_COMPRESS_FAST, G_FILE_COMPRESS_FAST);
 		BKE_BIT_TEST_SET(G.fileflags, fileflags & G_FILE_AUTOPLAY, G_FILE_AUTOPLAY);
 
 		/* prevent background mode scripts from clobbering history */
@@ -56,6 +56,7 @@
 #include "BKE_image.h"
 
 #include "DEG_depsgraph.h"
+#include "DEG_depsgraph_debug.h"
 
 #ifdef WITH_FFMPEG
 #include "IMB_imbuf.h"
@@ -389,9 +390,12 @@ static int arg_handle_print_help(int UNUSED(argc), const char **UNUSED(argv), vo
 	BLI_argsPrintArgDoc(ba, "--debug-python");
 	BLI_argsPrintArgDoc(ba, "--debug-depsgraph");
 	BLI_argsPrintArgDoc(ba, "--debug-depsgraph-no-threads");
+	BLI_argsPrintArgDoc(ba, "--debug-depsgraph-trace");
 
 	BLI_argsPrintArgDoc(ba, "--debug-gpumem");
 	BLI_argsPrintArgDoc(ba, "--debug-wm");
+	BLI_argsPrintArgDoc(ba, "--debug-io");
+	BLI_argsPrintArgDoc(ba, "--debug-compositor");
 	BLI_argsPrintArgDoc(ba, "--debug-all");
 
 	printf("\n");
@@ -584,6 +588,10 @@ static const char arg_handle_debug_mode_generic_set_doc_depsgraph_no_threads[] =
 "\n\tSwitch dependency graph to a single threaded evaluation";
 static const char arg_handle_debug_mode_generic_set_doc_gpumem[] =
 "\n\tEnable GPU memory stats in status bar";
+static const char arg_handle_debug_mode_generic_set_doc_io[] =
+"\n\tEnable debug messages for I/O (timing of .blend file reading phases)";
+static const char arg_handle_debug_mode_generic_set_doc_compositor[] =
+"\n\tEnable time and memory statistics of compositor executions.";
 
 static int arg_handle_debug_mode_generic_set(int UNUSED(argc), const char **UNUSED(argv), void *data)
 {
@@ -647,6 +655,22 @@ static int arg_handle_debug_value_set(int argc, const char **argv, void *UNUSED(
 	}
 }
 
+static const char arg_handle_debug_depsgraph_trace_set_doc[] =
+"<filename>\n\tWrite timing of every evaluated dependency graph operation to <filename>\n"
+"\t(Chrome Trace Event format, written on exit)\n"
+;
+static int arg_handle_debug_depsgraph_trace_set(int argc, const char **argv, void *UNUSED(data))
+{
+	if (argc > 1) {
+		DEG_debug_trace_begin(argv[1]);
+		return 1;
+	}
+	else {
+		printf("\nError: you must specify a path after '--debug-depsgraph-trace'.\n");
+		return 0;
+	}
+}
+
 static const char arg_handle_debug_fpe_set_doc[] =
 "\n\tEnable floating point exceptions"
 ;
@@ -1616,8 +1640,14 @@ void main_args_setup(bContext *C, bArgs *ba, SYS_SystemHandle *syshandle)
 	            CB_EX(arg_handle_debug_mode_generic_set, depsgraph), (void *)G_DEBUG_DEPSGRAPH);
 	BLI_argsAdd(ba, 1, NULL, "--debug-depsgraph-no-threads",
 	            CB_EX(arg_handle_debug_mode_generic_set, depsgraph_no_threads), (void *)G_DEBUG_DEPSGRAPH_NO_THREADS);
+	BLI_argsAdd(ba, 1, NULL, "--debug-depsgraph-trace",
+	            CB(arg_handle_debug_depsgraph_trace_set), NULL);
 	BLI_argsAdd(ba, 1, NULL, "--debug-gpumem",
 	            CB_EX(arg_handle_debug_mode_generic_set, gpumem), (void *)G_DEBUG_GPU_MEM);
+	BLI_argsAdd(ba, 1, NULL, "--debug-io",
+	            CB_EX(arg_handle_debug_mode_generic_set, io), (void *)G_DEBUG_IO);
+	BLI_argsAdd(ba, 1, NULL, "--debug-compositor",
+	            CB_EX(arg_handle_debug_mode_generic_set, compositor), (void *)G_DEBUG_COMPOSITOR);
 
 	BLI_argsAdd(ba, 1, NULL, "--enable-new-depsgraph", CB(arg_handle_depsgraph_use_new), NULL);
 
@@ -0,0 +1,76 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <math.h>
+
+#include "BLI_math_half.h"
+
+TEST(math_half, HalfToFloat)
+{
+	EXPECT_EQ(0.0f, half_to_float(0x0000));
+	EXPECT_EQ(1.0f, half_to_float(0x3c00));
+	EXPECT_EQ(-2.0f, half_to_float(0xc000));
+	EXPECT_EQ(65504.0f, half_to_float(0x7bff));
+	/* smallest normal and denormal */
+	EXPECT_EQ(6.103515625e-05f, half_to_float(0x0400));
+	EXPECT_EQ(5.9604644775390625e-08f, half_to_float(0x0001));
+	EXPECT_EQ(INFINITY, half_to_float(0x7c00));
+	EXPECT_EQ(-INFINITY, half_to_float(0xfc00));
+	EXPECT_TRUE(half_to_float(0x7e00) != half_to_float(0x7e00));
+}
+
+TEST(math_half, FloatToHalf)
+{
+	EXPECT_EQ(0x0000, float_to_half(0.0f));
+	EXPECT_EQ(0x8000, float_to_half(-0.0f));
+	EXPECT_EQ(0x3c00, float_to_half(1.0f));
+	EXPECT_EQ(0xc000, float_to_half(-2.0f));
+	EXPECT_EQ(0x7bff, float_to_half(65504.0f));
+	EXPECT_EQ(0x0001, float_to_half(5.9604644775390625e-08f));
+	/* too large and too small values */
+	EXPECT_EQ(0x7c00, float_to_half(65520.0f));
+	EXPECT_EQ(0x7c00, float_to_half(1e10f));
+	EXPECT_EQ(0xfc00, float_to_half(-INFINITY));
+	EXPECT_EQ(0x0000, float_to_half(1e-10f));
+	EXPECT_EQ(0x7e00, float_to_half(NAN));
+}
+
+TEST(math_half, FloatToHalfRounding)
+{
+	/* 1 + 2^-11 lies halfway between 1 and the next half, ties round to even */
+	EXPECT_EQ(0x3c00, float_to_half(1.00048828125f));
+	EXPECT_EQ(0x3c01, float_to_half(1.00048840046f));
+	/* 1 + 3 * 2^-11 lies halfway between two halves, the even one is above */
+	EXPECT_EQ(0x3c02, float_to_half(1.00146484375f));
+}
+
+TEST(math_half, RoundTrip)
+{
+	for (int i = 0; i < 0x10000; i++) {
+		const unsigned short h = (unsigned short)i;
+		const float f = half_to_float(h);
+		if (f == f) {
+			EXPECT_EQ(h, float_to_half(f));
+		}
+	}
+}
+
+TEST(math_half, Arrays)
+{
+	float src[37], dst[37];
+	unsigned short half[37];
+
+	for (int i = 0; i < 37; i++) {
+		src[i] = i * 1.37f - 20.0f;
+	}
+
+	float_to_half_vn(half, src, 37);
+	half_to_float_vn(dst, half, 37);
+
+	for (int i = 0; i < 37; i++) {
+		EXPECT_EQ(float_to_half(src[i]), half[i]);
+		EXPECT_EQ(half_to_float(half[i]), dst[i]);
+		EXPECT_NEAR(src[i], dst[i], 0.01f);
+	}
+}
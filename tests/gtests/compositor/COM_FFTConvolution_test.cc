@@ -0,0 +1,231 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <algorithm>
+#include <math.h>
+#include <vector>
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#include "BLI_threads.h"
+}
+
+#include "COM_FFTConvolution.h"
+
+/* The FFT results are compared with the per pixel sums of the blur operations,
+ * relative to the largest value of the image (all values are in 0..1). */
+#define FFT_TOLERANCE 1e-4f
+
+static std::vector<float> random_image(int width, int height)
+{
+	std::vector<float> image(4 * width * height);
+	unsigned int seed = 12345;
+	for (size_t i = 0; i < image.size(); i++) {
+		seed = seed * 1103515245u + 12345u;
+		image[i] = (float)((seed >> 8) & 0xffff) / 65535.0f;
+	}
+	return image;
+}
+
+/* Stand-in for the bokeh image input: a disk with a color fringe. */
+static void bokeh_sample(float r_color[4], float u, float v, int size)
+{
+	const int x = (int)floorf(u), y = (int)floorf(v);
+	if (x < 0 || y < 0 || x >= size || y >= size) {
+		r_color[0] = r_color[1] = r_color[2] = r_color[3] = 0.0f;
+		return;
+	}
+	const float dx = (x + 0.5f) / size - 0.5f, dy = (y + 0.5f) / size - 0.5f;
+	const float dist = sqrtf(dx * dx + dy * dy);
+	r_color[0] = dist < 0.5f ? 1.0f : 0.0f;
+	r_color[1] = dist < 0.45f ? 1.0f : 0.0f;
+	r_color[2] = dist < 0.4f ? 0.8f : 0.0f;
+	r_color[3] = (r_color[0] + r_color[1] + r_color[2]) / 3.0f;
+}
+
+static void expect_images_near(const std::vector<float> &a, const std::vector<float> &b)
+{
+	float max_diff = 0.0f;
+	for (size_t i = 0; i < a.size(); i++) {
+		max_diff = fmaxf(max_diff, fabsf(a[i] - b[i]));
+	}
+	EXPECT_LT(max_diff, FFT_TOLERANCE);
+}
+
+/* BokehBlurOperation: executePixel for a fixed size, against the kernel built by convolveFFT. */
+static void test_bokeh_blur(int width, int height, int pixelSize)
+{
+	const int bokehSize = 64;
+	const float bokehMid = bokehSize / 2.0f;
+	const float m = (bokehSize / 2.0f) / pixelSize;
+	const std::vector<float> image = random_image(width, height);
+
+	std::vector<float> direct(4 * width * height);
+	for (int y = 0; y < height; y++) {
+		for (int x = 0; x < width; x++) {
+			float color_accum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+			float multiplier_accum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+			const int miny = std::max(y - pixelSize, 0), maxy = std::min(y + pixelSize, height);
+			const int minx = std::max(x - pixelSize, 0), maxx = std::min(x + pixelSize, width);
+			for (int ny = miny; ny < maxy; ny++) {
+				for (int nx = minx; nx < maxx; nx++) {
+					float bokeh[4];
+					bokeh_sample(bokeh, bokehMid - (nx - x) * m, bokehMid - (ny - y) * m, bokehSize);
+					for (int c = 0; c < 4; c++) {
+						color_accum[c] += bokeh[c] * image[4 * (ny * width + nx) + c];
+						multiplier_accum[c] += bokeh[c];
+					}
+				}
+			}
+			for (int c = 0; c < 4; c++) {
+				direct[4 * (y * width + x) + c] = color_accum[c] * (1.0f / multiplier_accum[c]);
+			}
+		}
+	}
+
+	const int kernelSize = 2 * pixelSize + 1;
+	std::vector<float> kernel(4 * kernelSize * kernelSize, 0.0f);
+	for (int j = 1; j < kernelSize; j++) {
+		for (int i = 1; i < kernelSize; i++) {
+			bokeh_sample(&kernel[4 * (j * kernelSize + i)],
+			             bokehMid - (pixelSize - i) * m, bokehMid - (pixelSize - j) * m, bokehSize);
+		}
+	}
+
+	std::vector<float> fft(4 * width * height);
+	FFTConvolution::convolve(&fft[0], &image[0], width, height,
+	                         &kernel[0], kernelSize, kernelSize, 4,
+	                         pixelSize, pixelSize, 4, true);
+
+	expect_images_near(fft, direct);
+}
+
+/* GaussianBokehBlurOperation: executePixel against the mirrored kernel of convolveFFT. */
+static void test_gaussian_bokeh_blur(int width, int height, int radx, int rady)
+{
+	const int kernelWidth = 2 * radx + 1, kernelHeight = 2 * rady + 1;
+	const std::vector<float> image = random_image(width, height);
+
+	std::vector<float> gausstab(kernelWidth * kernelHeight);
+	float sum = 0.0f;
+	for (int j = -rady; j <= rady; j++) {
+		for (int i = -radx; i <= radx; i++) {
+			const float fi = (float)i / radx, fj = (float)j / rady;
+			/* asymmetric, so a wrongly mirrored kernel fails */
+			const float value = expf(-2.0f * (fi * fi + fj * fj)) * (1.5f + 0.5f * fi);
+			gausstab[(j + rady) * kernelWidth + (i + radx)] = value;
+			sum += value;
+		}
+	}
+	for (size_t i = 0; i < gausstab.size(); i++) {
+		gausstab[i] /= sum;
+	}
+
+	std::vector<float> direct(4 * width * height);
+	for (int y = 0; y < height; y++) {
+		for (int x = 0; x < width; x++) {
+			float color[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+			float multiplier_accum = 0.0f;
+			const int ymin = std::max(y - rady, 0), ymax = std::min(y + rady + 1, height);
+			const int xmin = std::max(x - radx, 0), xmax = std::min(x + radx + 1, width);
+			for (int ny = ymin; ny < ymax; ny++) {
+				for (int nx = xmin; nx < xmax; nx++) {
+					const float multiplier = gausstab[(ny - y + rady) * kernelWidth + (nx - x + radx)];
+					for (int c = 0; c < 4; c++) {
+						color[c] += image[4 * (ny * width + nx) + c] * multiplier;
+					}
+					multiplier_accum += multiplier;
+				}
+			}
+			for (int c = 0; c < 4; c++) {
+				direct[4 * (y * width + x) + c] = color[c] / multiplier_accum;
+			}
+		}
+	}
+
+	std::vector<float> kernel(kernelWidth * kernelHeight);
+	for (int j = 0; j < kernelHeight; j++) {
+		for (int i = 0; i < kernelWidth; i++) {
+			kernel[j * kernelWidth + i] = gausstab[(kernelHeight - 1 - j) * kernelWidth + (kernelWidth - 1 - i)];
+		}
+	}
+
+	std::vector<float> fft(4 * width * height);
+	FFTConvolution::convolve(&fft[0], &image[0], width, height,
+	                         &kernel[0], kernelWidth, kernelHeight, 1,
+	                         radx, rady, 4, true);
+
+	expect_images_near(fft, direct);
+}
+
+/* Fog glow: plain convolution without normalization, of the color channels only. */
+static void test_convolve_unnormalized(int width, int height, int kernelSize)
+{
+	const int center = kernelSize / 2;
+	const std::vector<float> image = random_image(width, height);
+	std::vector<float> kernel(kernelSize * kernelSize);
+	for (int j = 0; j < kernelSize; j++) {
+		for (int i = 0; i < kernelSize; i++) {
+			const float di = (float)(i - center) / center, dj = (float)(j - center) / center;
+			kernel[j * kernelSize + i] = 1.0f / (1.0f + 50.0f * (di * di + dj * dj)) / (kernelSize * kernelSize);
+		}
+	}
+
+	std::vector<float> direct(4 * width * height, 0.0f);
+	for (int y = 0; y < height; y++) {
+		for (int x = 0; x < width; x++) {
+			for (int j = 0; j < kernelSize; j++) {
+				for (int i = 0; i < kernelSize; i++) {
+					const int sx = x + center - i, sy = y + center - j;
+					if (sx >= 0 && sy >= 0 && sx < width && sy < height) {
+						for (int c = 0; c < 3; c++) {
+							direct[4 * (y * width + x) + c] += kernel[j * kernelSize + i] * image[4 * (sy * width + sx) + c];
+						}
+					}
+				}
+			}
+		}
+	}
+
+	std::vector<float> fft(4 * width * height, 0.0f);
+	FFTConvolution::convolve(&fft[0], &image[0], width, height,
+	                         &kernel[0], kernelSize, kernelSize, 1,
+	                         center, center, 3, false);
+
+	expect_images_near(fft, direct);
+}
+
+class FFTConvolutionTest : public ::testing::Test {
+protected:
+	static void SetUpTestCase()
+	{
+		BLI_threadapi_init();
+	}
+	static void TearDownTestCase()
+	{
+		BLI_threadapi_exit();
+	}
+};
+
+TEST_F(FFTConvolutionTest, BokehBlur)
+{
+	test_bokeh_blur(97, 61, 12);
+}
+
+TEST_F(FFTConvolutionTest, BokehBlurKernelLargerThanImage)
+{
+	test_bokeh_blur(40, 33, 30);
+}
+
+TEST_F(FFTConvolutionTest, GaussianBokehBlur)
+{
+	test_gaussian_bokeh_blur(83, 57, 11, 6);
+}
+
+TEST_F(FFTConvolutionTest, FogGlowMultipleBlocks)
+{
+	/* wider than a block (FFT_BLOCK_SIZE), so blocks are added together */
+	test_convolve_unnormalized(1500, 24, 33);
+}
@@ -0,0 +1,89 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+extern "C" {
+#include "BLI_utildefines.h"
+#include "BLI_threads.h"
+#include "PIL_time_utildefines.h"
+
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+}
+
+#define SCALE_REPEAT 3
+
+static const char *filter_names[] = {"box", "bilinear", "bicubic", "lanczos"};
+
+static void scale_test(int width, int height, int newx, int newy, int flags)
+{
+	ImBuf *ibuf = IMB_allocImBuf(width, height, 32, flags);
+
+	if (ibuf->rect) {
+		unsigned char *rect = (unsigned char *)ibuf->rect;
+		for (size_t i = 0; i < (size_t)width * height * 4; i++) {
+			rect[i] = (unsigned char)(i * 7);
+		}
+	}
+	if (ibuf->rect_float) {
+		for (size_t i = 0; i < (size_t)width * height * 4; i++) {
+			ibuf->rect_float[i] = (float)(i % 113) / 113.0f;
+		}
+	}
+
+	printf("\n========== %s %dx%d to %dx%d ==========\n",
+	       (flags & IB_rectfloat) ? "float" : "byte", width, height, newx, newy);
+
+	for (int filter = IMB_SCALE_FILTER_BOX; filter <= IMB_SCALE_FILTER_LANCZOS; filter++) {
+		double time_start = PIL_check_seconds_timer();
+
+		for (int i = 0; i < SCALE_REPEAT; i++) {
+			ImBuf *ibuf_scaled = IMB_dupImBuf(ibuf);
+			IMB_scaleImBuf_filter(ibuf_scaled, newx, newy, (IMB_ScaleFilter)filter);
+			IMB_freeImBuf(ibuf_scaled);
+		}
+
+		printf("%s: %.4f sec\n", filter_names[filter], (PIL_check_seconds_timer() - time_start) / SCALE_REPEAT);
+	}
+
+	IMB_freeImBuf(ibuf);
+}
+
+class ImbufScalingPerformance : public ::testing::Test {
+protected:
+	static void SetUpTestCase()
+	{
+		BLI_threadapi_init();
+		IMB_init();
+	}
+	static void TearDownTestCase()
+	{
+		IMB_exit();
+		BLI_threadapi_exit();
+	}
+};
+
+TEST_F(ImbufScalingPerformance, ByteDown)
+{
+	scale_test(3840, 2160, 1920, 1080, IB_rect);
+}
+
+TEST_F(ImbufScalingPerformance, ByteUp)
+{
+	scale_test(1920, 1080, 3840, 2160, IB_rect);
+}
+
+TEST_F(ImbufScalingPerformance, ByteThumbnail)
+{
+	scale_test(3840, 2160, 256, 144, IB_rect);
+}
+
+TEST_F(ImbufScalingPerformance, FloatDown)
+{
+	scale_test(3840, 2160, 1920, 1080, IB_rectfloat);
+}
+
+TEST_F(ImbufScalingPerformance, FloatUp)
+{
+	scale_test(1920, 1080, 3840, 2160, IB_rectfloat);
+}
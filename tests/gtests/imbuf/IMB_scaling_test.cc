@@ -0,0 +1,196 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#include "BLI_utildefines.h"
+#include "BLI_math_base.h"
+#include "BLI_threads.h"
+
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+}
+
+static const IMB_ScaleFilter kernel_filters[] = {
+	IMB_SCALE_FILTER_BILINEAR,
+	IMB_SCALE_FILTER_BICUBIC,
+	IMB_SCALE_FILTER_LANCZOS,
+};
+
+static ImBuf *random_ibuf(int width, int height)
+{
+	ImBuf *ibuf = IMB_allocImBuf(width, height, 32, IB_rect | IB_rectfloat);
+	unsigned char *rect = (unsigned char *)ibuf->rect;
+	unsigned int seed = 12345;
+
+	for (size_t i = 0; i < (size_t)width * height * 4; i++) {
+		seed = seed * 1103515245u + 12345u;
+		rect[i] = (unsigned char)(seed >> 16);
+		ibuf->rect_float[i] = rect[i] / 255.0f;
+	}
+	return ibuf;
+}
+
+static ImBuf *constant_ibuf(int width, int height, unsigned char value)
+{
+	ImBuf *ibuf = IMB_allocImBuf(width, height, 32, IB_rect | IB_rectfloat);
+
+	memset(ibuf->rect, value, (size_t)width * height * 4);
+	for (size_t i = 0; i < (size_t)width * height * 4; i++) {
+		ibuf->rect_float[i] = value / 255.0f;
+	}
+	return ibuf;
+}
+
+class ImbufScalingTest : public ::testing::Test {
+protected:
+	static void SetUpTestCase()
+	{
+		BLI_threadapi_init();
+		IMB_init();
+	}
+	static void TearDownTestCase()
+	{
+		IMB_exit();
+		BLI_threadapi_exit();
+	}
+};
+
+/* the box filter is the scaler of IMB_scaleImBuf */
+TEST_F(ImbufScalingTest, BoxMatchesScaleImBuf)
+{
+	const int sizes[][2] = {{97, 45}, {640, 360}, {31, 300}};
+
+	for (int i = 0; i < ARRAY_SIZE(sizes); i++) {
+		ImBuf *ibuf = random_ibuf(211, 123);
+		ImBuf *ibuf_box = IMB_dupImBuf(ibuf);
+
+		IMB_scaleImBuf(ibuf, sizes[i][0], sizes[i][1]);
+		IMB_scaleImBuf_filter(ibuf_box, sizes[i][0], sizes[i][1], IMB_SCALE_FILTER_BOX);
+
+		EXPECT_EQ(ibuf->x, ibuf_box->x);
+		EXPECT_EQ(ibuf->y, ibuf_box->y);
+		EXPECT_EQ(0, memcmp(ibuf->rect, ibuf_box->rect, (size_t)ibuf->x * ibuf->y * 4));
+		EXPECT_EQ(0, memcmp(ibuf->rect_float, ibuf_box->rect_float, sizeof(float) * ibuf->x * ibuf->y * 4));
+
+		IMB_freeImBuf(ibuf);
+		IMB_freeImBuf(ibuf_box);
+	}
+}
+
+/* weights are normalized, also at the borders */
+TEST_F(ImbufScalingTest, ConstantImage)
+{
+	const int sizes[][2] = {{40, 30}, {300, 200}, {13, 250}, {1, 1}};
+
+	for (int f = 0; f < ARRAY_SIZE(kernel_filters); f++) {
+		for (int i = 0; i < ARRAY_SIZE(sizes); i++) {
+			ImBuf *ibuf = constant_ibuf(100, 70, 200);
+
+			IMB_scaleImBuf_filter(ibuf, sizes[i][0], sizes[i][1], kernel_filters[f]);
+
+			ASSERT_EQ(sizes[i][0], ibuf->x);
+			ASSERT_EQ(sizes[i][1], ibuf->y);
+			for (size_t p = 0; p < (size_t)ibuf->x * ibuf->y * 4; p++) {
+				EXPECT_EQ(200, ((unsigned char *)ibuf->rect)[p]);
+				EXPECT_NEAR(200.0f / 255.0f, ibuf->rect_float[p], 1e-5f);
+			}
+
+			IMB_freeImBuf(ibuf);
+		}
+	}
+}
+
+/* symmetric kernels reproduce a linear gradient away from the borders */
+TEST_F(ImbufScalingTest, LinearGradient)
+{
+	const int width = 120, newsizes[] = {37, 60, 250, 517};
+
+	for (int f = 0; f < ARRAY_SIZE(kernel_filters); f++) {
+		for (int n = 0; n < ARRAY_SIZE(newsizes); n++) {
+			const int newx = newsizes[n];
+			const float scale = (float)width / newx;
+			const int border = (int)ceilf(4.0f * max_ff(1.0f, 1.0f / scale)) + 1;
+			ImBuf *ibuf = IMB_allocImBuf(width, 3, 32, IB_rectfloat);
+
+			for (int y = 0; y < ibuf->y; y++) {
+				for (int x = 0; x < width; x++) {
+					for (int c = 0; c < 4; c++) {
+						ibuf->rect_float[4 * (y * width + x) + c] = (float)x;
+					}
+				}
+			}
+
+			IMB_scaleImBuf_filter(ibuf, newx, 3, kernel_filters[f]);
+
+			for (int x = border; x < newx - border; x++) {
+				const float expected = (x + 0.5f) * scale - 0.5f;
+				EXPECT_NEAR(expected, ibuf->rect_float[4 * (newx + x)], 1e-3f * width);
+			}
+
+			IMB_freeImBuf(ibuf);
+		}
+	}
+}
+
+/* byte buffers give the rounded and clamped float result */
+TEST_F(ImbufScalingTest, ByteMatchesFloat)
+{
+	const int sizes[][2] = {{53, 41}, {400, 300}, {90, 250}};
+
+	for (int f = 0; f < ARRAY_SIZE(kernel_filters); f++) {
+		for (int i = 0; i < ARRAY_SIZE(sizes); i++) {
+			ImBuf *ibuf = random_ibuf(160, 120);
+
+			IMB_scaleImBuf_filter(ibuf, sizes[i][0], sizes[i][1], kernel_filters[f]);
+
+			for (size_t p = 0; p < (size_t)ibuf->x * ibuf->y * 4; p++) {
+				const float value = CLAMPIS(ibuf->rect_float[p], 0.0f, 1.0f) * 255.0f;
+				EXPECT_NEAR(value, ((unsigned char *)ibuf->rect)[p], 0.51f);
+			}
+
+			IMB_freeImBuf(ibuf);
+		}
+	}
+}
+
+/* float buffers with other than 4 channels */
+TEST_F(ImbufScalingTest, FloatChannels)
+{
+	for (int f = 0; f < ARRAY_SIZE(kernel_filters); f++) {
+		for (int channels = 1; channels <= 3; channels++) {
+			ImBuf *ibuf = IMB_allocImBuf(64, 48, 32, 0);
+			ImBuf *ibuf_rgba = IMB_allocImBuf(64, 48, 32, IB_rectfloat);
+
+			ibuf->channels = channels;
+			ibuf->rect_float = (float *)MEM_mallocN(sizeof(float) * 64 * 48 * channels, __func__);
+			ibuf->mall |= IB_rectfloat;
+
+			for (int p = 0; p < 64 * 48; p++) {
+				for (int c = 0; c < 4; c++) {
+					ibuf_rgba->rect_float[4 * p + c] = (c < channels) ? (float)((p * 7 + c * 13) % 31) : 0.0f;
+				}
+				for (int c = 0; c < channels; c++) {
+					ibuf->rect_float[channels * p + c] = ibuf_rgba->rect_float[4 * p + c];
+				}
+			}
+
+			IMB_scaleImBuf_filter(ibuf, 150, 20, kernel_filters[f]);
+			IMB_scaleImBuf_filter(ibuf_rgba, 150, 20, kernel_filters[f]);
+
+			for (int p = 0; p < 150 * 20; p++) {
+				for (int c = 0; c < channels; c++) {
+					EXPECT_NEAR(ibuf_rgba->rect_float[4 * p + c], ibuf->rect_float[channels * p + c], 1e-4f);
+				}
+			}
+
+			IMB_freeImBuf(ibuf);
+			IMB_freeImBuf(ibuf_rgba);
+		}
+	}
+}
@@ -0,0 +1,133 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <stdlib.h>
+
+extern "C" {
+#include "BLI_utildefines.h"
+#include "BLI_fileops.h"
+#include "BLI_math_base.h"
+#include "BLI_path_util.h"
+#include "BLI_string.h"
+#include "BLI_threads.h"
+#include "PIL_time_utildefines.h"
+
+#include "DNA_scene_types.h"
+
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+}
+
+/* Time loading thumbnails at reduced resolution against loading the full image and scaling it. */
+
+#define THUMB_REPEAT 3
+
+static void thumbnail_test(const char *name, int width, int height, eImbTypes ftype, int foptions)
+{
+	const char *tempdir = getenv("TMPDIR");
+	char filepath[FILE_MAX], filename[FILE_MAXFILE];
+	ImBuf *ibuf = IMB_allocImBuf(width, height, 24, (ftype == IMB_FTYPE_OPENEXR) ? IB_rectfloat : IB_rect);
+
+	for (int y = 0; y < height; y++) {
+		for (int x = 0; x < width; x++) {
+			const size_t i = (size_t)y * width + x;
+			if (ibuf->rect_float) {
+				ibuf->rect_float[4 * i + 0] = (float)x / width;
+				ibuf->rect_float[4 * i + 1] = (float)y / height;
+				ibuf->rect_float[4 * i + 2] = (float)((x / 64 + y / 64) % 2);
+				ibuf->rect_float[4 * i + 3] = 1.0f;
+			}
+			else {
+				unsigned char *rect = (unsigned char *)(ibuf->rect + i);
+				rect[0] = (unsigned char)(x * 255 / width);
+				rect[1] = (unsigned char)(y * 255 / height);
+				rect[2] = (unsigned char)(((x / 64 + y / 64) % 2) * 255);
+				rect[3] = 255;
+			}
+		}
+	}
+
+	BLI_snprintf(filename, sizeof(filename), "thumbnail_performance_%s", name);
+	BLI_join_dirfile(filepath, sizeof(filepath), tempdir ? tempdir : "/tmp", filename);
+
+	ibuf->ftype = ftype;
+	ibuf->foptions.flag = foptions;
+	ibuf->foptions.quality = 90;
+	if (!IMB_saveiff(ibuf, filepath, IB_rect | IB_rectfloat)) {
+		printf("\n%s: format not supported by this build, skipped\n", name);
+		IMB_freeImBuf(ibuf);
+		return;
+	}
+	IMB_freeImBuf(ibuf);
+
+	printf("\n========== %s %dx%d ==========\n", name, width, height);
+
+	for (int size = 128; size <= 256; size *= 2) {
+		double time_full = 0.0, time_thumb = 0.0;
+
+		for (int i = 0; i < THUMB_REPEAT; i++) {
+			double time_start = PIL_check_seconds_timer();
+			ImBuf *full = IMB_loadiffname(filepath, IB_rect | IB_metadata, NULL);
+			ASSERT_TRUE(full != NULL);
+			IMB_scaleImBuf(full, max_ii(full->x * size / max_ii(width, height), 1),
+			               max_ii(full->y * size / max_ii(width, height), 1));
+			IMB_freeImBuf(full);
+			time_full += PIL_check_seconds_timer() - time_start;
+
+			time_start = PIL_check_seconds_timer();
+			size_t r_width, r_height;
+			ImBuf *thumb = IMB_thumb_load_image(filepath, IB_rect | IB_metadata, size, NULL, &r_width, &r_height);
+			ASSERT_TRUE(thumb != NULL);
+			EXPECT_EQ(r_width, (size_t)width);
+			EXPECT_EQ(r_height, (size_t)height);
+			IMB_freeImBuf(thumb);
+			time_thumb += PIL_check_seconds_timer() - time_start;
+		}
+
+		printf("thumbnail %d: full image %.4f sec, reduced %.4f sec\n",
+		       size, time_full / THUMB_REPEAT, time_thumb / THUMB_REPEAT);
+	}
+
+	BLI_delete(filepath, false, false);
+}
+
+class ImbufThumbnailPerformance : public ::testing::Test {
+protected:
+	static void SetUpTestCase()
+	{
+		BLI_threadapi_init();
+		IMB_init();
+	}
+	static void TearDownTestCase()
+	{
+		IMB_exit();
+		BLI_threadapi_exit();
+	}
+};
+
+TEST_F(ImbufThumbnailPerformance, JPEG)
+{
+	thumbnail_test("jpeg.jpg", 4000, 3000, IMB_FTYPE_JPG, 0);
+}
+
+/* scanlines are compressed in blocks of 1, 16, 32 and 256 lines */
+TEST_F(ImbufThumbnailPerformance, OpenEXRZIPS)
+{
+	thumbnail_test("zips.exr", 4000, 3000, IMB_FTYPE_OPENEXR, OPENEXR_HALF | R_IMF_EXR_CODEC_ZIPS);
+}
+
+TEST_F(ImbufThumbnailPerformance, OpenEXRZIP)
+{
+	thumbnail_test("zip.exr", 4000, 3000, IMB_FTYPE_OPENEXR, OPENEXR_HALF | R_IMF_EXR_CODEC_ZIP);
+}
+
+TEST_F(ImbufThumbnailPerformance, OpenEXRPIZ)
+{
+	thumbnail_test("piz.exr", 4000, 3000, IMB_FTYPE_OPENEXR, OPENEXR_HALF | R_IMF_EXR_CODEC_PIZ);
+}
+
+TEST_F(ImbufThumbnailPerformance, OpenEXRDWAB)
+{
+	thumbnail_test("dwab.exr", 4000, 3000, IMB_FTYPE_OPENEXR, OPENEXR_HALF | R_IMF_EXR_CODEC_DWAB);
+}
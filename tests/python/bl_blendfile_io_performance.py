@@ -0,0 +1,78 @@
+# Apache License, Version 2.0
+
+# Benchmark loading of a synthetic .blend file with many datablocks,
+# mainly to keep an eye on pointer relinking (OldNewMap) and struct reading performance.
+#
+# ./blender.bin --background -noaudio --factory-startup --python tests/python/bl_blendfile_io_performance.py -- \
+#     --ids=20000 --runs=3
+#
+# Use '--debug-io' to get the time spent per reading phase.
+
+import os
+import sys
+import tempfile
+import time
+
+import bpy
+
+
+def create_many_ids(tot):
+    scene = bpy.context.scene
+
+    for i in range(tot):
+        # Each object gets its own mesh and node based material,
+        # so there are many pointers between (and within) datablocks to relink.
+        me = bpy.data.meshes.new("Mesh.%06d" % i)
+        me.vertices.add(4)
+        me.edges.add(4)
+        me.uv_textures.new()
+        me.vertex_colors.new()
+
+        ma = bpy.data.materials.new("Material.%06d" % i)
+        ma.use_nodes = True
+        nodes = ma.node_tree.nodes
+        links = ma.node_tree.links
+        node_prev = nodes.new("ShaderNodeRGB")
+        for _ in range(4):
+            node = nodes.new("ShaderNodeMixRGB")
+            links.new(node_prev.outputs[0], node.inputs[1])
+            node_prev = node
+        me.materials.append(ma)
+
+        ob = bpy.data.objects.new("Object.%06d" % i, me)
+        scene.objects.link(ob)
+
+
+def main():
+    argv = sys.argv[sys.argv.index("--") + 1:] if "--" in sys.argv else []
+    args = dict(arg.lstrip("-").split("=", 1) for arg in argv if "=" in arg)
+    tot_ids = int(args.get("ids", 10000))
+    tot_runs = int(args.get("runs", 3))
+
+    filepath = os.path.join(tempfile.gettempdir(), "bl_blendfile_io_performance.blend")
+
+    t = time.time()
+    create_many_ids(tot_ids)
+    print("Created %d objects (with meshes & materials) in %.3f sec" % (tot_ids, time.time() - t))
+
+    for compress, compress_fast in ((False, False), (True, False), (True, True)):
+        t = time.time()
+        bpy.ops.wm.save_as_mainfile(filepath=filepath, compress=compress, compress_fast=compress_fast)
+        print("Save (compress=%r, fast=%r): %.3f sec, %.1f MiB" %
+              (compress, compress_fast, time.time() - t, os.path.getsize(filepath) / (1024.0 * 1024.0)))
+
+        timings = []
+        for _ in range(tot_runs):
+            t = time.time()
+            bpy.ops.wm.open_mainfile(filepath=filepath)
+            timings.append(time.time() - t)
+
+        assert(len(bpy.data.objects) == tot_ids)
+        print("Load (compress=%r, fast=%r): best %.3f sec, average %.3f sec (%d runs)" %
+              (compress, compress_fast, min(timings), sum(timings) / len(timings), tot_runs))
+
+    os.remove(filepath)
+
+
+if __name__ == "__main__":
+    main()
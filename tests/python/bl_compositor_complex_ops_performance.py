@@ -0,0 +1,160 @@
+# Apache License, Version 2.0
+
+# Benchmark the compositor operations that need the whole image at once
+# (blurs using IIR filters, inpaint, double edge mask, tonemap, normalize, levels and glare),
+# compositing a 4K image with a node tree containing only the operation to time.
+#
+# ./blender.bin --background -noaudio --factory-startup \
+#     --python tests/python/bl_compositor_complex_ops_performance.py -- --renders=3
+#
+# Use '--ops=<name>,<name>' to time a subset of the operations,
+# and '-t 1' before '--python' to compare against single threaded compositing.
+
+import sys
+import time
+
+import bpy
+
+
+WIDTH = 3840
+HEIGHT = 2160
+
+
+def node_luminance_mask(tree, socket, threshold):
+    node_math = tree.nodes.new("CompositorNodeMath")
+    node_math.operation = 'GREATER_THAN'
+    node_math.inputs[1].default_value = threshold
+    tree.links.new(socket, node_math.inputs[0])
+    return node_math.outputs[0]
+
+
+def op_fast_gaussian(tree, image):
+    node = tree.nodes.new("CompositorNodeBlur")
+    node.filter_type = 'FAST_GAUSS'
+    node.size_x = node.size_y = 50
+    tree.links.new(image, node.inputs["Image"])
+    return node.outputs["Image"]
+
+
+def op_inpaint(tree, image):
+    node_alpha = tree.nodes.new("CompositorNodeSetAlpha")
+    tree.links.new(image, node_alpha.inputs["Image"])
+    tree.links.new(node_luminance_mask(tree, image, 0.5), node_alpha.inputs["Alpha"])
+
+    node = tree.nodes.new("CompositorNodeInpaint")
+    node.distance = 64
+    tree.links.new(node_alpha.outputs["Image"], node.inputs["Image"])
+    return node.outputs["Image"]
+
+
+def op_double_edge_mask(tree, image):
+    node = tree.nodes.new("CompositorNodeDoubleEdgeMask")
+    tree.links.new(node_luminance_mask(tree, image, 0.8), node.inputs["Inner Mask"])
+    tree.links.new(node_luminance_mask(tree, image, 0.3), node.inputs["Outer Mask"])
+    return node.outputs["Mask"]
+
+
+def op_tonemap(tonemap_type):
+    def op(tree, image):
+        node = tree.nodes.new("CompositorNodeTonemap")
+        node.tonemap_type = tonemap_type
+        tree.links.new(image, node.inputs["Image"])
+        return node.outputs["Image"]
+    return op
+
+
+def op_normalize(tree, image):
+    node = tree.nodes.new("CompositorNodeNormalize")
+    tree.links.new(image, node.inputs[0])
+    return node.outputs[0]
+
+
+def op_levels(output):
+    def op(tree, image):
+        node = tree.nodes.new("CompositorNodeLevels")
+        node.channel = 'COMBINED_RGB'
+        tree.links.new(image, node.inputs["Image"])
+
+        # Use the value for every pixel, so the result has the resolution of the image.
+        node_mix = tree.nodes.new("CompositorNodeMixRGB")
+        tree.links.new(node.outputs[output], node_mix.inputs[0])
+        tree.links.new(image, node_mix.inputs[1])
+        return node_mix.outputs["Image"]
+    return op
+
+
+def op_glare(glare_type):
+    def op(tree, image):
+        node = tree.nodes.new("CompositorNodeGlare")
+        node.glare_type = glare_type
+        node.quality = 'HIGH'
+        tree.links.new(image, node.inputs["Image"])
+        return node.outputs["Image"]
+    return op
+
+
+OPERATIONS = (
+    ("fast_gaussian", op_fast_gaussian),
+    ("inpaint", op_inpaint),
+    ("double_edge_mask", op_double_edge_mask),
+    ("tonemap_rd", op_tonemap('RD_PHOTORECEPTOR')),
+    ("tonemap_rh", op_tonemap('RH_SIMPLE')),
+    ("normalize", op_normalize),
+    ("levels_mean", op_levels("Mean")),
+    ("levels_std_dev", op_levels("Std Dev")),
+    ("glare_ghosts", op_glare('GHOSTS')),
+    ("glare_streaks", op_glare('STREAKS')),
+    ("glare_simple_star", op_glare('SIMPLE_STAR')),
+    ("glare_fog_glow", op_glare('FOG_GLOW')),
+)
+
+
+def create_node_tree(scene, image, op):
+    scene.use_nodes = True
+    tree = scene.node_tree
+    tree.nodes.clear()
+
+    node_image = tree.nodes.new("CompositorNodeImage")
+    node_image.image = image
+
+    node_composite = tree.nodes.new("CompositorNodeComposite")
+    tree.links.new(op(tree, node_image.outputs["Image"]), node_composite.inputs["Image"])
+
+
+def main():
+    argv = sys.argv[sys.argv.index("--") + 1:] if "--" in sys.argv else []
+    args = dict(arg.lstrip("-").split("=", 1) for arg in argv if "=" in arg)
+    tot_renders = int(args.get("renders", 3))
+    ops = args.get("ops")
+    ops = set(ops.split(",")) if ops else None
+
+    scene = bpy.context.scene
+    scene.render.resolution_x = WIDTH
+    scene.render.resolution_y = HEIGHT
+    scene.render.resolution_percentage = 100
+    # Only composite, nothing to render.
+    scene.render.use_compositing = True
+    for layer in scene.render.layers:
+        layer.use = False
+
+    image = bpy.data.images.new("Input", WIDTH, HEIGHT, float_buffer=True)
+    image.generated_type = 'COLOR_GRID'
+
+    for name, op in OPERATIONS:
+        if ops is not None and name not in ops:
+            continue
+
+        create_node_tree(scene, image, op)
+
+        timings = []
+        for i in range(tot_renders):
+            t = time.time()
+            bpy.ops.render.render()
+            timings.append(time.time() - t)
+
+        print("%s (%dx%d): best %.4f sec, average %.4f sec (%d renders)" %
+              (name, WIDTH, HEIGHT, min(timings), sum(timings) / len(timings), tot_renders))
+
+
+if __name__ == "__main__":
+    main()
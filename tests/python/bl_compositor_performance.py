@@ -0,0 +1,190 @@
+# Apache License, Version 2.0
+
+# Benchmark compositing of a node tree with the tiled and the full frame execution models,
+# comparing time spent and peak memory usage.
+#
+# ./blender.bin --background -noaudio --factory-startup --debug-compositor \
+#     --python tests/python/bl_compositor_performance.py -- --mode=full_frame --size=2048 --renders=5
+#
+# When a .blend file is loaded before the script, its compositing node tree is used,
+# otherwise a synthetic tree with blur, glare, defocus and mix nodes is created.
+# Use '--mode=tiled' or '--mode=full_frame' to choose the execution model,
+# '--resolution=1080p', '4k' or '8k' instead of '--size' for a synthetic input of that resolution,
+# and '--half-float=1' to store intermediate color buffers as half floats.
+#
+# With '--debug-compositor' the time of every execution group, the time chunks wait
+# in the scheduler queue and the peak buffer memory are printed for every render.
+#
+# Use '--reference=<file>.exr' to guard against changes of the result: the composited image is
+# compared to the reference image with a tolerance, like the render tests do, since SIMD and half
+# float paths round differently. A missing file is an error.
+# Add '--store-reference=1' to write the reference image instead.
+
+import os
+import resource
+import sys
+import time
+
+import bpy
+import numpy
+
+
+# same as the render tests: a pixel fails when a channel differs by more than FAIL,
+# the result fails when more than FAIL_PERCENT of the pixels fail
+FAIL = 0.01
+FAIL_PERCENT = 1.0
+
+RESOLUTIONS = {
+    "1080p": (1920, 1080),
+    "4k": (3840, 2160),
+    "8k": (7680, 4320),
+}
+
+
+def create_node_tree(scene, width, height):
+    scene.use_nodes = True
+    tree = scene.node_tree
+    tree.nodes.clear()
+
+    image = bpy.data.images.new("Input", width, height, float_buffer=True)
+    image.generated_type = 'COLOR_GRID'
+
+    node_image = tree.nodes.new("CompositorNodeImage")
+    node_image.image = image
+
+    node_blur = tree.nodes.new("CompositorNodeBlur")
+    node_blur.filter_type = 'GAUSS'
+    node_blur.size_x = node_blur.size_y = 30
+    tree.links.new(node_image.outputs["Image"], node_blur.inputs["Image"])
+
+    node_glare = tree.nodes.new("CompositorNodeGlare")
+    node_glare.glare_type = 'FOG_GLOW'
+    tree.links.new(node_image.outputs["Image"], node_glare.inputs["Image"])
+
+    node_defocus = tree.nodes.new("CompositorNodeDefocus")
+    node_defocus.use_zbuffer = False
+    node_defocus.z_scale = 10.0
+    tree.links.new(node_blur.outputs["Image"], node_defocus.inputs["Image"])
+
+    node_mix = tree.nodes.new("CompositorNodeMixRGB")
+    node_mix.blend_type = 'SCREEN'
+    tree.links.new(node_defocus.outputs["Image"], node_mix.inputs[1])
+    tree.links.new(node_glare.outputs["Image"], node_mix.inputs[2])
+
+    node_composite = tree.nodes.new("CompositorNodeComposite")
+    tree.links.new(node_mix.outputs["Image"], node_composite.inputs["Image"])
+
+
+def result_image(scene):
+    """Composited image, read back through a viewer node."""
+    tree = scene.node_tree
+    node_output = next(node for node in tree.nodes if node.type == 'COMPOSITE')
+    node_viewer = tree.nodes.new("CompositorNodeViewer")
+    tree.links.new(node_output.inputs["Image"].links[0].from_socket, node_viewer.inputs["Image"])
+    tree.nodes.active = node_viewer
+
+    bpy.ops.render.render()
+    tree.nodes.remove(node_viewer)
+    return bpy.data.images["Viewer Node"]
+
+
+def store_reference(scene, image, filepath):
+    settings = scene.render.image_settings
+    settings.file_format = 'OPEN_EXR'
+    settings.color_mode = 'RGBA'
+    settings.color_depth = '32'
+    settings.exr_codec = 'ZIP'
+    image.save_render(filepath, scene=scene)
+    print("Stored result image in %r" % filepath)
+
+
+def check_reference(image, filepath):
+    if not os.path.exists(filepath):
+        print("Reference image %r not found" % filepath)
+        return False
+
+    reference = bpy.data.images.load(filepath)
+    if tuple(reference.size) != tuple(image.size):
+        print("Result size %dx%d differs from reference size %dx%d in %r" %
+              (tuple(image.size) + tuple(reference.size) + (filepath,)))
+        return False
+
+    result_pixels = numpy.array(image.pixels[:], dtype=numpy.float32).reshape(-1, 4)
+    reference_pixels = numpy.array(reference.pixels[:], dtype=numpy.float32).reshape(-1, 4)
+    bpy.data.images.remove(reference)
+
+    diff = numpy.abs(result_pixels - reference_pixels).max(axis=1)
+    failed_percent = 100.0 * numpy.count_nonzero(diff > FAIL) / len(diff)
+    if failed_percent > FAIL_PERCENT:
+        print("Result differs from reference %r: %.2f%% of the pixels differ by more than %g "
+              "(largest difference %g)" % (filepath, failed_percent, FAIL, diff.max()))
+        return False
+    print("Result matches the reference, largest difference %g" % diff.max())
+    return True
+
+
+def main():
+    argv = sys.argv[sys.argv.index("--") + 1:] if "--" in sys.argv else []
+    args = dict(arg.lstrip("-").split("=", 1) for arg in argv if "=" in arg)
+    mode = args.get("mode", "tiled")
+    size = int(args.get("size", 2048))
+    width, height = RESOLUTIONS.get(args.get("resolution"), (size, size))
+    tot_renders = int(args.get("renders", 5))
+    half_float = bool(int(args.get("half-float", 0)))
+    reference = args.get("reference")
+    do_store_reference = bool(int(args.get("store-reference", 0)))
+
+    scene = bpy.context.scene
+    if not scene.use_nodes or not bpy.data.filepath:
+        create_node_tree(scene, width, height)
+        scene.render.resolution_x = width
+        scene.render.resolution_y = height
+        scene.render.resolution_percentage = 100
+
+    scene.node_tree.use_full_frame = (mode == 'full_frame')
+    scene.node_tree.use_half_float_buffers = half_float
+    scene.render.use_compositing = True
+    if not any(node.type == 'R_LAYERS' for node in scene.node_tree.nodes):
+        # Nothing to render, but rendering is cancelled when all render layers are disabled:
+        # keep the first one, on an empty scene layer.
+        empty_layer = next(i for i in reversed(range(20)) if not any(ob.layers[i] for ob in scene.objects))
+        for i, layer in enumerate(scene.render.layers):
+            layer.use = (i == 0)
+        scene.render.layers[0].layers = [i == empty_layer for i in range(20)]
+
+    # Only count renders which got to compositing.
+    renders_done = []
+    bpy.app.handlers.render_post.append(lambda scene: renders_done.append(scene.name))
+
+    timings = []
+    for i in range(tot_renders):
+        del renders_done[:]
+        t = time.time()
+        bpy.ops.render.render()
+        t = time.time() - t
+        if not renders_done:
+            print("Render %d was cancelled, nothing was composited" % i)
+            sys.exit(1)
+        timings.append(t)
+
+    image = result_image(scene)
+    size = tuple(image.size)
+    if size != (scene.render.resolution_x, scene.render.resolution_y):
+        print("Composited image has size %dx%d, expected %dx%d" %
+              (size + (scene.render.resolution_x, scene.render.resolution_y)))
+        sys.exit(1)
+
+    peak_memory = resource.getrusage(resource.RUSAGE_SELF).ru_maxrss / 1024.0
+    print("Composite (%s%s, %dx%d): best %.4f sec, average %.4f sec, peak memory %.1f MB (%d renders)" %
+          (mode, ", half float" if half_float else "", scene.render.resolution_x, scene.render.resolution_y,
+           min(timings), sum(timings) / len(timings), peak_memory, tot_renders))
+
+    if reference:
+        if do_store_reference:
+            store_reference(scene, image, reference)
+        elif not check_reference(image, reference):
+            sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,96 @@
+# Apache License, Version 2.0
+
+# Benchmark frame change evaluation of a synthetic heavy rig with the new dependency graph,
+# mainly to keep an eye on operation scheduling overhead and multi-threading scalability.
+#
+# ./blender.bin --background -noaudio --factory-startup --enable-new-depsgraph \
+#     --python tests/python/bl_depsgraph_eval_performance.py -- --chains=500 --bones=20 --frames=50
+#
+# Use '--debug-depsgraph' to get the time spent per evaluated frame,
+# and '--debug-depsgraph-no-threads' to compare against single threaded evaluation.
+# Pass '--trace=<filepath>' after '--' to write a Chrome Trace of the evaluated frames
+# (open it in chrome://tracing).
+
+import sys
+import time
+
+import bpy
+
+
+def create_rig(tot_chains, tot_bones):
+    scene = bpy.context.scene
+
+    arm = bpy.data.armatures.new("Rig")
+    ob = bpy.data.objects.new("Rig", arm)
+    scene.objects.link(ob)
+    scene.objects.active = ob
+
+    # Many independent chains, so there is enough parallelism to exploit,
+    # with long dependency paths within each of them.
+    bpy.ops.object.mode_set(mode='EDIT')
+    for i in range(tot_chains):
+        parent = None
+        for j in range(tot_bones):
+            eb = arm.edit_bones.new("Bone.%04d.%03d" % (i, j))
+            eb.head = (i * 0.1, 0.0, j * 0.1)
+            eb.tail = (i * 0.1, 0.0, (j + 1) * 0.1)
+            eb.parent = parent
+            eb.use_connect = parent is not None
+            parent = eb
+    bpy.ops.object.mode_set(mode='OBJECT')
+
+    for i in range(tot_chains):
+        chain = [ob.pose.bones["Bone.%04d.%03d" % (i, j)] for j in range(tot_bones)]
+
+        # Driver on the root bone, constraint copying it further down the chain.
+        fcu = chain[0].driver_add("rotation_euler", 0)
+        fcu.driver.type = 'SCRIPTED'
+        fcu.driver.expression = "frame * 0.01"
+
+        for pchan in chain[1:]:
+            con = pchan.constraints.new('COPY_ROTATION')
+            con.target = ob
+            con.subtarget = chain[0].name
+            con.mix_mode = 'ADD'
+
+        ik = chain[-1].constraints.new('IK')
+        ik.chain_count = tot_bones // 2
+
+    return ob
+
+
+def main():
+    argv = sys.argv[sys.argv.index("--") + 1:] if "--" in sys.argv else []
+    args = dict(arg.lstrip("-").split("=", 1) for arg in argv if "=" in arg)
+    tot_chains = int(args.get("chains", 500))
+    tot_bones = int(args.get("bones", 20))
+    tot_frames = int(args.get("frames", 50))
+
+    scene = bpy.context.scene
+
+    t = time.time()
+    create_rig(tot_chains, tot_bones)
+    scene.update()
+    print("Created rig with %d bones in %.3f sec" % (tot_chains * tot_bones, time.time() - t))
+
+    trace = args.get("trace")
+    if trace:
+        bpy.context.scene.depsgraph.debug_trace_begin()
+
+    timings = []
+    for frame in range(1, tot_frames + 1):
+        t = time.time()
+        scene.frame_set(frame)
+        timings.append(time.time() - t)
+
+    print("Frame change: best %.4f sec, average %.4f sec, %.2f fps (%d frames)" %
+          (min(timings), sum(timings) / len(timings), len(timings) / sum(timings), tot_frames))
+
+    if trace:
+        scene.depsgraph.debug_trace_end()
+        scene.depsgraph.debug_trace_write(trace)
+        print("Written trace to %r" % trace)
+
+
+if __name__ == "__main__":
+    main()
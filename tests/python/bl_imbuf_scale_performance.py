@@ -0,0 +1,63 @@
+# Apache License, Version 2.0
+
+# Benchmark scaling of byte and float images down and up, as done for thumbnails,
+# proxies and texture painting.
+#
+# ./blender.bin --background -noaudio --factory-startup \
+#     --python tests/python/bl_imbuf_scale_performance.py -- --size=3840 --scales=5
+
+import sys
+import time
+
+import bpy
+
+
+# (name, width factor, height factor)
+SCALES = (
+    ("half", 0.5, 0.5),
+    ("thumbnail", 0.0625, 0.0625),
+    ("double", 2.0, 2.0),
+    ("anamorphic", 0.75, 1.5),
+)
+
+
+def benchmark(width, height, float_buffer, tot_scales):
+    for name, factor_x, factor_y in SCALES:
+        new_width = max(1, int(width * factor_x))
+        new_height = max(1, int(height * factor_y))
+        timings = []
+
+        for i in range(tot_scales):
+            image = bpy.data.images.new("Scale", width, height, float_buffer=float_buffer)
+            image.generated_type = 'COLOR_GRID'
+
+            # generate the buffer before timing
+            image.pixels[0]
+
+            t = time.time()
+            image.scale(new_width, new_height)
+            timings.append(time.time() - t)
+
+            if tuple(image.size) != (new_width, new_height):
+                print("Image scaled to %dx%d instead of %dx%d" % (image.size[0], image.size[1], new_width, new_height))
+                sys.exit(1)
+
+            bpy.data.images.remove(image)
+
+        print("Scale %s %s (%dx%d -> %dx%d): best %.4f sec, average %.4f sec (%d scales)" %
+              ("float" if float_buffer else "byte", name, width, height, new_width, new_height,
+               min(timings), sum(timings) / len(timings), tot_scales))
+
+
+def main():
+    argv = sys.argv[sys.argv.index("--") + 1:] if "--" in sys.argv else []
+    args = dict(arg.lstrip("-").split("=", 1) for arg in argv if "=" in arg)
+    size = int(args.get("size", 3840))
+    tot_scales = int(args.get("scales", 5))
+
+    benchmark(size, size * 9 // 16, False, tot_scales)
+    benchmark(size, size * 9 // 16, True, tot_scales)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,131 @@
+# Apache License, Version 2.0
+
+# Benchmark reading the frames of a movie strip forward, as when playing back, where frames
+# are decoded ahead in a thread, and in random order, as when scrubbing, where every frame
+# restarts decoding. Check that both give the same frames.
+#
+# ./blender.bin --background -noaudio --factory-startup \
+#     --python tests/python/bl_sequencer_movie_performance.py -- --size=1920 --frames=100
+#
+# The movie is written by the script, in H.264 with a single group of pictures, so frames
+# can only be decoded from the start of the movie.
+
+import hashlib
+import os
+import random
+import sys
+import tempfile
+import time
+
+import bpy
+
+
+def write_movie(directory, width, height, tot_frames):
+    scene = bpy.data.scenes.new("Movie")
+    scene.render.resolution_x = width
+    scene.render.resolution_y = height
+    scene.render.resolution_percentage = 100
+    scene.frame_start = 1
+    scene.frame_end = tot_frames
+    scene.render.use_sequencer = True
+    scene.render.use_compositing = False
+
+    image = bpy.data.images.new("Input", width, height)
+    image.generated_type = 'COLOR_GRID'
+    image.filepath_raw = os.path.join(directory, "input.png")
+    image.file_format = 'PNG'
+    image.save()
+
+    ed = scene.sequence_editor_create()
+    strip = ed.sequences.new_image("Input", image.filepath_raw, 1, 1)
+    strip.frame_final_end = tot_frames + 1
+    effect = ed.sequences.new_effect("Transform", 'TRANSFORM', 2, 1,
+                                     frame_end=tot_frames + 1, seq1=strip)
+    effect.rotation_start = 0.0
+    effect.keyframe_insert("rotation_start", frame=1)
+    effect.rotation_start = 90.0
+    effect.keyframe_insert("rotation_start", frame=tot_frames)
+
+    scene.render.image_settings.file_format = 'FFMPEG'
+    scene.render.ffmpeg.format = 'MPEG4'
+    scene.render.ffmpeg.codec = 'H264'
+    scene.render.ffmpeg.gopsize = tot_frames
+    scene.render.ffmpeg.audio_codec = 'NONE'
+    scene.render.filepath = os.path.join(directory, "movie_")
+    scene.render.use_file_extension = True
+
+    bpy.context.screen.scene = scene
+    bpy.ops.render.render(animation=True, scene=scene.name)
+    filepath = scene.render.frame_path(frame=scene.frame_start)
+
+    bpy.data.scenes.remove(scene)
+    return filepath
+
+
+def render(scene, filepath):
+    t = time.time()
+    bpy.ops.render.render()
+    elapsed = time.time() - t
+    bpy.data.images["Render Result"].save_render(filepath, scene=scene)
+    with open(filepath, "rb") as f:
+        return elapsed, hashlib.md5(f.read()).hexdigest()
+
+
+def benchmark(scene, strip, directory, name, frames):
+    # free the sequencer cache, so all frames are read from the movie
+    strip.color_saturation = strip.color_saturation
+
+    timings = []
+    checksums = {}
+    for frame in frames:
+        scene.frame_set(frame)
+        elapsed, checksums[frame] = render(scene, os.path.join(directory, "result_%s.png" % name))
+        timings.append(elapsed)
+
+    print("Movie strip %s (%dx%d): best %.4f sec, average %.4f sec (%d frames)" %
+          (name, scene.render.resolution_x, scene.render.resolution_y,
+           min(timings), sum(timings) / len(timings), len(frames)))
+    return checksums
+
+
+def main():
+    argv = sys.argv[sys.argv.index("--") + 1:] if "--" in sys.argv else []
+    args = dict(arg.lstrip("-").split("=", 1) for arg in argv if "=" in arg)
+    size = int(args.get("size", 1920))
+    tot_frames = int(args.get("frames", 100))
+
+    scene = bpy.context.scene
+    directory = tempfile.mkdtemp()
+
+    movie = write_movie(directory, size, size * 9 // 16, tot_frames)
+    if not os.path.exists(movie):
+        print("Movie was not written, FFmpeg is needed")
+        sys.exit(1)
+
+    bpy.context.screen.scene = scene
+    scene.render.resolution_x = size
+    scene.render.resolution_y = size * 9 // 16
+    scene.render.resolution_percentage = 100
+    scene.render.use_sequencer = True
+    scene.render.use_compositing = False
+    scene.render.image_settings.file_format = 'PNG'
+    scene.frame_start = 1
+    scene.frame_end = tot_frames
+
+    ed = scene.sequence_editor_create()
+    strip = ed.sequences.new_movie("Movie", movie, 1, 1)
+
+    frames = list(range(1, tot_frames + 1))
+    checksums_forward = benchmark(scene, strip, directory, "forward", frames)
+    random.seed(0)
+    random.shuffle(frames)
+    checksums_random = benchmark(scene, strip, directory, "random", frames)
+
+    if checksums_forward != checksums_random:
+        print("Frames read forward differ from frames read in random order")
+        sys.exit(1)
+    print("Frames read forward match frames read in random order")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,119 @@
+# Apache License, Version 2.0
+
+# Benchmark rendering of a sequencer edit with stacked channels, rendering the strips of a
+# frame serially and in parallel, and check that both give the same result.
+#
+# ./blender.bin --background -noaudio --factory-startup \
+#     --python tests/python/bl_sequencer_performance.py -- --channels=8 --size=1920 --renders=5
+#
+# When a .blend file is loaded before the script, its sequencer edit is used, otherwise a
+# synthetic edit is created, with an image strip blended on every channel, color balance
+# modifiers and a cross and a transform effect taking some of the channels as input.
+#
+# Strips are rendered serially with one render thread, and in parallel otherwise.
+
+import hashlib
+import os
+import sys
+import tempfile
+import time
+
+import bpy
+
+
+BLEND_TYPES = ('ALPHA_OVER', 'ADD', 'MULTIPLY', 'SCREEN', 'OVERLAY', 'SUBTRACT', 'ALPHA_UNDER')
+
+
+def create_edit(scene, directory, tot_channels, width, height):
+    ed = scene.sequence_editor_create()
+    frame_end = scene.frame_end
+    strips = []
+
+    for channel in range(1, tot_channels + 1):
+        image = bpy.data.images.new("Input %d" % channel, width, height)
+        image.generated_type = 'COLOR_GRID' if channel % 2 else 'UV_GRID'
+        image.filepath_raw = os.path.join(directory, "input_%d.png" % channel)
+        image.file_format = 'PNG'
+        image.save()
+
+        strip = ed.sequences.new_image("Channel %d" % channel, image.filepath_raw, channel, 1)
+        strip.frame_final_end = frame_end + 1
+        if channel > 1:
+            strip.blend_type = BLEND_TYPES[channel % len(BLEND_TYPES)]
+            strip.blend_alpha = 0.5
+        if channel % 3 == 0:
+            modifier = strip.modifiers.new("Color Balance", 'COLOR_BALANCE')
+            modifier.color_balance.gain = (1.2, 0.9, 0.8)
+        strips.append(strip)
+
+    if tot_channels >= 4:
+        effect = ed.sequences.new_effect("Cross", 'GAMMA_CROSS', tot_channels + 1, 1,
+                                         frame_end=frame_end + 1, seq1=strips[-2], seq2=strips[-1])
+        effect.blend_type = 'ALPHA_OVER'
+        effect = ed.sequences.new_effect("Transform", 'TRANSFORM', tot_channels + 2, 1,
+                                         frame_end=frame_end + 1, seq1=strips[-3])
+        effect.rotation_start = 10.0
+        effect.blend_type = 'ADD'
+        effect.blend_alpha = 0.5
+
+
+def render(scene, filepath):
+    bpy.ops.render.render()
+    bpy.data.images["Render Result"].save_render(filepath, scene=scene)
+    with open(filepath, "rb") as f:
+        return hashlib.md5(f.read()).hexdigest()
+
+
+def benchmark(scene, tot_renders, directory, threads):
+    if threads:
+        scene.render.threads_mode = 'FIXED'
+        scene.render.threads = threads
+    else:
+        scene.render.threads_mode = 'AUTO'
+
+    timings = []
+    checksums = set()
+    for i in range(tot_renders):
+        scene.frame_set(scene.frame_start + i)
+        t = time.time()
+        checksums.add((i, render(scene, os.path.join(directory, "result_%d.png" % i))))
+        timings.append(time.time() - t)
+
+    print("Sequencer (%s, %dx%d): best %.4f sec, average %.4f sec (%d renders)" %
+          ("serial" if threads == 1 else "parallel", scene.render.resolution_x, scene.render.resolution_y,
+           min(timings), sum(timings) / len(timings), tot_renders))
+    return checksums
+
+
+def main():
+    argv = sys.argv[sys.argv.index("--") + 1:] if "--" in sys.argv else []
+    args = dict(arg.lstrip("-").split("=", 1) for arg in argv if "=" in arg)
+    tot_channels = int(args.get("channels", 8))
+    size = int(args.get("size", 1920))
+    tot_renders = int(args.get("renders", 5))
+
+    scene = bpy.context.scene
+    directory = tempfile.mkdtemp()
+
+    if scene.sequence_editor is None or not bpy.data.filepath:
+        scene.render.resolution_x = size
+        scene.render.resolution_y = size * 9 // 16
+        scene.render.resolution_percentage = 100
+        scene.frame_start = 1
+        scene.frame_end = tot_renders
+        create_edit(scene, directory, tot_channels, scene.render.resolution_x, scene.render.resolution_y)
+
+    scene.render.use_sequencer = True
+    scene.render.image_settings.file_format = 'PNG'
+
+    checksums_serial = benchmark(scene, tot_renders, directory, 1)
+    checksums_parallel = benchmark(scene, tot_renders, directory, 0)
+
+    if checksums_serial != checksums_parallel:
+        print("Parallel render differs from serial render")
+        sys.exit(1)
+    print("Parallel render matches serial render")
+
+
+if __name__ == "__main__":
+    main()
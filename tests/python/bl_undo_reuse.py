@@ -0,0 +1,107 @@
+# Apache License, Version 2.0
+
+# Global undo regression tests: datablocks that did not change between undo steps
+# are kept in memory, changed datablocks are read back from the undo step.
+#
+# ./blender.bin --background -noaudio --factory-startup --python tests/python/bl_undo_reuse.py -- --verbose
+import unittest
+
+import bpy
+
+
+def context_override():
+    window = bpy.context.window_manager.windows[0]
+    return {"window": window, "screen": window.screen}
+
+
+def undo_push(message):
+    bpy.ops.ed.undo_push(context_override(), message=message)
+
+
+def undo():
+    bpy.ops.ed.undo(context_override())
+
+
+def redo():
+    bpy.ops.ed.redo(context_override())
+
+
+def id_pointers(collection):
+    return {id_data.name: id_data.as_pointer() for id_data in collection}
+
+
+class TestUndoReuse(unittest.TestCase):
+    def setUp(self):
+        bpy.ops.wm.read_factory_settings()
+        undo_push("Initial")
+
+    def test_object_location(self):
+        bpy.data.objects["Cube"].location.x = 5.0
+        undo_push("Move")
+
+        objects = id_pointers(bpy.data.objects)
+        meshes = id_pointers(bpy.data.meshes)
+        cameras = id_pointers(bpy.data.cameras)
+
+        undo()
+        self.assertEqual(bpy.data.objects["Cube"].location.x, 0.0)
+        # unchanged datablocks keep their memory
+        self.assertEqual(bpy.data.objects["Camera"].as_pointer(), objects["Camera"])
+        self.assertEqual(bpy.data.objects["Lamp"].as_pointer(), objects["Lamp"])
+        self.assertEqual(id_pointers(bpy.data.meshes), meshes)
+        self.assertEqual(id_pointers(bpy.data.cameras), cameras)
+
+        redo()
+        self.assertEqual(bpy.data.objects["Cube"].location.x, 5.0)
+        self.assertEqual(bpy.data.objects["Camera"].as_pointer(), objects["Camera"])
+        self.assertEqual(id_pointers(bpy.data.meshes), meshes)
+
+    def test_obdata_dependency(self):
+        # the camera object uses the changed camera, it's read again too
+        bpy.data.cameras["Camera"].lens = 70.0
+        undo_push("Lens")
+
+        undo()
+        self.assertEqual(bpy.data.cameras["Camera"].lens, 35.0)
+        self.assertIs(bpy.data.objects["Camera"].data, bpy.data.cameras["Camera"])
+
+        redo()
+        self.assertEqual(bpy.data.cameras["Camera"].lens, 70.0)
+        self.assertIs(bpy.data.objects["Camera"].data, bpy.data.cameras["Camera"])
+
+    def test_add_remove(self):
+        objects = id_pointers(bpy.data.objects)
+
+        bpy.data.meshes.new("UndoMesh").use_fake_user = True
+        undo_push("Add")
+        self.assertIn("UndoMesh", bpy.data.meshes)
+
+        undo()
+        self.assertNotIn("UndoMesh", bpy.data.meshes)
+        self.assertEqual(id_pointers(bpy.data.objects), objects)
+
+        redo()
+        self.assertIn("UndoMesh", bpy.data.meshes)
+        self.assertEqual(id_pointers(bpy.data.objects), objects)
+
+    def test_user_count(self):
+        mesh = bpy.data.meshes["Cube"]
+        users = mesh.users
+        bpy.data.objects.new("UndoObject", mesh).use_fake_user = True
+        undo_push("Add User")
+        self.assertEqual(bpy.data.meshes["Cube"].users, users + 1)
+
+        # users of datablocks kept or read again match the undo step
+        undo()
+        self.assertNotIn("UndoObject", bpy.data.objects)
+        self.assertEqual(bpy.data.meshes["Cube"].users, users)
+
+        redo()
+        self.assertEqual(bpy.data.meshes["Cube"].users, users + 1)
+
+
+if __name__ == '__main__':
+    import sys
+
+    sys.argv = [__file__] + (sys.argv[sys.argv.index("--") + 1:] if "--" in sys.argv else [])
+    unittest.main()